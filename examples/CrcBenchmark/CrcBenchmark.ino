@@ -0,0 +1,140 @@
+/*
+ * VanBus: CrcBenchmark - measure the speed of the CRC calculation.
+ *
+ * Written by Erik Tromp
+ *
+ * Version 0.4.2 - October, 2026
+ *
+ * MIT license, all text above must be included in any redistribution.
+ *
+ * -----
+ * Description
+ *
+ * The CRC is calculated for each received packet (see 'TVanPacketRxDesc::CheckCrc' and
+ * 'TVanPacketRxDesc::CheckCrcAndRepair') and for each transmitted packet. The library can be compiled with one of
+ * these CRC calculation methods (see VanBusRx.h):
+ * - Default: one lookup table of 256 entries, one byte at a time
+ * - VAN_CRC_SLICING_BY_4: four lookup tables of 256 entries, four bytes at a time
+ * - VAN_CRC_NIBBLE_TABLE: one lookup table of 16 entries, half a byte at a time
+ *
+ * This sketch first checks the CRC calculation against a plain bit-by-bit calculation, then measures the time it
+ * takes, for a few packet sizes. Run it once for each method, to compare. No VAN bus needs to be connected.
+ *
+ * -----
+ * Output
+ *
+ * A line like this for each packet size:
+ *
+ *   size 33: 6.85 usec per packet, 0.21 usec (17.1 cycles) per byte
+ */
+
+#include <VanBusRx.h>  // https://github.com/0xCAFEDECAF/VanBus
+
+// Number of CRC calculations per measurement
+#define N_RUNS 10000
+
+// Packet sizes, including SOF and CRC
+const int sizes[] = { 5, 7, 16, 22, VAN_MAX_PACKET_SIZE };
+#define N_SIZES (sizeof(sizes) / sizeof(sizes[0]))
+
+// Reference: calculates the CRC one bit at a time. Same arguments and result as '_crcUpdate'.
+uint16_t CrcUpdateBitwise(uint16_t crc15, const uint8_t bytes[], int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        for (int bit = 7; bit >= 0; bit--)
+        {
+            const bool inBit = (bytes[i] >> bit & 1) != 0;
+            const bool topBit = (crc15 & 0x4000) != 0;
+            crc15 = (crc15 << 1) & 0x7FFF;
+            if (inBit != topBit) crc15 ^= 0x0F9D;
+        } // for
+    } // for
+
+    return crc15;
+} // CrcUpdateBitwise
+
+uint32_t randomState = 1;
+
+uint8_t RandomByte()
+{
+    // Xorshift
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
+} // RandomByte
+
+// Compares '_crcUpdate' with 'CrcUpdateBitwise' on random data. Returns the number of differences.
+int CheckCrcUpdate()
+{
+    uint8_t bytes[VAN_MAX_PACKET_SIZE];
+    int nErrors = 0;
+
+    for (int i = 0; i < 1000; i++)
+    {
+        const int n = RandomByte() % (VAN_MAX_PACKET_SIZE + 1);
+        for (int j = 0; j < n; j++) bytes[j] = RandomByte();
+        const uint16_t from = (RandomByte() << 8 | RandomByte()) & 0x7FFF;
+
+        if ((_crcUpdate(from, bytes, n) & 0x7FFF) != CrcUpdateBitwise(from, bytes, n)) nErrors++;
+    } // for
+
+    return nErrors;
+} // CheckCrcUpdate
+
+void Measure(int size)
+{
+    uint8_t bytes[VAN_MAX_PACKET_SIZE];
+    for (int i = 0; i < size; i++) bytes[i] = RandomByte();
+
+    // Same calculation as 'TVanPacketRxDesc::CheckCrc'. Make sure the compiler cannot leave out any calculation.
+    volatile uint16_t result = 0;
+
+    const uint32_t start = ESP.getCycleCount();
+    for (int i = 0; i < N_RUNS; i++)
+    {
+        bytes[3] = i;
+        result = result ^ _crcUpdate(0x7FFF, bytes + 1, size - 1);
+    } // for
+    const uint32_t cycles = ESP.getCycleCount() - start;  // Arithmetic has safe roll-over
+
+    char floatBuf[3][MAX_FLOAT_SIZE];
+    const float cyclesPerByte = (float)cycles / N_RUNS / (size - 1);
+    Serial.printf_P(PSTR("size %2d: %s usec per packet, %s usec (%s cycles) per byte\n"),
+        size,
+        FloatToStr(floatBuf[0], (float)cycles / N_RUNS / (F_CPU / 1000000), 2),
+        FloatToStr(floatBuf[1], cyclesPerByte / (F_CPU / 1000000), 2),
+        FloatToStr(floatBuf[2], cyclesPerByte, 1));
+
+    yield();
+} // Measure
+
+void setup()
+{
+    delay(1000);
+    Serial.begin(115200);
+
+    Serial.printf_P(PSTR("Starting VAN bus CRC benchmark, CPU at %u MHz, CRC calculation method: %s\n"),
+        (unsigned int)(F_CPU / 1000000),
+      #if defined VAN_CRC_SLICING_BY_4
+        "slicing-by-4 (VAN_CRC_SLICING_BY_4)"
+      #elif defined VAN_CRC_NIBBLE_TABLE
+        "nibble table (VAN_CRC_NIBBLE_TABLE)"
+      #else
+        "byte table (default)"
+      #endif // VAN_CRC_SLICING_BY_4
+    );
+
+    const int nErrors = CheckCrcUpdate();
+    Serial.printf_P(PSTR("CRC check: %s (%d errors)\n"), nErrors == 0 ? "OK" : "FAILED", nErrors);
+
+    // Warm up instruction cache and data cache
+    Measure(VAN_MAX_PACKET_SIZE);
+
+    for (unsigned int i = 0; i < N_SIZES; i++) Measure(sizes[i]);
+} // setup
+
+void loop()
+{
+} // loop
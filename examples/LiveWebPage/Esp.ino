@@ -39,88 +39,54 @@ void PrintSystemSpecs()
     Serial.print("\n");
 } // PrintSystemSpecs
 
-const char* EspSystemDataToJson(char* buf, const int n)
+void EspSystemDataToJson(TJsonStream& json)
 {
+  #ifdef PRINT_JSON_BUFFERS_ON_SERIAL
+    printJsonEvent = true;
+  #endif // PRINT_JSON_BUFFERS_ON_SERIAL
+
   #ifndef ARDUINO_ARCH_ESP32
     uint32_t flashSizeReal = ESP.getFlashChipRealSize();
   #endif // ARDUINO_ARCH_ESP32
     uint32_t flashSizeIde = ESP.getFlashChipSize();
     FlashMode_t flashModeIde = ESP.getFlashChipMode();
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-          #ifndef ARDUINO_ARCH_ESP32
-            "\"esp_last_reset_reason\": \"%s\",\n"
-            "\"esp_last_reset_info\": \"%s\",\n"
-            "\"esp_boot_version\": \"%u\",\n"
-          #endif // ARDUINO_ARCH_ESP32
-            "\"esp_cpu_speed\": \"%u MHz\",\n"
-            "\"esp_sdk_version\": \"%s\",\n"
-          #ifndef ARDUINO_ARCH_ESP32
-            "\"esp_chip_id\": \"0x%08X\",\n"
-            "\"esp_flash_id\": \"0x%08X\",\n"
-            "\"esp_flash_size_real\": \"%s MBytes\",\n"
-          #endif // ARDUINO_ARCH_ESP32
-            "\"esp_flash_size_ide\": \"%s MBytes\",\n"
-            "\"esp_flash_speed_ide\": \"%s MHz\",\n"
-
-            "\"esp_flash_mode_ide\": \"%s\",\n"
-
-            "\"esp_mac_address\": \"%s\",\n"
-            "\"esp_ip_address\": \"%s\",\n"
-            "\"esp_wifi_rssi\": \"%d dB\",\n"
-
-            "\"esp_free_ram\": \"%u bytes\"\n"
-        "}\n"
-    "}\n";
-
-    char floatBuf[3][MAX_FLOAT_SIZE];
-    int at = snprintf_P(buf, n, jsonFormatter,
-
-      #ifndef ARDUINO_ARCH_ESP32
-        ESP.getResetReason().c_str(),
-        ESP.getResetInfo().c_str(),
-
-        ESP.getBootVersion(),
-      #endif // ARDUINO_ARCH_ESP32
-        ESP.getCpuFreqMHz(),
-        ESP.getSdkVersion(),
-      #ifndef ARDUINO_ARCH_ESP32
-        ESP.getChipId(),
+  #ifndef ARDUINO_ARCH_ESP32
+    json.Str(PSTR("esp_last_reset_reason"), ESP.getResetReason().c_str());
+    json.Str(PSTR("esp_last_reset_info"), ESP.getResetInfo().c_str());
+    json.Printf(PSTR("esp_boot_version"), PSTR("%u"), ESP.getBootVersion());
+  #endif // ARDUINO_ARCH_ESP32
+    json.Printf(PSTR("esp_cpu_speed"), PSTR("%u MHz"), ESP.getCpuFreqMHz());
+    json.Str(PSTR("esp_sdk_version"), ESP.getSdkVersion());
 
-        ESP.getFlashChipId(),
-        FloatToStr(floatBuf[0], flashSizeReal/1024.0/1024.0, 2),
-      #endif // ARDUINO_ARCH_ESP32
-        FloatToStr(floatBuf[1], flashSizeIde/1024.0/1024.0, 2),
-        FloatToStr(floatBuf[2], ESP.getFlashChipSpeed()/1000000.0, 2),
+    char floatBuf[MAX_FLOAT_SIZE];
+  #ifndef ARDUINO_ARCH_ESP32
+    json.Printf(PSTR("esp_chip_id"), PSTR("0x%08X"), ESP.getChipId());
+    json.Printf(PSTR("esp_flash_id"), PSTR("0x%08X"), ESP.getFlashChipId());
+    json.Printf(PSTR("esp_flash_size_real"), PSTR("%s MBytes"), FloatToStr(floatBuf, flashSizeReal/1024.0/1024.0, 2));
+  #endif // ARDUINO_ARCH_ESP32
+    json.Printf(PSTR("esp_flash_size_ide"), PSTR("%s MBytes"), FloatToStr(floatBuf, flashSizeIde/1024.0/1024.0, 2));
+    json.Printf(PSTR("esp_flash_speed_ide"), PSTR("%s MHz"),
+        FloatToStr(floatBuf, ESP.getFlashChipSpeed()/1000000.0, 2)
+    );
 
+    json.Str(PSTR("esp_flash_mode_ide"),
         flashModeIde == FM_QIO ? qioStr :
         flashModeIde == FM_QOUT ? qoutStr :
         flashModeIde == FM_DIO ? dioStr :
         flashModeIde == FM_DOUT ? doutStr :
-        unknownStr,
+        unknownStr
+    );
 
-        WiFi.macAddress().c_str(),
-        WiFi.localIP().toString().c_str(),
-        WiFi.RSSI(),
+    json.Str(PSTR("esp_mac_address"), WiFi.macAddress().c_str());
+    json.Str(PSTR("esp_ip_address"), WiFi.localIP().toString().c_str());
+    json.Printf(PSTR("esp_wifi_rssi"), PSTR("%d dB"), WiFi.RSSI());
 
+    json.Printf(PSTR("esp_free_ram"), PSTR("%u bytes"),
       #ifdef ARDUINO_ARCH_ESP32
         esp_get_free_heap_size()
       #else
         system_get_free_heap_size()
       #endif // ARDUINO_ARCH_ESP32
     );
-
-    // JSON buffer overflow?
-    if (at >= n) return "";
-
-  #ifdef PRINT_JSON_BUFFERS_ON_SERIAL
-    Serial.print(F("Parsed to JSON object:\n"));
-    PrintJsonText(buf);
-  #endif // PRINT_JSON_BUFFERS_ON_SERIAL
-
-    return buf;
 } // EspSystemDataToJson
@@ -39,7 +39,11 @@ typedef struct
 extern const char emptyStr[];
 extern const char yesStr[];
 extern const char noStr[];
-void PrintJsonText(const char* jsonBuffer);
+
+// Defined in LiveWebPage.ino
+#ifdef PRINT_JSON_BUFFERS_ON_SERIAL
+extern bool printJsonEvent;
+#endif // PRINT_JSON_BUFFERS_ON_SERIAL
 
 // Main class for receiving IR
 class IRrecv
@@ -212,35 +216,15 @@ int IRrecv::compare(unsigned int oldval, unsigned int newval)
     return 1;
 } // IRrecv::compare
 
-const char* ParseIrPacketToJson(const TIrPacket& pkt)
+void ParseIrPacketToJson(const TIrPacket& pkt, TJsonStream& json)
 {
-    #define IR_JSON_BUFFER_SIZE 256
-    static char jsonBuffer[IR_JSON_BUFFER_SIZE];
-
-    if (strlen_P(pkt.buttonStr) == 0) return "";
-
-    PGM_P heldStr = pkt.held ? PSTR(" (held)") : emptyStr;
-
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"mfd_remote_control\": \"%s%s\"\n"
-        "}\n"
-    "}\n";
-
-    int at = snprintf_P(jsonBuffer, IR_JSON_BUFFER_SIZE, jsonFormatter, pkt.buttonStr, heldStr);
-
-    // JSON buffer overflow?
-    if (at >= IR_JSON_BUFFER_SIZE) return "";
+    if (strlen_P(pkt.buttonStr) == 0) return;
 
   #ifdef PRINT_JSON_BUFFERS_ON_SERIAL
-    Serial.print(F("IR remote control packet parsed to JSON object:\n"));
-    PrintJsonText(jsonBuffer);
+    printJsonEvent = true;
   #endif // PRINT_JSON_BUFFERS_ON_SERIAL
 
-    return jsonBuffer;
+    json.Printf(PSTR("mfd_remote_control"), PSTR("%s%s"), pkt.buttonStr, pkt.held ? PSTR(" (held)") : emptyStr);
 } // ParseIrPacketToJson
 
 IRrecv* irrecv;
@@ -0,0 +1,517 @@
+#ifndef JsonStream_h
+#define JsonStream_h
+
+// Delta JSON field encoder for the "display" events sent to the live web page.
+//
+// The web page ('writeToDom') simply updates each DOM object named in the "data" member of an event. So there is
+// no need to send a value that was sent before: the web page is already showing it. The packet parsers add each
+// member of "data" by calling this encoder, which remembers a hash of the last value sent for each key. A member
+// with the same value as last sent is left out. For the 'Str', 'Printf' and 'Style' members, the hash is taken
+// from the arguments, so an unchanged value is not even formatted. Insignificant white space is left out.
+//
+// The members are written directly into a fixed buffer of JSON_CHUNK_SIZE bytes. When that is full, the members in
+// it are sent as one complete event, and the next members go into a new event. 'EndEvent' sends the rest.
+//
+// A value is only remembered as sent when the sink reports that it sent the message. If the sink fails, the values
+// in that message are sent again with the next event that contains them. A message that the sink sent, but that the
+// client did not receive, cannot be detected here; 'Reset' when a client (re)connects.
+//
+// Keys, formats and string values are read with 'pgm_read_byte', so they can be in PROGMEM or in RAM. Static RAM:
+// about 8.5 kBytes (see JSON_DELTA_N_KEYS, JSON_CHUNK_SIZE and JSON_MAX_CHUNK_MEMBERS).
+
+#include <Arduino.h>
+#include <stdarg.h>
+
+// Number of JSON keys for which the hash of the last sent value is remembered. The LiveWebPage example uses around
+// 300 keys. More keys do not break anything, but values for those keys are always sent.
+#define JSON_DELTA_N_KEYS 512
+
+// Maximum size (including terminating '\0') of a message passed to the sink. A single member that does not fit is
+// left out; an array that does not fit is cut short. The longest array is a sat nav list of up to 80 entries.
+#define JSON_CHUNK_SIZE 4096
+
+// Maximum number of changed members of "data" in a message passed to the sink. If there are more, the event is split.
+#define JSON_MAX_CHUNK_MEMBERS 64
+
+// The members outside "data"
+#define JSON_EVENT_HEADER "{\"event\":\"display\",\"data\":{"
+#define JSON_EVENT_HEADER_LEN (sizeof(JSON_EVENT_HEADER) - 1)
+
+// Receives each complete JSON message, e.g. to send it over a websocket. Returns false if the message could not be
+// sent.
+typedef bool (*TJsonSink)(const char* json);
+
+class TJsonStream
+{
+  public:
+
+    // Constructor
+    TJsonStream(TJsonSink sink)
+        : sink(sink)
+        , at(chunk + JSON_EVENT_HEADER_LEN)
+        , memberAt(NULL)
+        , nPending(0)
+        , nMembersIn(0)
+        , nMembersOut(0)
+        , nBytesOut(0)
+    {
+        memcpy_P(chunk, PSTR(JSON_EVENT_HEADER), JSON_EVENT_HEADER_LEN);
+        Reset();
+    } // TJsonStream
+
+    // Forget all values sent; the next events are sent in full. Call e.g. when a new client connects.
+    void Reset()
+    {
+        memset(keyHashes, 0, sizeof(keyHashes));
+    } // Reset
+
+    // Adds member "key": "value"
+    void Str(PGM_P key, PGM_P value);
+
+    // Adds member "key": "<value>", where the value is formatted as by 'printf_P'. Conversions supported for
+    // comparing the arguments: "%%", "%c", "%s", "%p" and the integer and floating point conversions, with the usual
+    // flags, width, precision (also "*") and length modifiers "hh", "h", "l", "ll", "z" and "j".
+    void Printf(PGM_P key, PGM_P format, ...);
+
+    // Adds member "key": {"style": {"property": "<value>"}}, where the value is formatted as by 'Printf'
+    void Style(PGM_P key, PGM_P property, PGM_P format, ...);
+
+    // Adds member "key": ["<item>", ...]. Call 'ArrayItem' for each item, formatted as by 'Printf', then 'EndArray'.
+    // Note: an array can only be compared when it is complete, so its items are always formatted.
+    void BeginArray(PGM_P key);
+    void ArrayItem(PGM_P format, ...);
+    void EndArray();
+
+    // Sends the members of the current event that were not sent yet. The next members start a new event.
+    void EndEvent();
+
+    // Leaves out the members of the current event that were not sent yet, e.g. when parsing failed halfway
+    void CancelEvent()
+    {
+        at = chunk + JSON_EVENT_HEADER_LEN;
+        memberAt = NULL;
+        nPending = 0;
+    } // CancelEvent
+
+    uint32_t GetMembersIn() const { return nMembersIn; }
+    uint32_t GetMembersOut() const { return nMembersOut; }
+    uint32_t GetBytesOut() const { return nBytesOut; }
+
+  private:
+
+    static const uint32_t hashInit = 2166136261UL;  // FNV-1a
+    static uint32_t Hash(uint32_t hash, uint32_t v) { return (hash ^ v) * 16777619UL; }
+    static uint32_t HashStr(uint32_t hash, PGM_P s, int maxLen = -1);
+    static uint32_t HashArgs(uint32_t hash, PGM_P format, va_list args);
+
+    bool Changed(PGM_P key, uint32_t valueHash, int& i);
+    int FindKey(uint32_t keyHash);
+
+    bool Put(char c);
+    bool PutStr(PGM_P s);
+    bool PutPrintf(PGM_P format, va_list args);
+    bool OpenMember(PGM_P key);
+    void CloseMember(int i, uint32_t valueHash);
+    void DropMember();
+    bool SplitChunk();
+    void EmitChunk(char* end);
+
+    TJsonSink sink;
+
+    // Open addressing hash table: key hash 0 means: empty entry; value hash 0 means: no value sent yet
+    uint32_t keyHashes[JSON_DELTA_N_KEYS];
+    uint32_t valueHashes[JSON_DELTA_N_KEYS];
+
+    // Room is kept for the closing "}}" and the terminating '\0'
+    char chunk[JSON_CHUNK_SIZE];
+    char* const chunkEnd = chunk + JSON_CHUNK_SIZE - 3;
+    char* at;  // Where the next character goes
+    char* memberAt;  // Start of the member being written, or NULL
+
+    // The array being written
+    PGM_P arrayKey;
+    uint32_t arrayHash;
+    int nArrayItems;
+    bool arrayCut;
+
+    // Members in 'chunk', to be remembered as sent once the sink has sent the chunk
+    int nPending;
+    int16_t pendingKeys[JSON_MAX_CHUNK_MEMBERS];  // Index into 'keyHashes', or -1 if the table is full
+    uint32_t pendingValueHashes[JSON_MAX_CHUNK_MEMBERS];
+
+    uint32_t nMembersIn;
+    uint32_t nMembersOut;
+    uint32_t nBytesOut;
+}; // class TJsonStream
+
+// Hashes the characters of 's', at most 'maxLen' if not negative
+inline uint32_t TJsonStream::HashStr(uint32_t hash, PGM_P s, int maxLen)
+{
+    for (; maxLen != 0; maxLen--)
+    {
+        const char c = pgm_read_byte(s++);
+        if (c == 0) break;
+        hash = Hash(hash, (uint8_t)c);
+    } // for
+
+    return hash;
+} // TJsonStream::HashStr
+
+// Hashes the arguments that 'format' would print, without formatting them. Strings are hashed by their contents;
+// the same buffer often holds a different string. Returns 0 if 'format' contains an unknown conversion, meaning:
+// cannot tell if the value changed.
+inline uint32_t TJsonStream::HashArgs(uint32_t hash, PGM_P format, va_list args)
+{
+    hash = Hash(hash, (uint32_t)(uintptr_t)format);
+
+    for (;;)
+    {
+        char c = pgm_read_byte(format++);
+        if (c == 0) break;
+        if (c != '%') continue;
+
+        c = pgm_read_byte(format++);
+        if (c == '%') continue;
+
+        while (c == '-' || c == '+' || c == ' ' || c == '#' || c == '0') c = pgm_read_byte(format++);
+
+        if (c == '*')
+        {
+            hash = Hash(hash, va_arg(args, int));
+            c = pgm_read_byte(format++);
+        } // if
+        while (c >= '0' && c <= '9') c = pgm_read_byte(format++);
+
+        int precision = -1;
+        if (c == '.')
+        {
+            precision = 0;
+            c = pgm_read_byte(format++);
+            if (c == '*')
+            {
+                precision = va_arg(args, int);
+                hash = Hash(hash, precision);
+                c = pgm_read_byte(format++);
+            } // if
+            while (c >= '0' && c <= '9')
+            {
+                precision = precision * 10 + c - '0';
+                c = pgm_read_byte(format++);
+            } // while
+        } // if
+
+        int nLongs = 0;
+        bool isSize = false;
+        bool isMax = false;
+        while (c == 'h' || c == 'l' || c == 'z' || c == 'j')
+        {
+            if (c == 'l') nLongs++;
+            else if (c == 'z') isSize = true;
+            else if (c == 'j') isMax = true;
+            c = pgm_read_byte(format++);
+        } // while
+
+        unsigned long long v;
+        switch (c)
+        {
+            case 's':
+                hash = HashStr(hash, va_arg(args, PGM_P), precision);
+                hash = Hash(hash, 0);  // Separates the strings
+                continue;
+
+            case 'c':
+            case 'd':
+            case 'i':
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+                v =
+                    isMax ? (unsigned long long)va_arg(args, uintmax_t) :
+                    isSize ? (unsigned long long)va_arg(args, size_t) :
+                    nLongs >= 2 ? va_arg(args, unsigned long long) :
+                    nLongs == 1 ? va_arg(args, unsigned long) :
+                    va_arg(args, unsigned int);
+                break;
+
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            {
+                const double d = va_arg(args, double);
+                memcpy(&v, &d, sizeof(v));
+            }
+            break;
+
+            case 'p':
+                v = (uintptr_t)va_arg(args, void*);
+                break;
+
+            default:
+                return 0;
+        } // switch
+
+        hash = Hash(hash, (uint32_t)v);
+        hash = Hash(hash, (uint32_t)(v >> 32));
+    } // for
+
+    return hash == 0 ? 1 : hash;
+} // TJsonStream::HashArgs
+
+// Finds the entry for 'key' in 'i' (-1 if the table is full). Returns false if 'valueHash' is the value last sent
+// for that key.
+inline bool TJsonStream::Changed(PGM_P key, uint32_t valueHash, int& i)
+{
+    nMembersIn++;
+
+    uint32_t keyHash = HashStr(hashInit, key);
+    if (keyHash == 0) keyHash = 1;  // 0 is reserved for empty entries
+    i = FindKey(keyHash);
+
+    return i < 0 || valueHash == 0 || valueHashes[i] != valueHash;
+} // TJsonStream::Changed
+
+// Returns the index of the entry for 'keyHash', adding the entry if it is new. Returns -1 if the table is full.
+inline int TJsonStream::FindKey(uint32_t keyHash)
+{
+    unsigned int i = keyHash % JSON_DELTA_N_KEYS;
+    for (int n = 0; n < JSON_DELTA_N_KEYS; n++)
+    {
+        if (keyHashes[i] == keyHash) return i;
+        if (keyHashes[i] == 0)
+        {
+            keyHashes[i] = keyHash;
+            valueHashes[i] = 0;
+            return i;
+        } // if
+        i = (i + 1) % JSON_DELTA_N_KEYS;
+    } // for
+
+    return -1;
+} // TJsonStream::FindKey
+
+// Writes one character of the member being written. If the chunk is full, the members before it are sent first.
+// Returns false if the member does not fit even then.
+inline bool TJsonStream::Put(char c)
+{
+    if (at >= chunkEnd && (! SplitChunk() || at >= chunkEnd)) return false;
+    *at++ = c;
+    return true;
+} // TJsonStream::Put
+
+inline bool TJsonStream::PutStr(PGM_P s)
+{
+    for (;;)
+    {
+        const char c = pgm_read_byte(s++);
+        if (c == 0) return true;
+        if (! Put(c)) return false;
+    } // for
+} // TJsonStream::PutStr
+
+inline bool TJsonStream::PutPrintf(PGM_P format, va_list args)
+{
+    for (;;)
+    {
+        va_list copy;
+        va_copy(copy, args);
+        const int len = vsnprintf_P(at, chunkEnd - at + 1, format, copy);
+        va_end(copy);
+
+        if (len < 0) return false;
+        if (at + len <= chunkEnd)
+        {
+            at += len;
+            return true;
+        } // if
+
+        if (! SplitChunk()) return false;
+    } // for
+} // TJsonStream::PutPrintf
+
+// Starts writing member "key":
+inline bool TJsonStream::OpenMember(PGM_P key)
+{
+    char* const first = chunk + JSON_EVENT_HEADER_LEN;
+    if (nPending == JSON_MAX_CHUNK_MEMBERS)
+    {
+        EmitChunk(at);
+        at = first;
+    } // if
+
+    memberAt = at;
+    if ((at != first && ! Put(',')) || ! Put('"') || ! PutStr(key) || ! Put('"') || ! Put(':'))
+    {
+        DropMember();
+        return false;
+    } // if
+
+    return true;
+} // TJsonStream::OpenMember
+
+inline void TJsonStream::CloseMember(int i, uint32_t valueHash)
+{
+    pendingKeys[nPending] = i;
+    pendingValueHashes[nPending] = valueHash;
+    nPending++;
+    memberAt = NULL;
+} // TJsonStream::CloseMember
+
+inline void TJsonStream::DropMember()
+{
+    at = memberAt;
+    memberAt = NULL;
+} // TJsonStream::DropMember
+
+// Sends the members before the one being written, and moves that member to the start of the chunk. Returns false if
+// there are no members before it.
+inline bool TJsonStream::SplitChunk()
+{
+    char* const first = chunk + JSON_EVENT_HEADER_LEN;
+    if (memberAt == NULL || memberAt == first) return false;
+
+    // 'EmitChunk' closes the chunk at 'memberAt'; keep the characters it overwrites
+    char saved[3];
+    memcpy(saved, memberAt, sizeof(saved));
+    EmitChunk(memberAt);
+    memcpy(memberAt, saved, sizeof(saved));
+
+    // Leave out the separating ','
+    const size_t len = at - memberAt - 1;
+    memmove(first, memberAt + 1, len);
+    at = first + len;
+    memberAt = first;
+
+    return true;
+} // TJsonStream::SplitChunk
+
+// Closes the object in 'chunk' at 'end' and sends it. If sent, remembers the values in it as sent.
+inline void TJsonStream::EmitChunk(char* end)
+{
+    memcpy(end, "}}", 3);
+    if (sink(chunk))
+    {
+        nBytesOut += end + 2 - chunk;
+        nMembersOut += nPending;
+        for (int n = 0; n < nPending; n++)
+        {
+            if (pendingKeys[n] >= 0) valueHashes[pendingKeys[n]] = pendingValueHashes[n];
+        } // for
+    } // if
+
+    nPending = 0;
+} // TJsonStream::EmitChunk
+
+inline void TJsonStream::Str(PGM_P key, PGM_P value)
+{
+    const uint32_t valueHash = HashStr(hashInit, value);
+    int i;
+    if (! Changed(key, valueHash, i)) return;
+
+    if (! OpenMember(key)) return;
+    if (Put('"') && PutStr(value) && Put('"')) CloseMember(i, valueHash);
+    else DropMember();
+} // TJsonStream::Str
+
+inline void TJsonStream::Printf(PGM_P key, PGM_P format, ...)
+{
+    va_list args;
+    va_start(args, format);
+
+    const uint32_t valueHash = HashArgs(hashInit, format, args);
+    va_end(args);
+    int i;
+    if (! Changed(key, valueHash, i)) return;
+
+    if (! OpenMember(key)) return;
+    va_start(args, format);
+    const bool written = Put('"') && PutPrintf(format, args) && Put('"');
+    va_end(args);
+    if (written) CloseMember(i, valueHash);
+    else DropMember();
+} // TJsonStream::Printf
+
+inline void TJsonStream::Style(PGM_P key, PGM_P property, PGM_P format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    const uint32_t valueHash = HashArgs(HashStr(hashInit, property), format, args);
+    va_end(args);
+    int i;
+    if (! Changed(key, valueHash, i)) return;
+
+    if (! OpenMember(key)) return;
+    va_start(args, format);
+    const bool written =
+        PutStr(PSTR("{\"style\":{\"")) && PutStr(property) && PutStr(PSTR("\":\""))
+        && PutPrintf(format, args)
+        && PutStr(PSTR("\"}}"));
+    va_end(args);
+    if (written) CloseMember(i, valueHash);
+    else DropMember();
+} // TJsonStream::Style
+
+inline void TJsonStream::BeginArray(PGM_P key)
+{
+    arrayKey = key;
+    arrayHash = hashInit;
+    nArrayItems = 0;
+    arrayCut = ! OpenMember(key) || ! Put('[');
+    if (arrayCut && memberAt != NULL) DropMember();
+} // TJsonStream::BeginArray
+
+inline void TJsonStream::ArrayItem(PGM_P format, ...)
+{
+    va_list args;
+    if (arrayHash != 0)
+    {
+        va_start(args, format);
+        arrayHash = HashArgs(arrayHash, format, args);
+        va_end(args);
+    } // if
+
+    if (arrayCut) return;
+
+    // 'SplitChunk' may move the array, leaving out its separating ','. So remember the position of this item as an
+    // offset from after that ','.
+    char* const first = chunk + JSON_EVENT_HEADER_LEN;
+    const size_t itemOffset = at - memberAt - (memberAt != first);
+
+    va_start(args, format);
+    const bool written =
+        (nArrayItems == 0 || Put(','))
+        && Put('"') && PutPrintf(format, args) && Put('"');
+    va_end(args);
+
+    if (written)
+    {
+        nArrayItems++;
+        return;
+    } // if
+
+    // Cut the array short
+    at = memberAt + (memberAt != first) + itemOffset;
+    arrayCut = true;
+} // TJsonStream::ArrayItem
+
+inline void TJsonStream::EndArray()
+{
+    if (memberAt == NULL) return;
+
+    // Always send an array that was cut short: it will not show everything
+    const uint32_t valueHash = arrayCut ? 0 : arrayHash;
+    int i;
+    if (Changed(arrayKey, valueHash, i) && Put(']')) CloseMember(i, valueHash);
+    else DropMember();
+} // TJsonStream::EndArray
+
+inline void TJsonStream::EndEvent()
+{
+    if (nPending > 0) EmitChunk(at);
+    at = chunk + JSON_EVENT_HEADER_LEN;
+} // TJsonStream::EndEvent
+
+#endif // JsonStream_h
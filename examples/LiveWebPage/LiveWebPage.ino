@@ -3,7 +3,7 @@
  *
  * Written by Erik Tromp
  *
- * Version 0.4.0 - March, 2024
+ * Version 0.4.2 - October, 2026
  *
  * MIT license, all text above must be included in any redistribution.
  *
@@ -78,6 +78,7 @@
 #endif // ARDUINO_ARCH_ESP32
 
 #include <VanBusRx.h>  // https://github.com/0xCAFEDECAF/VanBus
+#include "JsonStream.h"
 
 // GPIO pin connected to VAN bus transceiver output
 #ifdef ARDUINO_ARCH_ESP32
@@ -96,10 +97,6 @@
   //const int RX_PIN = D8;  // GPIO15 - pulled to GND - Boot fails
 #endif // ARDUINO_ARCH_ESP32
 
-// TODO - reduce size of large JSON packets like the ones containing guidance instruction icons
-#define JSON_BUFFER_SIZE 4096
-char jsonBuffer[JSON_BUFFER_SIZE];
-
 #ifdef ARDUINO_ARCH_ESP32
   WebServer webServer;
 #else // ! ARDUINO_ARCH_ESP32
@@ -896,6 +893,11 @@ enum VanPacketFilter_t
 // serialDumpFilter != 0 means: print only the packet + JSON data for the specified IDEN
 uint16_t serialDumpFilter;
 
+#ifdef PRINT_JSON_BUFFERS_ON_SERIAL
+// Set per event by its producer: print the JSON text sent for it
+bool printJsonEvent = true;
+#endif // PRINT_JSON_BUFFERS_ON_SERIAL
+
 // Set a simple filter on the dumping of packet + JSON data on Serial.
 // Surf to e.g. http://car.lan/dumpOnly?iden=8c4 to have only packets with IDEN 0x8C4 dumped on serial.
 // Surf to http://car.lan/dumpOnly?iden=0 to dump all packets.
@@ -939,7 +941,7 @@ void SetupWifi();
 
 // Defined in Esp.ino
 void PrintSystemSpecs();
-const char* EspSystemDataToJson(char* buf, const int n);
+void EspSystemDataToJson(TJsonStream& json);
 
 // Infrared receiver
 
@@ -957,12 +959,11 @@ typedef struct
 
 // Defined in IRrecv.ino
 void IrSetup();
-const char* ParseIrPacketToJson(const TIrPacket& pkt);
+void ParseIrPacketToJson(const TIrPacket& pkt, TJsonStream& json);
 bool IrReceive(TIrPacket& irPacket);
 
 // Defined in PacketToJson.ino
-extern char jsonBuffer[];
-const char* ParseVanPacketToJson(TVanPacketRxDesc& pkt);
+void ParseVanPacketToJson(TVanPacketRxDesc& pkt, TJsonStream& json);
 void PrintJsonText(const char* jsonBuffer);
 
 // Create a web socket server on port 81
@@ -970,10 +971,18 @@ WebSocketsServer webSocket = WebSocketsServer(81);
 
 uint8_t websocketNum = 0xFF;
 
-void SendJsonText(const char* json)
+// Sink for 'jsonStream'. Returns false if the text could not be sent.
+bool WebSocketSendTxt(const char* json)
 {
-    if (strlen(json) <= 0) return;
-    if (websocketNum == 0xFF) return;
+  #ifdef PRINT_JSON_BUFFERS_ON_SERIAL
+    if (printJsonEvent)
+    {
+        Serial.print(F("Sending JSON object:\n"));
+        PrintJsonText(json);
+    } // if
+  #endif // PRINT_JSON_BUFFERS_ON_SERIAL
+
+    if (websocketNum == 0xFF) return false;
 
     delay(1); // Give some time to system to process other things?
 
@@ -981,7 +990,7 @@ void SendJsonText(const char* json)
 
     //webSocket.broadcastTXT(json);
     // No, serve only the last one connected (the others are probably already dead)
-    webSocket.sendTXT(websocketNum, json);
+    const bool sent = webSocket.sendTXT(websocketNum, json);
 
     // Print a message if the websocket transmissino took outrageously long (normally it takes around 1-2 msec).
     // If that takes really long (seconds or more), the VAN bus Rx queue will overrun (remember, ESP8266 is
@@ -997,7 +1006,12 @@ void SendJsonText(const char* json)
         Serial.print(F("JSON object:\n"));
         PrintJsonText(json);
     } // if
-} // SendJsonText
+
+    return sent;
+} // WebSocketSendTxt
+
+// Sends only the values that changed since they were last sent
+TJsonStream jsonStream(WebSocketSendTxt);
 
 void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t)
 {
@@ -1017,8 +1031,12 @@ void webSocketEvent(uint8_t num, WStype_t type, uint8_t * payload, size_t)
 
             websocketNum = num;
 
+            // The new client has not seen anything yet
+            jsonStream.Reset();
+
             // Send ESP system data to client
-            SendJsonText(EspSystemDataToJson(jsonBuffer, JSON_BUFFER_SIZE));
+            EspSystemDataToJson(jsonStream);
+            jsonStream.EndEvent();
         }
         break;
 
@@ -1066,6 +1084,10 @@ void setup()
     VanBusRx.Setup(RX_PIN, VAN_PACKET_QUEUE_SIZE);
     Serial.printf_P(PSTR("VanBusRx queue of size %d is set up\n"), VanBusRx.QueueSize());
 
+    // Repair packets with a CRC error in steps of at most 100 microseconds, between the other work in loop(). A
+    // packet needing a lengthy repair then does not hold up the websocket and the IR receiver.
+    VanBusRx.SetRepairBudget(100);
+
     IrSetup();
 } // setup
 
@@ -1076,12 +1098,24 @@ void loop()
 
     // IR receiver
     TIrPacket irPacket;
-    if (IrReceive(irPacket)) SendJsonText(ParseIrPacketToJson(irPacket));
+    if (IrReceive(irPacket))
+    {
+        ParseIrPacketToJson(irPacket, jsonStream);
+        jsonStream.EndEvent();
+    } // if
 
-    // VAN bus receiver
-    TVanPacketRxDesc pkt;
+    // VAN bus receiver. Parse the packet in place, in its queue slot; no need to copy it out.
     bool isQueueOverrun = false;
-    if (VanBusRx.Receive(pkt, &isQueueOverrun)) SendJsonText(ParseVanPacketToJson(pkt));
+    TVanPacketRxDesc* pkt = VanBusRx.Peek(&isQueueOverrun);
+    if (pkt != NULL)
+    {
+        ParseVanPacketToJson(*pkt, jsonStream);
+
+        // Free the queue slot before sending the JSON text, which can take quite some time
+        VanBusRx.Release();
+
+        jsonStream.EndEvent();
+    } // if
     if (isQueueOverrun) Serial.print(F("VAN PACKET QUEUE OVERRUN!\n"));
 
     // Print statistics every 5 seconds
@@ -1090,5 +1124,7 @@ void loop()
     {
         lastUpdate = millis();
         VanBusRx.DumpStats(Serial);
+        Serial.printf_P(PSTR("JSON members: %" PRIu32 " produced, %" PRIu32 " sent (%" PRIu32 " bytes)\n"),
+            jsonStream.GetMembersIn(), jsonStream.GetMembersOut(), jsonStream.GetBytesOut());
     } // if
 } // loop
@@ -15,11 +15,11 @@ enum VanPacketParseResult_t
     VAN_PACKET_PARSE_UNEXPECTED_LENGTH = -2,  // Packet had unexpected length
     VAN_PACKET_PARSE_UNRECOGNIZED_IDEN = -3,  // Packet had unrecognized IDEN field
     VAN_PACKET_PARSE_TO_BE_DECODED = -4,  // IDEN recognized but the correct parsing of this packet is not yet known
-    VAN_PACKET_PARSE_JSON_TOO_LONG = -5,  // IDEN recognized but the parsing into JSON overflows 'jsonBuffer'
     VAN_PACKET_PARSE_FRAGMENT_MISSED = -6  // Missed at least one fragment of a multi-fragment message
 }; // enum VanPacketParseResult_t
 
-typedef VanPacketParseResult_t (*TPacketParser)(TVanPacketRxDesc&, char*, const int);
+// A parser adds the members of the "display" event directly to 'json'
+typedef VanPacketParseResult_t (*TPacketParser)(TVanPacketRxDesc&, TJsonStream&);
 
 struct IdenHandler_t
 {
@@ -28,13 +28,11 @@ struct IdenHandler_t
     int dataLen;
     bool ignoreDups;
     TPacketParser parser;
-    int prevDataLen;
-    uint8_t* prevData;
+    bool selected;  // Outcome of 'IsPacketSelected(iden, SELECTED_PACKETS)', filled in by 'SetupHandlerMap'
 }; // struct IdenHandler_t
 
 // Often used string constants
 const char PROGMEM emptyStr[] = "";
-const char PROGMEM commaStr[] = ",";
 const char PROGMEM spaceStr[] = " ";
 const char PROGMEM onStr[] = "ON";
 const char PROGMEM offStr[] = "OFF";
@@ -54,6 +52,9 @@ const char PROGMEM notApplicable3Str[] = "---";
 const char PROGMEM notApplicableFloatStr[] = "--.-";
 PGM_P dashStr = notApplicable1Str;
 
+// Style properties
+const char PROGMEM transformStr[] = "transform";
+
 // Defined in PacketFilter.ino
 bool IsPacketSelected(uint16_t iden, VanPacketFilter_t filter);
 
@@ -155,26 +156,45 @@ void AsciiToHtml(String& in)
     } // for
 } // ToHtml
 
-// Pretty-print a JSON formatted string, adding indentation
-void PrintJsonText(const char* jsonBuffer)
+// Pretty-print a JSON formatted string, adding line breaks and indentation
+void PrintJsonText(const char* json)
 {
     // Number of spaces to add for each indentation level
     #define PRETTY_PRINT_JSON_INDENT 2
 
-    size_t j = 0;
     int indent = 0;
-    while (j < strlen(jsonBuffer))
+    bool inString = false;
+    for (const char* p = json; *p != 0; p++)
     {
-        const char* subString = jsonBuffer + j;
+        const char c = *p;
+
+        if (inString)
+        {
+            Serial.print(c);
+            if (c == '\\' && p[1] != 0) Serial.print(*++p);
+            else if (c == '"') inString = false;
+            continue;
+        } // if
 
-        if (subString[0] == '}' || subString[0] == ']') indent -= PRETTY_PRINT_JSON_INDENT;
+        if (c == '}' || c == ']')
+        {
+            indent -= PRETTY_PRINT_JSON_INDENT;
+            Serial.printf("\n%*s", indent, "");
+        } // if
 
-        size_t n = strcspn(subString, "\n");
-        if (n != strlen(subString)) Serial.printf("%*s%.*s\n", indent, "", n, subString);
-        j = j + n + 1;
+        Serial.print(c);
 
-        if (subString[0] == '{' || subString[0] == '[') indent += PRETTY_PRINT_JSON_INDENT;
-    } // while
+        if (c == '"') inString = true;
+        else if (c == ':') Serial.print(' ');
+        else if (c == ',') Serial.printf("\n%*s", indent, "");
+        else if (c == '{' || c == '[')
+        {
+            indent += PRETTY_PRINT_JSON_INDENT;
+            Serial.printf("\n%*s", indent, "");
+        } // if
+    } // for
+
+    Serial.print('\n');
 } // PrintJsonText
 
 // Tuner band
@@ -432,21 +452,19 @@ PGM_P SatNavGuidancePreferenceStr(uint8_t data)
 // * 6   : always 0x00 ??
 // * 7   : always 0x00 ??
 //
-void GuidanceInstructionIconJson(const char* iconName, const uint8_t data[8], char* buf, int& at, const int n)
+void GuidanceInstructionIconJson(PGM_P iconName, const uint8_t data[8], TJsonStream& json)
 {
+    // The keys are composed with the icon name
+    char key[48];
+
     // Show all the legs in the junction
 
     uint16_t legBits = (uint16_t)data[2] << 8 | data[3];
     for (int legBit = 1; legBit < 16; legBit++)
     {
         uint16_t degrees10 = legBit * 225;
-        at += at >= n ? 0 :
-            snprintf_P(buf + at, n - at, PSTR(",\n\"%s_leg_%u_%u\": \"%s\""),
-                iconName,
-                degrees10 / 10,
-                degrees10 % 10,
-                legBits & (1 << legBit) ? onStr : offStr
-            );
+        snprintf_P(key, sizeof(key), PSTR("%s_leg_%u_%u"), iconName, degrees10 / 10, degrees10 % 10);
+        json.Str(key, legBits & (1 << legBit) ? onStr : offStr);
     } // for
 
     // Show all the "no-entry" legs in the junction
@@ -455,39 +473,19 @@ void GuidanceInstructionIconJson(const char* iconName, const uint8_t data[8], ch
     for (int noEntryBit = 1; noEntryBit < 16; noEntryBit++)
     {
         uint16_t degrees10 = noEntryBit * 225;
-        at += at >= n ? 0 :
-            snprintf_P(buf + at, n - at, PSTR(",\n\"%s_no_entry_%u_%u\": \"%s\""),
-                iconName,
-                degrees10 / 10,
-                degrees10 % 10,
-                noEntryBits & (1 << noEntryBit) ? onStr : offStr
-            );
+        snprintf_P(key, sizeof(key), PSTR("%s_no_entry_%u_%u"), iconName, degrees10 / 10, degrees10 % 10);
+        json.Str(key, noEntryBits & (1 << noEntryBit) ? onStr : offStr);
     } // for
 
     // Show the direction to go (indicated clock-wise, i.e. 90 degrees is left turn)
 
     uint16_t direction = (1800 + data[0] * 225) % 3600;
 
-    const static char jsonFormatter[] PROGMEM =
-        ",\n"
-        "\"%s_direction_as_text\": \"%u.%u\",\n"  // degrees
-        "\"%s_direction\":\n"
-        "{\n"
-            "\"style\":\n"
-            "{\n"
-                "\"transform\": \"rotate(%u.%udeg)\"\n"
-            "}\n"
-        "}";
-
-    at += at >= n ? 0 :
-        snprintf_P(buf + at, n - at, jsonFormatter,
-            iconName,
-            direction / 10,
-            direction % 10,
-            iconName,
-            direction / 10,
-            direction % 10
-        );
+    snprintf_P(key, sizeof(key), PSTR("%s_direction_as_text"), iconName);
+    json.Printf(key, PSTR("%u.%u"), direction / 10, direction % 10);  // degrees
+
+    snprintf_P(key, sizeof(key), PSTR("%s_direction"), iconName);
+    json.Style(key, transformStr, PSTR("rotate(%u.%udeg)"), direction / 10, direction % 10);
 } // GuidanceInstructionIconJson
 
 enum Fuel_t
@@ -498,7 +496,7 @@ enum Fuel_t
 
 int fuelType = FUEL_PETROL;
 
-VanPacketParseResult_t ParseVinPkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseVinPkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#E24
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#E24
@@ -521,24 +519,12 @@ VanPacketParseResult_t ParseVinPkt(TVanPacketRxDesc& pkt, char* buf, const int n
         // Default already set to FUEL_PETROL
     } // switch
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"vin\": \"%-17.17s\"\n"
-        "}\n"
-    "}\n";
-
-    int at = snprintf_P(buf, n, jsonFormatter, data);
-
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
+    json.Printf(PSTR("vin"), PSTR("%-17.17s"), data);
 
     return VAN_PACKET_PARSE_OK;
 } // ParseVinPkt
 
-VanPacketParseResult_t ParseEnginePkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseEnginePkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#8A4
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#8A4
@@ -560,107 +546,59 @@ VanPacketParseResult_t ParseEnginePkt(TVanPacketRxDesc& pkt, char* buf, const in
     uint8_t extTempRaw = data[6];
     float extTemp = extTempRaw / 2.0 - 40;
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"dash_light\": \"%s\",\n"
-            "\"dash_actual_brightness\": \"%u\",\n"
-            "\"contact_key_position\": \"%s\",\n"
-            "\"engine_running\": \"%s\",\n"
-            "\"economy_mode\": \"%s\",\n"
-            "\"in_reverse\": \"%s\",\n"
-            "\"trailer\": \"%s\",\n"
-            "\"coolant_temp\": \"%s\",\n"
-            "\"coolant_temp_perc\":\n"
-            "{\n"
-                "\"style\":\n"
-                "{\n"
-                    "\"transform\": \"scaleX(%s)\"\n"
-                "}\n"
-            "},\n"
-            "\"odometer_1\": \"%s\",\n"
-            "\"exterior_temp\": \"%s\"\n"
-        "}\n"
-    "}\n";
-
-    char floatBuf[3][MAX_FLOAT_SIZE];
-    int at = snprintf_P(buf, n, jsonFormatter,
-
-        data[0] & 0x80 ? PSTR("FULL") : PSTR("DIMMED (LIGHTS ON)"),
-        data[0] & 0x0F,
+    json.Str(PSTR("dash_light"), data[0] & 0x80 ? PSTR("FULL") : PSTR("DIMMED (LIGHTS ON)"));
+    json.Printf(PSTR("dash_actual_brightness"), PSTR("%u"), data[0] & 0x0F);
 
+    json.Str(PSTR("contact_key_position"),
         contactKeyPosition == 0x00 ? offStr :
         contactKeyPosition == 0x01 ? PSTR("ACC") :
         contactKeyPosition == 0x03 ? onStr :
         contactKeyPosition == 0x02 ? PSTR("START") :
-        ToHexStr((uint8_t)(data[1] & 0x03)),
+        ToHexStr((uint8_t)(data[1] & 0x03))
+    );
 
-        data[1] & 0x04 ? yesStr : noStr,
-        economyMode ? onStr : offStr,
-        data[1] & 0x20 ? yesStr : noStr,
-        data[1] & 0x40 ? presentStr : notPresentStr,
+    json.Str(PSTR("engine_running"), data[1] & 0x04 ? yesStr : noStr);
+    json.Str(PSTR("economy_mode"), economyMode ? onStr : offStr);
+    json.Str(PSTR("in_reverse"), data[1] & 0x20 ? yesStr : noStr);
+    json.Str(PSTR("trailer"), data[1] & 0x40 ? presentStr : notPresentStr);
 
-        ! isCoolantTempValid ? notApplicable3Str : ToStr(coolantTemp),
+    json.Str(PSTR("coolant_temp"), ! isCoolantTempValid ? notApplicable3Str : ToStr(coolantTemp));
+
+    char floatBuf[MAX_FLOAT_SIZE];
+    json.Style(PSTR("coolant_temp_perc"), transformStr, PSTR("scaleX(%s)"),
 
         // TODO - hard coded value 130 degrees Celsius for 100%
         #define MAX_COOLANT_TEMP (130)
         ! isCoolantTempValid || coolantTemp <= 0 ? PSTR("0") :
             coolantTemp >= MAX_COOLANT_TEMP ? PSTR("1") :
-                FloatToStr(floatBuf[0], (float)coolantTemp / MAX_COOLANT_TEMP, 2),
-
-        FloatToStr(floatBuf[1], odometer, 1),
-        FloatToStr(floatBuf[2], extTemp, 1)
+                FloatToStr(floatBuf, (float)coolantTemp / MAX_COOLANT_TEMP, 2)
     );
 
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
+    json.Str(PSTR("odometer_1"), FloatToStr(floatBuf, odometer, 1));
+    json.Str(PSTR("exterior_temp"), FloatToStr(floatBuf, extTemp, 1));
 
     return VAN_PACKET_PARSE_OK;
 } // ParseEnginePkt
 
-VanPacketParseResult_t ParseHeadUnitStalkPkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseHeadUnitStalkPkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#9C4
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#9C4
 
     const uint8_t* data = pkt.Data();
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"head_unit_stalk_button_next\": \"%s\",\n"
-            "\"head_unit_stalk_button_prev\": \"%s\",\n"
-            "\"head_unit_stalk_button_volume_up\": \"%s\",\n"
-            "\"head_unit_stalk_button_volume_down\": \"%s\",\n"
-            "\"head_unit_stalk_button_source\": \"%s\",\n"
-            "\"head_unit_stalk_wheel\": \"%d\",\n"
-            "\"head_unit_stalk_wheel_rollover\": \"%u\"\n"
-        "}\n"
-    "}\n";
-
-    int at = snprintf_P(buf, n, jsonFormatter,
-
-        data[0] & 0x80 ? onStr : offStr,
-        data[0] & 0x40 ? onStr : offStr,
-        data[0] & 0x08 ? onStr : offStr,
-        data[0] & 0x04 ? onStr : offStr,
-        data[0] & 0x02 ? onStr : offStr,
-
-        data[1] - 0x80,
-        data[0] >> 4 & 0x03
-    );
-
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
+    json.Str(PSTR("head_unit_stalk_button_next"), data[0] & 0x80 ? onStr : offStr);
+    json.Str(PSTR("head_unit_stalk_button_prev"), data[0] & 0x40 ? onStr : offStr);
+    json.Str(PSTR("head_unit_stalk_button_volume_up"), data[0] & 0x08 ? onStr : offStr);
+    json.Str(PSTR("head_unit_stalk_button_volume_down"), data[0] & 0x04 ? onStr : offStr);
+    json.Str(PSTR("head_unit_stalk_button_source"), data[0] & 0x02 ? onStr : offStr);
+    json.Printf(PSTR("head_unit_stalk_wheel"), PSTR("%d"), data[1] - 0x80);
+    json.Printf(PSTR("head_unit_stalk_wheel_rollover"), PSTR("%u"), data[0] >> 4 & 0x03);
 
     return VAN_PACKET_PARSE_OK;
 } // ParseHeadUnitStalkPkt
 
-VanPacketParseResult_t ParseLightsStatusPkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseLightsStatusPkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#4FC
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#4FC_1
@@ -677,45 +615,28 @@ VanPacketParseResult_t ParseLightsStatusPkt(TVanPacketRxDesc& pkt, char* buf, co
     int32_t remainingKmToService = remainingKmToService20 * 20;
     if (remainingKmToServiceOverdue) remainingKmToService = - remainingKmToService;
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"instrument_cluster\": \"%sENALED\",\n"
-            "\"speed_regulator_wheel\": \"%s\",\n"
-            "\"hazard_lights\": \"%s\",\n"
-            "\"diesel_glow_plugs\": \"%s\",\n"
-            "\"door_open\": \"%s\",\n"
-            "\"distance_to_service\": \"%" PRId32 "\",\n"
-            "\"distance_to_service_dash\": \"%" PRId32 "\",\n"
-            "\"distance_to_service_perc\":\n"
-            "{\n"
-                "\"style\":\n"
-                "{\n"
-                    "\"transform\": \"scaleX(%s)\"\n"
-                "}\n"
-            "},\n"
-            "\"lights\": \"%s%s%s%s%s%s\"";
+    json.Printf(PSTR("instrument_cluster"), PSTR("%sENALED"), data[0] & 0x80 ? emptyStr : PSTR("NOT "));
+    json.Str(PSTR("speed_regulator_wheel"), data[0] & 0x40 ? onStr : offStr);
+    json.Str(PSTR("hazard_lights"), data[0] & 0x20 ? onStr : offStr);
+    json.Str(PSTR("diesel_glow_plugs"), data[0] & 0x04 ? onStr : offStr);
+    json.Str(PSTR("door_open"), data[1] & 0x01 ? yesStr : noStr);
 
-    char floatBuf[MAX_FLOAT_SIZE];
-    int at = snprintf_P(buf, n, jsonFormatter,
+    json.Printf(PSTR("distance_to_service"), PSTR("%" PRId32), remainingKmToService);
 
-        data[0] & 0x80 ? emptyStr : PSTR("NOT "),
-        data[0] & 0x40 ? onStr : offStr,
-        data[0] & 0x20 ? onStr : offStr,
-        data[0] & 0x04 ? onStr : offStr,
-        data[1] & 0x01 ? yesStr : noStr,
+    // Round downwards (even if negative) to nearest multiple of 100 kms
+    json.Printf(PSTR("distance_to_service_dash"), PSTR("%" PRId32), _floor(remainingKmToService, 100));
 
-        remainingKmToService,
-        _floor(remainingKmToService, 100),  // Round downwards (even if negative) to nearest multiple of 100 kms
+    char floatBuf[MAX_FLOAT_SIZE];
+    json.Style(PSTR("distance_to_service_perc"), transformStr, PSTR("scaleX(%s)"),
 
         // TODO - hard coded value 30,000 kms for 100%
         #define SERVICE_INTERVAL (30000)
         remainingKmToService <= 0 ? PSTR("0") :
             remainingKmToService >= SERVICE_INTERVAL ? PSTR("1") :
-                FloatToStr(floatBuf, (float)remainingKmToService / SERVICE_INTERVAL, 2),
+                FloatToStr(floatBuf, (float)remainingKmToService / SERVICE_INTERVAL, 2)
+    );
 
+    json.Printf(PSTR("lights"), PSTR("%s%s%s%s%s%s"),
         data[5] & 0x80 ? PSTR("DIPPED_BEAM ") : emptyStr,
         data[5] & 0x40 ? PSTR("HIGH_BEAM ") : emptyStr,
         data[5] & 0x20 ? PSTR("FOG_FRONT ") : emptyStr,
@@ -726,81 +647,56 @@ VanPacketParseResult_t ParseLightsStatusPkt(TVanPacketRxDesc& pkt, char* buf, co
 
     if (data[5] & 0x02)
     {
-        at += at >= n ? 0 :
-            snprintf_P(buf + at, n - at,
-                PSTR(",\n\"auto_gearbox\": \"%s%s%s%s\""),
-                (data[4] & 0x70) == 0x00 ? PSTR("P") :
-                (data[4] & 0x70) == 0x10 ? PSTR("R") :
-                (data[4] & 0x70) == 0x20 ? PSTR("N") :
-                (data[4] & 0x70) == 0x30 ? PSTR("D") :
-                (data[4] & 0x70) == 0x40 ? PSTR("4") :
-                (data[4] & 0x70) == 0x50 ? PSTR("3") :
-                (data[4] & 0x70) == 0x60 ? PSTR("2") :
-                (data[4] & 0x70) == 0x70 ? PSTR("1") :
-                ToHexStr((uint8_t)(data[4] & 0x70)),
-
-                data[4] & 0x08 ? PSTR(" - Snow") : emptyStr,
-                data[4] & 0x04 ? PSTR(" - Sport") : emptyStr,
-                data[4] & 0x80 ? PSTR(" (blinking)") : emptyStr
-            );
+        json.Printf(PSTR("auto_gearbox"), PSTR("%s%s%s%s"),
+            (data[4] & 0x70) == 0x00 ? PSTR("P") :
+            (data[4] & 0x70) == 0x10 ? PSTR("R") :
+            (data[4] & 0x70) == 0x20 ? PSTR("N") :
+            (data[4] & 0x70) == 0x30 ? PSTR("D") :
+            (data[4] & 0x70) == 0x40 ? PSTR("4") :
+            (data[4] & 0x70) == 0x50 ? PSTR("3") :
+            (data[4] & 0x70) == 0x60 ? PSTR("2") :
+            (data[4] & 0x70) == 0x70 ? PSTR("1") :
+            ToHexStr((uint8_t)(data[4] & 0x70)),
+
+            data[4] & 0x08 ? PSTR(" - Snow") : emptyStr,
+            data[4] & 0x04 ? PSTR(" - Sport") : emptyStr,
+            data[4] & 0x80 ? PSTR(" (blinking)") : emptyStr
+        );
     } // if
 
-    if (data[6] != 0xFF)
-    {
-        at += at >= n ? 0 :
-            snprintf_P(buf + at, n - at, PSTR(",\n\"oil_temp\": \"%d\""), (int)data[6] - 40);  // Never seen this
-    } // if
+    if (data[6] != 0xFF) json.Printf(PSTR("oil_temp"), PSTR("%d"), (int)data[6] - 40);  // Never seen this
+    if (data[7] != 0xFF) json.Printf(PSTR("fuel_level"), PSTR("%u"), data[7]);  // Never seen this
 
-    if (data[7] != 0xFF)
-    {
-        at += at >= n ? 0 :
-            snprintf_P(buf + at, n - at, PSTR(",\n\"fuel_level\": \"%u\""), data[7]);  // Never seen this
-    } // if
+    json.Printf(PSTR("oil_level_raw"), PSTR("%u"), data[8]);
 
-    at += at >= n ? 0 :
-        snprintf_P(buf + at, n - at, PSTR(",\n\"oil_level_raw\": \"%u\""), data[8]);
-
-    at += at >= n ? 0 :
-        snprintf_P(buf + at, n - at, PSTR(
-                ",\n"
-                "\"oil_level_raw_perc\":\n"
-                "{\n"
-                    "\"style\":\n"
-                    "{\n"
-                        "\"transform\": \"scaleX(%s)\"\n"
-                    "}\n"
-                "}"
-            ),
-
-            #define MAX_OIL_LEVEL (85)
-            data[8] >= MAX_OIL_LEVEL ? PSTR("1") :
-                FloatToStr(floatBuf, (float)data[8] / MAX_OIL_LEVEL, 2)
-        );
+    json.Style(PSTR("oil_level_raw_perc"), transformStr, PSTR("scaleX(%s)"),
+        #define MAX_OIL_LEVEL (85)
+        data[8] >= MAX_OIL_LEVEL ? PSTR("1") :
+            FloatToStr(floatBuf, (float)data[8] / MAX_OIL_LEVEL, 2)
+    );
 
-    at += at >= n ? 0 :
-        snprintf_P(buf + at, n - at, PSTR(",\n\"oil_level_dash\": \"%s\""),
-            data[8] <= 11 ? PSTR("------") :
-            data[8] <= 25 ? PSTR("O-----") :
-            data[8] <= 39 ? PSTR("OO----") :
-            data[8] <= 53 ? PSTR("OOO---") :
-            data[8] <= 67 ? PSTR("OOOO--") :
-            data[8] <= 81 ? PSTR("OOOOO-") :
-            PSTR("OOOOOO")
-        );
+    json.Str(PSTR("oil_level_dash"),
+        data[8] <= 11 ? PSTR("------") :
+        data[8] <= 25 ? PSTR("O-----") :
+        data[8] <= 39 ? PSTR("OO----") :
+        data[8] <= 53 ? PSTR("OOO---") :
+        data[8] <= 67 ? PSTR("OOOO--") :
+        data[8] <= 81 ? PSTR("OOOOO-") :
+        PSTR("OOOOOO")
+    );
 
     if (data[10] != 0xFF)
     {
         // Never seen this; I don't have LPG
-        at += at >= n ? 0 :
-            snprintf_P(buf + at, n - at, PSTR(",\n\"lpg_fuel_level\": \"%s\""),
-                data[10] <= 8 ? PSTR("1") :
-                data[10] <= 17 ? PSTR("2") :
-                data[10] <= 33 ? PSTR("3") :
-                data[10] <= 50 ? PSTR("4") :
-                data[10] <= 67 ? PSTR("5") :
-                data[10] <= 83 ? PSTR("6") :
-                PSTR("7")
-            );
+        json.Str(PSTR("lpg_fuel_level"),
+            data[10] <= 8 ? PSTR("1") :
+            data[10] <= 17 ? PSTR("2") :
+            data[10] <= 33 ? PSTR("3") :
+            data[10] <= 50 ? PSTR("4") :
+            data[10] <= 67 ? PSTR("5") :
+            data[10] <= 83 ? PSTR("6") :
+            PSTR("7")
+        );
     } // if
 
     if (dataLen == 14)
@@ -809,29 +705,22 @@ VanPacketParseResult_t ParseLightsStatusPkt(TVanPacketRxDesc& pkt, char* buf, co
 
         // http://pinterpeti.hu/psavanbus/PSA-VAN.html#4FC_2
 
-        at += at >= n ? 0 :
-            snprintf_P(buf + at, n - at, PSTR(",\n\"cruise_control\": \"%s\""),
-                data[11] == 0x41 ? offStr :
-                data[11] == 0x49 ? PSTR("Cruise") :
-                data[11] == 0x59 ? PSTR("Cruise - speed") :
-                data[11] == 0x81 ? PSTR("Limiter") :
-                data[11] == 0x89 ? PSTR("Limiter - speed") :
-                ToHexStr(data[11])
-            );
+        json.Str(PSTR("cruise_control"),
+            data[11] == 0x41 ? offStr :
+            data[11] == 0x49 ? PSTR("Cruise") :
+            data[11] == 0x59 ? PSTR("Cruise - speed") :
+            data[11] == 0x81 ? PSTR("Limiter") :
+            data[11] == 0x89 ? PSTR("Limiter - speed") :
+            ToHexStr(data[11])
+        );
 
-        at += at >= n ? 0 :
-            snprintf_P(buf + at, n - at, PSTR(",\n\"cruise_control_speed\": \"%u\""), data[12]);
+        json.Printf(PSTR("cruise_control_speed"), PSTR("%u"), data[12]);
     } // if
 
-    at += at >= n ? 0 : snprintf_P(buf + at, n - at, PSTR("\n}\n}\n"));
-
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
-
     return VAN_PACKET_PARSE_OK;
 } // ParseLightsStatusPkt
 
-VanPacketParseResult_t ParseDeviceReportPkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseDeviceReportPkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#8C4
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#8C4
@@ -840,21 +729,12 @@ VanPacketParseResult_t ParseDeviceReportPkt(TVanPacketRxDesc& pkt, char* buf, co
     if (dataLen < 1 || dataLen > 3) return VAN_PACKET_PARSE_UNEXPECTED_LENGTH;
 
     const uint8_t* data = pkt.Data();
-    int at = 0;
 
     if (data[0] == 0x8A)
     {
         if (dataLen != 3) return VAN_PACKET_PARSE_UNEXPECTED_LENGTH;
 
-        const static char jsonFormatter[] PROGMEM =
-        "{\n"
-            "\"event\": \"display\",\n"
-            "\"data\":\n"
-            "{\n"
-                "\"head_unit_report\": \"%s\"";
-
-        at = snprintf_P(buf, n, jsonFormatter,
-
+        json.Str(PSTR("head_unit_report"),
             data[1] == 0x20 ? PSTR("TUNER_REPLY") :
             data[1] == 0x21 ? PSTR("AUDIO_SETTINGS_ANNOUNCE") :
             data[1] == 0x22 ? PSTR("BUTTON_PRESS_ANNOUNCE") :
@@ -879,51 +759,37 @@ VanPacketParseResult_t ParseDeviceReportPkt(TVanPacketRxDesc& pkt, char* buf, co
         // Button-press announcement?
         if ((data[1] & 0x0F) == 0x02)
         {
-            at += at >= n ? 0 :
-                snprintf_P(buf + at, n - at,
-                    PSTR(",\n\"head_unit_button_pressed\": \"%s%s\""),
-
-                    (data[2] & 0x1F) == 0x01 ? PSTR("1") :
-                    (data[2] & 0x1F) == 0x02 ? PSTR("2") :
-                    (data[2] & 0x1F) == 0x03 ? PSTR("3") :
-                    (data[2] & 0x1F) == 0x04 ? PSTR("4") :
-                    (data[2] & 0x1F) == 0x05 ? PSTR("5") :
-                    (data[2] & 0x1F) == 0x06 ? PSTR("6") :
-                    (data[2] & 0x1F) == 0x11 ? PSTR("AUDIO_DOWN") :
-                    (data[2] & 0x1F) == 0x12 ? PSTR("AUDIO_UP") :
-                    (data[2] & 0x1F) == 0x13 ? PSTR("SEEK_BACKWARD") :
-                    (data[2] & 0x1F) == 0x14 ? PSTR("SEEK_FORWARD") :
-                    (data[2] & 0x1F) == 0x16 ? PSTR("AUDIO") :
-                    (data[2] & 0x1F) == 0x17 ? PSTR("MAN") :  // Not seen
-                    (data[2] & 0x1F) == 0x1B ? PSTR("TUNER") :
-                    (data[2] & 0x1F) == 0x1C ? PSTR("TAPE") :
-                    (data[2] & 0x1F) == 0x1D ? PSTR("CD") :
-                    (data[2] & 0x1F) == 0x1E ? PSTR("CD_CHANGER") :
-                    ToHexStr(data[2]),
-
-                    (data[2] & 0xC0) == 0xC0 ? PSTR(" (held)") :
-                    data[2] & 0x40 ? PSTR(" (released)") :
-                    data[2] & 0x80 ? PSTR(" (repeat)") :
-                    emptyStr
-                );
+            json.Printf(PSTR("head_unit_button_pressed"), PSTR("%s%s"),
+                (data[2] & 0x1F) == 0x01 ? PSTR("1") :
+                (data[2] & 0x1F) == 0x02 ? PSTR("2") :
+                (data[2] & 0x1F) == 0x03 ? PSTR("3") :
+                (data[2] & 0x1F) == 0x04 ? PSTR("4") :
+                (data[2] & 0x1F) == 0x05 ? PSTR("5") :
+                (data[2] & 0x1F) == 0x06 ? PSTR("6") :
+                (data[2] & 0x1F) == 0x11 ? PSTR("AUDIO_DOWN") :
+                (data[2] & 0x1F) == 0x12 ? PSTR("AUDIO_UP") :
+                (data[2] & 0x1F) == 0x13 ? PSTR("SEEK_BACKWARD") :
+                (data[2] & 0x1F) == 0x14 ? PSTR("SEEK_FORWARD") :
+                (data[2] & 0x1F) == 0x16 ? PSTR("AUDIO") :
+                (data[2] & 0x1F) == 0x17 ? PSTR("MAN") :  // Not seen
+                (data[2] & 0x1F) == 0x1B ? PSTR("TUNER") :
+                (data[2] & 0x1F) == 0x1C ? PSTR("TAPE") :
+                (data[2] & 0x1F) == 0x1D ? PSTR("CD") :
+                (data[2] & 0x1F) == 0x1E ? PSTR("CD_CHANGER") :
+                ToHexStr(data[2]),
+
+                (data[2] & 0xC0) == 0xC0 ? PSTR(" (held)") :
+                data[2] & 0x40 ? PSTR(" (released)") :
+                data[2] & 0x80 ? PSTR(" (repeat)") :
+                emptyStr
+            );
         } // if
-
-        at += at >= n ? 0 : snprintf_P(buf + at, n - at, PSTR("\n}\n}\n"));
     }
     else if (data[0] == 0x96)
     {
         if (dataLen != 1) return VAN_PACKET_PARSE_UNEXPECTED_LENGTH;
 
-        const static char jsonFormatter[] PROGMEM =
-        "{\n"
-            "\"event\": \"display\",\n"
-            "\"data\":\n"
-            "{\n"
-                "\"cd_changer_announce\": \"STATUS_UPDATE_ANNOUNCE\"\n"
-            "}\n"
-        "}\n";
-
-        at = snprintf_P(buf, n, jsonFormatter);
+        json.Str(PSTR("cd_changer_announce"), PSTR("STATUS_UPDATE_ANNOUNCE"));
     }
     else if (data[0] == 0x07)
     {
@@ -967,26 +833,9 @@ VanPacketParseResult_t ParseDeviceReportPkt(TVanPacketRxDesc& pkt, char* buf, co
         // & 0x01: User selecting
         // & 0x02: Requesting "satnav_status_3" (IDEN 0x8CE) ?
 
-        const static char jsonFormatter[] PROGMEM =
-        "{\n"
-            "\"event\": \"display\",\n"
-            "\"data\":\n"
-            "{\n"
-                "\"mfd_to_satnav_instruction\": \"%s\",\n"
-                "\"mfd_to_satnav_status_1_request\": \"%s\",\n"
-                "\"mfd_to_satnav_status_2_request\": \"%s\",\n"
-                "\"mfd_to_satnav_status_3_request\": \"%s\",\n"
-                "\"mfd_to_satnav_guidance_request\": \"%s\",\n"
-                "\"mfd_to_satnav_guidance_data_request\": \"%s\",\n"
-                "\"mfd_to_satnav_report_request\": \"%s\",\n"
-                "\"mfd_to_satnav_response_request\": \"%s\",\n"
-                "\"mfd_to_satnav_user_selection\": \"%s\"\n"
-            "}\n"
-        "}\n";
-
         uint16_t code = (uint16_t)data[1] << 8 | data[2];
 
-        at = snprintf_P(buf, n, jsonFormatter,
+        json.Str(PSTR("mfd_to_satnav_instruction"),
 
             // User clicks on "Accept" button (usually bottom left of dialog screen)
             code == 0x0001 ? PSTR("Accept") :
@@ -1023,17 +872,17 @@ VanPacketParseResult_t ParseDeviceReportPkt(TVanPacketRxDesc& pkt, char* buf, co
             code == 0x4700 ? ToHexStr(code) :  // Route computed?
             code == 0x6000 ? ToHexStr(code) :  // ??
 
-            ToHexStr(code),
-
-            data[1] & 0x01 ? yesStr : noStr,
-            data[1] & 0x40 ? yesStr : noStr,
-            data[2] & 0x02 ? yesStr : noStr,
-            data[1] & 0x02 ? yesStr : noStr,
-            data[1] & 0x04 ? yesStr : noStr,
-            data[1] & 0x20 ? yesStr : noStr,
-            data[1] & 0x10 ? yesStr : noStr,
-            data[2] & 0x01 ? yesStr : noStr
+            ToHexStr(code)
         );
+
+        json.Str(PSTR("mfd_to_satnav_status_1_request"), data[1] & 0x01 ? yesStr : noStr);
+        json.Str(PSTR("mfd_to_satnav_status_2_request"), data[1] & 0x40 ? yesStr : noStr);
+        json.Str(PSTR("mfd_to_satnav_status_3_request"), data[2] & 0x02 ? yesStr : noStr);
+        json.Str(PSTR("mfd_to_satnav_guidance_request"), data[1] & 0x02 ? yesStr : noStr);
+        json.Str(PSTR("mfd_to_satnav_guidance_data_request"), data[1] & 0x04 ? yesStr : noStr);
+        json.Str(PSTR("mfd_to_satnav_report_request"), data[1] & 0x20 ? yesStr : noStr);
+        json.Str(PSTR("mfd_to_satnav_response_request"), data[1] & 0x10 ? yesStr : noStr);
+        json.Str(PSTR("mfd_to_satnav_user_selection"), data[2] & 0x01 ? yesStr : noStr);
     }
     else if (data[0] == 0x52)
     {
@@ -1053,13 +902,10 @@ VanPacketParseResult_t ParseDeviceReportPkt(TVanPacketRxDesc& pkt, char* buf, co
         return VAN_PACKET_PARSE_TO_BE_DECODED;
     } // if
 
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
-
     return VAN_PACKET_PARSE_OK;
 } // ParseDeviceReportPkt
 
-VanPacketParseResult_t ParseCarStatus1Pkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseCarStatus1Pkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#564
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#564
@@ -1083,81 +929,56 @@ VanPacketParseResult_t ParseCarStatus1Pkt(TVanPacketRxDesc& pkt, char* buf, cons
     uint16_t instConsumptionLt100_x10 = (uint16_t)data[22] << 8 | data[23];
     uint16_t distanceToEmpty = (uint16_t)data[24] << 8 | data[25];
 
-    const static char jsonFormatter1[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"door_front_right\": \"%s\",\n"
-            "\"door_front_left\": \"%s\",\n"
-            "\"door_rear_right\": \"%s\",\n"
-            "\"door_rear_left\": \"%s\",\n"
-            "\"door_boot\": \"%s\",\n"
-            "\"right_stalk_button\": \"%s\",\n"
-            "\"exp_moving_avg_speed\": \"%u\",\n"
-            "\"inst_consumption\": \"%s\",\n"
-            "\"distance_to_empty\": \"%u\",\n"
-            "\"avg_speed_1\": \"%u\",\n"
-            "\"distance_1\": \"%s\",\n"
-            "\"avg_consumption_1\": \"%s\"";
-
-    char floatBuf[2][MAX_FLOAT_SIZE];
-    int at = snprintf_P(buf, n, jsonFormatter1,
-        data[7] & 0x80 ? openStr : closedStr,
-        data[7] & 0x40 ? openStr : closedStr,
-        data[7] & 0x20 ? openStr : closedStr,
-        data[7] & 0x10 ? openStr : closedStr,
-        data[7] & 0x08 ? openStr : closedStr,
-        stalkIsPressed ? PSTR("PRESSED") : PSTR("RELEASED"),
-
-        // When engine running but stopped (actual vehicle speed is 0), this value counts down by 1 every
-        // 10 - 20 seconds or so. When driving, this goes up and down slowly toward the current speed.
-        // Looking at the time stamps when this value changes, this seems to be an exponential moving
-        // average (EMA) of the recent vehicle speed. When the actual speed is 0, the value is seen to decrease
-        // about 12% per minute. If the actual vehicle speed is sampled every second, then, in the
-        // following formula, K would be around 12% / 60 = 0.2% = 0.002 :
-        //
-        //   exp_moving_avg_speed := exp_moving_avg_speed * (1 − K) + actual_vehicle_speed * K
-        //
-        // Often used in EMA is the constant N, where K = 2 / (N + 1). That means N would be around 1000 (given
-        // a sampling time of 1 second).
-        //
-        data[13],
+    json.Str(PSTR("door_front_right"), data[7] & 0x80 ? openStr : closedStr);
+    json.Str(PSTR("door_front_left"), data[7] & 0x40 ? openStr : closedStr);
+    json.Str(PSTR("door_rear_right"), data[7] & 0x20 ? openStr : closedStr);
+    json.Str(PSTR("door_rear_left"), data[7] & 0x10 ? openStr : closedStr);
+    json.Str(PSTR("door_boot"), data[7] & 0x08 ? openStr : closedStr);
+    json.Str(PSTR("right_stalk_button"), stalkIsPressed ? PSTR("PRESSED") : PSTR("RELEASED"));
+
+    // When engine running but stopped (actual vehicle speed is 0), this value counts down by 1 every
+    // 10 - 20 seconds or so. When driving, this goes up and down slowly toward the current speed.
+    // Looking at the time stamps when this value changes, this seems to be an exponential moving
+    // average (EMA) of the recent vehicle speed. When the actual speed is 0, the value is seen to decrease
+    // about 12% per minute. If the actual vehicle speed is sampled every second, then, in the
+    // following formula, K would be around 12% / 60 = 0.2% = 0.002 :
+    //
+    //   exp_moving_avg_speed := exp_moving_avg_speed * (1 − K) + actual_vehicle_speed * K
+    //
+    // Often used in EMA is the constant N, where K = 2 / (N + 1). That means N would be around 1000 (given
+    // a sampling time of 1 second).
+    //
+    json.Printf(PSTR("exp_moving_avg_speed"), PSTR("%u"), data[13]);
+
+    char floatBuf[MAX_FLOAT_SIZE];
+    json.Str(PSTR("inst_consumption"),
+        instConsumptionLt100_x10 != 0xFFFF ?
+            FloatToStr(floatBuf, (float)instConsumptionLt100_x10 / 10.0, 1) :
+            notApplicableFloatStr
+    );
 
-        instConsumptionLt100_x10 != 0xFFFF ? FloatToStr(floatBuf[0], (float)instConsumptionLt100_x10 / 10.0, 1) : notApplicableFloatStr,
+    json.Printf(PSTR("distance_to_empty"), PSTR("%u"), distanceToEmpty);
 
-        distanceToEmpty,
-        avgSpeedTrip1,
-        distanceTrip1 != 0xFFFF ? ToStr(distanceTrip1) : notApplicable2Str,
+    json.Printf(PSTR("avg_speed_1"), PSTR("%u"), avgSpeedTrip1);
+    json.Str(PSTR("distance_1"), distanceTrip1 != 0xFFFF ? ToStr(distanceTrip1) : notApplicable2Str);
+    json.Str(PSTR("avg_consumption_1"),
         avgConsumptionLt100Trip1 != 0xFFFF ?
-            FloatToStr(floatBuf[1], (float)avgConsumptionLt100Trip1 / 10.0, 1) :
+            FloatToStr(floatBuf, (float)avgConsumptionLt100Trip1 / 10.0, 1) :
             notApplicableFloatStr
     );
 
-    const static char jsonFormatter2[] PROGMEM =
-            ",\n"
-            "\"avg_speed_2\": \"%u\",\n"
-            "\"distance_2\": \"%s\",\n"
-            "\"avg_consumption_2\": \"%s\"\n"
-        "}\n"
-    "}\n";
-
-    at += at >= n ? 0 :
-        snprintf_P(buf + at, n - at, jsonFormatter2,
-            avgSpeedTrip2,
-            distanceTrip2 == 0xFFFF ? notApplicable2Str : ToStr(distanceTrip2),
-            avgConsumptionLt100Trip2 != 0xFFFF ?
-                FloatToStr(floatBuf[0], (float)avgConsumptionLt100Trip2 / 10.0, 1) :
-                notApplicableFloatStr
-        );
-
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
+    json.Printf(PSTR("avg_speed_2"), PSTR("%u"), avgSpeedTrip2);
+    json.Str(PSTR("distance_2"), distanceTrip2 == 0xFFFF ? notApplicable2Str : ToStr(distanceTrip2));
+    json.Str(PSTR("avg_consumption_2"),
+        avgConsumptionLt100Trip2 != 0xFFFF ?
+            FloatToStr(floatBuf, (float)avgConsumptionLt100Trip2 / 10.0, 1) :
+            notApplicableFloatStr
+    );
 
     return VAN_PACKET_PARSE_OK;
 } // ParseCarStatus1Pkt
 
-VanPacketParseResult_t ParseCarStatus2Pkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseCarStatus2Pkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#524
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#524
@@ -1350,19 +1171,10 @@ VanPacketParseResult_t ParseCarStatus2Pkt(TVanPacketRxDesc& pkt, char* buf, cons
         msg_15_0, msg_15_1, msg_15_2, msg_15_3, msg_15_4, msg_15_5, msg_15_6, msg_15_7
     };
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"alarm_list\":\n"
-            "[";
-
-    int at = snprintf_P(buf, n, jsonFormatter);
+    json.BeginArray(PSTR("alarm_list"));
 
     const uint8_t* data = pkt.Data();
 
-    bool first = true;
     for (int byte = 0; byte < dataLen; byte++)
     {
         // Skip byte 9; it is the index of the current message
@@ -1372,45 +1184,30 @@ VanPacketParseResult_t ParseCarStatus2Pkt(TVanPacketRxDesc& pkt, char* buf, cons
         {
             if (data[byte] >> bit & 0x01)
             {
-                char alarmText[80];  // Make sure this is large enough for the largest string it must hold; see above
-                strncpy_P(alarmText, (char *)pgm_read_dword(&(msgTable[byte * 8 + bit])), sizeof(alarmText) - 1);
-                alarmText[sizeof(alarmText) - 1] = 0;
-
-                // TODO - with lots of alarms set, this packet could become very large and overflow the JSON buffer
-                at += at >= n ? 0 :
-                    snprintf_P(buf + at, n - at, PSTR("%s\n\"%s\""), first ? emptyStr : commaStr, alarmText);
-                first = false;
+                json.ArrayItem(PSTR("%s"), (PGM_P)pgm_read_dword(&(msgTable[byte * 8 + bit])));
             } // if
         } // for
     } // for
 
-    at += at >= n ? 0 : snprintf_P(buf + at, n - at, PSTR("\n]"));
+    json.EndArray();
 
     uint8_t currentMsg = data[9];
 
     // The message to be shown in the popup on the MFD
-    at += at >= n ? 0 :
-        snprintf_P(buf + at, n - at,
-            PSTR(",\n\"notification_message_on_mfd\": \"%s\""),
+    json.Str(PSTR("notification_message_on_mfd"),
 
-            // Relying on short-circuit boolean evaluation
-            currentMsg <= 0x7F && strlen_P(msgTable[currentMsg]) > 0 ? msgTable[currentMsg] : emptyStr
-        );
+        // Relying on short-circuit boolean evaluation
+        currentMsg <= 0x7F && strlen_P(msgTable[currentMsg]) > 0 ? msgTable[currentMsg] : emptyStr
+    );
 
     // Separately report "doors locked" status
     bool doorsLocked = data[8] & 0x01;
-    at += at >= n ? 0 :
-        snprintf_P(buf + at, n - at, PSTR(",\n\"doors_locked\": \"%s\""), doorsLocked ? yesStr : noStr);
-
-    at += at >= n ? 0 : snprintf_P(buf + at, n - at, PSTR("\n}\n}\n"));
-
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
+    json.Str(PSTR("doors_locked"), doorsLocked ? yesStr : noStr);
 
     return VAN_PACKET_PARSE_OK;
 } // ParseCarStatus2Pkt
 
-VanPacketParseResult_t ParseDashboardPkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseDashboardPkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#824
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#824
@@ -1441,33 +1238,22 @@ VanPacketParseResult_t ParseDashboardPkt(TVanPacketRxDesc& pkt, char* buf, const
 
     float vehicleSpeed = vehicleSpeed_x100 / 100.0;
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"engine_rpm\": \"%s\",\n"
-            "\"vehicle_speed\": \"%s\"\n"
-        "}\n"
-    "}\n";
-
-    char floatBuf[2][MAX_FLOAT_SIZE];
-    int at = snprintf_P(buf, n, jsonFormatter,
+    char floatBuf[MAX_FLOAT_SIZE];
+    json.Str(PSTR("engine_rpm"),
         engineRpm_x8 != 0xFFFF ?
-            FloatToStr(floatBuf[0], engineRpm_x8 / 8.0, 0) :
-            notApplicable3Str,
+            FloatToStr(floatBuf, engineRpm_x8 / 8.0, 0) :
+            notApplicable3Str
+    );
+    json.Str(PSTR("vehicle_speed"),
         vehicleSpeed_x100 != 0xFFFF ?
-            FloatToStr(floatBuf[1], vehicleSpeed, 0) :
+            FloatToStr(floatBuf, vehicleSpeed, 0) :
             notApplicable2Str
     );
 
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
-
     return VAN_PACKET_PARSE_OK;
 } // ParseDashboardPkt
 
-VanPacketParseResult_t ParseDashboardButtonsPkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseDashboardButtonsPkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#664
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#664
@@ -1479,54 +1265,34 @@ VanPacketParseResult_t ParseDashboardButtonsPkt(TVanPacketRxDesc& pkt, char* buf
     float fuelLevelFiltered = data[4] / 2.0;
     float fuelLevelRaw = data[5] / 2.0;
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"hazard_lights_button\": \"%s\",\n"  // Not sure
-            "\"door_lock\": \"%s\",\n"
-            "\"dashboard_programmed_brightness\": \"%u\",\n"
-            "\"esp\": \"%s\",\n"
-            "\"fuel_level_filtered\": \"%s\",\n"
-            "\"fuel_level_filtered_perc\":\n"
-            "{\n"
-                "\"style\":\n"
-                "{\n"
-                    "\"transform\": \"scaleX(%s)\"\n"
-                "}\n"
-            "},\n"
-            "\"fuel_level_raw\": \"%s\"\n"
-        "}\n"
-    "}\n";
-
-    // data[6..10] - always 00-FF-00-FF-00
-
-    char floatBuf[3][MAX_FLOAT_SIZE];
-    int at = snprintf_P(buf, n, jsonFormatter,
-        data[0] & 0x02 ? onStr : offStr,
-        data[2] & 0x40 ? onStr : offStr,
-        data[2] & 0x0F,
-        data[3] & 0x02 ? onStr : offStr,
+    json.Str(PSTR("hazard_lights_button"), data[0] & 0x02 ? onStr : offStr);  // Not sure
+    json.Str(PSTR("door_lock"), data[2] & 0x40 ? onStr : offStr);
+    json.Printf(PSTR("dashboard_programmed_brightness"), PSTR("%u"), data[2] & 0x0F);
+    json.Str(PSTR("esp"), data[3] & 0x02 ? onStr : offStr);
 
-        // Surely fuel level. Test with tank full shows definitely level is in litres.
-        data[4] == 0xFF || data[4] == 0x00 ? notApplicable3Str : FloatToStr(floatBuf[0], fuelLevelFiltered, 1),
+    // Surely fuel level. Test with tank full shows definitely level is in litres.
+    char floatBuf[MAX_FLOAT_SIZE];
+    json.Str(PSTR("fuel_level_filtered"),
+        data[4] == 0xFF || data[4] == 0x00 ? notApplicable3Str : FloatToStr(floatBuf, fuelLevelFiltered, 1)
+    );
 
+    json.Style(PSTR("fuel_level_filtered_perc"), transformStr, PSTR("scaleX(%s)"),
         #define FULL_TANK_LITRES (73.0)
         data[4] == 0xFF ? PSTR("0") :
             fuelLevelFiltered >= FULL_TANK_LITRES ? PSTR("1") :
-                FloatToStr(floatBuf[1], fuelLevelFiltered / FULL_TANK_LITRES, 2),
+                FloatToStr(floatBuf, fuelLevelFiltered / FULL_TANK_LITRES, 2)
+    );
 
-        data[5] == 0xFF || data[5] == 0x00 ? notApplicable3Str : FloatToStr(floatBuf[2], fuelLevelRaw, 1)
+    json.Str(PSTR("fuel_level_raw"),
+        data[5] == 0xFF || data[5] == 0x00 ? notApplicable3Str : FloatToStr(floatBuf, fuelLevelRaw, 1)
     );
 
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
+    // data[6..10] - always 00-FF-00-FF-00
 
     return VAN_PACKET_PARSE_OK;
 } // ParseDashboardButtonsPkt
 
-VanPacketParseResult_t ParseHeadUnitPkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseHeadUnitPkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#554
 
@@ -1545,7 +1311,6 @@ VanPacketParseResult_t ParseHeadUnitPkt(TVanPacketRxDesc& pkt, char* buf, const
     const uint8_t* data = pkt.Data();
     uint8_t infoType = data[1];
     int dataLen = pkt.DataLen();
-    int at = 0;
 
     switch (infoType)
     {
@@ -1565,8 +1330,6 @@ VanPacketParseResult_t ParseHeadUnitPkt(TVanPacketRxDesc& pkt, char* buf, const
             // data[2]: radio band and preset position
             uint8_t band = data[2] & 0x07;
             uint8_t presetMemory = data[2] >> 3 & 0x0F;
-            char presetMemoryBuffer[3];
-            sprintf_P(presetMemoryBuffer, PSTR("%1u"), presetMemory);
 
             // data[3]: search bits
             bool dxSensitivity = data[3] & 0x02;  // Tuner sensitivity: distant (Dx) or local (Lo)
@@ -1596,53 +1359,43 @@ VanPacketParseResult_t ParseHeadUnitPkt(TVanPacketRxDesc& pkt, char* buf, const
             // & 0x0F = signal strength: increases with antenna plugged in and decreases with antenna plugged
             //          out. Updated when a station is being tuned in to, or when the MAN button is pressed.
             uint8_t signalStrength = data[6] & 0x0F;
-            char signalStrengthBuffer[3];
-            sprintf_P(signalStrengthBuffer, PSTR("%u"), signalStrength);
-
-            const static char jsonFormatterCommon[] PROGMEM =
-            "{\n"
-                "\"event\": \"display\",\n"
-                "\"data\":\n"
-                "{\n"
-                    "\"tuner_band\": \"%s\",\n"
-                    "\"fm_band\": \"%s\",\n"
-                    "\"fm_band_1\": \"%s\",\n"
-                    "\"fm_band_2\": \"%s\",\n"
-                    "\"fm_band_ast\": \"%s\",\n"
-                    "\"am_band\": \"%s\",\n"
-                    "\"tuner_memory\": \"%s\",\n"
-                    "\"frequency\": \"%s %s\",\n"
-                    "\"signal_strength\": \"%s\",\n"
-                    "\"search_mode\": \"%s\",\n"
-                    "\"search_sensitivity\": \"%s\",\n"
-                    "\"search_direction\": \"%s\"";
 
-            char floatBuf[MAX_FLOAT_SIZE];
-            at = snprintf_P(buf, n, jsonFormatterCommon,
-                TunerBandStr(band),
+            json.Str(PSTR("tuner_band"), TunerBandStr(band));
+            json.Str(PSTR("fm_band"),
                 band == TB_FM1 || band == TB_FM2 || band == TB_FM3 || band == TB_FMAST || band == TB_PTY_SELECT ?
-                    onStr : offStr,
-                band == TB_FM1 ? onStr : offStr,
-                band == TB_FM2 ? onStr : offStr,
-                band == TB_FMAST ? onStr : offStr,
-                band == TB_AM ? onStr : offStr,
-                presetMemory == 0 ? notApplicable1Str : presetMemoryBuffer,
+                    onStr : offStr
+            );
+            json.Str(PSTR("fm_band_1"), band == TB_FM1 ? onStr : offStr);
+            json.Str(PSTR("fm_band_2"), band == TB_FM2 ? onStr : offStr);
+            json.Str(PSTR("fm_band_ast"), band == TB_FMAST ? onStr : offStr);
+            json.Str(PSTR("am_band"), band == TB_AM ? onStr : offStr);
+            json.Printf(PSTR("tuner_memory"), presetMemory == 0 ? notApplicable1Str : PSTR("%1u"), presetMemory);
+
+            char floatBuf[MAX_FLOAT_SIZE];
+            json.Printf(PSTR("frequency"), PSTR("%s %s"),
                 frequency == 0x07FF ? notApplicable3Str :
                     band == TB_AM
                         ? FloatToStr(floatBuf, frequency, 0)  // AM and LW bands
                         : FloatToStr(floatBuf, (frequency / 2 + 500) / 10.0, 1),  // FM bands
-                band == TB_AM ? PSTR("KHz") : PSTR("MHz"),
+                band == TB_AM ? PSTR("KHz") : PSTR("MHz")
+            );
 
-                // Also applicable in AM mode
+            // Also applicable in AM mode
+            json.Printf(PSTR("signal_strength"),
                 signalStrength == 15 && (searchMode == TS_BY_FREQUENCY || searchMode == TS_BY_MATCHING_PTY)
                     ? notApplicable2Str
-                    : signalStrengthBuffer,
+                    : PSTR("%u"),
+                signalStrength
+            );
 
-                TunerSearchModeStr(searchMode),
+            json.Str(PSTR("search_mode"), TunerSearchModeStr(searchMode));
 
-                // Sensitivity of automatic search: distant (Dx) or local (Lo)
-                ! automaticSearchBusy ? emptyStr : dxSensitivity ? PSTR("Dx") : PSTR("Lo"),
+            // Sensitivity of automatic search: distant (Dx) or local (Lo)
+            json.Str(PSTR("search_sensitivity"),
+                ! automaticSearchBusy ? emptyStr : dxSensitivity ? PSTR("Dx") : PSTR("Lo")
+            );
 
+            json.Str(PSTR("search_direction"),
                 ! anySearchBusy ? emptyStr : searchDirectionUp ? PSTR("UP") : PSTR("DOWN")
             );
 
@@ -1668,8 +1421,6 @@ VanPacketParseResult_t ParseHeadUnitPkt(TVanPacketRxDesc& pkt, char* buf, const
                 uint16_t piCode = (uint16_t)data[8] << 8 | data[9];
                 uint8_t countryCode = piCode >> 12 & 0x0F;
                 uint8_t coverageCode = piCode >> 8 & 0x0F;
-                char piBuffer[5];
-                sprintf_P(piBuffer, PSTR("%04X"), piCode);
 
                 // data[10]: for PTY-based search mode
                 // & 0x1F: PTY code to search
@@ -1682,54 +1433,29 @@ VanPacketParseResult_t ParseHeadUnitPkt(TVanPacketRxDesc& pkt, char* buf, const
                 // data[11]: PTY code of current station
                 uint8_t currPty = data[11] & 0x1F;
 
+                json.Str(PSTR("pty_selection_menu"), ptySelectionMenu ? onStr : offStr);
+                json.Str(PSTR("selected_pty_full"), selectedPty == 0x00 ? notApplicable3Str : PtyStrFull(selectedPty));
+                json.Str(PSTR("pty_standby_mode"), ptyStandbyMode ? yesStr : noStr);
+                json.Str(PSTR("pty_match"), ptyMatch ? yesStr : noStr);
+                json.Str(PSTR("pty_full"), currPty == 0x00 ? notApplicable3Str : PtyStrFull(currPty));
+
+                json.Printf(PSTR("pi_code"), piCode == 0xFFFF ? notApplicable3Str : PSTR("%04X"), piCode);
+                json.Str(PSTR("pi_country"), piCode == 0xFFFF ? notApplicable2Str : RadioPiCountry(countryCode));
+                json.Str(PSTR("pi_area_coverage"),
+                    piCode == 0xFFFF ? notApplicable3Str : RadioPiAreaCoverage(coverageCode)
+                );
+
+                json.Str(PSTR("regional"), regional ? onStr : offStr);
+                json.Str(PSTR("ta_selected"), taSelected ? yesStr : noStr);
+                json.Str(PSTR("ta_not_available"), taNotAvailable ? yesStr : noStr);
+                json.Str(PSTR("rds_selected"), rdsSelected ? yesStr : noStr);
+                json.Str(PSTR("rds_not_available"), rdsNotAvailable ? yesStr : noStr);
+
                 // data[12]...data[20]: RDS text
-                char rdsTxt[9];
-                strncpy(rdsTxt, (const char*) data + 12, 8);
-                rdsTxt[8] = 0;
-
-                const static char jsonFormatterFmBand[] PROGMEM = ",\n"
-                    "\"pty_selection_menu\": \"%s\",\n"
-                    "\"selected_pty_full\": \"%s\",\n"
-                    "\"pty_standby_mode\": \"%s\",\n"
-                    "\"pty_match\": \"%s\",\n"
-                    "\"pty_full\": \"%s\",\n"
-                    "\"pi_code\": \"%s\",\n"
-                    "\"pi_country\": \"%s\",\n"
-                    "\"pi_area_coverage\": \"%s\",\n"
-                    "\"regional\": \"%s\",\n"
-                    "\"ta_selected\": \"%s\",\n"
-                    "\"ta_not_available\": \"%s\",\n"
-                    "\"rds_selected\": \"%s\",\n"
-                    "\"rds_not_available\": \"%s\",\n"
-                    "\"rds_text\": \"%s\",\n"
-                    "\"info_traffic\": \"%s\"";
-
-                at += at >= n ? 0 :
-                    snprintf_P(buf + at, n - at, jsonFormatterFmBand,
-                        ptySelectionMenu ? onStr : offStr,
-
-                        selectedPty == 0x00 ? notApplicable3Str : PtyStrFull(selectedPty),
-
-                        ptyStandbyMode ? yesStr : noStr,
-                        ptyMatch ? yesStr : noStr,
-                        currPty == 0x00 ? notApplicable3Str : PtyStrFull(currPty),
-
-                        piCode == 0xFFFF ? notApplicable3Str : piBuffer,
-                        piCode == 0xFFFF ? notApplicable2Str : RadioPiCountry(countryCode),
-                        piCode == 0xFFFF ? notApplicable3Str : RadioPiAreaCoverage(coverageCode),
-
-                        regional ? onStr : offStr,
-                        taSelected ? yesStr : noStr,
-                        taNotAvailable ? yesStr : noStr,
-                        rdsSelected ? yesStr : noStr,
-                        rdsNotAvailable ? yesStr : noStr,
-                        rdsTxt,
-
-                        taAnnounce ? yesStr : noStr
-                    );
-            } // if
+                json.Printf(PSTR("rds_text"), PSTR("%.8s"), data + 12);
 
-            at += at >= n ? 0 : snprintf_P(buf + at, n - at, PSTR("\n}\n}\n"));
+                json.Str(PSTR("info_traffic"), taAnnounce ? yesStr : noStr);
+            } // if
         }
         break;
 
@@ -1741,27 +1467,9 @@ VanPacketParseResult_t ParseHeadUnitPkt(TVanPacketRxDesc& pkt, char* buf, const
 
             uint8_t status = data[2] & 0x3C;
 
-            const static char jsonFormatter[] PROGMEM =
-            "{\n"
-                "\"event\": \"display\",\n"
-                "\"data\":\n"
-                "{\n"
-                    "\"tape_side\": \"%s\",\n"
-                    "\"tape_status\": \"%s\",\n"
-                    "\"tape_status_stopped\": \"%s\",\n"
-                    "\"tape_status_loading\": \"%s\",\n"
-                    "\"tape_status_play\": \"%s\",\n"
-                    "\"tape_status_fast_forward\": \"%s\",\n"
-                    "\"tape_status_next_track\": \"%s\",\n"
-                    "\"tape_status_rewind\": \"%s\",\n"
-                    "\"tape_status_previous_track\": \"%s\"\n"
-                "}\n"
-            "}\n";
-
-            at = snprintf_P(buf, n, jsonFormatter,
-
-                data[2] & 0x01 ? PSTR("2") : PSTR("1"),
+            json.Str(PSTR("tape_side"), data[2] & 0x01 ? PSTR("2") : PSTR("1"));
 
+            json.Str(PSTR("tape_status"),
                 status == 0x00 ? PSTR("STOPPED") :
                 status == 0x04 ? PSTR("LOADING") :
                 status == 0x0C ? PSTR("PLAY") :
@@ -1769,16 +1477,16 @@ VanPacketParseResult_t ParseHeadUnitPkt(TVanPacketRxDesc& pkt, char* buf, const
                 status == 0x14 ? PSTR("NEXT_TRACK") :
                 status == 0x30 ? PSTR("REWIND") :
                 status == 0x34 ? PSTR("PREVIOUS_TRACK") :
-                ToHexStr(status),
-
-                status == 0x00 ? onStr : offStr,
-                status == 0x04 ? onStr : offStr,
-                status == 0x0C ? onStr : offStr,
-                status == 0x10 ? onStr : offStr,
-                status == 0x14 ? onStr : offStr,
-                status == 0x30 ? onStr : offStr,
-                status == 0x34 ? onStr : offStr
+                ToHexStr(status)
             );
+
+            json.Str(PSTR("tape_status_stopped"), status == 0x00 ? onStr : offStr);
+            json.Str(PSTR("tape_status_loading"), status == 0x04 ? onStr : offStr);
+            json.Str(PSTR("tape_status_play"), status == 0x0C ? onStr : offStr);
+            json.Str(PSTR("tape_status_fast_forward"), status == 0x10 ? onStr : offStr);
+            json.Str(PSTR("tape_status_next_track"), status == 0x14 ? onStr : offStr);
+            json.Str(PSTR("tape_status_rewind"), status == 0x30 ? onStr : offStr);
+            json.Str(PSTR("tape_status_previous_track"), status == 0x34 ? onStr : offStr);
         }
         break;
 
@@ -1791,23 +1499,11 @@ VanPacketParseResult_t ParseHeadUnitPkt(TVanPacketRxDesc& pkt, char* buf, const
             uint8_t tunerBand = data[2] >> 4 & 0x07;
             uint8_t tunerMemory = data[2] & 0x0F;
 
-            char rdsOrFreqTxt[9];
-            strncpy(rdsOrFreqTxt, (const char*) data + 3, 8);
-            rdsOrFreqTxt[8] = 0;
-
-            const static char jsonFormatter[] PROGMEM =
-            "{\n"
-                "\"event\": \"display\",\n"
-                "\"data\":\n"
-                "{\n"
-                    "\"radio_preset_%s_%u\": \"%s%s\"\n"
-                "}\n"
-            "}\n";
-
-            at = snprintf_P(buf, n, jsonFormatter,
-                TunerBandStr(tunerBand),
-                tunerMemory,
-                rdsOrFreqTxt,
+            char key[32];
+            snprintf_P(key, sizeof(key), PSTR("radio_preset_%s_%u"), TunerBandStr(tunerBand), tunerMemory);
+
+            json.Printf(key, PSTR("%.8s%s"),
+                data + 3,
                 tunerBand == TB_AM ? PSTR(" KHz") : data[2] & 0x80 ? emptyStr : PSTR(" MHz")
             );
         }
@@ -1819,9 +1515,6 @@ VanPacketParseResult_t ParseHeadUnitPkt(TVanPacketRxDesc& pkt, char* buf, const
 
             if (dataLen != 19) return VAN_PACKET_PARSE_UNEXPECTED_LENGTH;
 
-            char trackTimeStr[7];
-            sprintf_P(trackTimeStr, PSTR("%X:%02X"), data[5], data[6]);
-
             static bool loading = false;
             bool searching = data[3] & 0x10;
 
@@ -1831,38 +1524,12 @@ VanPacketParseResult_t ParseHeadUnitPkt(TVanPacketRxDesc& pkt, char* buf, const
 
             uint8_t totalTracks = data[8];
             bool totalTracksValid = totalTracks != 0xFF;
-            char totalTracksStr[3];
-            if (totalTracksValid) sprintf_P(totalTracksStr, PSTR("%X"), totalTracks);
 
-            char totalTimeStr[7];
             uint8_t totalTimeMin = data[9];
             uint8_t totalTimeSec = data[10];
             bool totalTimeValid = totalTimeMin != 0xFF && totalTimeSec != 0xFF;
-            if (totalTimeValid) sprintf_P(totalTimeStr, PSTR("%X:%02X"), totalTimeMin, totalTimeSec);
-
-            const static char jsonFormatter[] PROGMEM =
-            "{\n"
-                "\"event\": \"display\",\n"
-                "\"data\":\n"
-                "{\n"
-                    "\"cd_status\": \"%s\",\n"
-                    "\"cd_status_loading\": \"%s\",\n"
-                    "\"cd_status_eject\": \"%s\",\n"
-                    "\"cd_status_pause\": \"%s\",\n"
-                    "\"cd_status_play\": \"%s\",\n"
-                    "\"cd_status_fast_forward\": \"%s\",\n"
-                    "\"cd_status_rewind\": \"%s\",\n"
-                    "\"cd_status_searching\": \"%s\",\n"
-                    "\"cd_track_time\": \"%s\",\n"
-                    "\"cd_current_track\": \"%X\",\n"
-                    "\"cd_total_tracks\": \"%s\",\n"
-                    "\"cd_total_time\": \"%s\",\n"
-                    "\"cd_random\": \"%s\"\n"
-                "}\n"
-            "}\n";
-
-            at = snprintf_P(buf, n, jsonFormatter,
 
+            json.Str(PSTR("cd_status"),
                 data[3] == 0x00 ? PSTR("EJECT") :
                 data[3] == 0x10 ? PSTR("ERROR") :  // E.g. disc inserted upside down
                 data[3] == 0x11 ? PSTR("LOADING") :
@@ -1872,25 +1539,29 @@ VanPacketParseResult_t ParseHeadUnitPkt(TVanPacketRxDesc& pkt, char* buf, const
                 data[3] == 0x03 ? PSTR("PLAY") :
                 data[3] == 0x04 ? PSTR("FAST_FORWARD") :
                 data[3] == 0x05 ? PSTR("REWIND") :
-                ToHexStr(data[3]),
-
-                loading ? onStr : offStr,
-                data[3] == 0x00 ? onStr : offStr,
-                (data[3] & 0x0F) == 0x02 && ! searching ? onStr : offStr,
-                (data[3] & 0x0F) == 0x03 && ! searching ? onStr : offStr,
-                (data[3] & 0x0F) == 0x04 ? onStr : offStr,
-                (data[3] & 0x0F) == 0x05 ? onStr : offStr,
+                ToHexStr(data[3])
+            );
 
-                (data[3] == 0x12 || data[3] == 0x13) && ! loading ? onStr : offStr,
+            json.Str(PSTR("cd_status_loading"), loading ? onStr : offStr);
+            json.Str(PSTR("cd_status_eject"), data[3] == 0x00 ? onStr : offStr);
+            json.Str(PSTR("cd_status_pause"), (data[3] & 0x0F) == 0x02 && ! searching ? onStr : offStr);
+            json.Str(PSTR("cd_status_play"), (data[3] & 0x0F) == 0x03 && ! searching ? onStr : offStr);
+            json.Str(PSTR("cd_status_fast_forward"), (data[3] & 0x0F) == 0x04 ? onStr : offStr);
+            json.Str(PSTR("cd_status_rewind"), (data[3] & 0x0F) == 0x05 ? onStr : offStr);
 
-                searching ? PSTR("--:--") : trackTimeStr,
+            json.Str(PSTR("cd_status_searching"), (data[3] == 0x12 || data[3] == 0x13) && ! loading ? onStr : offStr);
 
-                data[7],
-                totalTracksValid ? totalTracksStr : notApplicable2Str,
-                totalTimeValid ? totalTimeStr : PSTR("--:--"),
+            json.Printf(PSTR("cd_track_time"), searching ? PSTR("--:--") : PSTR("%X:%02X"), data[5], data[6]);
 
-                data[2] & 0x01 ? onStr : offStr  // CD track shuffle: long-press "CD" button
+            json.Printf(PSTR("cd_current_track"), PSTR("%X"), data[7]);
+            json.Printf(PSTR("cd_total_tracks"), totalTracksValid ? PSTR("%X") : notApplicable2Str, totalTracks);
+            json.Printf(PSTR("cd_total_time"),
+                totalTimeValid ? PSTR("%X:%02X") : PSTR("--:--"),
+                totalTimeMin,
+                totalTimeSec
             );
+
+            json.Str(PSTR("cd_random"), data[2] & 0x01 ? onStr : offStr);  // CD track shuffle: long-press "CD" button
         }
         break;
 
@@ -1907,52 +1578,34 @@ VanPacketParseResult_t ParseHeadUnitPkt(TVanPacketRxDesc& pkt, char* buf, const
         break;
     } // switch
 
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
-
     return VAN_PACKET_PARSE_OK;
 } // ParseHeadUnitPkt
 
-VanPacketParseResult_t ParseMfdLanguageUnitsPkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseMfdLanguageUnitsPkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#984
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#984
 
     const uint8_t* data = pkt.Data();
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"mfd_language\": \"%s\",\n"
-            "\"mfd_temperature_unit\": \"%s\",\n"
-            "\"mfd_distance_unit\": \"%s\",\n"
-            "\"mfd_time_unit\": \"%s\"\n"
-        "}\n"
-    "}\n";
-
-    int at = snprintf_P(buf, n, jsonFormatter,
+    json.Str(PSTR("mfd_language"),
         data[3] == 0x00 ? PSTR("FRENCH") :
         data[3] == 0x01 ? PSTR("ENGLISH") :
         data[3] == 0x02 ? PSTR("GERMAN") :
         data[3] == 0x03 ? PSTR("SPANISH") :
         data[3] == 0x04 ? PSTR("ITALIAN") :
         data[3] == 0x06 ? PSTR("DUTCH") :
-        notApplicable3Str,
-
-        data[4] & 0x02 ? PSTR("FAHRENHEIT") : PSTR("CELSIUS"),
-        data[4] & 0x04 ? PSTR("MILES_YARDS") : PSTR("KILOMETRES_METRES"),
-        data[4] & 0x08 ? PSTR("24_H") : PSTR("12_H")
+        notApplicable3Str
     );
 
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
+    json.Str(PSTR("mfd_temperature_unit"), data[4] & 0x02 ? PSTR("FAHRENHEIT") : PSTR("CELSIUS"));
+    json.Str(PSTR("mfd_distance_unit"), data[4] & 0x04 ? PSTR("MILES_YARDS") : PSTR("KILOMETRES_METRES"));
+    json.Str(PSTR("mfd_time_unit"), data[4] & 0x08 ? PSTR("24_H") : PSTR("12_H"));
 
     return VAN_PACKET_PARSE_OK;
 } // ParseMfdLanguageUnitsPkt
 
-VanPacketParseResult_t ParseAudioSettingsPkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseAudioSettingsPkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#4D4
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#4D4
@@ -1967,47 +1620,11 @@ VanPacketParseResult_t ParseAudioSettingsPkt(TVanPacketRxDesc& pkt, char* buf, c
     int8_t balance = (int8_t)(0x3F) - (data[6] & 0x7F);
     int8_t fader = (int8_t)(0x3F) - (data[7] & 0x7F);
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"head_unit_power\": \"%s\",\n"
-            "\"tape_present\": \"%s\",\n"
-            "\"cd_present\": \"%s\",\n"
-            "\"audio_source\": \"%s\",\n"
-            "\"ext_mute\": \"%s\",\n"
-            "\"mute\": \"%s\",\n"
-            "\"volume\": \"%u\",\n"
-            "\"volume_update\": \"%s\",\n"
-            "\"volume_perc\":\n"
-            "{\n"
-                "\"style\":\n"
-                "{\n"
-                    "\"transform\": \"scaleX(%s)\"\n"
-                "}\n"
-            "},\n"
-            "\"audio_menu\": \"%s\",\n"
-            "\"bass\": \"%+d\",\n"
-            "\"bass_update\": \"%s\",\n"
-            "\"treble\": \"%+d\",\n"
-            "\"treble_update\": \"%s\",\n"
-            "\"loudness\": \"%s\",\n"
-            "\"fader\": \"%s%d\",\n"
-            "\"fader_update\": \"%s\",\n"
-            "\"balance\": \"%s%d\",\n"
-            "\"balance_update\": \"%s\",\n"
-            "\"auto_volume\": \"%s\"\n"
-        "}\n"
-    "}\n";
-
-    char floatBuf[MAX_FLOAT_SIZE];
-
-    int at = snprintf_P(buf, n, jsonFormatter,
-        isHeadUnitPowerOn ? onStr : offStr,
-        isTapePresent ? yesStr : noStr,
-        isCdPresent ? yesStr : noStr,
+    json.Str(PSTR("head_unit_power"), isHeadUnitPowerOn ? onStr : offStr);
+    json.Str(PSTR("tape_present"), isTapePresent ? yesStr : noStr);
+    json.Str(PSTR("cd_present"), isCdPresent ? yesStr : noStr);
 
+    json.Str(PSTR("audio_source"),
         (data[4] & 0x0F) == 0x00 ? noneStr :  // Source of audio
         (data[4] & 0x0F) == 0x01 ? PSTR("TUNER") :
         (data[4] & 0x0F) == 0x02 ?
@@ -2021,43 +1638,43 @@ VanPacketParseResult_t ParseAudioSettingsPkt(TVanPacketRxDesc& pkt, char* buf, c
         // whenever this source is chosen.
         (data[4] & 0x0F) == 0x05 ? PSTR("NAVIGATION") :
 
-        ToHexStr((uint8_t)(data[4] & 0x0F)),
-
-        // External mute. Activated when head unit ISO connector A pin 1 ("Phone mute") is pulled LOW (to Ground).
-        data[1] & 0x02 ? onStr : offStr,
-
-        // Mute. To activate: press both VOL_UP and VOL_DOWN buttons on stalk.
-        data[1] & 0x01 ? onStr : offStr,
+        ToHexStr((uint8_t)(data[4] & 0x0F))
+    );
 
-        volume,
-        data[5] & 0x80 ? yesStr : noStr,
+    // External mute. Activated when head unit ISO connector A pin 1 ("Phone mute") is pulled LOW (to Ground).
+    json.Str(PSTR("ext_mute"), data[1] & 0x02 ? onStr : offStr);
 
-        // Factory head unit has fixed maximum volume value of 30
-        #define MAX_AUDIO_VOLUME (30)
-        FloatToStr(floatBuf, (float)volume / MAX_AUDIO_VOLUME, 2),
+    // Mute. To activate: press both VOL_UP and VOL_DOWN buttons on stalk.
+    json.Str(PSTR("mute"), data[1] & 0x01 ? onStr : offStr);
 
-        // Audio menu. Bug: if CD changer is playing, this one is always "OPEN" (even if it isn't).
-        data[1] & 0x20 ? openStr : closedStr,
+    json.Printf(PSTR("volume"), PSTR("%u"), volume);
+    json.Str(PSTR("volume_update"), data[5] & 0x80 ? yesStr : noStr);
 
-        (int8_t)(data[8] & 0x7F) - 0x3F,  // Bass
-        data[8] & 0x80 ? yesStr : noStr,
-        (int8_t)(data[9] & 0x7F) - 0x3F,  // Treble
-        data[9] & 0x80 ? yesStr : noStr,
-        data[1] & 0x10 ? onStr : offStr,  // Loudness
-        fader == 0 ? "   " : fader > 0 ? "F +" : "R ", fader,
-        data[7] & 0x80 ? yesStr : noStr,
-        balance == 0 ? "   " : balance > 0 ? "R +" : "L ", balance,
-        data[6] & 0x80 ? yesStr : noStr,
-        data[1] & 0x04 ? onStr : offStr  // Auto volume
+    // Factory head unit has fixed maximum volume value of 30
+    #define MAX_AUDIO_VOLUME (30)
+    char floatBuf[MAX_FLOAT_SIZE];
+    json.Style(PSTR("volume_perc"), transformStr, PSTR("scaleX(%s)"),
+        FloatToStr(floatBuf, (float)volume / MAX_AUDIO_VOLUME, 2)
     );
 
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
+    // Audio menu. Bug: if CD changer is playing, this one is always "OPEN" (even if it isn't).
+    json.Str(PSTR("audio_menu"), data[1] & 0x20 ? openStr : closedStr);
+
+    json.Printf(PSTR("bass"), PSTR("%+d"), (int8_t)(data[8] & 0x7F) - 0x3F);
+    json.Str(PSTR("bass_update"), data[8] & 0x80 ? yesStr : noStr);
+    json.Printf(PSTR("treble"), PSTR("%+d"), (int8_t)(data[9] & 0x7F) - 0x3F);
+    json.Str(PSTR("treble_update"), data[9] & 0x80 ? yesStr : noStr);
+    json.Str(PSTR("loudness"), data[1] & 0x10 ? onStr : offStr);
+    json.Printf(PSTR("fader"), PSTR("%s%d"), fader == 0 ? "   " : fader > 0 ? "F +" : "R ", fader);
+    json.Str(PSTR("fader_update"), data[7] & 0x80 ? yesStr : noStr);
+    json.Printf(PSTR("balance"), PSTR("%s%d"), balance == 0 ? "   " : balance > 0 ? "R +" : "L ", balance);
+    json.Str(PSTR("balance_update"), data[6] & 0x80 ? yesStr : noStr);
+    json.Str(PSTR("auto_volume"), data[1] & 0x04 ? onStr : offStr);
 
     return VAN_PACKET_PARSE_OK;
 } // ParseAudioSettingsPkt
 
-VanPacketParseResult_t ParseMfdStatusPkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseMfdStatusPkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#5E4
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#5E4
@@ -2073,16 +1690,7 @@ VanPacketParseResult_t ParseMfdStatusPkt(TVanPacketRxDesc& pkt, char* buf, const
         TRIP_COUTER_2_RESET = 0x60FF
     }; // enum MfdStatus_t
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"mfd_status\": \"%s\""
-        "}\n"
-    "}\n";
-
-    int at = snprintf_P(buf, n, jsonFormatter,
+    json.Str(PSTR("mfd_status"),
 
         // hmmm... MFD can also be ON if this is reported; this happens e.g. in the "minimal VAN network" test
         // setup with only the head unit (radio) and MFD. Maybe this is a status report: the MFD shows if has
@@ -2095,13 +1703,10 @@ VanPacketParseResult_t ParseMfdStatusPkt(TVanPacketRxDesc& pkt, char* buf, const
         ToHexStr(mfdStatus)
     );
 
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
-
     return VAN_PACKET_PARSE_OK;
 } // ParseMfdStatusPkt
 
-VanPacketParseResult_t ParseAirCon1Pkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseAirCon1Pkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#464
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#464
@@ -2191,34 +1796,16 @@ VanPacketParseResult_t ParseAirCon1Pkt(TVanPacketRxDesc& pkt, char* buf, const i
         setFanSpeed == 3 ? 1 :  // All empty blades (1)
         0;  // Fan icon not visible at all
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"ac_icon\": \"%s\",\n"
-            "\"recirc\": \"%s\",\n"
-            "\"rear_heater_1\": \"%s\",\n"
-            "\"reported_fan_speed\": \"%u\",\n"
-            "\"set_fan_speed\": \"%u\"\n"
-        "}\n"
-    "}\n";
-
-    int at = snprintf_P(buf, n, jsonFormatter,
-        ac_icon ? onStr : offStr,
-        data[0] & 0x04 ? onStr : offStr,
-        rear_heater ? onStr : offStr,
-        data[4],
-        setFanSpeed
-    );
-
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
+    json.Str(PSTR("ac_icon"), ac_icon ? onStr : offStr);
+    json.Str(PSTR("recirc"), data[0] & 0x04 ? onStr : offStr);
+    json.Str(PSTR("rear_heater_1"), rear_heater ? onStr : offStr);
+    json.Printf(PSTR("reported_fan_speed"), PSTR("%u"), data[4]);
+    json.Printf(PSTR("set_fan_speed"), PSTR("%u"), setFanSpeed);
 
     return VAN_PACKET_PARSE_OK;
 } // ParseAirCon1Pkt
 
-VanPacketParseResult_t ParseAirCon2Pkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseAirCon2Pkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#4DC
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#4DC
@@ -2261,49 +1848,31 @@ VanPacketParseResult_t ParseAirCon2Pkt(TVanPacketRxDesc& pkt, char* buf, const i
 
     float evaporatorTempCelsius = evaporatorTemp / 10.0 - 40.0;
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"contact_key_on\": \"%s\",\n"
-            "\"ac_enabled\": \"%s\",\n"
-            "\"rear_heater_2\": \"%s\",\n"
-            "\"ac_compressor\": \"%s\",\n"
-            "\"contact_key_position_ac\": \"%s\",\n"
-            "\"condenser_temp\": \"%s\",\n"
-            "\"evaporator_temp\": \"%s\"\n"
-        "}\n"
-    "}\n";
-
-    char floatBuf[MAX_FLOAT_SIZE];
-    int at = snprintf_P(buf, n, jsonFormatter,
-        statusBits & 0x80 ? yesStr : noStr,
-        statusBits & 0x40 ? yesStr : noStr,
-        statusBits & 0x20 ? onStr : offStr,
-        statusBits & 0x01 ? onStr : offStr,
+    json.Str(PSTR("contact_key_on"), statusBits & 0x80 ? yesStr : noStr);
+    json.Str(PSTR("ac_enabled"), statusBits & 0x40 ? yesStr : noStr);
+    json.Str(PSTR("rear_heater_2"), statusBits & 0x20 ? onStr : offStr);
+    json.Str(PSTR("ac_compressor"), statusBits & 0x01 ? onStr : offStr);
 
+    json.Str(PSTR("contact_key_position_ac"),
         contactKeyData == 0x1C ? PSTR("ACC_OR_OFF") :
         contactKeyData == 0x18 ? PSTR("ACC-->OFF") :
         contactKeyData == 0x04 ? PSTR("ON-->ACC") :
         contactKeyData == 0x00 ? onStr :
-        ToHexStr(contactKeyData),
-
-        // This is not interior temperature. This rises quite rapidly if the aircon compressor is
-        // running, and drops again when the aircon compressor is off. So I think this is the condenser
-        // temperature.
-        condenserTemp == 0xFF ? notApplicable2Str : ToStr(condenserTemp),
-
-        FloatToStr(floatBuf, evaporatorTempCelsius, 1)
+        ToHexStr(contactKeyData)
     );
 
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
+    // This is not interior temperature. This rises quite rapidly if the aircon compressor is
+    // running, and drops again when the aircon compressor is off. So I think this is the condenser
+    // temperature.
+    json.Str(PSTR("condenser_temp"), condenserTemp == 0xFF ? notApplicable2Str : ToStr(condenserTemp));
+
+    char floatBuf[MAX_FLOAT_SIZE];
+    json.Str(PSTR("evaporator_temp"), FloatToStr(floatBuf, evaporatorTempCelsius, 1));
 
     return VAN_PACKET_PARSE_OK;
 } // ParseAirCon2Pkt
 
-VanPacketParseResult_t ParseCdChangerPkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseCdChangerPkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#4EC
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#4EC
@@ -2324,58 +1893,23 @@ VanPacketParseResult_t ParseCdChangerPkt(TVanPacketRxDesc& pkt, char* buf, const
     uint8_t trackTimeMin = data[4];
     uint8_t trackTimeSec = data[5];
     bool trackTimeValid = trackTimeMin != 0xFF && trackTimeSec != 0xFF;
-    char trackTimeStr[7];
-    if (trackTimeValid) sprintf_P(trackTimeStr, PSTR("%X:%02X"), trackTimeMin, trackTimeSec);
 
     uint8_t totalTracks = data[8];
     bool totalTracksValid = totalTracks != 0xFF;
-    char totalTracksStr[3];
-    if (totalTracksValid) sprintf_P(totalTracksStr, PSTR("%X"), totalTracks);
 
     uint8_t currentTrack = data[6];
     uint8_t currentDisc = data[7];
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"cd_changer_present\": \"%s\",\n"
-            "\"cd_changer_status_loading\": \"%s\",\n"
-            "\"cd_changer_status_eject\": \"%s\",\n"
-            "\"cd_changer_status_operational\": \"%s\",\n"
-            "\"cd_changer_status_searching\": \"%s\",\n"
-            "\"cd_changer_status\": \"%s\",\n"
-            "\"cd_changer_status_pause\": \"%s\",\n"
-            "\"cd_changer_status_play\": \"%s\",\n"
-            "\"cd_changer_status_fast_forward\": \"%s\",\n"
-            "\"cd_changer_status_rewind\": \"%s\",\n"
-            "\"cd_changer_cartridge_present\": \"%s\",\n"
-            "\"cd_changer_track_time\": \"%s\",\n"
-            "\"cd_changer_current_track\": \"%s\",\n"
-            "\"cd_changer_total_tracks\": \"%s\",\n"
-            "\"cd_changer_disc_1_present\": \"%s\",\n"
-            "\"cd_changer_disc_2_present\": \"%s\",\n"
-            "\"cd_changer_disc_3_present\": \"%s\",\n"
-            "\"cd_changer_disc_4_present\": \"%s\",\n"
-            "\"cd_changer_disc_5_present\": \"%s\",\n"
-            "\"cd_changer_disc_6_present\": \"%s\",\n"
-            "\"cd_changer_current_disc\": \"%s\",\n"
-            "\"cd_changer_random\": \"%s\"\n"
-        "}\n"
-    "}\n";
-
-    int at = snprintf_P(buf, n, jsonFormatter,
-
-        data[2] & 0x40 ? yesStr : noStr,  // CD changer device present
-        loading ? yesStr : noStr,  // Loading disc
-        ejecting ? yesStr : noStr,  // Ejecting cartridge
-
-        // Head unit powered on; CD changer operational (either standby or selected as audio source)
-        data[2] & 0x80 ? yesStr : noStr,
-
-        searching ? onStr : offStr,
+    json.Str(PSTR("cd_changer_present"), data[2] & 0x40 ? yesStr : noStr);  // CD changer device present
+    json.Str(PSTR("cd_changer_status_loading"), loading ? yesStr : noStr);  // Loading disc
+    json.Str(PSTR("cd_changer_status_eject"), ejecting ? yesStr : noStr);  // Ejecting cartridge
+
+    // Head unit powered on; CD changer operational (either standby or selected as audio source)
+    json.Str(PSTR("cd_changer_status_operational"), data[2] & 0x80 ? yesStr : noStr);
 
+    json.Str(PSTR("cd_changer_status_searching"), searching ? onStr : offStr);
+
+    json.Str(PSTR("cd_changer_status"),
         data[2] == 0x40 ? PSTR("POWER_OFF") :  // Not sure
         data[2] == 0x41 ? PSTR("POWER_ON") :  // Not sure
         data[2] == 0x49 ? PSTR("INITIALIZE") :  // Not sure
@@ -2392,29 +1926,35 @@ VanPacketParseResult_t ParseCdChangerPkt(TVanPacketRxDesc& pkt, char* buf, const
             // an error condition, e.g. disc inserted wrong way round
             currentDisc == 0xFF && currentTrack == 0xFF ? PSTR("ERROR") :
             PSTR("PLAY-SEARCHING") :
-        ToHexStr(data[2]),
+        ToHexStr(data[2])
+    );
 
-        (data[2] & 0x07) == 0x01 && ! ejecting && ! loading ? onStr : offStr,  // Pause
-        (data[2] & 0x07) == 0x03 && ! searching && ! loading ? onStr : offStr,  // Play
-        (data[2] & 0x07) == 0x04 ? onStr : offStr,  // Fast forward
-        (data[2] & 0x07) == 0x05 ? onStr : offStr,  // Rewind
+    json.Str(PSTR("cd_changer_status_pause"), (data[2] & 0x07) == 0x01 && ! ejecting && ! loading ? onStr : offStr);
+    json.Str(PSTR("cd_changer_status_play"), (data[2] & 0x07) == 0x03 && ! searching && ! loading ? onStr : offStr);
+    json.Str(PSTR("cd_changer_status_fast_forward"), (data[2] & 0x07) == 0x04 ? onStr : offStr);
+    json.Str(PSTR("cd_changer_status_rewind"), (data[2] & 0x07) == 0x05 ? onStr : offStr);
 
-        cdChangerCartridgePresent ? yesStr : noStr,
+    json.Str(PSTR("cd_changer_cartridge_present"), cdChangerCartridgePresent ? yesStr : noStr);
 
-        trackTimeValid ? trackTimeStr : PSTR("--:--"),
+    json.Printf(PSTR("cd_changer_track_time"),
+        trackTimeValid ? PSTR("%X:%02X") : PSTR("--:--"),
+        trackTimeMin,
+        trackTimeSec
+    );
 
-        currentTrack == 0xFF ? notApplicable2Str : ToBcdStr(currentTrack),
-        totalTracksValid ? totalTracksStr : notApplicable2Str,
+    json.Str(PSTR("cd_changer_current_track"), currentTrack == 0xFF ? notApplicable2Str : ToBcdStr(currentTrack));
+    json.Printf(PSTR("cd_changer_total_tracks"), totalTracksValid ? PSTR("%X") : notApplicable2Str, totalTracks);
 
-        data[10] & 0x01 ? yesStr : noStr,
-        data[10] & 0x02 ? yesStr : noStr,
-        data[10] & 0x04 ? yesStr : noStr,
-        data[10] & 0x08 ? yesStr : noStr,
-        data[10] & 0x10 ? yesStr : noStr,
-        data[10] & 0x20 ? yesStr : noStr,
+    json.Str(PSTR("cd_changer_disc_1_present"), data[10] & 0x01 ? yesStr : noStr);
+    json.Str(PSTR("cd_changer_disc_2_present"), data[10] & 0x02 ? yesStr : noStr);
+    json.Str(PSTR("cd_changer_disc_3_present"), data[10] & 0x04 ? yesStr : noStr);
+    json.Str(PSTR("cd_changer_disc_4_present"), data[10] & 0x08 ? yesStr : noStr);
+    json.Str(PSTR("cd_changer_disc_5_present"), data[10] & 0x10 ? yesStr : noStr);
+    json.Str(PSTR("cd_changer_disc_6_present"), data[10] & 0x20 ? yesStr : noStr);
 
-        // Pass the number only if disc is actually present: if cartridge is present without any discs, then
-        // 'currentDisc' (data[7]) will be incorrectly reported as '1'.
+    // Pass the number only if disc is actually present: if cartridge is present without any discs, then
+    // 'currentDisc' (data[7]) will be incorrectly reported as '1'.
+    json.Str(PSTR("cd_changer_current_disc"),
         currentDisc == 0xFF ? notApplicable2Str :
             currentDisc == 1 && data[10] & 0x01 ? PSTR("1") :
             currentDisc == 2 && data[10] & 0x02 ? PSTR("2") :
@@ -2422,18 +1962,15 @@ VanPacketParseResult_t ParseCdChangerPkt(TVanPacketRxDesc& pkt, char* buf, const
             currentDisc == 4 && data[10] & 0x08 ? PSTR("4") :
             currentDisc == 5 && data[10] & 0x10 ? PSTR("5") :
             currentDisc == 6 && data[10] & 0x20 ? PSTR("6") :
-            notApplicable2Str,
-
-        data[1] == 0x01 ? onStr : offStr
+            notApplicable2Str
     );
 
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
+    json.Str(PSTR("cd_changer_random"), data[1] == 0x01 ? onStr : offStr);
 
     return VAN_PACKET_PARSE_OK;
 } // ParseCdChangerPkt
 
-VanPacketParseResult_t ParseSatNavStatus1Pkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseSatNavStatus1Pkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#54E
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#54E
@@ -2441,17 +1978,7 @@ VanPacketParseResult_t ParseSatNavStatus1Pkt(TVanPacketRxDesc& pkt, char* buf, c
     const uint8_t* data = pkt.Data();
     uint16_t status = (uint16_t)data[1] << 8 | data[2];
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"satnav_status_1\": \"%s%s\"\n"
-        "}\n"
-    "}\n";
-
-    int at = snprintf_P(buf, n, jsonFormatter,
-
+    json.Printf(PSTR("satnav_status_1"), PSTR("%s%s"),
         status == 0x0000 ? noneStr :
         status == 0x0001 ? PSTR("DESTINATION_NOT_ON_MAP") :
         status == 0x0020 ? ToHexStr(status) :  // Seen this but what is it?? Nearly at destination ??
@@ -2487,16 +2014,13 @@ VanPacketParseResult_t ParseSatNavStatus1Pkt(TVanPacketRxDesc& pkt, char* buf, c
         emptyStr
     );
 
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
-
     return VAN_PACKET_PARSE_OK;
 } // ParseSatNavStatus1Pkt
 
 // Sat nav equipment detection
 bool satnavEquipmentDetected = true;
 
-VanPacketParseResult_t ParseSatNavStatus2Pkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseSatNavStatus2Pkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#7CE
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#7CE
@@ -2542,19 +2066,7 @@ VanPacketParseResult_t ParseSatNavStatus2Pkt(TVanPacketRxDesc& pkt, char* buf, c
             satnavEquipmentDetected = false;
         } // if
 
-        const static char jsonFormatter[] PROGMEM =
-        "{\n"
-            "\"event\": \"display\",\n"
-            "\"data\":\n"
-            "{\n"
-                "\"satnav_equipment_present\": \"%s\"\n"
-            "}\n"
-        "}\n";
-
-        int at = snprintf_P(buf, n, jsonFormatter, satnavEquipmentDetected ? yesStr : noStr);
-
-        // JSON buffer overflow?
-        if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
+        json.Str(PSTR("satnav_equipment_present"), satnavEquipmentDetected ? yesStr : noStr);
 
         return VAN_PACKET_PARSE_OK;
     } // if
@@ -2578,95 +2090,65 @@ VanPacketParseResult_t ParseSatNavStatus2Pkt(TVanPacketRxDesc& pkt, char* buf, c
 
     bool satnavDiscRecognized = (data[2] & 0x70) == 0x30;
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"satnav_route_computed\": \"%s\",\n" // Report this first. TODO - explain why
-            "\"satnav_status_2\": \"%s\",\n"
-            "\"satnav_destination_reachable\": \"%s\",\n"
-            "\"satnav_on_map\": \"%s\",\n"
-            "\"satnav_download_finished\": \"%s\",\n"
-            "\"satnav_disc_recognized\": \"%s\",\n"
-            "\"satnav_gps_fix\": \"%s\",\n"
-            "\"satnav_gps_fix_lost\": \"%s\",\n"
-            "\"satnav_gps_scanning\": \"%s\",\n"
-            "\"satnav_language\": \"%s\",\n"
-            "\"satnav_gps_speed\": \"%s%u\"";
-
-    int at = snprintf_P(buf, n, jsonFormatter,
-
-        data[1] & 0x20 ? noStr : yesStr,
-
-        satnavStatus2Str,
-
-        data[1] & 0x10 ? yesStr : noStr,
-        data[1] & 0x40 ? noStr : yesStr,
-        data[1] & 0x80 ? yesStr : noStr,
+    json.Str(PSTR("satnav_route_computed"), data[1] & 0x20 ? noStr : yesStr);  // Report this first. TODO - explain why
+    json.Str(PSTR("satnav_status_2"), satnavStatus2Str);
+    json.Str(PSTR("satnav_destination_reachable"), data[1] & 0x10 ? yesStr : noStr);
+    json.Str(PSTR("satnav_on_map"), data[1] & 0x40 ? noStr : yesStr);
+    json.Str(PSTR("satnav_download_finished"), data[1] & 0x80 ? yesStr : noStr);
 
+    json.Str(PSTR("satnav_disc_recognized"),
         satnavDiscRecognized ? yesStr :
         (data[2] & 0x70) == 0x70 ? noStr :
-        ToHexStr((uint8_t)(data[2] & 0x70)),
+        ToHexStr((uint8_t)(data[2] & 0x70))
+    );
 
-        data[2] & 0x01 ? yesStr : noStr,
-        data[2] & 0x02 ? yesStr : noStr,
-        data[2] & 0x04 ? yesStr : noStr,
+    json.Str(PSTR("satnav_gps_fix"), data[2] & 0x01 ? yesStr : noStr);
+    json.Str(PSTR("satnav_gps_fix_lost"), data[2] & 0x02 ? yesStr : noStr);
+    json.Str(PSTR("satnav_gps_scanning"), data[2] & 0x04 ? yesStr : noStr);
 
+    json.Str(PSTR("satnav_language"),
         data[5] == 0x00 ? PSTR("FRENCH") :
         data[5] == 0x01 ? PSTR("ENGLISH") :
         data[5] == 0x02 ? PSTR("GERMAN") :
         data[5] == 0x03 ? PSTR("SPANISH") :
         data[5] == 0x04 ? PSTR("ITALIAN") :
         data[5] == 0x06 ? PSTR("DUTCH") :
-        notApplicable3Str,
+        notApplicable3Str
+    );
 
-        // 0xE0 as boundary for "reverse": just guessing. Do we ever drive faster than 224 km/h?
+    // 0xE0 as boundary for "reverse": just guessing. Do we ever drive faster than 224 km/h?
+    json.Printf(PSTR("satnav_gps_speed"), PSTR("%s%u"),
         data[16] >= 0xE0 ? dashStr : emptyStr,
         data[16] < 0xE0 ? data[16] : 0xFF - data[16] + 1
     );
 
     // TODO - what is this?
     uint16_t zzz = (uint16_t)data[9] << 8 | data[10];
-    if (zzz != 0x00)
-    {
-        at += at >= n ? 0 : snprintf_P(buf + at, n - at, PSTR(",\n\"satnav_zzz\": \"%u\""), zzz);
-    } // if
+    if (zzz != 0x00) json.Printf(PSTR("satnav_zzz"), PSTR("%u"), zzz);
 
     if (data[17] != 0x00)
     {
-        at += at >= n ? 0 :
-            snprintf_P(buf + at, n - at, PSTR(",\n\"satnav_guidance_status\": \"%s%s%s%s%s%s%s\""),
-
-                data[17] & 0x01 ? PSTR("LOADING_AUDIO_FRAGMENT ") : emptyStr,
-                data[17] & 0x02 ? PSTR("AUDIO_OUTPUT ") : emptyStr,
-                data[17] & 0x04 ? PSTR("NEW_GUIDANCE_INSTRUCTION ") : emptyStr,
-                data[17] & 0x08 ? PSTR("READING_DISC ") : emptyStr,
-                data[17] & 0x10 ? PSTR("COMPUTING_ROUTE ") : emptyStr,
-                data[17] & 0x20 ? PSTR("DISC_PRESENT ") : emptyStr,
-                data[17] & 0x80 ? PSTR("REACHED_DESTINATION ") : emptyStr
-            );
-    } // if
-
-    if (! satnavEquipmentDetected)
-    {
-        // Large packet received, so sat nav equipment is obviously present. Add this to the JSON data.
-        // Variable 'satnavEquipmentDetected' is set to 'true' after successful return; see below.
-        at += at >= n ? 0 :
-            snprintf_P(buf + at, n - at, PSTR(",\n\"satnav_equipment_present\": \"YES\""));
+        json.Printf(PSTR("satnav_guidance_status"), PSTR("%s%s%s%s%s%s%s"),
+            data[17] & 0x01 ? PSTR("LOADING_AUDIO_FRAGMENT ") : emptyStr,
+            data[17] & 0x02 ? PSTR("AUDIO_OUTPUT ") : emptyStr,
+            data[17] & 0x04 ? PSTR("NEW_GUIDANCE_INSTRUCTION ") : emptyStr,
+            data[17] & 0x08 ? PSTR("READING_DISC ") : emptyStr,
+            data[17] & 0x10 ? PSTR("COMPUTING_ROUTE ") : emptyStr,
+            data[17] & 0x20 ? PSTR("DISC_PRESENT ") : emptyStr,
+            data[17] & 0x80 ? PSTR("REACHED_DESTINATION ") : emptyStr
+        );
     } // if
 
-    at += at >= n ? 0 : snprintf_P(buf + at, n - at, PSTR("\n}\n}\n"));
-
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
+    // Large packet received, so sat nav equipment is obviously present. Add this to the JSON data.
+    // Variable 'satnavEquipmentDetected' is set to 'true' after successful return; see below.
+    if (! satnavEquipmentDetected) json.Str(PSTR("satnav_equipment_present"), yesStr);
 
     satnavEquipmentDetected = true;
 
     return VAN_PACKET_PARSE_OK;
 } // ParseSatNavStatus2Pkt
 
-VanPacketParseResult_t ParseSatNavStatus3Pkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseSatNavStatus3Pkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#8CE
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#8CE
@@ -2675,22 +2157,12 @@ VanPacketParseResult_t ParseSatNavStatus3Pkt(TVanPacketRxDesc& pkt, char* buf, c
     if (dataLen != 2 && dataLen != 3 && dataLen != 17) return VAN_PACKET_PARSE_UNEXPECTED_LENGTH;
 
     const uint8_t* data = pkt.Data();
-    int at = 0;
 
     if (dataLen == 2)
     {
         uint16_t status = (uint16_t)data[0] << 8 | data[1];
 
-        const static char jsonFormatter[] PROGMEM =
-        "{\n"
-            "\"event\": \"display\",\n"
-            "\"data\":\n"
-            "{\n"
-                "\"satnav_status_3\": \"%s\"\n"
-            "}\n"
-        "}\n";
-
-        at = snprintf_P(buf, n, jsonFormatter,
+        json.Str(PSTR("satnav_status_3"),
 
             status == 0x0000 ? PSTR("COMPUTING_ROUTE") :
             status == 0x0001 ? PSTR("STOPPING_NAVIGATION") :
@@ -2715,55 +2187,32 @@ VanPacketParseResult_t ParseSatNavStatus3Pkt(TVanPacketRxDesc& pkt, char* buf, c
 
         uint8_t satnavGuidancePreference = data[1];
 
-        const static char jsonFormatter[] PROGMEM =
-        "{\n"
-            "\"event\": \"display\",\n"
-            "\"data\":\n"
-            "{\n"
-                "\"satnav_guidance_preference\": \"%s\"\n"
-            "}\n"
-        "}\n";
-
-        at = snprintf_P(buf, n, jsonFormatter, SatNavGuidancePreferenceStr(satnavGuidancePreference));
+        json.Str(PSTR("satnav_guidance_preference"), SatNavGuidancePreferenceStr(satnavGuidancePreference));
     }
     else if (dataLen == 17 && data[0] == 0x20)
     {
         // Some set of ID strings. Stays the same even when the navigation CD is changed.
 
-        const static char jsonFormatter[] PROGMEM =
-        "{\n"
-            "\"event\": \"display\",\n"
-            "\"data\":\n"
-            "{\n"
-                "\"satnav_system_id\":\n"
-                "[";
-
-        at = snprintf_P(buf, n, jsonFormatter);
+        json.BeginArray(PSTR("satnav_system_id"));
 
         char txt[VAN_MAX_DATA_BYTES - 1 + 1];  // Max 28 data bytes, minus header (1), plus terminating '\0'
 
-        bool first = true;
         int at2 = 1;
         while (at2 < dataLen)
         {
             strncpy(txt, (const char*) data + at2, dataLen - at2);
             txt[dataLen - at2] = 0;
-            at += at >= n ? 0 :
-                snprintf_P(buf + at, n - at, PSTR("%s\n\"%s\""), first ? emptyStr : commaStr, txt);
+            json.ArrayItem(PSTR("%s"), txt);
             at2 += strlen(txt) + 1;
-            first = false;
         } // while
 
-        at += at >= n ? 0 : snprintf_P(buf + at, n - at, PSTR("\n]\n}\n}\n"));
+        json.EndArray();
     } // if
 
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
-
     return VAN_PACKET_PARSE_OK;
 } // ParseSatNavStatus3Pkt
 
-VanPacketParseResult_t ParseSatNavGuidanceDataPkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseSatNavGuidanceDataPkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#9CE
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#9CE
@@ -2783,63 +2232,39 @@ VanPacketParseResult_t ParseSatNavGuidanceDataPkt(TVanPacketRxDesc& pkt, char* b
     // TODO - Not sure, just guessing. Could also be number of instructions still to be done.
     uint16_t minutesToTravel = (uint16_t)data[13] << 8 | data[14];
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"satnav_curr_heading_compass_needle\":\n"
-            "{\n"
-                "\"style\":\n"
-                "{\n"
-                    "\"transform\": \"rotate(%udeg)\"\n"
-                "}\n"
-            "},\n"
-            "\"satnav_curr_heading\": \"%u\",\n"  // degrees
-            "\"satnav_heading_to_dest_pointer\":\n"
-            "{\n"
-                "\"style\":\n"
-                "{\n"
-                    "\"transform\": \"rotate(%udeg)\"\n"
-                "}\n"
-            "},\n"
-            "\"satnav_heading_to_dest\": \"%u\",\n"  // degrees
-            "\"satnav_distance_to_dest_via_road\": \"%s %s\",\n"
-            "\"satnav_distance_to_dest_via_straight_line\": \"%s %s\",\n"
-            "\"satnav_turn_at\": \"%s %s\",\n"
-            "\"satnav_heading_on_roundabout_as_text\": \"%s\",\n"  // degrees
-            "\"satnav_minutes_to_travel\": \"%u\"\n"
-        "}\n"
-    "}\n";
-
-    char floatBuf[4][MAX_FLOAT_SIZE];
-    int at = snprintf_P(buf, n, jsonFormatter,
-
-        360 - currHeading, // Compass needle direction is current heading, mirrored over a vertical line
-        currHeading,
-        (360 - currHeading + headingToDestination) % 360, // To show pointer indicating direction relative to current heading
-        headingToDestination,
-
-        FloatToStr(floatBuf[0], roadDistanceToDestination, 0),
-        roadDistanceToDestinationInKmsMiles ? PSTR("km/mile") : PSTR("m/yd"),
-
-        FloatToStr(floatBuf[1], gpsDistanceToDestination, 0),
-        gpsDistanceToDestinationInKmsMiles ? PSTR("km/mile") : PSTR("m/yd"),
-
-        FloatToStr(floatBuf[2], distanceToNextTurn, 0),
-        distanceToNextTurnInKmsMiles ? PSTR("km/mile") : PSTR("m/yd"),
-
-        headingOnRoundabout == 0x7FFF ? notApplicable3Str : FloatToStr(floatBuf[3], headingOnRoundabout, 0),
-        minutesToTravel
+    // Compass needle direction is current heading, mirrored over a vertical line
+    json.Style(PSTR("satnav_curr_heading_compass_needle"), transformStr, PSTR("rotate(%udeg)"), 360 - currHeading);
+    json.Printf(PSTR("satnav_curr_heading"), PSTR("%u"), currHeading);  // degrees
+
+    // To show pointer indicating direction relative to current heading
+    json.Style(PSTR("satnav_heading_to_dest_pointer"), transformStr, PSTR("rotate(%udeg)"),
+        (360 - currHeading + headingToDestination) % 360
     );
+    json.Printf(PSTR("satnav_heading_to_dest"), PSTR("%u"), headingToDestination);  // degrees
 
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
+    char floatBuf[MAX_FLOAT_SIZE];
+    json.Printf(PSTR("satnav_distance_to_dest_via_road"), PSTR("%s %s"),
+        FloatToStr(floatBuf, roadDistanceToDestination, 0),
+        roadDistanceToDestinationInKmsMiles ? PSTR("km/mile") : PSTR("m/yd")
+    );
+    json.Printf(PSTR("satnav_distance_to_dest_via_straight_line"), PSTR("%s %s"),
+        FloatToStr(floatBuf, gpsDistanceToDestination, 0),
+        gpsDistanceToDestinationInKmsMiles ? PSTR("km/mile") : PSTR("m/yd")
+    );
+    json.Printf(PSTR("satnav_turn_at"), PSTR("%s %s"),
+        FloatToStr(floatBuf, distanceToNextTurn, 0),
+        distanceToNextTurnInKmsMiles ? PSTR("km/mile") : PSTR("m/yd")
+    );
+
+    json.Str(PSTR("satnav_heading_on_roundabout_as_text"),  // degrees
+        headingOnRoundabout == 0x7FFF ? notApplicable3Str : FloatToStr(floatBuf, headingOnRoundabout, 0)
+    );
+    json.Printf(PSTR("satnav_minutes_to_travel"), PSTR("%u"), minutesToTravel);
 
     return VAN_PACKET_PARSE_OK;
 } // ParseSatNavGuidanceDataPkt
 
-VanPacketParseResult_t ParseSatNavGuidancePkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseSatNavGuidancePkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#64E
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#64E
@@ -2852,33 +2277,26 @@ VanPacketParseResult_t ParseSatNavGuidancePkt(TVanPacketRxDesc& pkt, char* buf,
 
     const uint8_t* data = pkt.Data();
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"satnav_curr_turn_icon\": \"%s\",\n"
-            "\"satnav_fork_icon_take_right_exit\": \"%s\",\n"
-            "\"satnav_fork_icon_keep_right\": \"%s\",\n"
-            "\"satnav_fork_icon_take_left_exit\": \"%s\",\n"
-            "\"satnav_fork_icon_keep_left\": \"%s\",\n"
-            "\"satnav_next_turn_icon\": \"%s\",\n"
-            "\"satnav_turn_around_if_possible_icon\": \"%s\",\n"
-            "\"satnav_follow_road_icon\": \"%s\",\n"
-            "\"satnav_not_on_map_icon\": \"%s\"";
-
     // Determines which guidance icon(s) will be visible
-    int at = snprintf_P(buf, n, jsonFormatter,
-        (data[1] == 0x01 && (data[2] == 0x00 || data[2] == 0x01)) || data[1] == 0x03 ? onStr : offStr,
-        data[1] == 0x01 && data[2] == 0x02 && data[4] == 0x12 ? onStr : offStr,
-        data[1] == 0x01 && data[2] == 0x02 && data[4] == 0x14 ? onStr : offStr,
-        data[1] == 0x01 && data[2] == 0x02 && data[4] == 0x21 ? onStr : offStr,  // Never seen; just guessing
-        data[1] == 0x01 && data[2] == 0x02 && data[4] == 0x41 ? onStr : offStr,
-        data[1] == 0x03 ? onStr : offStr,
-        data[1] == 0x04 ? onStr : offStr,
-        data[1] == 0x05 ? onStr : offStr,
-        data[1] == 0x06 ? onStr : offStr
+    json.Str(PSTR("satnav_curr_turn_icon"),
+        (data[1] == 0x01 && (data[2] == 0x00 || data[2] == 0x01)) || data[1] == 0x03 ? onStr : offStr
+    );
+    json.Str(PSTR("satnav_fork_icon_take_right_exit"),
+        data[1] == 0x01 && data[2] == 0x02 && data[4] == 0x12 ? onStr : offStr
     );
+    json.Str(PSTR("satnav_fork_icon_keep_right"),
+        data[1] == 0x01 && data[2] == 0x02 && data[4] == 0x14 ? onStr : offStr
+    );
+    json.Str(PSTR("satnav_fork_icon_take_left_exit"),
+        data[1] == 0x01 && data[2] == 0x02 && data[4] == 0x21 ? onStr : offStr  // Never seen; just guessing
+    );
+    json.Str(PSTR("satnav_fork_icon_keep_left"),
+        data[1] == 0x01 && data[2] == 0x02 && data[4] == 0x41 ? onStr : offStr
+    );
+    json.Str(PSTR("satnav_next_turn_icon"), data[1] == 0x03 ? onStr : offStr);
+    json.Str(PSTR("satnav_turn_around_if_possible_icon"), data[1] == 0x04 ? onStr : offStr);
+    json.Str(PSTR("satnav_follow_road_icon"), data[1] == 0x05 ? onStr : offStr);
+    json.Str(PSTR("satnav_not_on_map_icon"), data[1] == 0x06 ? onStr : offStr);
 
     if (data[1] == 0x01)  // Single turn
     {
@@ -2888,7 +2306,7 @@ VanPacketParseResult_t ParseSatNavGuidancePkt(TVanPacketRxDesc& pkt, char* buf,
 
             // One instruction icon: current in data[4...11]
 
-            GuidanceInstructionIconJson(PSTR("satnav_curr_turn_icon"), data + 4, buf, at, n);
+            GuidanceInstructionIconJson(PSTR("satnav_curr_turn_icon"), data + 4, json);
         }
         else if (data[2] == 0x02)
         {
@@ -2903,8 +2321,8 @@ VanPacketParseResult_t ParseSatNavGuidancePkt(TVanPacketRxDesc& pkt, char* buf,
 
         // Two instruction icons: current in data[6...13], next in data[14...21]
 
-        GuidanceInstructionIconJson(PSTR("satnav_curr_turn_icon"), data + 6, buf, at, n);
-        GuidanceInstructionIconJson(PSTR("satnav_next_turn_icon"), data + 14, buf, at, n);
+        GuidanceInstructionIconJson(PSTR("satnav_curr_turn_icon"), data + 6, json);
+        GuidanceInstructionIconJson(PSTR("satnav_next_turn_icon"), data + 14, json);
     }
     else if (data[1] == 0x04)  // Turn around if possible
     {
@@ -2918,23 +2336,11 @@ VanPacketParseResult_t ParseSatNavGuidancePkt(TVanPacketRxDesc& pkt, char* buf,
 
         // Show one of the five available icons
 
-        const static char jsonFormatter[] PROGMEM =
-            ",\n"
-            "\"satnav_follow_road_then_turn_right\": \"%s\",\n"
-            "\"satnav_follow_road_then_turn_left\": \"%s\",\n"
-            "\"satnav_follow_road_until_roundabout\": \"%s\",\n"
-            "\"satnav_follow_road_straight_ahead\": \"%s\",\n"
-            "\"satnav_follow_road_retrieving_next_instruction\": \"%s\"";
-
-        at += at >= n ? 0 :
-            snprintf_P(buf + at, n - at, jsonFormatter,
-
-                data[2] == 0x01 ? onStr : offStr,
-                data[2] == 0x02 ? onStr : offStr,
-                data[2] == 0x04 ? onStr : offStr,
-                data[2] == 0x08 ? onStr : offStr,
-                data[2] == 0x10 ? onStr : offStr
-            );
+        json.Str(PSTR("satnav_follow_road_then_turn_right"), data[2] == 0x01 ? onStr : offStr);
+        json.Str(PSTR("satnav_follow_road_then_turn_left"), data[2] == 0x02 ? onStr : offStr);
+        json.Str(PSTR("satnav_follow_road_until_roundabout"), data[2] == 0x04 ? onStr : offStr);
+        json.Str(PSTR("satnav_follow_road_straight_ahead"), data[2] == 0x08 ? onStr : offStr);
+        json.Str(PSTR("satnav_follow_road_retrieving_next_instruction"), data[2] == 0x10 ? onStr : offStr);
     }
     else if (data[1] == 0x06)  // Not on map
     {
@@ -2942,32 +2348,16 @@ VanPacketParseResult_t ParseSatNavGuidancePkt(TVanPacketRxDesc& pkt, char* buf,
 
         uint16_t direction = (data[2] * 225 + 1800) % 3600;
 
-        const static char jsonFormatter[] PROGMEM =
-            ",\n"
-            "\"satnav_not_on_map_follow_heading_as_text\": \"%u.%u\",\n"  // degrees
-            "\"satnav_not_on_map_follow_heading\":\n"
-            "{\n"
-                "\"style\":\n"
-                "{\n"
-                    "\"transform\": \"rotate(%u.%udeg)\"\n"
-                "}\n"
-            "}";
-
-        at += at >= n ? 0 :
-            snprintf_P(buf + at, n - at, jsonFormatter,
-
-                direction / 10,
-                direction % 10,
-                direction / 10,
-                direction % 10
-            );
+        json.Printf(PSTR("satnav_not_on_map_follow_heading_as_text"), PSTR("%u.%u"),  // degrees
+            direction / 10,
+            direction % 10
+        );
+        json.Style(PSTR("satnav_not_on_map_follow_heading"), transformStr, PSTR("rotate(%u.%udeg)"),
+            direction / 10,
+            direction % 10
+        );
     } // if
 
-    at += at >= n ? 0 : snprintf_P(buf + at, n - at, PSTR("\n}\n}\n"));
-
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
-
     return VAN_PACKET_PARSE_OK;
 } // ParseSatNavGuidancePkt
 
@@ -3004,7 +2394,7 @@ String ComposeCityString(const String& records3, const String& records4)
     return result;
 } // ComposeCityString
 
-VanPacketParseResult_t ParseSatNavReportPkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseSatNavReportPkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#6CE
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#6CE
@@ -3184,221 +2574,171 @@ VanPacketParseResult_t ParseSatNavReportPkt(TVanPacketRxDesc& pkt, char* buf, co
 
     // Create an 'easily digestable' report in JSON format
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"satnav_report\": \"%s\"";
-
-    int at = snprintf_P(buf, n, jsonFormatter, SatNavRequestStr(report));
+    json.Str(PSTR("satnav_report"), SatNavRequestStr(report));
 
     switch(report)
     {
         case SR_CURRENT_STREET:
         case SR_NEXT_STREET:
         {
+            PGM_P key = report == SR_CURRENT_STREET ? PSTR("satnav_curr_street") : PSTR("satnav_next_street");
+
             if (records[6].length() == 0)
             {
                 // In this case, the original MFD says: "Street not listed". We just show the city.
 
-                const static char jsonFormatter[] PROGMEM =
-                    ",\n"
-                    "\"%s\": \"%s\"";
-
-                at += at >= n ? 0 :
-                    snprintf_P(buf + at, n - at, jsonFormatter,
-                        report == SR_CURRENT_STREET ? PSTR("satnav_curr_street") : PSTR("satnav_next_street"),
-
-                        // City (if any) + optional district
-                        ComposeCityString(records[3], records[4]).c_str()
-                    );
+                // City (if any) + optional district
+                json.Str(key, ComposeCityString(records[3], records[4]).c_str());
 
                 break;
             } // if
 
-            const static char jsonFormatter[] PROGMEM =
-                ",\n"
-                "\"%s\": \"%s (%s)\"";
-
             // Current/next street is in first (and only) record. Copy only city [3], district [4] (if any) and
             // street [5, 6]; skip the other strings.
-            at += at >= n ? 0 :
-                snprintf_P(buf + at, n - at, jsonFormatter,
+            json.Printf(key, PSTR("%s (%s)"),
 
-                    report == SR_CURRENT_STREET ? PSTR("satnav_curr_street") : PSTR("satnav_next_street"),
+                // Street
+                ComposeStreetString(records[5], records[6]).c_str(),
 
-                    // Street
-                    ComposeStreetString(records[5], records[6]).c_str(),
-
-                    // City + optional district
-                    ComposeCityString(records[3], records[4]).c_str()
-                );
+                // City + optional district
+                ComposeCityString(records[3], records[4]).c_str()
+            );
         } // case
         break;
 
         case SR_DESTINATION:
         case SR_LAST_DESTINATION:
         {
-            const static char jsonFormatter[] PROGMEM =
-                ",\n"
-                "\"%s\": \"%s\",\n"
-                "\"%s\": \"%s\",\n"
-                "\"%s\": \"%s\",\n"
-                "\"%s\": \"%s\",\n"
-                "\"%s\": \"%s\"";
-
             // Address is in first (and only) record. Copy at least only city [3], district [4] (if any), street [5, 6]
             // and house number [7]; skip the other strings.
-            at += at >= n ? 0 :
-                snprintf_P(buf + at, n - at, jsonFormatter,
-
-                    report == SR_DESTINATION ?
-                        PSTR("satnav_current_destination_country") :
-                        PSTR("satnav_last_destination_country"),
-
-                    // Country
-                    records[1].c_str(),
-
-                    report == SR_DESTINATION ?
-                        PSTR("satnav_current_destination_province") :
-                        PSTR("satnav_last_destination_province"),
 
-                    // Province
-                    records[2].c_str(),
-
-                    report == SR_DESTINATION ?
-                        PSTR("satnav_current_destination_city") :
-                        PSTR("satnav_last_destination_city"),
-
-                    // City + optional district
-                    ComposeCityString(records[3], records[4]).c_str(),
+            // Country
+            json.Str(
+                report == SR_DESTINATION ?
+                    PSTR("satnav_current_destination_country") :
+                    PSTR("satnav_last_destination_country"),
+                records[1].c_str()
+            );
 
-                    report == SR_DESTINATION ?
-                        PSTR("satnav_current_destination_street") :
-                        PSTR("satnav_last_destination_street"),
+            // Province
+            json.Str(
+                report == SR_DESTINATION ?
+                    PSTR("satnav_current_destination_province") :
+                    PSTR("satnav_last_destination_province"),
+                records[2].c_str()
+            );
 
-                    // Street
-                    // Note: if the street is empty: it means "City centre"
-                    ComposeStreetString(records[5], records[6]).c_str(),
+            // City + optional district
+            json.Str(
+                report == SR_DESTINATION ?
+                    PSTR("satnav_current_destination_city") :
+                    PSTR("satnav_last_destination_city"),
+                ComposeCityString(records[3], records[4]).c_str()
+            );
 
-                    report == SR_DESTINATION ?
-                        PSTR("satnav_current_destination_house_number") :
-                        PSTR("satnav_last_destination_house_number"),
+            // Street
+            // Note: if the street is empty: it means "City centre"
+            json.Str(
+                report == SR_DESTINATION ?
+                    PSTR("satnav_current_destination_street") :
+                    PSTR("satnav_last_destination_street"),
+                ComposeStreetString(records[5], records[6]).c_str()
+            );
 
-                    // First string is either "C" or "V"; "C" has GPS coordinates in [7] and [8]; "V" has house number
-                    // in [7]. If we see "V", show house number
-                    records[0] == "V" && records[7] != "0" ?
-                        records[7].c_str() :
-                        emptyStr
-                );
+            // First string is either "C" or "V"; "C" has GPS coordinates in [7] and [8]; "V" has house number
+            // in [7]. If we see "V", show house number
+            json.Str(
+                report == SR_DESTINATION ?
+                    PSTR("satnav_current_destination_house_number") :
+                    PSTR("satnav_last_destination_house_number"),
+                records[0] == "V" && records[7] != "0" ?
+                    records[7].c_str() :
+                    emptyStr
+            );
         } // case
         break;
 
         case SR_PERSONAL_ADDRESS:
         case SR_PROFESSIONAL_ADDRESS:
         {
-            const static char jsonFormatter[] PROGMEM =
-                ",\n"
-                "\"%s\": \"%s\",\n"
-                "\"%s\": \"%s\",\n"
-                "\"%s\": \"%s\",\n"
-                "\"%s\": \"%s\",\n"
-                "\"%s\": \"%s\",\n"
-                "\"%s\": \"%s\"";
-
             // Chosen address is in first (and only) record. Copy at least city [3], district [4] (if any),
             // street [5, 6], house number [7] and entry name [8]; skip the other strings.
-            at += at >= n ? 0 :
-                snprintf_P(buf + at, n - at, jsonFormatter,
 
-                    report == SR_PERSONAL_ADDRESS ?
-                        PSTR("satnav_personal_address_entry") :
-                        PSTR("satnav_professional_address_entry"),
-
-                    // Name of the entry
-                    records[0] == "C" ? records[9].c_str() : records[8].c_str(),
-
-                    // Address
-
-                    report == SR_PERSONAL_ADDRESS ?
-                        PSTR("satnav_personal_address_country") :
-                        PSTR("satnav_professional_address_country"),
-
-                    // Country
-                    records[1].c_str(),
-
-                    report == SR_PERSONAL_ADDRESS ?
-                        PSTR("satnav_personal_address_province") :
-                        PSTR("satnav_professional_address_province"),
-
-                    // Province
-                    records[2].c_str(),
+            // Name of the entry
+            json.Str(
+                report == SR_PERSONAL_ADDRESS ?
+                    PSTR("satnav_personal_address_entry") :
+                    PSTR("satnav_professional_address_entry"),
+                records[0] == "C" ? records[9].c_str() : records[8].c_str()
+            );
 
-                    report == SR_PERSONAL_ADDRESS ?
-                        PSTR("satnav_personal_address_city") :
-                        PSTR("satnav_professional_address_city"),
+            // Address
 
-                    // City + optional district
-                    ComposeCityString(records[3], records[4]).c_str(),
+            // Country
+            json.Str(
+                report == SR_PERSONAL_ADDRESS ?
+                    PSTR("satnav_personal_address_country") :
+                    PSTR("satnav_professional_address_country"),
+                records[1].c_str()
+            );
 
-                    report == SR_PERSONAL_ADDRESS ?
-                        PSTR("satnav_personal_address_street") :
-                        PSTR("satnav_professional_address_street"),
+            // Province
+            json.Str(
+                report == SR_PERSONAL_ADDRESS ?
+                    PSTR("satnav_personal_address_province") :
+                    PSTR("satnav_professional_address_province"),
+                records[2].c_str()
+            );
 
-                    // Street
-                    // Note: if the street is empty: it means "City centre"
-                    ComposeStreetString(records[5], records[6]).c_str(),
+            // City + optional district
+            json.Str(
+                report == SR_PERSONAL_ADDRESS ?
+                    PSTR("satnav_personal_address_city") :
+                    PSTR("satnav_professional_address_city"),
+                ComposeCityString(records[3], records[4]).c_str()
+            );
 
-                    report == SR_PERSONAL_ADDRESS ?
-                        PSTR("satnav_personal_address_house_number") :
-                        PSTR("satnav_professional_address_house_number"),
+            // Street
+            // Note: if the street is empty: it means "City centre"
+            json.Str(
+                report == SR_PERSONAL_ADDRESS ?
+                    PSTR("satnav_personal_address_street") :
+                    PSTR("satnav_professional_address_street"),
+                ComposeStreetString(records[5], records[6]).c_str()
+            );
 
-                    // First string is either "C" or "V"; "C" has GPS coordinates in [7] and [8]; "V" has house number
-                    // in [7]. If we see "V", show house number
-                    records[0] == "V" && records[7] != "0" ?
-                        records[7].c_str() :
-                        emptyStr
-                );
+            // First string is either "C" or "V"; "C" has GPS coordinates in [7] and [8]; "V" has house number
+            // in [7]. If we see "V", show house number
+            json.Str(
+                report == SR_PERSONAL_ADDRESS ?
+                    PSTR("satnav_personal_address_house_number") :
+                    PSTR("satnav_professional_address_house_number"),
+                records[0] == "V" && records[7] != "0" ?
+                    records[7].c_str() :
+                    emptyStr
+            );
         } // case
         break;
 
         case SR_SERVICE_ADDRESS:
         {
-            const static char jsonFormatter[] PROGMEM =
-                ",\n"
-                "\"satnav_service_address_entry\": \"%s\",\n"
-                "\"satnav_service_address_country\": \"%s\",\n"
-                "\"satnav_service_address_province\": \"%s\",\n"
-                "\"satnav_service_address_city\": \"%s\",\n"
-                "\"satnav_service_address_street\": \"%s\",\n"
-                "\"satnav_service_address_distance\": \"%s m/yd\"";
-
             // Chosen service address is in first (and only) record. Copy at least city [3], district [4]
             // (if any), street [5, 6], entry name [9] and distance [11]; skip the other strings.
-            at += at >= n ? 0 :
-                snprintf_P(buf + at, n - at, jsonFormatter,
 
-                    // Name of the service address
-                    records[9].c_str(),
+            // Name of the service address
+            json.Str(PSTR("satnav_service_address_entry"), records[9].c_str());
 
-                    // Service address
+            // Service address
+            json.Str(PSTR("satnav_service_address_country"), records[1].c_str());
+            json.Str(PSTR("satnav_service_address_province"), records[2].c_str());
 
-                    // Country
-                    records[1].c_str(),
+            // City + optional district
+            json.Str(PSTR("satnav_service_address_city"), ComposeCityString(records[3], records[4]).c_str());
 
-                    // Province
-                    records[2].c_str(),
+            json.Str(PSTR("satnav_service_address_street"), ComposeStreetString(records[5], records[6]).c_str());
 
-                    // City + optional district
-                    ComposeCityString(records[3], records[4]).c_str(),
-
-                    // Street
-                    ComposeStreetString(records[5], records[6]).c_str(),
-
-                    // Distance to the service address (sat nav reports in metres or in yards)
-                    records[11].c_str()
-                );
+            // Distance to the service address (sat nav reports in metres or in yards)
+            json.Printf(PSTR("satnav_service_address_distance"), PSTR("%s m/yd"), records[11].c_str());
         }
         break;
 
@@ -3407,72 +2747,36 @@ VanPacketParseResult_t ParseSatNavReportPkt(TVanPacketRxDesc& pkt, char* buf, co
         case SR_PERSONAL_ADDRESS_LIST:
         case SR_PROFESSIONAL_ADDRESS_LIST:
         {
-            const static char jsonFormatter[] PROGMEM =
-                ",\n"
-                "\"satnav_list\":\n"
-                "[";
-
-            at += at >= n ? 0 :
-                snprintf_P(buf + at, n - at, jsonFormatter);
+            json.BeginArray(PSTR("satnav_list"));
 
             // Each item in the list is a single string in a separate record
-            for (int i = 0; i < currentRecord; i++)
-            {
-                at += at >= n ? 0 :
-                    snprintf_P(buf + at, n - at,
-                        PSTR("%s\n\"%s\""),
-                        i == 0 ? emptyStr : commaStr,
-                        records[i].c_str()
-                    );
-            } // for
+            for (int i = 0; i < currentRecord; i++) json.ArrayItem(PSTR("%s"), records[i].c_str());
 
-            at += at >= n ? 0 :
-                snprintf_P(buf + at, n - at, PSTR("\n]"));
+            json.EndArray();
         } // case
         break;
 
         case SR_ENTER_HOUSE_NUMBER:
         {
-            const static char jsonFormatter[] PROGMEM =
-                ",\n"
-                "\"satnav_house_number_range\": \"From %s to %s\"";
-
             // Range of "house numbers" is in first (and only) record, the lowest number is in the first string, and
             // highest number is in the second string.
             // Note: "0...0" means: not applicable. MFD will follow through directly to showing the address (without a
             //   house number).
-            at += at >= n ? 0 :
-                snprintf_P(buf + at, n - at, jsonFormatter,
-
-                    records[0].c_str(),
-                    records[1].c_str()
-                );
+            json.Printf(PSTR("satnav_house_number_range"), PSTR("From %s to %s"),
+                records[0].c_str(),
+                records[1].c_str()
+            );
         } // case
         break;
 
         case SR_SERVICE_LIST:
         {
-            const static char jsonFormatter[] PROGMEM =
-                ",\n"
-                "\"satnav_list\":\n"
-                "[";
-
-            at += at >= n ? 0 :
-                snprintf_P(buf + at, n - at, jsonFormatter);
+            json.BeginArray(PSTR("satnav_list"));
 
             // Each "service" in the list is a single string in a separate record
-            for (int i = 0; i < currentRecord; i++)
-            {
-                at += at >= n ? 0 :
-                    snprintf_P(buf + at, n - at,
-                        PSTR("%s\n\"%s\""),
-                        i == 0 ? emptyStr : commaStr,
-                        records[i].c_str()
-                    );
-            } // for
+            for (int i = 0; i < currentRecord; i++) json.ArrayItem(PSTR("%s"), records[i].c_str());
 
-            at += at >= n ? 0 :
-                snprintf_P(buf + at, n - at, PSTR("\n]"));
+            json.EndArray();
         } // case
         break;
 
@@ -3484,37 +2788,25 @@ VanPacketParseResult_t ParseSatNavReportPkt(TVanPacketRxDesc& pkt, char* buf, co
             // - Press Left twice
             // - Hold Esc until the debug menu appears ("Supplier DEBUG Menu")
 
-            const static char jsonFormatter[] PROGMEM =
-                ",\n"
-                "\"satnav_software_modules_list\":\n"
-                "[";
-
-            at += at >= n ? 0 :
-                snprintf_P(buf + at, n - at, jsonFormatter);
+            json.BeginArray(PSTR("satnav_software_modules_list"));
 
             // Each "module" in the list is a triplet of strings ('module_name', then 'version' and 'date' in a rather
             // free format) in a separate record
             for (int i = 0; i < currentRecord; i++)
             {
-                at += at >= n ? 0 :
-                    snprintf_P(buf + at, n - at,
-                        PSTR("%s\n\"%s - %s - %s\""),
-                        i == 0 ? emptyStr : commaStr,
-                        records[i * 3].c_str(),
-                        records[i * 3 + 1].c_str(),
-                        records[i * 3 + 2].c_str()
-                    );
+                json.ArrayItem(PSTR("%s - %s - %s"),
+                    records[i * 3].c_str(),
+                    records[i * 3 + 1].c_str(),
+                    records[i * 3 + 2].c_str()
+                );
             } // for
 
-            at += at >= n ? 0 :
-                snprintf_P(buf + at, n - at, PSTR("\n]"));
+            json.EndArray();
         } // case
         break;
 
     } // switch
 
-    at += at >= n ? 0 : snprintf_P(buf + at, n - at, PSTR("\n}\n}\n"));
-
     // Reset
     report = INVALID_SATNAV_REPORT;
     offsetInBuffer = 0;
@@ -3527,13 +2819,10 @@ VanPacketParseResult_t ParseSatNavReportPkt(TVanPacketRxDesc& pkt, char* buf, co
     currentRecord = 0;
     currentString = 0;
 
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
-
     return VAN_PACKET_PARSE_OK;
 } // ParseSatNavReportPkt
 
-VanPacketParseResult_t ParseMfdToSatNavPkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseMfdToSatNavPkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#94E
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#94E
@@ -3546,15 +2835,8 @@ VanPacketParseResult_t ParseMfdToSatNavPkt(TVanPacketRxDesc& pkt, char* buf, con
     uint8_t param = data[1];
     uint8_t type = data[2];
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"mfd_to_satnav_request\": \"%s\",\n"
-            "\"mfd_to_satnav_request_type\": \"%s\"";
-
-    int at = snprintf_P(buf, n, jsonFormatter, SatNavRequestStr(request), SatNavRequestTypeStr(type));
+    json.Str(PSTR("mfd_to_satnav_request"), SatNavRequestStr(request));
+    json.Str(PSTR("mfd_to_satnav_request_type"), SatNavRequestTypeStr(type));
 
     const char* goToScreen =
 
@@ -3767,36 +3049,19 @@ VanPacketParseResult_t ParseMfdToSatNavPkt(TVanPacketRxDesc& pkt, char* buf, con
 
         emptyStr;
 
-    if (strlen_P(goToScreen) > 0)
-    {
-        at += at >= n ? 0 :
-            snprintf_P(buf + at, n - at, PSTR
-                (
-                    ",\n"
-                    "\"mfd_to_satnav_go_to_screen\": \"%s\""
-                ),
-
-                goToScreen
-            );
-    } // if
+    if (strlen_P(goToScreen) > 0) json.Str(PSTR("mfd_to_satnav_go_to_screen"), goToScreen);
 
     if (data[3] != 0x00)
     {
         char buffer[2];
         sprintf_P(buffer, PSTR("%c"), data[3]);
 
-        at += at >= n ? 0 :
-            snprintf_P(buf + at, n - at, PSTR
-                (
-                    ",\n"
-                    "\"mfd_to_satnav_enter_character\": \"%s\""
-                ),
-
-                (data[3] >= 'A' && data[3] <= 'Z') || (data[3] >= '0' && data[3] <= '9') || data[3] == '\'' ? buffer :
-                data[3] == ' ' ? "_" : // Space
-                data[3] == 0x01 ? "Esc" :
-                "?"
-            );
+        json.Str(PSTR("mfd_to_satnav_enter_character"),
+            (data[3] >= 'A' && data[3] <= 'Z') || (data[3] >= '0' && data[3] <= '9') || data[3] == '\'' ? buffer :
+            data[3] == ' ' ? "_" : // Space
+            data[3] == 0x01 ? "Esc" :
+            "?"
+        );
     } // if
 
     if (dataLen >= 9)
@@ -3807,40 +3072,20 @@ VanPacketParseResult_t ParseMfdToSatNavPkt(TVanPacketRxDesc& pkt, char* buf, con
         //if (selectionOrOffset > 0 && length > 0)
         if (length > 0)
         {
-            at += at >= n ? 0 :
-                snprintf_P(buf + at, n - at, PSTR
-                    (
-                        ",\n"
-                        "\"mfd_to_satnav_offset\": \"%u\",\n"
-                        "\"mfd_to_satnav_length\": \"%u\""
-                    ),
-                    selectionOrOffset,
-                    length
-                );
+            json.Printf(PSTR("mfd_to_satnav_offset"), PSTR("%u"), selectionOrOffset);
+            json.Printf(PSTR("mfd_to_satnav_length"), PSTR("%u"), length);
         }
         //else if (selectionOrOffset > 0)
         else
         {
-            at += at >= n ? 0 :
-                snprintf_P(buf + at, n - at, PSTR
-                    (
-                        ",\n"
-                        "\"mfd_to_satnav_selection\": \"%u\""
-                    ),
-                    selectionOrOffset
-                );
+            json.Printf(PSTR("mfd_to_satnav_selection"), PSTR("%u"), selectionOrOffset);
         } // if
     } // if
 
-    at += at >= n ? 0 : snprintf_P(buf + at, n - at, PSTR("\n}\n}\n"));
-
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
-
     return VAN_PACKET_PARSE_OK;
 } // ParseMfdToSatNavPkt
 
-VanPacketParseResult_t ParseSatNavToMfdPkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseSatNavToMfdPkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#74E
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#74E
@@ -3854,30 +3099,19 @@ VanPacketParseResult_t ParseSatNavToMfdPkt(TVanPacketRxDesc& pkt, char* buf, con
     // selected characters.
     int16_t list2Size = (int16_t)(data[11] << 8 | data[12]);
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"satnav_to_mfd_response\": \"%s\"";
+    json.Str(PSTR("satnav_to_mfd_response"), SatNavRequestStr(request));
 
-    int at = snprintf_P(buf, n, jsonFormatter, SatNavRequestStr(request));
-
-    if (listSize >= 0)
-    {
-        at += at >= n ? 0 : snprintf_P(buf + at, n - at, PSTR(",\n\"satnav_to_mfd_list_size\": \"%d\""), listSize);
-    } // if
+    if (listSize >= 0) json.Printf(PSTR("satnav_to_mfd_list_size"), PSTR("%d"), listSize);
 
     // data[10] is some "flags" byte. Values seen:
     // - 0x41 : Second list
     // - 0x48 : No second list
     // - 0xF1 : Second list with same length as first list
-    if (data[10] == 0x41 && list2Size >= 0)
-    {
-        at += at >= n ? 0 : snprintf_P(buf + at, n - at, PSTR(",\n\"satnav_to_mfd_list_2_size\": \"%d\""), list2Size);
-    } // if
+    if (data[10] == 0x41 && list2Size >= 0) json.Printf(PSTR("satnav_to_mfd_list_2_size"), PSTR("%d"), list2Size);
 
-    at += at >= n ? 0 : snprintf_P(buf + at, n - at, PSTR(",\n\"satnav_to_mfd_show_characters\": \""));
+    // 26 letters, the single quote, 10 numbers and the space
+    char characters[26 + 1 + 10 + 1 + 1];
+    int at = 0;
 
     // TODO - handle SR_ARCHIVE_IN_DIRECTORY
 
@@ -3886,18 +3120,14 @@ VanPacketParseResult_t ParseSatNavToMfdPkt(TVanPacketRxDesc& pkt, char* buf, con
     {
         for (int bit = 0; bit < (byte == 3 ? 2 : 8); bit++)
         {
-            if (data[byte + 17] >> bit & 0x01)
-            {
-                at += at >= n ? 0 :
-                    snprintf_P(buf + at, n - at, PSTR("%c"), 65 + 8 * byte + bit);
-            } // if
+            if (data[byte + 17] >> bit & 0x01) characters[at++] = 65 + 8 * byte + bit;
         } // for
     } // for
 
     if (data[21] >> 6 & 0x01)
     {
         // Special character: single quote (')
-        at += at >= n ? 0 : snprintf_P(buf + at, n - at, PSTR("\'"));
+        characters[at++] = '\'';
     } // if
 
     // Available numbers are bit-coded in bytes 20...21, starting with '0' at bit 2 of byte 20, ending
@@ -3906,63 +3136,38 @@ VanPacketParseResult_t ParseSatNavToMfdPkt(TVanPacketRxDesc& pkt, char* buf, con
     {
         for (int bit = (byte == 0 ? 2 : 0); bit < (byte == 1 ? 4 : 8); bit++)
         {
-            if (data[byte + 20] >> bit & 0x01)
-            {
-                at += at >= n ? 0 :
-                    snprintf_P(buf + at, n - at, PSTR("%c"), 48 + 8 * byte + bit - 2);
-            } // if
+            if (data[byte + 20] >> bit & 0x01) characters[at++] = 48 + 8 * byte + bit - 2;
         } // for
     } // for
 
     if (data[22] >> 1 & 0x01)
     {
         // <Space>, will be shown as '_'
-        at += at >= n ? 0 : snprintf_P(buf + at, n - at, PSTR("_"));
+        characters[at++] = '_';
     } // if
 
-    at += at >= n ? 0 :
-        snprintf_P(buf + at, n - at, PSTR("\"\n}\n}\n"));
-
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
+    characters[at] = 0;
+    json.Str(PSTR("satnav_to_mfd_show_characters"), characters);
 
     return VAN_PACKET_PARSE_OK;
 } // ParseSatNavToMfdPkt
 
-VanPacketParseResult_t ParseWheelSpeedPkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseWheelSpeedPkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#744
 
     const uint8_t* data = pkt.Data();
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"wheel_speed_rear_right\": \"%s\",\n"
-            "\"wheel_speed_rear_left\": \"%s\",\n"
-            "\"wheel_pulses_rear_right\": \"%u\",\n"
-            "\"wheel_pulses_rear_left\": \"%u\"\n"
-        "}\n"
-    "}\n";
-
-    char floatBuf[2][MAX_FLOAT_SIZE];
-
-    int at = snprintf_P(buf, n, jsonFormatter,
-        FloatToStr(floatBuf[0], ((uint16_t)data[0] << 8 | data[1]) / 100.0, 2),
-        FloatToStr(floatBuf[1], ((uint16_t)data[2] << 8 | data[3]) / 100.0, 2),
-        (uint16_t)data[4] << 8 | data[5],
-        (uint16_t)data[6] << 8 | data[7]
-    );
-
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
+    char floatBuf[MAX_FLOAT_SIZE];
+    json.Str(PSTR("wheel_speed_rear_right"), FloatToStr(floatBuf, ((uint16_t)data[0] << 8 | data[1]) / 100.0, 2));
+    json.Str(PSTR("wheel_speed_rear_left"), FloatToStr(floatBuf, ((uint16_t)data[2] << 8 | data[3]) / 100.0, 2));
+    json.Printf(PSTR("wheel_pulses_rear_right"), PSTR("%u"), (uint16_t)data[4] << 8 | data[5]);
+    json.Printf(PSTR("wheel_pulses_rear_left"), PSTR("%u"), (uint16_t)data[6] << 8 | data[7]);
 
     return VAN_PACKET_PARSE_OK;
 } // ParseWheelSpeedPkt
 
-VanPacketParseResult_t ParseOdometerPkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseOdometerPkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#8FC
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#8FC
@@ -3971,28 +3176,13 @@ VanPacketParseResult_t ParseOdometerPkt(TVanPacketRxDesc& pkt, char* buf, const
 
     float odometer = ((uint32_t)data[1] << 16 | (uint32_t)data[2] << 8 | data[3]) / 10.0;
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"odometer_2\": \"%s\"\n"
-        "}\n"
-    "}\n";
-
     char floatBuf[MAX_FLOAT_SIZE];
-
-    int at = snprintf_P(buf, n, jsonFormatter,
-        FloatToStr(floatBuf, odometer, 1)
-    );
-
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
+    json.Str(PSTR("odometer_2"), FloatToStr(floatBuf, odometer, 1));
 
     return VAN_PACKET_PARSE_OK;
 } // ParseOdometerPkt
 
-VanPacketParseResult_t ParseCom2000Pkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseCom2000Pkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#450
 
@@ -4000,94 +3190,46 @@ VanPacketParseResult_t ParseCom2000Pkt(TVanPacketRxDesc& pkt, char* buf, const i
 
     // TODO - replace event "display" by "button_press"; JavaScript on served website could react by changing to
     // different screen or displaying popup
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"com2000_light_switch_auto\": \"%s\",\n"
-            "\"com2000_light_switch_fog_light_forward\": \"%s\",\n"
-            "\"com2000_light_switch_fog_light_backward\": \"%s\",\n"
-            "\"com2000_light_switch_signal_beam\": \"%s\",\n"
-            "\"com2000_light_switch_full_beam\": \"%s\",\n"
-            "\"com2000_light_switch_all_off\": \"%s\",\n"
-            "\"com2000_light_switch_side_lights\": \"%s\",\n"
-            "\"com2000_light_switch_low_beam\": \"%s\",\n"
-            "\"com2000_right_stalk_button_trip_computer\": \"%s\",\n"
-            "\"com2000_right_stalk_rear_window_wash\": \"%s\",\n"
-            "\"com2000_right_stalk_rear_window_wiper\": \"%s\",\n"
-            "\"com2000_right_stalk_windscreen_wash\": \"%s\",\n"
-            "\"com2000_right_stalk_windscreen_wipe_once\": \"%s\",\n"
-            "\"com2000_right_stalk_windscreen_wipe_auto\": \"%s\",\n"
-            "\"com2000_right_stalk_windscreen_wipe_normal\": \"%s\",\n"
-            "\"com2000_right_stalk_windscreen_wipe_fast\": \"%s\",\n"
-            "\"com2000_turn_signal_left\": \"%s\",\n"
-            "\"com2000_turn_signal_right\": \"%s\",\n"
-            "\"com2000_head_unit_stalk_button_src\": \"%s\",\n"
-            "\"com2000_head_unit_stalk_button_volume_up\": \"%s\",\n"
-            "\"com2000_head_unit_stalk_button_volume_down\": \"%s\",\n"
-            "\"com2000_head_unit_stalk_button_seek_backward\": \"%s\",\n"
-            "\"com2000_head_unit_stalk_button_seek_forward\": \"%s\",\n"
-            "\"com2000_head_unit_stalk_wheel_pos\": \"%d\"\n"
-        "}\n"
-    "}\n";
-
-    int at = snprintf_P(buf, n, jsonFormatter,
-
-        data[1] & 0x01 ? onStr : offStr,
-        data[1] & 0x02 ? onStr : offStr,
-        data[1] & 0x04 ? onStr : offStr,
-        data[1] & 0x08 ? onStr : offStr,
-        data[1] & 0x10 ? onStr : offStr,
-        data[1] & 0x20 ? onStr : offStr,
-        data[1] & 0x40 ? onStr : offStr,
-        data[1] & 0x80 ? onStr : offStr,
-
-        data[2] & 0x01 ? onStr : offStr,
-        data[2] & 0x02 ? onStr : offStr,
-        data[2] & 0x04 ? onStr : offStr,
-        data[2] & 0x08 ? onStr : offStr,
-        data[2] & 0x10 ? onStr : offStr,
-        data[2] & 0x20 ? onStr : offStr,
-        data[2] & 0x40 ? onStr : offStr,
-        data[2] & 0x80 ? onStr : offStr,
-
-        data[3] & 0x40 ? onStr : offStr,
-        data[3] & 0x80 ? onStr : offStr,
-
-        data[5] & 0x02 ? onStr : offStr,
-        data[5] & 0x03 ? onStr : offStr,
-        data[5] & 0x08 ? onStr : offStr,
-        data[5] & 0x40 ? onStr : offStr,
-        data[5] & 0x80 ? onStr : offStr,
-
-        (int8_t)data[6]
-    );
-
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
+    json.Str(PSTR("com2000_light_switch_auto"), data[1] & 0x01 ? onStr : offStr);
+    json.Str(PSTR("com2000_light_switch_fog_light_forward"), data[1] & 0x02 ? onStr : offStr);
+    json.Str(PSTR("com2000_light_switch_fog_light_backward"), data[1] & 0x04 ? onStr : offStr);
+    json.Str(PSTR("com2000_light_switch_signal_beam"), data[1] & 0x08 ? onStr : offStr);
+    json.Str(PSTR("com2000_light_switch_full_beam"), data[1] & 0x10 ? onStr : offStr);
+    json.Str(PSTR("com2000_light_switch_all_off"), data[1] & 0x20 ? onStr : offStr);
+    json.Str(PSTR("com2000_light_switch_side_lights"), data[1] & 0x40 ? onStr : offStr);
+    json.Str(PSTR("com2000_light_switch_low_beam"), data[1] & 0x80 ? onStr : offStr);
+
+    json.Str(PSTR("com2000_right_stalk_button_trip_computer"), data[2] & 0x01 ? onStr : offStr);
+    json.Str(PSTR("com2000_right_stalk_rear_window_wash"), data[2] & 0x02 ? onStr : offStr);
+    json.Str(PSTR("com2000_right_stalk_rear_window_wiper"), data[2] & 0x04 ? onStr : offStr);
+    json.Str(PSTR("com2000_right_stalk_windscreen_wash"), data[2] & 0x08 ? onStr : offStr);
+    json.Str(PSTR("com2000_right_stalk_windscreen_wipe_once"), data[2] & 0x10 ? onStr : offStr);
+    json.Str(PSTR("com2000_right_stalk_windscreen_wipe_auto"), data[2] & 0x20 ? onStr : offStr);
+    json.Str(PSTR("com2000_right_stalk_windscreen_wipe_normal"), data[2] & 0x40 ? onStr : offStr);
+    json.Str(PSTR("com2000_right_stalk_windscreen_wipe_fast"), data[2] & 0x80 ? onStr : offStr);
+
+    json.Str(PSTR("com2000_turn_signal_left"), data[3] & 0x40 ? onStr : offStr);
+    json.Str(PSTR("com2000_turn_signal_right"), data[3] & 0x80 ? onStr : offStr);
+
+    json.Str(PSTR("com2000_head_unit_stalk_button_src"), data[5] & 0x02 ? onStr : offStr);
+    json.Str(PSTR("com2000_head_unit_stalk_button_volume_up"), data[5] & 0x03 ? onStr : offStr);
+    json.Str(PSTR("com2000_head_unit_stalk_button_volume_down"), data[5] & 0x08 ? onStr : offStr);
+    json.Str(PSTR("com2000_head_unit_stalk_button_seek_backward"), data[5] & 0x40 ? onStr : offStr);
+    json.Str(PSTR("com2000_head_unit_stalk_button_seek_forward"), data[5] & 0x80 ? onStr : offStr);
+
+    json.Printf(PSTR("com2000_head_unit_stalk_wheel_pos"), PSTR("%d"), (int8_t)data[6]);
 
     return VAN_PACKET_PARSE_OK;
 } // ParseCom2000Pkt
 
-VanPacketParseResult_t ParseCdChangerCmdPkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseCdChangerCmdPkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#8EC
 
     const uint8_t* data = pkt.Data();
     uint16_t cdcCommand = (uint16_t)data[0] << 8 | data[1];
 
-    const static char jsonFormatter[] PROGMEM =
-    "{\n"
-        "\"event\": \"display\",\n"
-        "\"data\":\n"
-        "{\n"
-            "\"cd_changer_command\": \"%s\"\n"
-        "}\n"
-    "}\n";
-
-    int at = snprintf_P(buf, n, jsonFormatter,
-
+    json.Str(PSTR("cd_changer_command"),
         cdcCommand == 0x1101 ? PSTR("POWER_OFF") :
         cdcCommand == 0x2101 ? PSTR("POWER_OFF") :
         cdcCommand == 0x1181 ? PSTR("PAUSE") :
@@ -4105,20 +3247,16 @@ VanPacketParseResult_t ParseCdChangerCmdPkt(TVanPacketRxDesc& pkt, char* buf, co
         ToHexStr(cdcCommand)
     );
 
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
-
     return VAN_PACKET_PARSE_OK;
 } // ParseCdChangerCmdPkt
 
-VanPacketParseResult_t ParseMfdToHeadUnitPkt(TVanPacketRxDesc& pkt, char* buf, const int n)
+VanPacketParseResult_t ParseMfdToHeadUnitPkt(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     // http://graham.auld.me.uk/projects/vanbus/packets.html#8D4
     // http://pinterpeti.hu/psavanbus/PSA-VAN.html#8D4
 
     int dataLen = pkt.DataLen();
     const uint8_t* data = pkt.Data();
-    int at = 0;
 
     // Maybe this is in fact "Head unit to MFD"??
 
@@ -4126,44 +3264,21 @@ VanPacketParseResult_t ParseMfdToHeadUnitPkt(TVanPacketRxDesc& pkt, char* buf, c
     {
         if (dataLen != 2) return VAN_PACKET_PARSE_UNEXPECTED_LENGTH;
 
-        const static char jsonFormatter[] PROGMEM =
-        "{\n"
-            "\"event\": \"display\",\n"
-            "\"data\":\n"
-            "{\n"
-                "\"head_unit_update_audio_bits_mute\": \"%s\",\n"
-                "\"head_unit_update_audio_bits_auto_volume\": \"%s\",\n"
-                "\"head_unit_update_audio_bits_loudness\": \"%s\",\n"
-                "\"head_unit_update_audio_bits_audio_menu\": \"%s\",\n"
-                "\"head_unit_update_audio_bits_power\": \"%s\",\n"
-                "\"head_unit_update_audio_bits_contact_key\": \"%s\"\n"
-            "}\n"
-        "}\n";
-
-        at = snprintf_P(buf, n, jsonFormatter,
-            data[1] & 0x01 ? onStr : offStr,
-            data[1] & 0x02 ? onStr : offStr,
-            data[1] & 0x10 ? onStr : offStr,
-
-            // Bug: if CD changer is playing, this one is always "OPEN"...
-            data[1] & 0x20 ? openStr : closedStr,
-
-            data[1] & 0x40 ? onStr : offStr,
-            data[1] & 0x80 ? onStr : offStr
-        );
+        json.Str(PSTR("head_unit_update_audio_bits_mute"), data[1] & 0x01 ? onStr : offStr);
+        json.Str(PSTR("head_unit_update_audio_bits_auto_volume"), data[1] & 0x02 ? onStr : offStr);
+        json.Str(PSTR("head_unit_update_audio_bits_loudness"), data[1] & 0x10 ? onStr : offStr);
+
+        // Bug: if CD changer is playing, this one is always "OPEN"...
+        json.Str(PSTR("head_unit_update_audio_bits_audio_menu"), data[1] & 0x20 ? openStr : closedStr);
+
+        json.Str(PSTR("head_unit_update_audio_bits_power"), data[1] & 0x40 ? onStr : offStr);
+        json.Str(PSTR("head_unit_update_audio_bits_contact_key"), data[1] & 0x80 ? onStr : offStr);
     }
     else if (data[0] == 0x12)
     {
         if (dataLen != 2 && dataLen != 11) return VAN_PACKET_PARSE_UNEXPECTED_LENGTH;
 
-        const static char jsonFormatter[] PROGMEM =
-        "{\n"
-            "\"event\": \"display\",\n"
-            "\"data\":\n"
-            "{\n"
-                "\"head_unit_update_switch_to\": \"%s\"";
-
-        at = snprintf_P(buf, n, jsonFormatter,
+        json.Str(PSTR("head_unit_update_switch_to"),
             data[1] == 0x01 ? PSTR("TUNER") :
             data[1] == 0x02 ? PSTR("INTERNAL_CD_OR_TAPE") :
             data[1] == 0x03 ? PSTR("CD_CHANGER") :
@@ -4178,19 +3293,9 @@ VanPacketParseResult_t ParseMfdToHeadUnitPkt(TVanPacketRxDesc& pkt, char* buf, c
 
         if (dataLen == 11)
         {
-            const static char jsonFormatter2[] PROGMEM = ",\n"
-                "\"head_unit_update_power\": \"%s\",\n"
-                "\"head_unit_update_source\": \"%s\",\n"
-                "\"head_unit_update_volume_1\": \"%u%s\",\n"
-                "\"head_unit_update_balance\": \"%d%s\",\n"
-                "\"head_unit_update_fader\": \"%d%s\",\n"
-                "\"head_unit_update_bass\": \"%d%s\",\n"
-                "\"head_unit_update_treble\": \"%d%s\"";
-
-            at += at >= n ? 0 : snprintf_P(buf + at, n - at, jsonFormatter2,
-
-                data[2] & 0x01 ? onStr : offStr,
+            json.Str(PSTR("head_unit_update_power"), data[2] & 0x01 ? onStr : offStr);
 
+            json.Str(PSTR("head_unit_update_source"),
                 (data[4] & 0x0F) == 0x00 ? noneStr :  // source
                 (data[4] & 0x0F) == 0x01 ? PSTR("TUNER") :
                 (data[4] & 0x0F) == 0x02 ? PSTR("INTERNAL_CD_OR_TAPE") :
@@ -4201,37 +3306,36 @@ VanPacketParseResult_t ParseMfdToHeadUnitPkt(TVanPacketRxDesc& pkt, char* buf, c
                 // whenever this source is chosen.
                 (data[4] & 0x0F) == 0x05 ? PSTR("NAVIGATION") :
 
-                ToHexStr((uint8_t)(data[4] & 0x0F)),
+                ToHexStr((uint8_t)(data[4] & 0x0F))
+            );
 
+            json.Printf(PSTR("head_unit_update_volume_1"), PSTR("%u%s"),
                 data[5] & 0x7F,
-                data[5] & 0x80 ? updatedStr : emptyStr,
+                data[5] & 0x80 ? updatedStr : emptyStr
+            );
+            json.Printf(PSTR("head_unit_update_balance"), PSTR("%d%s"),
                 (int8_t)(0x3F) - (data[6] & 0x7F),
-                data[6] & 0x80 ? updatedStr : emptyStr,
+                data[6] & 0x80 ? updatedStr : emptyStr
+            );
+            json.Printf(PSTR("head_unit_update_fader"), PSTR("%d%s"),
                 (int8_t)(0x3F) - (data[7] & 0x7F),
-                data[7] & 0x80 ? updatedStr : emptyStr,
+                data[7] & 0x80 ? updatedStr : emptyStr
+            );
+            json.Printf(PSTR("head_unit_update_bass"), PSTR("%d%s"),
                 (int8_t)(data[8] & 0x7F) - 0x3F,
-                data[8] & 0x80 ? updatedStr : emptyStr,
+                data[8] & 0x80 ? updatedStr : emptyStr
+            );
+            json.Printf(PSTR("head_unit_update_treble"), PSTR("%d%s"),
                 (int8_t)(data[9] & 0x7F) - 0x3F,
                 data[9] & 0x80 ? updatedStr : emptyStr
             );
         } // if
-
-        at += at >= n ? 0 : snprintf_P(buf + at, n - at, PSTR("\n}\n}\n"));
     }
     else if (data[0] == 0x13)
     {
         if (dataLen != 2) return VAN_PACKET_PARSE_UNEXPECTED_LENGTH;
 
-        const static char jsonFormatter[] PROGMEM =
-        "{\n"
-            "\"event\": \"display\",\n"
-            "\"data\":\n"
-            "{\n"
-                "\"head_unit_update_volume_2\": \"%u(%s%s)\"\n"
-            "}\n"
-        "}\n";
-
-        at = snprintf_P(buf, n, jsonFormatter,
+        json.Printf(PSTR("head_unit_update_volume_2"), PSTR("%u(%s%s)"),
             data[1] & 0x1F,
             data[1] & 0x40 ? PSTR("relative: ") : PSTR("absolute"),
             data[1] & 0x40 ?
@@ -4253,58 +3357,23 @@ VanPacketParseResult_t ParseMfdToHeadUnitPkt(TVanPacketRxDesc& pkt, char* buf, c
 
         // TODO - bit 7 of data[1] is always 1 ?
 
-        const static char jsonFormatter[] PROGMEM =
-        "{\n"
-            "\"event\": \"display\",\n"
-            "\"data\":\n"
-            "{\n"
-                "\"head_unit_update_audio_levels_balance\": \"%d\",\n"
-                "\"head_unit_update_audio_levels_fader\": \"%d\",\n"
-                "\"head_unit_update_audio_levels_bass\": \"%d\",\n"
-                "\"head_unit_update_audio_levels_treble\": \"%d\"\n"
-            "}\n"
-        "}\n";
-
-        at = snprintf_P(buf, n, jsonFormatter,
-            (int8_t)(0x3F) - (data[1] & 0x7F),
-            (int8_t)(0x3F) - data[2],
-            (int8_t)data[3] - 0x3F,
-            (int8_t)data[4] - 0x3F
-        );
+        json.Printf(PSTR("head_unit_update_audio_levels_balance"), PSTR("%d"), (int8_t)(0x3F) - (data[1] & 0x7F));
+        json.Printf(PSTR("head_unit_update_audio_levels_fader"), PSTR("%d"), (int8_t)(0x3F) - data[2]);
+        json.Printf(PSTR("head_unit_update_audio_levels_bass"), PSTR("%d"), (int8_t)data[3] - 0x3F);
+        json.Printf(PSTR("head_unit_update_audio_levels_treble"), PSTR("%d"), (int8_t)data[4] - 0x3F);
     }
     else if (data[0] == 0x27)
     {
         if (dataLen != 2) return VAN_PACKET_PARSE_UNEXPECTED_LENGTH;
 
-        const static char jsonFormatter[] PROGMEM =
-        "{\n"
-            "\"event\": \"display\",\n"
-            "\"data\":\n"
-            "{\n"
-                "\"head_unit_preset_request_band\": \"%s\",\n"
-                "\"head_unit_preset_request_memory\": \"%u\"\n"
-            "}\n"
-        "}\n";
-
-        at = snprintf_P(buf, n, jsonFormatter,
-            TunerBandStr(data[1] >> 4 & 0x07),
-            data[1] & 0x0F
-        );
+        json.Str(PSTR("head_unit_preset_request_band"), TunerBandStr(data[1] >> 4 & 0x07));
+        json.Printf(PSTR("head_unit_preset_request_memory"), PSTR("%u"), data[1] & 0x0F);
     }
     else if (data[0] == 0x61)
     {
         if (dataLen != 4) return VAN_PACKET_PARSE_UNEXPECTED_LENGTH;
 
-        const static char jsonFormatter[] PROGMEM =
-        "{\n"
-            "\"event\": \"display\",\n"
-            "\"data\":\n"
-            "{\n"
-                "\"head_unit_cd_request\": \"%s\"\n"
-            "}\n"
-        "}\n";
-
-        at = snprintf_P(buf, n, jsonFormatter,
+        json.Str(PSTR("head_unit_cd_request"),
             data[1] == 0x02 ? PSTR("PAUSE") :
             data[1] == 0x03 ? PSTR("PLAY") :
             data[3] == 0xFF ? PSTR("NEXT") :
@@ -4316,74 +3385,42 @@ VanPacketParseResult_t ParseMfdToHeadUnitPkt(TVanPacketRxDesc& pkt, char* buf, c
     {
         if (dataLen != 1) return VAN_PACKET_PARSE_UNEXPECTED_LENGTH;
 
-        const static char jsonFormatter[] PROGMEM =
-        "{\n"
-            "\"event\": \"display\",\n"
-            "\"data\":\n"
-            "{\n"
-                "\"head_unit_tuner_info_request\": \"REQUEST\"\n"
-            "}\n"
-        "}\n";
-
-        at = snprintf_P(buf, n, jsonFormatter);
+        json.Str(PSTR("head_unit_tuner_info_request"), PSTR("REQUEST"));
     }
     else if (data[0] == 0xD2)
     {
         if (dataLen != 1) return VAN_PACKET_PARSE_UNEXPECTED_LENGTH;
 
-        const static char jsonFormatter[] PROGMEM =
-        "{\n"
-            "\"event\": \"display\",\n"
-            "\"data\":\n"
-            "{\n"
-                "\"head_unit_tape_info_request\": \"REQUEST\"\n"
-            "}\n"
-        "}\n";
-
-        at = snprintf_P(buf, n, jsonFormatter);
+        json.Str(PSTR("head_unit_tape_info_request"), PSTR("REQUEST"));
     }
     else if (data[0] == 0xD6)
     {
         if (dataLen != 1) return VAN_PACKET_PARSE_UNEXPECTED_LENGTH;
 
-        const static char jsonFormatter[] PROGMEM =
-        "{\n"
-            "\"event\": \"display\",\n"
-            "\"data\":\n"
-            "{\n"
-                "\"head_unit_cd_track_info_request\": \"REQUEST\"\n"
-            "}\n"
-        "}\n";
-
-        at = snprintf_P(buf, n, jsonFormatter);
+        json.Str(PSTR("head_unit_cd_track_info_request"), PSTR("REQUEST"));
     }
     else
     {
         return VAN_PACKET_PARSE_TO_BE_DECODED;
     } // if
 
-    // JSON buffer overflow?
-    if (at >= n) return VAN_PACKET_PARSE_JSON_TOO_LONG;
-
     return VAN_PACKET_PARSE_OK;
 } // ParseMfdToHeadUnitPkt
 
 // Defined in LiveWebPage.ino
 extern uint16_t serialDumpFilter;
+#ifdef PRINT_JSON_BUFFERS_ON_SERIAL
+extern bool printJsonEvent;
+#endif // PRINT_JSON_BUFFERS_ON_SERIAL
+
+// Data of the previous packet, per IDEN
+static TVanDupCache dupCache;
 
 // Check if the new packet data differs from the previous.
 // Optionally, print the new packet on serial port, highlighting the bytes that differ.
 bool IsPacketDataDuplicate(TVanPacketRxDesc& pkt, IdenHandler_t* handler)
 {
-    uint16_t iden = pkt.Iden();
-    int dataLen = pkt.DataLen();
-    const uint8_t* data = pkt.Data();
-
-    // Relying on short-circuit boolean evaluation
-    bool isDuplicate =
-        handler->prevDataLen == dataLen  // handler->prevDataLen is initialized to -1
-        && handler->prevData != NULL
-        && memcmp(data, handler->prevData, dataLen) == 0;
+    bool isDuplicate = dupCache.IsDuplicate(pkt);
 
     if (handler->ignoreDups && isDuplicate) return true;  // Duplicate packet, to be ignored
 
@@ -4391,31 +3428,34 @@ bool IsPacketDataDuplicate(TVanPacketRxDesc& pkt, IdenHandler_t* handler)
     if (isDuplicate) return false;  // Duplicate packet, not to be ignored, but don't print
 
   #ifdef PRINT_RAW_PACKET_DATA
+    uint16_t iden = pkt.Iden();
+    int dataLen = pkt.DataLen();
+    const uint8_t* data = pkt.Data();
+
     // Not a duplicate packet: print the diff, and save the packet to compare with the next
-    if ((serialDumpFilter == 0 || iden == serialDumpFilter) && IsPacketSelected(iden, SELECTED_PACKETS))
+    if ((serialDumpFilter == 0 || iden == serialDumpFilter) && handler->selected)
     {
         Serial.printf_P(PSTR("---> Received: %s packet (IDEN %03X)\n"), handler->idenStr, iden);
 
-        // The first time, handler->prevData will be NULL, so only the "FULL: " line will be printed
-        //if (handler->prevData != NULL)
-
-        // The first time, or after an call to ResetPacketPrevData, handler->prevDataLen will be -1, so only
-        // the "FULL: " line will be printed
-        if (handler->prevData != NULL && handler->prevDataLen >= 0)
+        // The first time, or after a call to 'dupCache.Forget', there is no previous data, so only the "FULL: "
+        // line will be printed
+        int prevDataLen;
+        const uint8_t* prevData = dupCache.Data(iden, prevDataLen);
+        if (prevData != NULL)
         {
             // First line: print the new packet's data where it differs from the previous packet
             Serial.printf_P(PSTR("DIFF: %03X %1X (%s) "), iden, pkt.CommandFlags(), pkt.CommandFlagsStr());
             if (dataLen > 0)
             {
-                int n = handler->prevDataLen;
+                int n = prevDataLen;
                 for (int i = 0; i < n; i++)
                 {
                     char diffByte[] = "\u00b7\u00b7";  // \u00b7 is center dot character
 
                     // Relying on short-circuit boolean evaluation
-                    if (i >= dataLen || data[i] != handler->prevData[i])
+                    if (i >= dataLen || data[i] != prevData[i])
                     {
-                        snprintf_P(diffByte, sizeof(diffByte), PSTR("%02X"), handler->prevData[i]);
+                        snprintf_P(diffByte, sizeof(diffByte), PSTR("%02X"), prevData[i]);
                     } // if
                     Serial.printf_P(PSTR("%s%s"), diffByte, i < n - 1 ? dashStr : emptyStr);
                 } // for
@@ -4429,18 +3469,11 @@ bool IsPacketDataDuplicate(TVanPacketRxDesc& pkt, IdenHandler_t* handler)
     } // if
   #endif // PRINT_RAW_PACKET_DATA
 
-    if (handler->prevData == NULL) handler->prevData = (uint8_t*) malloc(VAN_MAX_DATA_BYTES);
-
-    if (handler->prevData != NULL)
-    {
-        // Save packet data to compare against at next packet reception
-        memset(handler->prevData, 0, VAN_MAX_DATA_BYTES);
-        memcpy(handler->prevData, data, dataLen);
-        handler->prevDataLen = dataLen;
-    } // if
+    // Save packet data to compare against at next packet reception
+    dupCache.Remember(pkt);
 
   #ifdef PRINT_RAW_PACKET_DATA
-    if ((serialDumpFilter == 0 || iden == serialDumpFilter) && IsPacketSelected(iden, SELECTED_PACKETS))
+    if ((serialDumpFilter == 0 || iden == serialDumpFilter) && handler->selected)
     {
         // Now print the new packet's data in full
         Serial.printf_P(PSTR("FULL: %03X %1X (%s) "), iden, pkt.CommandFlags(), pkt.CommandFlagsStr());
@@ -4470,45 +3503,62 @@ static IdenHandler_t handlers[] =
     // 3. Number of expected bytes (or -1 if varying/unknown),
     // 4. Ignore duplicates (boolean)
     // 5. handler function
-    // 6. prevDataLen: must be initialized to -1 to indicate "unknown"
-    { VIN_IDEN, "vin", 17, true, &ParseVinPkt, -1, nullptr },
-    { ENGINE_IDEN, "engine", 7, true, &ParseEnginePkt, -1, nullptr },
-    { HEAD_UNIT_STALK_IDEN, "head_unit_stalk", 2, true, &ParseHeadUnitStalkPkt, -1, nullptr },
-    { LIGHTS_STATUS_IDEN, "lights_status", -1, true, &ParseLightsStatusPkt, -1, nullptr },
-    { DEVICE_REPORT, "device_report", -1, true, &ParseDeviceReportPkt, -1, nullptr },
-    { CAR_STATUS1_IDEN, "car_status_1", 27, true, &ParseCarStatus1Pkt, -1, nullptr },
-    { CAR_STATUS2_IDEN, "car_status_2", -1, true, &ParseCarStatus2Pkt, -1, nullptr },
-    { DASHBOARD_IDEN, "dashboard", 7, true, &ParseDashboardPkt, -1, nullptr },
-    { DASHBOARD_BUTTONS_IDEN, "dashboard_buttons", -1, true, &ParseDashboardButtonsPkt, -1, nullptr },
-    { HEAD_UNIT_IDEN, "head_unit", -1, true, &ParseHeadUnitPkt, -1, nullptr },
-    { MFD_LANGUAGE_UNITS_IDEN, "time", 5, true, &ParseMfdLanguageUnitsPkt, -1, nullptr },
-    { AUDIO_SETTINGS_IDEN, "audio_settings", 11, true, &ParseAudioSettingsPkt, -1, nullptr },
-    { MFD_STATUS_IDEN, "mfd_status", 2, true, &ParseMfdStatusPkt, -1, nullptr },
-    { AIRCON1_IDEN, "aircon_1", 5, true, &ParseAirCon1Pkt, -1, nullptr },
-    { AIRCON2_IDEN, "aircon_2", 7, true, &ParseAirCon2Pkt, -1, nullptr },
-    { CDCHANGER_IDEN, "cd_changer", -1, true, &ParseCdChangerPkt, -1, nullptr },
-    { SATNAV_STATUS_1_IDEN, "satnav_status_1", 6, true, &ParseSatNavStatus1Pkt, -1, nullptr },
-    { SATNAV_STATUS_2_IDEN, "satnav_status_2", -1, false, &ParseSatNavStatus2Pkt, -1, nullptr },
-    { SATNAV_STATUS_3_IDEN, "satnav_status_3", -1, true, &ParseSatNavStatus3Pkt, -1, nullptr },
-    { SATNAV_GUIDANCE_DATA_IDEN, "satnav_guidance_data", 16, true, &ParseSatNavGuidanceDataPkt, -1, nullptr },
-    { SATNAV_GUIDANCE_IDEN, "satnav_guidance", -1, true, &ParseSatNavGuidancePkt, -1, nullptr },
-    { SATNAV_REPORT_IDEN, "satnav_report", -1, true, &ParseSatNavReportPkt, -1, nullptr },
-    { MFD_TO_SATNAV_IDEN, "mfd_to_satnav", -1, true, &ParseMfdToSatNavPkt, -1, nullptr },
-    { SATNAV_TO_MFD_IDEN, "satnav_to_mfd", 27, true, &ParseSatNavToMfdPkt, -1, nullptr },
-    { WHEEL_SPEED_IDEN, "wheel_speed", 5, true, &ParseWheelSpeedPkt, -1, nullptr },
-    { ODOMETER_IDEN, "odometer", 5, true, &ParseOdometerPkt, -1, nullptr },
-    { COM2000_IDEN, "com2000", 10, true, &ParseCom2000Pkt, -1, nullptr },
-    { CDCHANGER_COMMAND_IDEN, "cd_changer_command", 2, true, &ParseCdChangerCmdPkt, -1, nullptr },
-    { MFD_TO_HEAD_UNIT_IDEN, "display_to_head_unit", -1, true, &ParseMfdToHeadUnitPkt, -1, nullptr },
+    { VIN_IDEN, "vin", 17, true, &ParseVinPkt },
+    { ENGINE_IDEN, "engine", 7, true, &ParseEnginePkt },
+    { HEAD_UNIT_STALK_IDEN, "head_unit_stalk", 2, true, &ParseHeadUnitStalkPkt },
+    { LIGHTS_STATUS_IDEN, "lights_status", -1, true, &ParseLightsStatusPkt },
+    { DEVICE_REPORT, "device_report", -1, true, &ParseDeviceReportPkt },
+    { CAR_STATUS1_IDEN, "car_status_1", 27, true, &ParseCarStatus1Pkt },
+    { CAR_STATUS2_IDEN, "car_status_2", -1, true, &ParseCarStatus2Pkt },
+    { DASHBOARD_IDEN, "dashboard", 7, true, &ParseDashboardPkt },
+    { DASHBOARD_BUTTONS_IDEN, "dashboard_buttons", -1, true, &ParseDashboardButtonsPkt },
+    { HEAD_UNIT_IDEN, "head_unit", -1, true, &ParseHeadUnitPkt },
+    { MFD_LANGUAGE_UNITS_IDEN, "time", 5, true, &ParseMfdLanguageUnitsPkt },
+    { AUDIO_SETTINGS_IDEN, "audio_settings", 11, true, &ParseAudioSettingsPkt },
+    { MFD_STATUS_IDEN, "mfd_status", 2, true, &ParseMfdStatusPkt },
+    { AIRCON1_IDEN, "aircon_1", 5, true, &ParseAirCon1Pkt },
+    { AIRCON2_IDEN, "aircon_2", 7, true, &ParseAirCon2Pkt },
+    { CDCHANGER_IDEN, "cd_changer", -1, true, &ParseCdChangerPkt },
+    { SATNAV_STATUS_1_IDEN, "satnav_status_1", 6, true, &ParseSatNavStatus1Pkt },
+    { SATNAV_STATUS_2_IDEN, "satnav_status_2", -1, false, &ParseSatNavStatus2Pkt },
+    { SATNAV_STATUS_3_IDEN, "satnav_status_3", -1, true, &ParseSatNavStatus3Pkt },
+    { SATNAV_GUIDANCE_DATA_IDEN, "satnav_guidance_data", 16, true, &ParseSatNavGuidanceDataPkt },
+    { SATNAV_GUIDANCE_IDEN, "satnav_guidance", -1, true, &ParseSatNavGuidancePkt },
+    { SATNAV_REPORT_IDEN, "satnav_report", -1, true, &ParseSatNavReportPkt },
+    { MFD_TO_SATNAV_IDEN, "mfd_to_satnav", -1, true, &ParseMfdToSatNavPkt },
+    { SATNAV_TO_MFD_IDEN, "satnav_to_mfd", 27, true, &ParseSatNavToMfdPkt },
+    { WHEEL_SPEED_IDEN, "wheel_speed", 5, true, &ParseWheelSpeedPkt },
+    { ODOMETER_IDEN, "odometer", 5, true, &ParseOdometerPkt },
+    { COM2000_IDEN, "com2000", 10, true, &ParseCom2000Pkt },
+    { CDCHANGER_COMMAND_IDEN, "cd_changer_command", 2, true, &ParseCdChangerCmdPkt },
+    { MFD_TO_HEAD_UNIT_IDEN, "display_to_head_unit", -1, true, &ParseMfdToHeadUnitPkt },
   #if 0
-    { AIR_CONDITIONER_DIAG_IDEN, "aircon_diag", -1, true, &DefaultPacketParser, -1, nullptr },
-    { AIR_CONDITIONER_DIAG_COMMAND_IDEN, "aircon_diag_command", -1, true, &DefaultPacketParser, -1, nullptr },
+    { AIR_CONDITIONER_DIAG_IDEN, "aircon_diag", -1, true, &DefaultPacketParser },
+    { AIR_CONDITIONER_DIAG_COMMAND_IDEN, "aircon_diag_command", -1, true, &DefaultPacketParser },
   #endif
 }; // handlers
 
-const IdenHandler_t* const handlers_end = handlers + sizeof(handlers) / sizeof(handlers[0]);
+#define N_HANDLERS (sizeof(handlers) / sizeof(handlers[0]))
+
+// Index into 'handlers', by IDEN
+static TVanIdenMap handlerMap;
+
+// Fills 'handlerMap', so that finding the handler for a packet takes constant time. Also evaluates the packet
+// filter once for each handler, instead of for each packet.
+void SetupHandlerMap()
+{
+    for (unsigned int i = 0; i < N_HANDLERS; i++)
+    {
+        if (! handlerMap.Set(handlers[i].iden, i))
+        {
+            Serial.printf_P(PSTR("--> WARNING: cannot map handler for IDEN %03X!\n"), handlers[i].iden);
+        } // if
+
+        handlers[i].selected = IsPacketSelected(handlers[i].iden, SELECTED_PACKETS);
+    } // for
+} // SetupHandlerMap
 
-const char* ParseVanPacketToJson(TVanPacketRxDesc& pkt)
+void ParseVanPacketToJson(TVanPacketRxDesc& pkt, TJsonStream& json)
 {
     if (! pkt.CheckCrcAndRepair())
     {
@@ -4525,45 +3575,31 @@ const char* ParseVanPacketToJson(TVanPacketRxDesc& pkt)
       #endif // VAN_RX_ISR_DEBUGGING
   #endif // PRINT_VAN_CRC_ERROR_PACKETS_ON_SERIAL
 
-        return ""; // CRC error
+        return; // CRC error
     } // if
 
     int dataLen = pkt.DataLen();
-    if (dataLen < 0 || dataLen > VAN_MAX_DATA_BYTES) return ""; // Unexpected packet length
+    if (dataLen < 0 || dataLen > VAN_MAX_DATA_BYTES) return; // Unexpected packet length
+
+    if (handlerMap.Count() == 0) SetupHandlerMap();
 
     uint16_t iden = pkt.Iden();
-    IdenHandler_t* handler = handlers;
+    uint8_t handlerIdx = handlerMap.Get(iden);
 
-    // Search the correct handler. Relying on short-circuit boolean evaluation.
-    while (handler != handlers_end && handler->iden != iden) handler++;
+    // Handler found?
+    if (handlerIdx == VAN_IDEN_MAP_NONE) return; // Unrecognized IDEN value
 
-    // Hander found?
-    if (handler == handlers_end) return ""; // Unrecognized IDEN value
+    IdenHandler_t* handler = handlers + handlerIdx;
 
-    if (handler->dataLen >= 0 && dataLen != handler->dataLen) return ""; // Unexpected packet length
+    if (handler->dataLen >= 0 && dataLen != handler->dataLen) return; // Unexpected packet length
 
     // Check if packet content is the same as in previous packet and must therefore be ignored
-    if (IsPacketDataDuplicate(pkt, handler)) return "";
-
-    int result = handler->parser(pkt, jsonBuffer, JSON_BUFFER_SIZE);
-
-    if (result == VAN_PACKET_PARSE_JSON_TOO_LONG)
-    {
-        Serial.print(F("--> WARNING: JSON BUFFER OVERFLOW!\n"));
-
-        // No use to return the JSON buffer; it is invalid
-        return "";
-    } // if
-
-    if (result != VAN_PACKET_PARSE_OK) return ""; // Parsing result not OK
+    if (IsPacketDataDuplicate(pkt, handler)) return;
 
   #ifdef PRINT_JSON_BUFFERS_ON_SERIAL
-    if ((serialDumpFilter == 0 || iden == serialDumpFilter) && IsPacketSelected(iden, SELECTED_PACKETS))
-    {
-        Serial.print(F("Parsed to JSON object:\n"));
-        PrintJsonText(jsonBuffer);
-    } // if
+    printJsonEvent = (serialDumpFilter == 0 || iden == serialDumpFilter) && handler->selected;
   #endif // PRINT_JSON_BUFFERS_ON_SERIAL
 
-    return jsonBuffer;
+    // Parsing result not OK? Then leave out the members it added so far.
+    if (handler->parser(pkt, json) != VAN_PACKET_PARSE_OK) json.CancelEvent();
 } // ParseVanPacketToJson
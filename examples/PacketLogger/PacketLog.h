@@ -0,0 +1,304 @@
+#ifndef PacketLog_h
+#define PacketLog_h
+
+// Ring-buffered writer of binary VAN packet records (see 'TVanPacketRxDesc::ToBinary') into a file on flash.
+//
+// While the flash chip is being written, no code can be run from flash, and interrupts may be served late. When
+// that happens in the middle of a packet, the packet is lost (see the comment on 'TVanPacketRxQueue::Disable').
+// So this writer never writes to flash when called, but first collects the records in a RAM ring of blocks.
+// 'Flush' then writes at most one block, or does one file system commit, and only if the bus has been idle long
+// enough. Blocks are VAN_LOG_BLOCK_SIZE bytes, a multiple of the flash page size, so each block write is a whole
+// number of page writes.
+//
+// Not all flash operations are short:
+// - A block write that only programs pages takes up to a few milliseconds ("max write" in 'DumpStats').
+// - A block write that starts a new erase unit of the file system (every VAN_LOG_ERASE_SIZE bytes) must first erase
+//   a sector. A commit ('file.flush()') updates the file system metadata, which can also erase and copy a sector.
+//   These take tens of milliseconds ("max erase write" and "max commit" in 'DumpStats'), i.e. the time of several
+//   packets.
+// So 'Flush' waits for VAN_LOG_MIN_IDLE_MICROS of bus idle time before a short write, and for the much longer
+// VAN_LOG_MIN_IDLE_MICROS_LONG before an erase write or a commit. If the RAM ring is about to fill up, it stops
+// waiting for the long gap, and uses the short one.
+//
+// Note: an idle bus at the start of a flash operation says nothing for sure about the rest of it. VAN traffic comes
+// in bursts, with longer gaps in between; waiting for a gap that is already longer than the operation makes it
+// likely, but not certain, that the operation ends before the next packet starts. 'Flush' counts the operations
+// during which the bus became active ("overlapped" in 'DumpStats'); compare these with the CRC error and drop counts
+// of 'VanBusRx.DumpStats', with logging on and off.
+//
+// Block layout:
+// - 2 bytes: 'V', 'L'
+// - 2 bytes: number of bytes used in the block, including this header (little endian)
+// - 2 bytes: number of slots in the receive queue (little endian)
+// - Records. The first record of each block does not depend on any previous record, so each block can be decoded
+//   on its own.
+// - Padding with 0xFF
+//
+// See ../../extras/VanLogToText for converting a log file back into 'DumpRaw' text.
+
+#include <FS.h>
+#include <VanBusRx.h>
+
+// Size of a block written to flash; must be a multiple of the flash page size (256 bytes)
+#define VAN_LOG_BLOCK_SIZE 512
+
+// Number of blocks in the RAM ring
+#define VAN_LOG_N_BLOCKS 16
+
+#define VAN_LOG_HEADER_SIZE 6
+
+// Size of the erase unit of the file system (LittleFS and SPIFFS both use 4 kByte flash sectors). A block write
+// that starts at a multiple of this file position is taken to need a sector erase. This is an estimate: the file
+// system also stores its own data in sectors, so the actual erases are not exactly aligned with the file position.
+#define VAN_LOG_ERASE_SIZE 4096
+
+// Minimum time since the last bus level change, before writing a block without erasing. Must be longer than the
+// worst-case page write of one block: with 512 byte blocks, writes of up to 1820 microseconds were seen (see
+// "max write" in 'DumpStats').
+#ifndef VAN_LOG_MIN_IDLE_MICROS
+  #define VAN_LOG_MIN_IDLE_MICROS 3000
+#endif // VAN_LOG_MIN_IDLE_MICROS
+
+// Minimum time since the last bus level change, before a block write that erases, or a file system commit. Must be
+// longer than "max erase write" and "max commit" in 'DumpStats', which are typically tens of milliseconds.
+// Increase VAN_LOG_N_BLOCKS if the RAM ring fills up ("dropped") because the bus is never idle this long.
+#ifndef VAN_LOG_MIN_IDLE_MICROS_LONG
+  #define VAN_LOG_MIN_IDLE_MICROS_LONG 50000
+#endif // VAN_LOG_MIN_IDLE_MICROS_LONG
+
+// Number of blocks written between two file system commits; less means: less data lost at power down, but more
+// time spent in flash writes
+#define VAN_LOG_SYNC_EVERY_N_BLOCKS 16
+
+class TVanLogWriter
+{
+  public:
+
+    TVanLogWriter()
+        : fill(0)
+        , nFull(0)
+        , syncPending(false)
+        , nRecords(0)
+        , nDropped(0)
+        , nBlocksWritten(0)
+        , nWriteErrors(0)
+        , maxWriteMicros(0)
+        , maxEraseWriteMicros(0)
+        , maxCommitMicros(0)
+        , nOverlapped(0)
+    {
+        StartBlock();
+    } // TVanLogWriter
+
+    // Appends all records to 'file', which must be open for writing
+    void Begin(fs::File f) { file = f; }
+
+    // Adds a record of the packet to the RAM ring. Never writes to flash. Returns false if the RAM ring is full, in
+    // which case the packet is dropped. The sequence numbers of the records after it show that the packet is missing.
+    bool Add(const TVanPacketRxDesc& pkt);
+
+    // Writes at most one completed block to flash, but only if the bus is idle. To be called often, e.g. each time
+    // from loop(). Returns true if anything was written.
+    bool Flush();
+
+    // Writes all blocks, including the one being filled, regardless of bus activity. Call e.g. before closing the
+    // file.
+    void FlushAll();
+
+    // Writes all blocks, then closes the file
+    void End()
+    {
+        FlushAll();
+        file.close();
+    } // End
+
+    uint32_t GetRecordCount() const { return nRecords; }
+    uint32_t GetDropCount() const { return nDropped; }
+    uint32_t GetBlocksWritten() const { return nBlocksWritten; }
+    uint32_t GetMaxWriteMicros() const { return maxWriteMicros; }
+    uint32_t GetMaxEraseWriteMicros() const { return maxEraseWriteMicros; }
+    uint32_t GetMaxCommitMicros() const { return maxCommitMicros; }
+    uint32_t GetOverlapCount() const { return nOverlapped; }
+
+    void DumpStats(Stream& s) const;
+
+  private:
+
+    static bool IsBusIdle(uint32_t minIdleMicros)
+    {
+        const uint32_t idleCycles = ESP.getCycleCount() - VanBusRx.GetLastMediaAccessAt();  // Arithmetic has safe roll-over
+        return idleCycles >= minIdleMicros * (F_CPU / 1000000);
+    } // IsBusIdle
+
+    // Returns true if writing the next block will probably have to erase a flash sector first
+    bool NextWriteErases() { return file.position() % VAN_LOG_ERASE_SIZE == 0; }
+
+    void StartBlock()
+    {
+        used = VAN_LOG_HEADER_SIZE;
+        prevMicros = 0;
+        prevSeqNo = 0;
+    } // StartBlock
+
+    void CloseBlock();
+    void WriteBlock();
+    void Commit();
+
+    uint8_t blocks[VAN_LOG_N_BLOCKS][VAN_LOG_BLOCK_SIZE];
+    int fill;  // Index of the block being filled
+    int nFull;  // Number of completed blocks, not yet written; these are just before 'fill' in the ring
+    int used;  // Number of bytes used in the block being filled
+
+    // Of the previous record in the block being filled
+    uint32_t prevMicros;
+    uint32_t prevSeqNo;
+
+    fs::File file;
+    bool syncPending;
+
+    uint32_t nRecords;
+    uint32_t nDropped;
+    uint32_t nBlocksWritten;
+    uint32_t nWriteErrors;
+    uint32_t maxWriteMicros;  // Longest block write that did not erase
+    uint32_t maxEraseWriteMicros;  // Longest block write that probably erased a sector
+    uint32_t maxCommitMicros;  // Longest file system commit
+    uint32_t nOverlapped;  // Number of flash operations by 'Flush' during which the bus became active
+}; // class TVanLogWriter
+
+bool TVanLogWriter::Add(const TVanPacketRxDesc& pkt)
+{
+    uint8_t record[VAN_MAX_BINARY_SIZE];
+    uint32_t sofMicros = prevMicros;
+    uint32_t seqNo = prevSeqNo;
+    int n = pkt.ToBinary(record, sofMicros, seqNo);
+
+    if (used + n > VAN_LOG_BLOCK_SIZE)
+    {
+        // One block must remain free: the one being filled
+        if (nFull >= VAN_LOG_N_BLOCKS - 1)
+        {
+            nDropped++;
+            return false;
+        } // if
+
+        CloseBlock();
+
+        // First record in a block does not depend on any previous record
+        sofMicros = 0;
+        seqNo = 0;
+        n = pkt.ToBinary(record, sofMicros, seqNo);
+    } // if
+
+    memcpy(blocks[fill] + used, record, n);
+    used += n;
+    prevMicros = sofMicros;
+    prevSeqNo = seqNo;
+    nRecords++;
+
+    return true;
+} // TVanLogWriter::Add
+
+void TVanLogWriter::CloseBlock()
+{
+    uint8_t* block = blocks[fill];
+    const int queueSize = VanBusRx.QueueSize();
+
+    block[0] = 'V';
+    block[1] = 'L';
+    block[2] = used & 0xFF;
+    block[3] = used >> 8;
+    block[4] = queueSize & 0xFF;
+    block[5] = queueSize >> 8;
+    memset(block + used, 0xFF, VAN_LOG_BLOCK_SIZE - used);
+
+    nFull++;
+    fill = (fill + 1) % VAN_LOG_N_BLOCKS;
+    StartBlock();
+} // TVanLogWriter::CloseBlock
+
+// Writes the oldest completed block
+void TVanLogWriter::WriteBlock()
+{
+    const int oldest = (fill - nFull + VAN_LOG_N_BLOCKS) % VAN_LOG_N_BLOCKS;
+    const bool erases = NextWriteErases();
+
+    const unsigned long start = micros();
+    if (file.write(blocks[oldest], VAN_LOG_BLOCK_SIZE) != VAN_LOG_BLOCK_SIZE) nWriteErrors++;
+    const unsigned long duration = micros() - start;  // Arithmetic has safe roll-over
+    uint32_t& maxMicros = erases ? maxEraseWriteMicros : maxWriteMicros;
+    if (duration > maxMicros) maxMicros = duration;
+
+    // On error, the block is lost as well: retrying would fill up the RAM ring, e.g. when the file system is full
+    nFull--;
+    nBlocksWritten++;
+    if (nBlocksWritten % VAN_LOG_SYNC_EVERY_N_BLOCKS == 0) syncPending = true;
+} // TVanLogWriter::WriteBlock
+
+void TVanLogWriter::Commit()
+{
+    const unsigned long start = micros();
+    file.flush();
+    const unsigned long duration = micros() - start;  // Arithmetic has safe roll-over
+    if (duration > maxCommitMicros) maxCommitMicros = duration;
+
+    syncPending = false;
+} // TVanLogWriter::Commit
+
+bool TVanLogWriter::Flush()
+{
+    if (! file || (nFull == 0 && ! syncPending)) return false;
+
+    // Erasing and committing take much longer than programming pages, so wait for a much longer gap before those.
+    // But not when the RAM ring is about to fill up: then losing a packet is better than losing many records.
+    const bool longOperation = syncPending || NextWriteErases();
+    const bool ringAlmostFull = nFull >= VAN_LOG_N_BLOCKS - 2;
+    const uint32_t minIdleMicros =
+        longOperation && ! ringAlmostFull ? VAN_LOG_MIN_IDLE_MICROS_LONG : VAN_LOG_MIN_IDLE_MICROS;
+    if (! IsBusIdle(minIdleMicros)) return false;
+
+    const uint32_t lastMediaAccessAt = VanBusRx.GetLastMediaAccessAt();
+
+    // Commit to the file system separately from writing a block, to keep each flash operation short
+    if (syncPending)
+    {
+        Commit();
+    }
+    else
+    {
+        WriteBlock();
+    } // if
+
+    // A packet that started during the flash operation may have been lost
+    if (VanBusRx.GetLastMediaAccessAt() != lastMediaAccessAt) nOverlapped++;
+
+    return true;
+} // TVanLogWriter::Flush
+
+void TVanLogWriter::FlushAll()
+{
+    if (! file) return;
+
+    if (used > VAN_LOG_HEADER_SIZE) CloseBlock();
+    while (nFull > 0) WriteBlock();
+    Commit();
+} // TVanLogWriter::FlushAll
+
+void TVanLogWriter::DumpStats(Stream& s) const
+{
+    s.printf_P(
+        PSTR("Log: records: %" PRIu32 ", dropped: %" PRIu32 ", blocks written: %" PRIu32 ", write errors: %" PRIu32
+            ", pending: %d, max write: %" PRIu32 " usec, max erase write: %" PRIu32 " usec, max commit: %" PRIu32
+            " usec, overlapped: %" PRIu32 "\n"),
+        nRecords,
+        nDropped,
+        nBlocksWritten,
+        nWriteErrors,
+        nFull,
+        maxWriteMicros,
+        maxEraseWriteMicros,
+        maxCommitMicros,
+        nOverlapped);
+} // TVanLogWriter::DumpStats
+
+#endif // PacketLog_h
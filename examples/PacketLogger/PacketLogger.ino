@@ -0,0 +1,188 @@
+/*
+ * VanBus: PacketLogger - log all packets, received on a VAN bus, in compact binary format into a file on flash.
+ *
+ * Written by Erik Tromp
+ *
+ * Version 0.4.2 - October, 2026
+ *
+ * MIT license, all text above must be included in any redistribution.
+ *
+ * -----
+ * Description
+ *
+ * Each received packet is stored as a binary record (see 'TVanPacketRxDesc::ToBinary'), typically 8 bytes plus the
+ * number of data bytes. So a 1 MByte file system holds hours of bus traffic.
+ *
+ * The receiver stays enabled all the time: the records are collected in RAM, and only written to flash, block by
+ * block, when the bus is idle (see PacketLog.h). A block write that only programs pages takes a few milliseconds,
+ * and waits for a gap of VAN_LOG_MIN_IDLE_MICROS. Every 4 kBytes, a block write must first erase a flash sector, and
+ * every VAN_LOG_SYNC_EVERY_N_BLOCKS blocks the file system commits its metadata. These take tens of milliseconds,
+ * and wait for a gap of VAN_LOG_MIN_IDLE_MICROS_LONG. If the bus has no such gaps, packets arriving during an erase
+ * or commit may still be lost.
+ *
+ * The log is appended to the file LOG_FILE_NAME, on LittleFS (ESP8266) or SPIFFS (ESP32). To retrieve it, read the
+ * flash partition with 'esptool.py read_flash', and unpack it with 'mklittlefs -u' or 'mkspiffs -u'. Then convert
+ * the log into 'DumpRaw' text with the program in ../../extras/VanLogToText .
+ *
+ * Wiring: see the VanBusDump example.
+ *
+ * -----
+ * Serial commands
+ *
+ * - 'c': write all pending records to flash, close the log file and stop logging (e.g. before removing power)
+ * - 'o': open the log file again and continue logging
+ * - 'e': erase the log file
+ *
+ * -----
+ * Output
+ *
+ * Every 10 seconds, the receiver statistics and a line like this:
+ *
+ *   Log: records: 3516, dropped: 0, blocks written: 71, write errors: 0, pending: 0, max write: 1820 usec,
+ *     max erase write: <n> usec, max commit: <n> usec, overlapped: 0
+ *
+ * (printed on a single line). The "max" values are the worst-case durations of a flash operation seen so far.
+ *
+ * "overlapped" counts the flash writes during which a packet started; such a packet may be lost, showing up as a CRC
+ * error or a missed sequence number. To see what the logging costs, compare the receiver statistics with logging on
+ * and off (serial commands 'o' and 'c').
+ */
+
+#ifdef ARDUINO_ARCH_ESP32
+  #include <WiFi.h>
+  #include <SPIFFS.h>
+  #define LOG_FS SPIFFS
+#else
+  #include <ESP8266WiFi.h>
+  #include <LittleFS.h>
+  #define LOG_FS LittleFS
+#endif // ARDUINO_ARCH_ESP32
+
+#include <VanBusRx.h>  // https://github.com/0xCAFEDECAF/VanBus
+#include "PacketLog.h"
+
+// GPIO pin connected to VAN bus transceiver output
+#ifdef ARDUINO_ARCH_ESP32
+  const int RX_PIN = GPIO_NUM_22;
+#else // ! ARDUINO_ARCH_ESP32
+
+  #if defined ARDUINO_ESP8266_GENERIC || defined ARDUINO_ESP8266_ESP01
+    // For ESP-01 board we use GPIO 2 (internal pull-up, keep disconnected or high at boot time)
+    #define D2 (2)
+  #endif // defined ARDUINO_ESP8266_GENERIC || defined ARDUINO_ESP8266_ESP01
+
+  // For WEMOS D1 mini board we use D2 (GPIO 4)
+  const int RX_PIN = D2;
+#endif // ARDUINO_ARCH_ESP32
+
+#define LOG_FILE_NAME "/vanbus.log"
+
+TVanLogWriter logWriter;
+bool logging = false;
+
+void OpenLog()
+{
+    fs::File file = LOG_FS.open(LOG_FILE_NAME, "a");
+    if (! file)
+    {
+        Serial.printf_P(PSTR("Cannot open '%s'\n"), LOG_FILE_NAME);
+        return;
+    } // if
+
+    Serial.printf_P(PSTR("Logging to '%s' (%u bytes)\n"), LOG_FILE_NAME, (unsigned int)file.size());
+    logWriter.Begin(file);
+    logging = true;
+} // OpenLog
+
+void CloseLog()
+{
+    if (! logging) return;
+
+    logWriter.End();
+    logging = false;
+    Serial.printf_P(PSTR("Log file '%s' is closed\n"), LOG_FILE_NAME);
+} // CloseLog
+
+void setup()
+{
+    delay(1000);
+    Serial.begin(115200);
+    Serial.print("Starting VAN bus packet logger\n");
+
+    // Disable Wi-Fi altogether to get rid of long and variable interrupt latency, causing packet CRC errors
+    // From: https://esp8266hints.wordpress.com/2017/06/29/save-power-by-reliably-switching-the-esp-wifi-on-and-off/
+    WiFi.disconnect(true);
+    delay(1);
+    WiFi.mode(WIFI_OFF);
+    delay(1);
+  #ifdef ARDUINO_ARCH_ESP8266
+    WiFi.forceSleepBegin();
+    delay(1);
+  #endif // ARDUINO_ARCH_ESP8266
+
+  #ifdef ARDUINO_ARCH_ESP32
+    if (! LOG_FS.begin(true))  // Format if mount fails
+  #else // ! ARDUINO_ARCH_ESP32
+    if (! LOG_FS.begin())
+  #endif // ARDUINO_ARCH_ESP32
+    {
+        Serial.print("Cannot mount file system\n");
+    }
+    else
+    {
+        OpenLog();
+    } // if
+
+    VanBusRx.Setup(RX_PIN);
+    Serial.printf_P(PSTR("VanBusRx queue of size %d is set up\n"), VanBusRx.QueueSize());
+} // setup
+
+void loop()
+{
+    TVanPacketRxDesc pkt;
+    if (VanBusRx.Receive(pkt))
+    {
+        pkt.CheckCrcAndRepair();
+        if (logging) logWriter.Add(pkt);
+    } // if
+
+    // Write to flash, but only when the bus is idle
+    if (logging) logWriter.Flush();
+
+    if (Serial.available() > 0)
+    {
+        switch (Serial.read())
+        {
+            case 'c':
+            {
+                CloseLog();
+            }
+            break;
+
+            case 'o':
+            {
+                if (! logging) OpenLog();
+            }
+            break;
+
+            case 'e':
+            {
+                const bool wasLogging = logging;
+                CloseLog();
+                LOG_FS.remove(LOG_FILE_NAME);
+                Serial.printf_P(PSTR("Log file '%s' is erased\n"), LOG_FILE_NAME);
+                if (wasLogging) OpenLog();
+            }
+            break;
+        } // switch
+    } // if
+
+    // Print some boring statistics
+    static unsigned long lastUpdate = 0;
+    if (millis() - lastUpdate >= 10000UL) // Arithmetic has safe roll-over
+    {
+        lastUpdate = millis();
+        VanBusRx.DumpStats(Serial);
+        logWriter.DumpStats(Serial);
+    } // if
+} // loop
@@ -0,0 +1,433 @@
+/*
+ * VanBus: ReplayTrace - benchmark and regression test of the packet decoder, by replaying bus level changes.
+ *
+ * Written by Erik Tromp
+ *
+ * Version 0.4.2 - October, 2026
+ *
+ * MIT license, all text above must be included in any redistribution.
+ *
+ * -----
+ * Description
+ *
+ * The receiver converts the time between two bus level changes into a number of bits. The timing values it uses
+ * were found by trial and error, on real vehicles. This sketch feeds bus level changes into the very same packet
+ * decoder, using 'VanBusRx.ReplayEdge', so that any change in the timing logic can be validated against many
+ * packets within seconds. No VAN bus needs to be connected.
+ *
+ * Note: this sketch runs on the ESP8266 or ESP32 board. To replay packets through the same decoder on a PC, see the
+ * DecoderReplay program in ../../extras/DecoderReplay.
+ *
+ * There are two sources of bus level changes:
+ *
+ * 1. Packets in "Raw:" format, as printed by 'TVanPacketRxDesc::DumpRaw' (see e.g. the VanBusDump example, or the
+ *    file ../PacketParser/example_log.txt). Each packet is encoded into its ideal bit timing, at a few different bit
+ *    rates, which is then disturbed by a simulated interrupt latency of increasing magnitude.
+ *    A few packets are built into this sketch; they are replayed at startup. More can be pasted into the serial
+ *    monitor, one line per packet.
+ *
+ * 2. Bit timing dumps, as printed by 'TIsrDebugPacket::Dump' (compile option VAN_RX_ISR_DEBUGGING, see e.g. the
+ *    VanBusDump example), pasted into the serial monitor. These are replayed exactly as recorded, after which the
+ *    decoded packet is printed.
+ *
+ * Lines copied from the Arduino IDE Serial Monitor may keep their time stamp ("14:00:21.703 -> ").
+ *
+ * -----
+ * Output
+ *
+ * For each simulated bit time (in CPU cycles at 80 MHz) and interrupt latency, a line like this:
+ *
+ *   bit time 667, latency 0.50 usec: frames: 1000, OK: 1000, repaired: 0, failed: 0, wrong: 0, decode: 2.93 usec/edge
+ *
+ * Legend:
+ * - "OK": decoded with correct CRC
+ * - "repaired": decoded with CRC error, but repaired by 'CheckCrcAndRepair'
+ * - "failed": not decoded, or with an unrepairable CRC error
+ * - "wrong": decoded with correct CRC or repaired, but different from the original packet
+ * - "decode": average CPU time spent in 'VanBusRx.ReplayEdge' per bus level change
+ */
+
+#include <VanBusRx.h>  // https://github.com/0xCAFEDECAF/VanBus
+
+// GPIO pin connected to VAN bus transceiver output. Does not need to be connected: the receiver is disabled while
+// replaying.
+#ifdef ARDUINO_ARCH_ESP32
+  const int RX_PIN = GPIO_NUM_22;
+#else // ! ARDUINO_ARCH_ESP32
+
+  #if defined ARDUINO_ESP8266_GENERIC || defined ARDUINO_ESP8266_ESP01
+    // For ESP-01 board we use GPIO 2 (internal pull-up, keep disconnected or high at boot time)
+    #define D2 (2)
+  #endif // defined ARDUINO_ESP8266_GENERIC || defined ARDUINO_ESP8266_ESP01
+
+  // For WEMOS D1 mini board we use D2 (GPIO 4)
+  const int RX_PIN = D2;
+#endif // ARDUINO_ARCH_ESP32
+
+// Simulated VAN bus bit times, in CPU cycles at 80 MHz. Nominal is 125 kbit/sec, i.e. 640 cycles at 80 MHz, but on
+// real vehicles the bit time is measured at approximately 667 cycles at 80 MHz. The fixed decoder timing values are
+// tuned to the latter; with VAN_RX_ADAPTIVE_BIT_TIMING (see VanBusRx.h), the decoder measures the bit time itself.
+const uint32_t bitTimes[] = { 667, 640, 700 };
+#define N_BIT_TIMES (sizeof(bitTimes) / sizeof(bitTimes[0]))
+
+// Number of idle bits following the EOF, before the next packet starts
+#define IFS_BITS 5
+
+// Simulated interrupt latencies, in CPU cycles at 80 MHz
+const uint32_t latencies[] = { 0, 40, 80, 120, 160, 200, 240, 320 };
+#define N_LATENCIES (sizeof(latencies) / sizeof(latencies[0]))
+
+// Number of times the built-in packets are replayed, for each simulated bit time and interrupt latency
+#define N_ROUNDS 100
+
+// Built-in packets, copied from ../PacketParser/example_log.txt and from the VanBusDump example
+#define MAX_LINE_SIZE 200
+static const char PROGMEM builtInPackets[][MAX_LINE_SIZE] =
+{
+    "Raw: #9487 ( 8/15)  5(10) 0E 984 8 (W-0) 00-00-00-06-08:D0-C8 NO_ACK OK D0C8 CRC_OK",
+    "Raw: #9522 (13/15)  3( 8) 0E 8C4 C (WA0) 8A-21-40:3D-54 ACK OK 3D54 CRC_OK",
+    "Raw: #9523 (14/15) 11(16) 0E 4D4 E (RA0) 80-0C-01-00-31-80-3F-3F-3F-3F-80:E3-1E ACK OK E31E CRC_OK",
+    "Raw: #9570 ( 1/15) 22(27) 0E 554 E (RA0) 83-D1-A9-80-00-04-0D-63-83-C6-A1-0A-53-4B-59-52-41-44-49-4F-00-83:81-4E ACK OK 814E CRC_OK",
+    "Raw: #9572 ( 3/15)  2( 7) 0E 8D4 C (WA0) 27-11:37-78 ACK OK 3778 CRC_OK",
+    "Raw: #9574 ( 5/15) 12(17) 0E 554 E (RA0) 85-D3-11-20-38-37-2E-35-30-00-20-85:80-44 ACK OK 8044 CRC_OK",
+    "Raw: #9598 (14/15)  1( 6) 0E 8D4 C (WA0) D1:7D-0E ACK OK 7D0E CRC_OK",
+    "Raw: #9569 (15/15)  3( 8) 0E 8C4 C (WA0) 8A-24-40:9B-32 ACK OK 9B32 CRC_OK",
+    "Raw: #0000 ( 0/15)  0( 5) 0E 7CE RA1 21-14 NO_ACK OK 2114 CRC_OK",
+    "Raw: #0003 ( 3/15)  2( 7) 0E 5E4 WA0 00-FF:1F-F8 NO_ACK OK 1FF8 CRC_OK",
+};
+#define N_BUILT_IN_PACKETS (sizeof(builtInPackets) / sizeof(builtInPackets[0]))
+
+// A packet as parsed from a "Raw:" line
+struct TPacket
+{
+    uint8_t bytes[VAN_MAX_PACKET_SIZE];  // Including SOF and CRC
+    int size;
+    bool ack;
+};
+
+// Replay results
+struct TResults
+{
+    uint32_t nFrames;
+    uint32_t nOk;
+    uint32_t nRepaired;
+    uint32_t nFailed;
+    uint32_t nWrong;
+    uint32_t nEdges;
+    uint64_t decodeCycles;
+};
+
+// Time base of the replayed bus level changes
+uint32_t replayAt = 0;
+
+// Bit time of the replayed packets, in CPU cycles
+uint32_t bitTimeCycles = CPU_CYCLES(667);
+
+// Skips the time stamp, as added by the Arduino IDE Serial Monitor, e.g. "14:00:21.703 -> "
+const char* SkipTimeStamp(const char* line)
+{
+    if (strlen(line) < 16 || line[2] != ':' || line[5] != ':') return line;
+    const char* p = strstr(line, "-> ");
+    return p == NULL ? line : p + 3;
+} // SkipTimeStamp
+
+// Parses a line as printed by 'TVanPacketRxDesc::DumpRaw'. Returns false if the line is not in that format.
+bool ParseRawLine(const char* line, TPacket& pkt)
+{
+    const char* p = strstr(line, "Raw:");
+    if (p == NULL) return false;
+
+    // Start of the packet: the SOF byte
+    p = strstr(p, " 0E ");
+    if (p == NULL) return false;
+    p += 4;
+
+    unsigned int iden;
+    int n;
+    if (sscanf(p, "%3x%n", &iden, &n) != 1) return false;
+    p += n;
+
+    // Command flags: either a hex digit followed by e.g. "(RA0)", or only e.g. "RA0"
+    unsigned int flags;
+    while (*p == ' ') p++;
+    if (isxdigit(p[0]) && p[1] == ' ')
+    {
+        flags = strtoul(p, NULL, 16);
+        p = strchr(p, ')');
+        if (p == NULL) return false;
+        p++;
+    }
+    else
+    {
+        if (strlen(p) < 3) return false;
+        flags = 0x08 | (p[0] == 'R' ? 0x02 : 0) | (p[1] == 'A' ? 0x04 : 0) | (p[2] == '1' ? 0x01 : 0);
+        p += 3;
+    } // if
+
+    pkt.bytes[0] = 0x0E;
+    pkt.bytes[1] = iden >> 4;
+    pkt.bytes[2] = (iden & 0x0F) << 4 | (flags & 0x0F);
+    pkt.size = 3;
+
+    // Data bytes and CRC, e.g. "8A-21-40:3D-54"
+    while (*p == ' ') p++;
+    for (;;)
+    {
+        unsigned int byte;
+        if (! isxdigit(p[0]) || ! isxdigit(p[1]) || sscanf(p, "%2x", &byte) != 1) return false;
+        if (pkt.size >= VAN_MAX_PACKET_SIZE) return false;
+        pkt.bytes[pkt.size++] = byte;
+        p += 2;
+        if (*p != '-' && *p != ':') break;
+        p++;
+    } // for
+
+    if (pkt.size < 5) return false;  // At least IDEN, COM and CRC
+
+    while (*p == ' ') p++;
+    pkt.ack = strncmp(p, "ACK", 3) == 0;
+
+    return true;
+} // ParseRawLine
+
+// Returns a random number 0 ... max, reproducible
+uint32_t Random(uint32_t max)
+{
+    static uint32_t seed = 12345;
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 8) % (max + 1);
+} // Random
+
+// Feeds a level change into the decoder, with a random interrupt latency
+void ReplayEdge(uint32_t at, int pinLevel, uint32_t maxLatency, TResults& results)
+{
+    const uint32_t start = ESP.getCycleCount();
+    VanBusRx.ReplayEdge(at + Random(maxLatency), pinLevel);
+    results.decodeCycles += ESP.getCycleCount() - start;
+    results.nEdges++;
+} // ReplayEdge
+
+// Encodes a packet into its bit timing, and feeds the resulting level changes into the decoder
+void ReplayPacket(const TPacket& pkt, uint32_t maxLatency, TResults& results)
+{
+    int prevBit = 1;  // Bus is idle
+    uint32_t at = replayAt;
+
+    #define BIT(b) \
+    { \
+        const int bit = (b); \
+        if (bit != prevBit) ReplayEdge(at, bit == 0 ? VAN_LOGICAL_LOW : VAN_LOGICAL_HIGH, maxLatency, results); \
+        prevBit = bit; \
+        at += bitTimeCycles; \
+    }
+
+    for (int i = 0; i < pkt.size; i++)
+    {
+        // After each 4 bits, the inverse of the last bit is inserted ("Enhanced Manchester" encoding)
+        const uint8_t byte = pkt.bytes[i];
+        uint16_t stuffed = (byte & 0xF0) << 2 | (~ byte & 0x10) << 1 | (byte & 0x0F) << 1 | (~ byte & 0x01);
+
+        // The last Manchester bit is always 0, to indicate EOD
+        if (i == pkt.size - 1) stuffed &= 0x3FE;
+
+        for (int bitNo = 9; bitNo >= 0; bitNo--) BIT(stuffed >> bitNo & 0x01);
+    } // for
+
+    // ACK: 1 time slot recessive, then 1 time slot dominant if acknowledged
+    BIT(1);
+    BIT(pkt.ack ? 0 : 1);
+
+    // EOF
+    for (int i = 0; i < 8; i++) BIT(1);
+
+    VanBusRx.ReplayEnd();
+    replayAt = at + IFS_BITS * bitTimeCycles;
+} // ReplayPacket
+
+// Replays a packet, then checks the outcome
+void ReplayAndCheck(const TPacket& pkt, uint32_t maxLatency, TResults& results)
+{
+    ReplayPacket(pkt, maxLatency, results);
+    results.nFrames++;
+
+    TVanPacketRxDesc rxPkt;
+    if (! VanBusRx.Receive(rxPkt))
+    {
+        results.nFailed++;
+        return;
+    } // if
+
+    // Drop any further (bogus) packets
+    TVanPacketRxDesc dummy;
+    while (VanBusRx.Receive(dummy)) { }
+
+    const bool crcOk = rxPkt.CheckCrc();
+    if (! crcOk && ! rxPkt.CheckCrcAndRepair())
+    {
+        results.nFailed++;
+        return;
+    } // if
+
+    if (rxPkt.DataLen() != pkt.size - 5
+        || rxPkt.Iden() != (pkt.bytes[1] << 4 | pkt.bytes[2] >> 4)
+        || rxPkt.CommandFlags() != (pkt.bytes[2] & 0x0F)
+        || memcmp(rxPkt.Data(), pkt.bytes + 3, pkt.size - 5) != 0)
+    {
+        results.nWrong++;
+        return;
+    } // if
+
+    if (crcOk) results.nOk++; else results.nRepaired++;
+} // ReplayAndCheck
+
+void PrintResults(uint32_t bitTime, uint32_t latency, const TResults& results)
+{
+    char floatBuf[MAX_FLOAT_SIZE];
+    Serial.printf_P(PSTR("bit time %" PRIu32 ", "), bitTime);
+    Serial.printf_P(PSTR("latency %s usec: "), FloatToStr(floatBuf, latency / 80.0, 2));
+    Serial.printf_P(
+        PSTR("frames: %" PRIu32 ", OK: %" PRIu32 ", repaired: %" PRIu32 ", failed: %" PRIu32 ", wrong: %" PRIu32),
+        results.nFrames,
+        results.nOk,
+        results.nRepaired,
+        results.nFailed,
+        results.nWrong);
+    Serial.printf_P(
+        PSTR(", decode: %s usec/edge\n"),
+        results.nEdges == 0
+            ? "-.--"
+            : FloatToStr(floatBuf, (float)results.decodeCycles / results.nEdges / (F_CPU / 1000000), 2));
+} // PrintResults
+
+// Replays the specified packets, for each simulated bit time and interrupt latency
+void Benchmark(const TPacket* pkts, int nPkts, int nRounds)
+{
+    for (unsigned int b = 0; b < N_BIT_TIMES; b++)
+    {
+        bitTimeCycles = CPU_CYCLES(bitTimes[b]);
+
+        for (unsigned int l = 0; l < N_LATENCIES; l++)
+        {
+            const uint32_t maxLatency = CPU_CYCLES(latencies[l]);
+            TResults results;
+            memset(&results, 0, sizeof(results));
+
+            for (int round = 0; round < nRounds; round++)
+            {
+                for (int i = 0; i < nPkts; i++) ReplayAndCheck(pkts[i], maxLatency, results);
+                yield();  // Keep the watchdog happy
+            } // for
+
+            PrintResults(bitTimes[b], latencies[l], results);
+        } // for
+    } // for
+} // Benchmark
+
+// Replays one line of a bit timing dump as printed by 'TIsrDebugPacket::Dump'. Returns false if the line is not in
+// that format.
+bool ReplayIsrDumpLine(const char* line)
+{
+    int i;
+    int n;
+    if (sscanf(line, "%d%n", &i, &n) != 1) return false;
+
+    // Number of CPU cycles since previous level change, at 80 MHz
+    const char* p = line + n;
+    while (*p == ' ') p++;
+    uint32_t nCycles;
+    if (*p == '>') nCycles = 0xFFFF; else if (sscanf(p, "%" SCNu32, &nCycles) != 1) return false;
+
+    // New pin level, e.g. "1"->"0","0"
+    p = strstr(p, "\"->\"");
+    if (p == NULL || (p[4] != '0' && p[4] != '1')) return false;
+    const int pinLevel = p[4] - '0';
+
+    replayAt += CPU_CYCLES(nCycles);
+    VanBusRx.ReplayEdge(replayAt, pinLevel);
+    return true;
+} // ReplayIsrDumpLine
+
+// Prints the packets decoded from a bit timing dump
+void FinishIsrDump()
+{
+    VanBusRx.ReplayEnd();
+
+    TVanPacketRxDesc pkt;
+    while (VanBusRx.Receive(pkt))
+    {
+        Serial.print(F("Replayed: "));
+        bool crcOk = pkt.CheckCrcAndRepair();
+        pkt.DumpRaw(Serial);
+        if (! crcOk) Serial.print(F("--> CRC error, not repairable\n"));
+    } // while
+} // FinishIsrDump
+
+void setup()
+{
+    delay(1000);
+    Serial.begin(115200);
+    Serial.print("Starting VAN bus packet decoder benchmark\n");
+
+    VanBusRx.Setup(RX_PIN);
+
+    // Disconnect from the bus: the decoder is fed by 'ReplayEdge' only
+    VanBusRx.Disable();
+
+    static TPacket pkts[N_BUILT_IN_PACKETS];
+    int nPkts = 0;
+    for (unsigned int i = 0; i < N_BUILT_IN_PACKETS; i++)
+    {
+        char line[MAX_LINE_SIZE];
+        strcpy_P(line, builtInPackets[i]);
+        if (ParseRawLine(line, pkts[nPkts])) nPkts++;
+    } // for
+
+    Serial.printf_P(PSTR("Replaying %d built-in packets, %d times for each simulated bit time and interrupt latency\n"),
+        nPkts, N_ROUNDS);
+    Benchmark(pkts, nPkts, N_ROUNDS);
+    VanBusRx.DumpStats(Serial);
+
+    Serial.print(F("Paste \"Raw:\" lines or bit timing dumps to replay them\n"));
+} // setup
+
+void loop()
+{
+    static char line[MAX_LINE_SIZE];
+    static int at = 0;
+    static bool inIsrDump = false;
+
+    while (Serial.available() > 0)
+    {
+        const int c = Serial.read();
+        if (c == '\r') continue;
+        if (c != '\n')
+        {
+            if (at < MAX_LINE_SIZE - 1) line[at++] = c;
+            continue;
+        } // if
+
+        line[at] = 0;
+        at = 0;
+
+        const char* p = SkipTimeStamp(line);
+
+        if (ReplayIsrDumpLine(p))
+        {
+            inIsrDump = true;
+            continue;
+        } // if
+
+        if (inIsrDump)
+        {
+            FinishIsrDump();
+            inIsrDump = false;
+        } // if
+
+        TPacket pkt;
+        if (ParseRawLine(p, pkt))
+        {
+            Serial.printf_P(PSTR("%s\n"), p);
+            Benchmark(&pkt, 1, N_ROUNDS);
+        } // if
+    } // while
+} // loop
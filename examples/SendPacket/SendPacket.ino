@@ -3,7 +3,7 @@
  *
  * Written by Erik Tromp
  *
- * Version 0.4.1 - September, 2024
+ * Version 0.4.2 - October, 2026
  *
  * MIT license, all text above must be included in any redistribution.
  *
@@ -49,6 +49,11 @@
   const int RX_PIN = D2; // GPIO pin connected to VAN bus transceiver output
 #endif // ARDUINO_ARCH_ESP32
 
+// Packet to send remote exterior temperature to the multifunction display (MFD). It is prepared only once;
+// sending it is then a simple copy into the transmit queue.
+const uint8_t rmtTemperatureBytes[] = {0x0F, 0x07, 0x00, 0x00, 0x00, 0x00, 0x70};
+TVanPreparedTxPacket rmtTemperaturePacket(0x8A4, 0x08, rmtTemperatureBytes, sizeof(rmtTemperatureBytes));
+
 void setup()
 {
     delay(1000);
@@ -104,8 +109,9 @@ void loop()
         const int byteToSend = temperatureValue * 2 + 0x50;
         assert(byteToSend >= 0 && byteToSend <= 255);
 
-        const uint8_t rmtTemperatureBytes[] = {0x0F, 0x07, 0x00, 0x00, 0x00, 0x00, (uint8_t)byteToSend};
-        VanBus.SyncSendPacket(0x8A4, 0x08, rmtTemperatureBytes, sizeof(rmtTemperatureBytes));
+        // Only the changed byte and the CRC are encoded again
+        rmtTemperaturePacket.SetByte(6, (uint8_t)byteToSend);
+        VanBus.SyncSendPacket(rmtTemperaturePacket);
     } // if
 
     // Print some boring statistics
@@ -3,7 +3,7 @@
  *
  * Written by Erik Tromp
  *
- * Version 0.4.1 - September, 2024
+ * Version 0.4.2 - October, 2026
  *
  * MIT license, all text above must be included in any redistribution.
  *
@@ -129,5 +129,10 @@ void loop()
     {
         lastUpdate = millis();
         VanBusRx.DumpStats(Serial);
+
+      #ifdef VAN_ISR_PROFILING
+        // Execution time of the interrupt service routines, since the previous dump
+        VanBusRx.DumpIsrProfile(Serial, true);
+      #endif // VAN_ISR_PROFILING
     } // if
 } // loop
@@ -0,0 +1,393 @@
+/*
+ * VanBus: DecoderReplay - regression test of the packet decoder on the host computer, by replaying bus level changes.
+ *
+ * Written by Erik Tromp
+ *
+ * Version 0.4.2 - October, 2026
+ *
+ * MIT license, all text above must be included in any redistribution.
+ *
+ * -----
+ * This is a program for the host computer (PC), not an Arduino sketch. It runs the packet decoder of the library
+ * ('TVanRxDecoder', see ../../src/VanBusRxDecoder.h), which has no dependency on the Arduino core or on the hardware.
+ * Build and run it with CMake:
+ *
+ *   cmake -S . -B build && cmake --build build && ctest --test-dir build --output-on-failure
+ *
+ * or with any C++ compiler, e.g.:
+ *
+ *   g++ -O2 -o DecoderReplay DecoderReplay.cpp
+ *
+ * Usage:
+ *
+ *   DecoderReplay <file> [<file> ...]
+ *
+ * Replays each packet in "Raw:" format, as printed by 'TVanPacketRxDesc::DumpRaw', found in the files. E.g. the
+ * built-in packets of ../../examples/ReplayTrace/ReplayTrace.ino, and ../../examples/PacketParser/example_log.txt.
+ * Like the ReplayTrace example, each packet is encoded into its ideal bit timing, at a few different bit rates, which
+ * is then disturbed by a simulated interrupt latency of increasing magnitude. See ReplayTrace for the output format.
+ * Only the bit times and latencies that the decoder must handle without CRC repair are replayed (see 'bitTimes' and
+ * 'latencies' below); ReplayTrace covers the full range on the target.
+ * Packets that need a CRC repair count as "failed": 'TVanPacketRxDesc::CheckCrcAndRepair' is not available here.
+ *
+ * Exit code is 1 if any packet was "failed" or "wrong".
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+#include <inttypes.h>
+
+// As on the ESP8266 at 80 MHz
+#ifndef F_CPU
+  #define F_CPU 80000000L
+#endif // F_CPU
+#define LOW 0
+#define HIGH 1
+
+#include "../../src/VanBusRxDecoder.h"
+
+// Simulated VAN bus bit times and interrupt latencies, in CPU cycles at 80 MHz. A subset of the ReplayTrace example:
+// only the range that the decoder must handle without CRC repair. Beyond that, "failed" is expected.
+#ifdef VAN_RX_ADAPTIVE_BIT_TIMING
+static const uint32_t bitTimes[] = { 667, 640, 700 };
+static const uint32_t latencies[] = { 0, 40, 80, 120, 160, 200 };
+#else
+// The fixed timing values are tuned to the bit time as measured on real vehicles
+static const uint32_t bitTimes[] = { 667 };
+static const uint32_t latencies[] = { 0, 40 };
+#endif // VAN_RX_ADAPTIVE_BIT_TIMING
+#define N_BIT_TIMES (sizeof(bitTimes) / sizeof(bitTimes[0]))
+#define N_LATENCIES (sizeof(latencies) / sizeof(latencies[0]))
+
+// Number of idle bits following the EOF, before the next packet starts
+#define IFS_BITS 5
+
+// Number of times the packets are replayed, for each simulated bit time and interrupt latency. The first round is
+// not counted: with VAN_RX_ADAPTIVE_BIT_TIMING, the decoder needs a few packets to adapt to a new bit time.
+#define N_ROUNDS 100
+
+#define MAX_LINE_SIZE 512
+#define MAX_PACKETS 1000
+
+// A packet as parsed from a "Raw:" line, or as decoded
+struct TPacket
+{
+    uint8_t bytes[VAN_MAX_PACKET_SIZE];  // Including SOF and CRC
+    int size;
+    bool ack;
+};
+
+// Replay results
+struct TResults
+{
+    uint32_t nFrames;
+    uint32_t nOk;
+    uint32_t nFailed;
+    uint32_t nWrong;
+};
+
+static uint16_t crcTable[256];
+
+// See '_initCrcTable' in ../../src/VanBusRx.cpp
+static void InitCrcTable()
+{
+    for (int i = 0; i < 256; i++)
+    {
+        uint16_t crc = i << 7;
+        for (int bit = 0; bit < 8; bit++)
+        {
+            if (crc & 0x4000) crc = (crc << 1) ^ 0x0F9D; else crc <<= 1;
+        } // for
+        crcTable[i] = crc & 0x7FFF;
+    } // for
+} // InitCrcTable
+
+// Same as 'TVanPacketRxDesc::CheckCrc'
+static bool CheckCrc(const uint8_t bytes[], int size)
+{
+    uint16_t crc15 = 0x7FFF;
+    for (int i = 1; i < size; i++) crc15 = (uint16_t)((crc15 << 8) ^ crcTable[(uint8_t)((crc15 >> 7) ^ bytes[i])]);
+    return ((crc15 & 0x7FFF) ^ 0x19B7) == 0;
+} // CheckCrc
+
+// Same as 'ParseRawLine' in ../../examples/ReplayTrace/ReplayTrace.ino
+static bool ParseRawLine(const char* line, TPacket& pkt)
+{
+    const char* p = strstr(line, "Raw:");
+    if (p == NULL) return false;
+
+    // Start of the packet: the SOF byte
+    p = strstr(p, " 0E ");
+    if (p == NULL) return false;
+    p += 4;
+
+    unsigned int iden;
+    int n;
+    if (sscanf(p, "%3x%n", &iden, &n) != 1) return false;
+    p += n;
+
+    // Command flags: either a hex digit followed by e.g. "(RA0)", or only e.g. "RA0"
+    unsigned int flags;
+    while (*p == ' ') p++;
+    if (isxdigit(p[0]) && p[1] == ' ')
+    {
+        flags = strtoul(p, NULL, 16);
+        p = strchr(p, ')');
+        if (p == NULL) return false;
+        p++;
+    }
+    else
+    {
+        if (strlen(p) < 3) return false;
+        flags = 0x08 | (p[0] == 'R' ? 0x02 : 0) | (p[1] == 'A' ? 0x04 : 0) | (p[2] == '1' ? 0x01 : 0);
+        p += 3;
+    } // if
+
+    pkt.bytes[0] = 0x0E;
+    pkt.bytes[1] = iden >> 4;
+    pkt.bytes[2] = (iden & 0x0F) << 4 | (flags & 0x0F);
+    pkt.size = 3;
+
+    // Data bytes and CRC, e.g. "8A-21-40:3D-54"
+    while (*p == ' ') p++;
+    for (;;)
+    {
+        unsigned int byte;
+        if (! isxdigit(p[0]) || ! isxdigit(p[1]) || sscanf(p, "%2x", &byte) != 1) return false;
+        if (pkt.size >= VAN_MAX_PACKET_SIZE) return false;
+        pkt.bytes[pkt.size++] = byte;
+        p += 2;
+        if (*p != '-' && *p != ':') break;
+        p++;
+    } // for
+
+    if (pkt.size < 5) return false;  // At least IDEN, COM and CRC
+
+    while (*p == ' ') p++;
+    pkt.ack = strncmp(p, "ACK", 3) == 0;
+
+    return true;
+} // ParseRawLine
+
+// Returns a random number 0 ... max, reproducible
+static uint32_t Random(uint32_t max)
+{
+    static uint32_t seed = 12345;
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 8) % (max + 1);
+} // Random
+
+// Emulation of the receive queue around the decoder: see 'TVanPacketRxQueue::DecodeEdge', 'ReplayEdge' and
+// 'ReplayEnd' in ../../src/VanBusRx.cpp
+static TVanRxDecoder decoder;
+static uint8_t slot[VAN_MAX_PACKET_SIZE];
+static bool ackTimerArmed = false;
+static uint32_t ackTimerArmedAt = 0;
+static uint32_t replayLastEdgeAt = 0;
+
+// The first packet decoded since the last call to 'ReplayPacket', and the number of decoded packets
+static TPacket received;
+static int nReceived = 0;
+
+static void TakePacket()
+{
+    if (nReceived++ > 0) return;
+
+    memcpy(received.bytes, slot, decoder.size);
+    received.size = decoder.size;
+    received.ack = decoder.ack == VAN_ACK;
+} // TakePacket
+
+static void DecodeEdge(uint32_t curr, int pinLevel)
+{
+    const unsigned int events = decoder.Decode(curr, pinLevel, slot);
+    if (events & (VAN_RX_EV_NOISE | VAN_RX_EV_IGNORED)) return;
+
+    if (events & VAN_RX_EV_CANCEL_ACK_TIMER) ackTimerArmed = false;
+    if (events & VAN_RX_EV_PACKET) TakePacket();
+    if (events & VAN_RX_EV_ARM_ACK_TIMER)
+    {
+        ackTimerArmed = true;
+        ackTimerArmedAt = curr;
+    } // if
+
+    decoder.CheckPinLevelAtReturn(pinLevel, pinLevel);
+} // DecodeEdge
+
+static void ReplayEnd()
+{
+    if (ackTimerArmed)
+    {
+        ackTimerArmed = false;
+        if (decoder.AckTimeout()) TakePacket();
+        return;
+    } // if
+
+    if (decoder.state == VAN_RX_SEARCHING || decoder.state == VAN_RX_LOADING)
+    {
+        replayLastEdgeAt += VAN_REPLAY_IDLE_CPU_CYCLES;
+        DecodeEdge(replayLastEdgeAt, VAN_LOGICAL_HIGH);
+    } // if
+} // ReplayEnd
+
+static void ReplayEdge(uint32_t cycles, int pinLevel)
+{
+    if (ackTimerArmed && cycles - ackTimerArmedAt >= VAN_ACK_TIMEOUT_CPU_CYCLES) ReplayEnd();  // Safe roll-over
+
+    DecodeEdge(cycles, pinLevel);
+    replayLastEdgeAt = cycles;
+
+    if (decoder.state != VAN_RX_WAITING_ACK) ackTimerArmed = false;
+} // ReplayEdge
+
+// Time base of the replayed bus level changes
+static uint32_t replayAt = 0;
+
+// Encodes a packet into its bit timing, and feeds the resulting level changes into the decoder. Same as
+// 'ReplayPacket' in ../../examples/ReplayTrace/ReplayTrace.ino.
+static void ReplayPacket(const TPacket& pkt, uint32_t bitTimeCycles, uint32_t maxLatency)
+{
+    int prevBit = 1;  // Bus is idle
+    uint32_t at = replayAt;
+
+    #define BIT(b) \
+    { \
+        const int bit = (b); \
+        if (bit != prevBit) ReplayEdge(at + Random(maxLatency), bit == 0 ? VAN_LOGICAL_LOW : VAN_LOGICAL_HIGH); \
+        prevBit = bit; \
+        at += bitTimeCycles; \
+    }
+
+    for (int i = 0; i < pkt.size; i++)
+    {
+        // After each 4 bits, the inverse of the last bit is inserted ("Enhanced Manchester" encoding)
+        const uint8_t byte = pkt.bytes[i];
+        uint16_t stuffed = (byte & 0xF0) << 2 | (~ byte & 0x10) << 1 | (byte & 0x0F) << 1 | (~ byte & 0x01);
+
+        // The last Manchester bit is always 0, to indicate EOD
+        if (i == pkt.size - 1) stuffed &= 0x3FE;
+
+        for (int bitNo = 9; bitNo >= 0; bitNo--) BIT(stuffed >> bitNo & 0x01);
+    } // for
+
+    // ACK: 1 time slot recessive, then 1 time slot dominant if acknowledged
+    BIT(1);
+    BIT(pkt.ack ? 0 : 1);
+
+    // EOF
+    for (int i = 0; i < 8; i++) BIT(1);
+
+    ReplayEnd();
+    replayAt = at + IFS_BITS * bitTimeCycles;
+} // ReplayPacket
+
+// Replays a packet, then checks the outcome
+static void ReplayAndCheck(const TPacket& pkt, uint32_t bitTimeCycles, uint32_t maxLatency, TResults& results)
+{
+    nReceived = 0;
+    ReplayPacket(pkt, bitTimeCycles, maxLatency);
+    results.nFrames++;
+
+    if (nReceived == 0 || ! CheckCrc(received.bytes, received.size))
+    {
+        results.nFailed++;
+        return;
+    } // if
+
+    if (received.size != pkt.size || memcmp(received.bytes + 1, pkt.bytes + 1, pkt.size - 1) != 0)
+    {
+        results.nWrong++;
+        return;
+    } // if
+
+    results.nOk++;
+} // ReplayAndCheck
+
+// Reads all "Raw:" lines from a file. Returns the number of packets read, or -1 if the file cannot be opened.
+static int ReadPackets(const char* fileName, TPacket* pkts, int maxPkts)
+{
+    FILE* f = fopen(fileName, "r");
+    if (f == NULL) return -1;
+
+    int nPkts = 0;
+    char line[MAX_LINE_SIZE];
+    while (nPkts < maxPkts && fgets(line, sizeof(line), f) != NULL)
+    {
+        if (ParseRawLine(line, pkts[nPkts])) nPkts++;
+    } // while
+
+    fclose(f);
+    return nPkts;
+} // ReadPackets
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <file> [<file> ...]\n", argv[0]);
+        return 1;
+    } // if
+
+    InitCrcTable();
+
+    static TPacket pkts[MAX_PACKETS];
+    int nPkts = 0;
+    for (int i = 1; i < argc; i++)
+    {
+        const int n = ReadPackets(argv[i], pkts + nPkts, MAX_PACKETS - nPkts);
+        if (n < 0)
+        {
+            fprintf(stderr, "Cannot open '%s'\n", argv[i]);
+            return 1;
+        } // if
+        printf("%s: %d packets\n", argv[i], n);
+        nPkts += n;
+    } // for
+
+    if (nPkts == 0)
+    {
+        fprintf(stderr, "No \"Raw:\" lines found\n");
+        return 1;
+    } // if
+
+  #ifdef VAN_RX_ADAPTIVE_BIT_TIMING
+    printf("Replaying with VAN_RX_ADAPTIVE_BIT_TIMING\n");
+  #endif // VAN_RX_ADAPTIVE_BIT_TIMING
+
+    bool passed = true;
+    for (unsigned int b = 0; b < N_BIT_TIMES; b++)
+    {
+        for (unsigned int l = 0; l < N_LATENCIES; l++)
+        {
+            TResults results;
+            memset(&results, 0, sizeof(results));
+
+            for (int i = 0; i < nPkts; i++) ReplayPacket(pkts[i], CPU_CYCLES(bitTimes[b]), CPU_CYCLES(latencies[l]));
+
+            for (int round = 1; round < N_ROUNDS; round++)
+            {
+                for (int i = 0; i < nPkts; i++)
+                {
+                    ReplayAndCheck(pkts[i], CPU_CYCLES(bitTimes[b]), CPU_CYCLES(latencies[l]), results);
+                } // for
+            } // for
+
+            printf(
+                "bit time %" PRIu32 ", latency %.2f usec: frames: %" PRIu32 ", OK: %" PRIu32 ", failed: %" PRIu32
+                    ", wrong: %" PRIu32 "\n",
+                bitTimes[b],
+                latencies[l] / 80.0,
+                results.nFrames,
+                results.nOk,
+                results.nFailed,
+                results.nWrong);
+
+            if (results.nFailed != 0 || results.nWrong != 0) passed = false;
+        } // for
+    } // for
+
+    return passed ? 0 : 1;
+} // main
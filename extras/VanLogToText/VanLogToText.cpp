@@ -0,0 +1,265 @@
+/*
+ * VanBus: VanLogToText - convert a binary packet log, as written by the PacketLogger example, into the text format
+ *   of 'TVanPacketRxDesc::DumpRaw'.
+ *
+ * Written by Erik Tromp
+ *
+ * Version 0.4.2 - October, 2026
+ *
+ * MIT license, all text above must be included in any redistribution.
+ *
+ * -----
+ * This is a program for the host computer (PC), not an Arduino sketch. Build it with any C++ compiler, e.g.:
+ *
+ *   g++ -O2 -o VanLogToText VanLogToText.cpp
+ *
+ * Usage:
+ *
+ *   VanLogToText [-t] [-b <block size>] <log file>
+ *
+ * Options:
+ * -t : start each line with the packet time stamp, relative to the boot of the logging device, in the format of the
+ *      Arduino IDE Serial Monitor, e.g. "00:01:23.456 -> "
+ * -b : block size; must be the same as VAN_LOG_BLOCK_SIZE in ../../examples/PacketLogger/PacketLog.h (default 512)
+ *
+ * The output can e.g. be pasted into the serial monitor of the ReplayTrace example. Note: the receive queue slot
+ * number is not logged; the sequence number modulo the queue size is shown instead.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+
+#define VAN_MAX_PACKET_SIZE 33
+#define VAN_LOG_HEADER_SIZE 6
+
+static const char* resultStr[] = { "OK", "ERROR_NBITS", "ERROR_MANCHESTER", "ERROR_MAX_PACKET" };
+
+static uint16_t crcTable[256];
+
+// See '_initCrcTable' in ../../src/VanBusRx.cpp
+static void InitCrcTable()
+{
+    for (int i = 0; i < 256; i++)
+    {
+        uint16_t crc = i << 7;
+        for (int bit = 0; bit < 8; bit++)
+        {
+            if (crc & 0x4000) crc = (crc << 1) ^ 0x0F9D; else crc <<= 1;
+        } // for
+        crcTable[i] = crc & 0x7FFF;
+    } // for
+} // InitCrcTable
+
+static uint16_t CrcUpdate(uint16_t crc15, const uint8_t bytes[], int n)
+{
+    for (int i = 0; i < n; i++) crc15 = (uint16_t)((crc15 << 8) ^ crcTable[(uint8_t)((crc15 >> 7) ^ bytes[i])]);
+    return crc15;
+} // CrcUpdate
+
+// Same as 'TVanPacketRxDesc::Crc'
+static uint16_t Crc(const uint8_t bytes[], int size)
+{
+    return (uint16_t)((CrcUpdate(0x7FFF, bytes + 1, size - 3) ^ 0x7FFF) << 1);
+} // Crc
+
+// Same as 'TVanPacketRxDesc::CheckCrc'
+static bool CheckCrc(const uint8_t bytes[], int size)
+{
+    return ((CrcUpdate(0x7FFF, bytes + 1, size - 1) & 0x7FFF) ^ 0x19B7) == 0;
+} // CheckCrc
+
+// Reads an unsigned LEB128 number. Returns false if it does not end before 'end'.
+static bool ReadVarint(const uint8_t*& p, const uint8_t* end, uint32_t& value)
+{
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7)
+    {
+        if (p >= end) return false;
+        const uint8_t byte = *p++;
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) return true;
+    } // for
+    return false;
+} // ReadVarint
+
+struct TRecord
+{
+    uint64_t sofMicros;
+    uint32_t seqNo;
+    int result;
+    bool noAck;
+    int uncertainBit;
+    int size;
+    uint8_t bytes[VAN_MAX_PACKET_SIZE];
+};
+
+// Same as 'TVanPacketRxDesc::DumpRaw'
+static void DumpRaw(const TRecord& r, int queueSize)
+{
+    const int size = r.size;
+    const uint8_t* bytes = r.bytes;
+
+    printf("Raw: #%04" PRIu32 " (%*d/%d) %2d(%2d) ",
+        r.seqNo % 10000,
+        queueSize > 100 ? 3 : queueSize > 10 ? 2 : 1,
+        (int)(r.seqNo % queueSize) + 1,
+        queueSize,
+        size - 5 < 0 ? 0 : size - 5,
+        size);
+
+    if (size >= 1) printf("%02X ", bytes[0]);
+    if (size >= 3)
+    {
+        printf("%03X %1X (%c%c%d) ",
+            bytes[1] << 4 | bytes[2] >> 4,
+            bytes[2] & 0x0F,
+            bytes[2] & 0x02 ? 'R' : 'W',
+            bytes[2] & 0x04 ? 'A' : '-',
+            bytes[2] & 0x01);
+    } // if
+
+    for (int i = 3; i < size; i++) printf("%02X%c", bytes[i], i == size - 3 ? ':' : i < size - 1 ? '-' : ' ');
+
+    printf("%s %s %04X %s", r.noAck ? "NO_ACK" : "ACK", resultStr[r.result], Crc(bytes, size),
+        CheckCrc(bytes, size) ? "CRC_OK" : "CRC_ERROR");
+
+    if (r.uncertainBit != 0) printf(" uBit=%d", r.uncertainBit);
+
+    printf("\n%*s", queueSize > 100 ? 43 : queueSize > 10 ? 41 : 39, " ");
+    for (int i = 3; i < size - 2; i++)
+    {
+        if (bytes[i] >= 0x20 && bytes[i] <= 0x7E) printf("%2c ", bytes[i]); else printf(" · ");
+    } // for
+    printf("\n");
+} // DumpRaw
+
+// Decodes one record; see 'TVanPacketRxDesc::ToBinary' in ../../src/VanBusRx.cpp for the format. Returns false if
+// the record is malformed.
+static bool ReadRecord(const uint8_t*& p, const uint8_t* end, uint32_t& prevMicros, uint32_t& prevSeqNo, TRecord& r)
+{
+    uint32_t delta;
+    if (! ReadVarint(p, end, delta)) return false;
+    prevMicros += delta;
+
+    if (p >= end) return false;
+    const uint8_t status = *p++;
+    if (status & 0xC0) return false;
+    r.result = status & 0x03;
+    r.noAck = status & 0x04;
+
+    delta = 1;
+    if ((status & 0x10) && ! ReadVarint(p, end, delta)) return false;
+    prevSeqNo += delta;
+    r.seqNo = prevSeqNo;
+
+    r.uncertainBit = 0;
+    if (status & 0x08)
+    {
+        if (end - p < 2) return false;
+        r.uncertainBit = p[0] | p[1] << 8;
+        p += 2;
+    } // if
+
+    if (p >= end) return false;
+    r.size = *p++;
+    if (r.size > VAN_MAX_PACKET_SIZE) return false;
+    if (r.size == 0) return true;
+
+    // The SOF byte is only stored if it is not 0x0E
+    const int from = status & 0x20 ? 0 : 1;
+    r.bytes[0] = 0x0E;
+    if (end - p < r.size - from) return false;
+    memcpy(r.bytes + from, p, r.size - from);
+    p += r.size - from;
+
+    return true;
+} // ReadRecord
+
+int main(int argc, char* argv[])
+{
+    bool printTime = false;
+    long blockSize = 512;
+    const char* fileName = NULL;
+    bool usage = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "-t") == 0) printTime = true;
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) blockSize = strtol(argv[++i], NULL, 0);
+        else if (argv[i][0] != '-' && fileName == NULL) fileName = argv[i];
+        else usage = true;
+    } // for
+
+    if (usage || fileName == NULL || blockSize <= VAN_LOG_HEADER_SIZE || blockSize > 0xFFFF)
+    {
+        fprintf(stderr, "Usage: %s [-t] [-b <block size>] <log file>\n", argv[0]);
+        return 2;
+    } // if
+
+    FILE* f = fopen(fileName, "rb");
+    if (f == NULL)
+    {
+        perror(fileName);
+        return 1;
+    } // if
+
+    InitCrcTable();
+
+    uint8_t* block = (uint8_t*)malloc(blockSize);
+    uint64_t lastMicros = 0;
+    long offset = 0;
+    int nBadBlocks = 0;
+
+    while (fread(block, 1, blockSize, f) == (size_t)blockSize)
+    {
+        const int used = block[2] | block[3] << 8;
+        const int queueSize = block[4] | block[5] << 8;
+        if (block[0] != 'V' || block[1] != 'L' || used < VAN_LOG_HEADER_SIZE || used > blockSize || queueSize == 0)
+        {
+            fprintf(stderr, "Skipping invalid block at offset %ld\n", offset);
+            nBadBlocks++;
+            offset += blockSize;
+            continue;
+        } // if
+
+        // The first record of a block does not depend on any previous record
+        const uint8_t* p = block + VAN_LOG_HEADER_SIZE;
+        const uint8_t* end = block + used;
+        uint32_t prevMicros = 0;
+        uint32_t prevSeqNo = 0;
+
+        while (p < end)
+        {
+            TRecord r;
+            if (! ReadRecord(p, end, prevMicros, prevSeqNo, r))
+            {
+                fprintf(stderr, "Skipping invalid record at offset %ld\n", offset + (long)(p - block));
+                nBadBlocks++;
+                break;
+            } // if
+
+            // Only the 32 least significant bits of the time stamp are logged
+            lastMicros += (uint32_t)(prevMicros - (uint32_t)lastMicros);
+            r.sofMicros = lastMicros;
+
+            if (printTime)
+            {
+                const uint64_t millis = r.sofMicros / 1000;
+                printf("%02" PRIu64 ":%02" PRIu64 ":%02" PRIu64 ".%03" PRIu64 " -> ",
+                    millis / 3600000, millis / 60000 % 60, millis / 1000 % 60, millis % 1000);
+            } // if
+
+            DumpRaw(r, queueSize);
+        } // while
+
+        offset += blockSize;
+    } // while
+
+    free(block);
+    fclose(f);
+
+    return nBadBlocks == 0 ? 0 : 1;
+} // main
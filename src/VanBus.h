@@ -3,7 +3,7 @@
  *
  * Written by Erik Tromp
  *
- * Version 0.4.0 - March, 2024
+ * Version 0.4.2 - October, 2026
  *
  * MIT license, all text above must be included in any redistribution.
  */
@@ -40,7 +40,11 @@ class TVanBus
 
     // -----
     // Interfaces for both Tx and Rx
-    static void Setup(uint8_t rxPin, uint8_t txPin) { VanBusTx.Setup(rxPin, txPin); }
+    static bool Setup(uint8_t rxPin, uint8_t txPin, int isrCore = VAN_ISR_CORE_CALLER,
+        int txQueueSize = VAN_DEFAULT_TX_QUEUE_SIZE)
+    {
+        return VanBusTx.Setup(rxPin, txPin, isrCore, txQueueSize);
+    } // Setup
 
     static void DumpStats(Stream& s, bool longForm = true)
     {
@@ -48,15 +52,42 @@ class TVanBus
         VanBusRx.DumpStats(s, longForm);
     } // DumpStats
 
+  #ifdef VAN_ISR_PROFILING
+    static void DumpIsrProfile(Stream& s, bool reset = false)
+    {
+        VanBusRx.DumpIsrProfile(s, reset);
+        VanBusTx.DumpIsrProfile(s, reset);
+    } // DumpIsrProfile
+  #endif // VAN_ISR_PROFILING
+
     // -----
     // Rx interfaces
     static bool Available() { return VanBusRx.Available(); }
+    static void Poll() { VanBusRx.Poll(); }
 
     static bool Receive(TVanPacketRxDesc& pkt, bool* isQueueOverrun = NULL)
     {
         return VanBusRx.Receive(pkt, isQueueOverrun);
     } // Receive
 
+    static int ReceiveMany(TVanPacketRxDesc* pkts, int max, bool* isQueueOverrun = NULL)
+    {
+        return VanBusRx.ReceiveMany(pkts, max, isQueueOverrun);
+    } // ReceiveMany
+
+    static TVanPacketRxDesc* Peek(bool* isQueueOverrun = NULL) { return VanBusRx.Peek(isQueueOverrun); }
+    static void Release() { VanBusRx.Release(); }
+
+    static bool OnPacket(void (*callback)(TVanPacketRxDesc& pkt), int core = VAN_ISR_CORE_CALLER)
+    {
+        return VanBusRx.OnPacket(callback, core);
+    } // OnPacket
+
+    static void SetRepairBudget(unsigned int budgetMicros, bool (TVanPacketRxDesc::*wantToCount)() const = 0)
+    {
+        VanBusRx.SetRepairBudget(budgetMicros, wantToCount);
+    } // SetRepairBudget
+
     static uint32_t GetRxCount() { return VanBusRx.GetCount(); }
     static int QueueSize() { return VanBusRx.QueueSize(); }
     static int GetNQueued() { return VanBusRx.GetNQueued(); }
@@ -65,6 +96,25 @@ class TVanBus
     {
         return VanBusRx.SetDropPolicy(startAt, isEssential);
     } // SetDropPolicy
+    static void AcceptIden(uint16_t iden, uint16_t mask = 0xFFF) { VanBusRx.AcceptIden(iden, mask); }
+    static void RejectIden(uint16_t iden, uint16_t mask = 0xFFF) { VanBusRx.RejectIden(iden, mask); }
+    static void AcceptAllIdens() { VanBusRx.AcceptAllIdens(); }
+    static void RejectAllIdens() { VanBusRx.RejectAllIdens(); }
+    static bool SetIdenLane(uint16_t iden, VanRxLane_t lane, uint16_t mask = 0xFFF)
+    {
+        return VanBusRx.SetIdenLane(iden, lane, mask);
+    } // SetIdenLane
+    static bool SetLaneDepth(VanRxLane_t lane, int depth) { return VanBusRx.SetLaneDepth(lane, depth); }
+    static void SetIdleTimeout(unsigned long timeoutMs, void (*onIdle)(bool idle) = 0, bool lightSleep = false)
+    {
+        VanBusRx.SetIdleTimeout(timeoutMs, onIdle, lightSleep);
+    } // SetIdleTimeout
+    static void PollBusIdle() { VanBusRx.PollBusIdle(); }
+    static bool IsBusIdle() { return VanBusRx.IsBusIdle(); }
+    static bool LightSleep() { return VanBusRx.LightSleep(); }
+  #ifdef VAN_RX_STATS
+    static void GetStats(TVanRxStats& snapshot, bool reset = false) { VanBusRx.GetStats(snapshot, reset); }
+  #endif // VAN_RX_STATS
 
     // -----
     // Tx interfaces
@@ -73,11 +123,60 @@ class TVanBus
         return VanBusTx.SyncSendPacket(iden, cmdFlags, data, dataLen, timeOutMs);
     } // SyncSendPacket
 
-    static bool SendPacket(uint16_t iden, uint8_t cmdFlags, const uint8_t* data, size_t dataLen, unsigned int timeOutMs = 10)
+    static bool SendPacket(uint16_t iden, uint8_t cmdFlags, const uint8_t* data, size_t dataLen, unsigned int timeOutMs = 10,
+        uint8_t priority = VAN_TX_PRIORITY_NORMAL, unsigned int deadlineMs = 0)
+    {
+        return VanBusTx.SendPacket(iden, cmdFlags, data, dataLen, timeOutMs, priority, deadlineMs);
+    } // SendPacket
+
+    static bool SyncSendPacket(const TVanPreparedTxPacket& packet, unsigned int timeOutMs = 10)
+    {
+        return VanBusTx.SyncSendPacket(packet, timeOutMs);
+    } // SyncSendPacket
+
+    static bool SendPacket(const TVanPreparedTxPacket& packet, unsigned int timeOutMs = 10,
+        uint8_t priority = VAN_TX_PRIORITY_NORMAL, unsigned int deadlineMs = 0)
     {
-        return VanBusTx.SendPacket(iden, cmdFlags, data, dataLen, timeOutMs);
+        return VanBusTx.SendPacket(packet, timeOutMs, priority, deadlineMs);
     } // SendPacket
 
+    static bool QueuePacket(uint16_t iden, uint8_t cmdFlags, const uint8_t* data, size_t dataLen, uint32_t* n = NULL,
+        uint8_t priority = VAN_TX_PRIORITY_NORMAL, unsigned int deadlineMs = 0)
+    {
+        return VanBusTx.QueuePacket(iden, cmdFlags, data, dataLen, n, priority, deadlineMs);
+    } // QueuePacket
+
+    static bool QueuePacket(const TVanPreparedTxPacket& packet, uint32_t* n = NULL,
+        uint8_t priority = VAN_TX_PRIORITY_NORMAL, unsigned int deadlineMs = 0)
+    {
+        return VanBusTx.QueuePacket(packet, n, priority, deadlineMs);
+    } // QueuePacket
+
+    static PacketTxResult_t GetTxResult(uint32_t n, TVanPacketTxResult* result = NULL)
+    {
+        return VanBusTx.GetTxResult(n, result);
+    } // GetTxResult
+
+    static bool SetInFrameReply(const TVanPreparedTxPacket* reply, unsigned int timeOutMs = 10)
+    {
+        return VanBusTx.SetInFrameReply(reply, timeOutMs);
+    } // SetInFrameReply
+
+    static bool ClearInFrameReply(uint16_t iden, unsigned int timeOutMs = 10)
+    {
+        return VanBusTx.ClearInFrameReply(iden, timeOutMs);
+    } // ClearInFrameReply
+
+    static bool IsSendingInFrameReply(const TVanPreparedTxPacket* reply)
+    {
+        return VanBusTx.IsSendingInFrameReply(reply);
+    } // IsSendingInFrameReply
+
+    static void SetReliableSend(int maxRetries = VAN_TX_DEFAULT_MAX_RETRIES)
+    {
+        VanBusTx.SetReliableSend(maxRetries);
+    } // SetReliableSend
+
     static uint32_t GetTxCount() { return VanBusTx.GetCount(); }
 
 }; // class TVanBus
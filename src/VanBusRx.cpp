@@ -3,7 +3,7 @@
  *
  * Written by Erik Tromp
  *
- * Version 0.4.1 - September, 2024
+ * Version 0.4.2 - October, 2026
  *
  * MIT license, all text above must be included in any redistribution.
  */
@@ -13,13 +13,215 @@
 
 #ifdef ARDUINO_ARCH_ESP32
   #include <esp_task_wdt.h>
+  #include <esp_timer.h>  // esp_timer_get_time
+  #include <esp_sleep.h>  // esp_light_sleep_start
+  #include <driver/gpio.h>  // gpio_wakeup_enable
+  #include <esp_intr_alloc.h>  // esp_intr_alloc
+  #include <soc/gpio_struct.h>  // GPIO
   #define wdt_reset() esp_task_wdt_reset()
 #else
   #include <Esp.h>  // wdt_reset
+  #include <Schedule.h>  // schedule_function
+  extern "C" {
+    #include <user_interface.h>  // wifi_fpm_do_sleep
+    #include <gpio.h>  // gpio_pin_wakeup_enable
+  }
 #endif
 
 static const uint16_t VAN_CRC_POLYNOM = 0x0F9D;
 
+#if defined VAN_CRC_SLICING_BY_4
+
+// Lookup tables for calculating the CRC four bytes at a time ("slicing-by-4"). The CRC register is kept
+// left-aligned in 16 bits. Entry i of crcTables[k] is the CRC register after byte i, followed by k zero bytes.
+static uint16_t crcTables[4][256] =
+{
+    {
+        0x0000, 0x1F3A, 0x3E74, 0x214E, 0x7CE8, 0x63D2, 0x429C, 0x5DA6,
+        0xF9D0, 0xE6EA, 0xC7A4, 0xD89E, 0x8538, 0x9A02, 0xBB4C, 0xA476,
+        0xEC9A, 0xF3A0, 0xD2EE, 0xCDD4, 0x9072, 0x8F48, 0xAE06, 0xB13C,
+        0x154A, 0x0A70, 0x2B3E, 0x3404, 0x69A2, 0x7698, 0x57D6, 0x48EC,
+        0xC60E, 0xD934, 0xF87A, 0xE740, 0xBAE6, 0xA5DC, 0x8492, 0x9BA8,
+        0x3FDE, 0x20E4, 0x01AA, 0x1E90, 0x4336, 0x5C0C, 0x7D42, 0x6278,
+        0x2A94, 0x35AE, 0x14E0, 0x0BDA, 0x567C, 0x4946, 0x6808, 0x7732,
+        0xD344, 0xCC7E, 0xED30, 0xF20A, 0xAFAC, 0xB096, 0x91D8, 0x8EE2,
+        0x9326, 0x8C1C, 0xAD52, 0xB268, 0xEFCE, 0xF0F4, 0xD1BA, 0xCE80,
+        0x6AF6, 0x75CC, 0x5482, 0x4BB8, 0x161E, 0x0924, 0x286A, 0x3750,
+        0x7FBC, 0x6086, 0x41C8, 0x5EF2, 0x0354, 0x1C6E, 0x3D20, 0x221A,
+        0x866C, 0x9956, 0xB818, 0xA722, 0xFA84, 0xE5BE, 0xC4F0, 0xDBCA,
+        0x5528, 0x4A12, 0x6B5C, 0x7466, 0x29C0, 0x36FA, 0x17B4, 0x088E,
+        0xACF8, 0xB3C2, 0x928C, 0x8DB6, 0xD010, 0xCF2A, 0xEE64, 0xF15E,
+        0xB9B2, 0xA688, 0x87C6, 0x98FC, 0xC55A, 0xDA60, 0xFB2E, 0xE414,
+        0x4062, 0x5F58, 0x7E16, 0x612C, 0x3C8A, 0x23B0, 0x02FE, 0x1DC4,
+        0x3976, 0x264C, 0x0702, 0x1838, 0x459E, 0x5AA4, 0x7BEA, 0x64D0,
+        0xC0A6, 0xDF9C, 0xFED2, 0xE1E8, 0xBC4E, 0xA374, 0x823A, 0x9D00,
+        0xD5EC, 0xCAD6, 0xEB98, 0xF4A2, 0xA904, 0xB63E, 0x9770, 0x884A,
+        0x2C3C, 0x3306, 0x1248, 0x0D72, 0x50D4, 0x4FEE, 0x6EA0, 0x719A,
+        0xFF78, 0xE042, 0xC10C, 0xDE36, 0x8390, 0x9CAA, 0xBDE4, 0xA2DE,
+        0x06A8, 0x1992, 0x38DC, 0x27E6, 0x7A40, 0x657A, 0x4434, 0x5B0E,
+        0x13E2, 0x0CD8, 0x2D96, 0x32AC, 0x6F0A, 0x7030, 0x517E, 0x4E44,
+        0xEA32, 0xF508, 0xD446, 0xCB7C, 0x96DA, 0x89E0, 0xA8AE, 0xB794,
+        0xAA50, 0xB56A, 0x9424, 0x8B1E, 0xD6B8, 0xC982, 0xE8CC, 0xF7F6,
+        0x5380, 0x4CBA, 0x6DF4, 0x72CE, 0x2F68, 0x3052, 0x111C, 0x0E26,
+        0x46CA, 0x59F0, 0x78BE, 0x6784, 0x3A22, 0x2518, 0x0456, 0x1B6C,
+        0xBF1A, 0xA020, 0x816E, 0x9E54, 0xC3F2, 0xDCC8, 0xFD86, 0xE2BC,
+        0x6C5E, 0x7364, 0x522A, 0x4D10, 0x10B6, 0x0F8C, 0x2EC2, 0x31F8,
+        0x958E, 0x8AB4, 0xABFA, 0xB4C0, 0xE966, 0xF65C, 0xD712, 0xC828,
+        0x80C4, 0x9FFE, 0xBEB0, 0xA18A, 0xFC2C, 0xE316, 0xC258, 0xDD62,
+        0x7914, 0x662E, 0x4760, 0x585A, 0x05FC, 0x1AC6, 0x3B88, 0x24B2,
+    },
+    {
+        0x0000, 0x72EC, 0xE5D8, 0x9734, 0xD48A, 0xA666, 0x3152, 0x43BE,
+        0xB62E, 0xC4C2, 0x53F6, 0x211A, 0x62A4, 0x1048, 0x877C, 0xF590,
+        0x7366, 0x018A, 0x96BE, 0xE452, 0xA7EC, 0xD500, 0x4234, 0x30D8,
+        0xC548, 0xB7A4, 0x2090, 0x527C, 0x11C2, 0x632E, 0xF41A, 0x86F6,
+        0xE6CC, 0x9420, 0x0314, 0x71F8, 0x3246, 0x40AA, 0xD79E, 0xA572,
+        0x50E2, 0x220E, 0xB53A, 0xC7D6, 0x8468, 0xF684, 0x61B0, 0x135C,
+        0x95AA, 0xE746, 0x7072, 0x029E, 0x4120, 0x33CC, 0xA4F8, 0xD614,
+        0x2384, 0x5168, 0xC65C, 0xB4B0, 0xF70E, 0x85E2, 0x12D6, 0x603A,
+        0xD2A2, 0xA04E, 0x377A, 0x4596, 0x0628, 0x74C4, 0xE3F0, 0x911C,
+        0x648C, 0x1660, 0x8154, 0xF3B8, 0xB006, 0xC2EA, 0x55DE, 0x2732,
+        0xA1C4, 0xD328, 0x441C, 0x36F0, 0x754E, 0x07A2, 0x9096, 0xE27A,
+        0x17EA, 0x6506, 0xF232, 0x80DE, 0xC360, 0xB18C, 0x26B8, 0x5454,
+        0x346E, 0x4682, 0xD1B6, 0xA35A, 0xE0E4, 0x9208, 0x053C, 0x77D0,
+        0x8240, 0xF0AC, 0x6798, 0x1574, 0x56CA, 0x2426, 0xB312, 0xC1FE,
+        0x4708, 0x35E4, 0xA2D0, 0xD03C, 0x9382, 0xE16E, 0x765A, 0x04B6,
+        0xF126, 0x83CA, 0x14FE, 0x6612, 0x25AC, 0x5740, 0xC074, 0xB298,
+        0xBA7E, 0xC892, 0x5FA6, 0x2D4A, 0x6EF4, 0x1C18, 0x8B2C, 0xF9C0,
+        0x0C50, 0x7EBC, 0xE988, 0x9B64, 0xD8DA, 0xAA36, 0x3D02, 0x4FEE,
+        0xC918, 0xBBF4, 0x2CC0, 0x5E2C, 0x1D92, 0x6F7E, 0xF84A, 0x8AA6,
+        0x7F36, 0x0DDA, 0x9AEE, 0xE802, 0xABBC, 0xD950, 0x4E64, 0x3C88,
+        0x5CB2, 0x2E5E, 0xB96A, 0xCB86, 0x8838, 0xFAD4, 0x6DE0, 0x1F0C,
+        0xEA9C, 0x9870, 0x0F44, 0x7DA8, 0x3E16, 0x4CFA, 0xDBCE, 0xA922,
+        0x2FD4, 0x5D38, 0xCA0C, 0xB8E0, 0xFB5E, 0x89B2, 0x1E86, 0x6C6A,
+        0x99FA, 0xEB16, 0x7C22, 0x0ECE, 0x4D70, 0x3F9C, 0xA8A8, 0xDA44,
+        0x68DC, 0x1A30, 0x8D04, 0xFFE8, 0xBC56, 0xCEBA, 0x598E, 0x2B62,
+        0xDEF2, 0xAC1E, 0x3B2A, 0x49C6, 0x0A78, 0x7894, 0xEFA0, 0x9D4C,
+        0x1BBA, 0x6956, 0xFE62, 0x8C8E, 0xCF30, 0xBDDC, 0x2AE8, 0x5804,
+        0xAD94, 0xDF78, 0x484C, 0x3AA0, 0x791E, 0x0BF2, 0x9CC6, 0xEE2A,
+        0x8E10, 0xFCFC, 0x6BC8, 0x1924, 0x5A9A, 0x2876, 0xBF42, 0xCDAE,
+        0x383E, 0x4AD2, 0xDDE6, 0xAF0A, 0xECB4, 0x9E58, 0x096C, 0x7B80,
+        0xFD76, 0x8F9A, 0x18AE, 0x6A42, 0x29FC, 0x5B10, 0xCC24, 0xBEC8,
+        0x4B58, 0x39B4, 0xAE80, 0xDC6C, 0x9FD2, 0xED3E, 0x7A0A, 0x08E6,
+    },
+    {
+        0x0000, 0x6BC6, 0xD78C, 0xBC4A, 0xB022, 0xDBE4, 0x67AE, 0x0C68,
+        0x7F7E, 0x14B8, 0xA8F2, 0xC334, 0xCF5C, 0xA49A, 0x18D0, 0x7316,
+        0xFEFC, 0x953A, 0x2970, 0x42B6, 0x4EDE, 0x2518, 0x9952, 0xF294,
+        0x8182, 0xEA44, 0x560E, 0x3DC8, 0x31A0, 0x5A66, 0xE62C, 0x8DEA,
+        0xE2C2, 0x8904, 0x354E, 0x5E88, 0x52E0, 0x3926, 0x856C, 0xEEAA,
+        0x9DBC, 0xF67A, 0x4A30, 0x21F6, 0x2D9E, 0x4658, 0xFA12, 0x91D4,
+        0x1C3E, 0x77F8, 0xCBB2, 0xA074, 0xAC1C, 0xC7DA, 0x7B90, 0x1056,
+        0x6340, 0x0886, 0xB4CC, 0xDF0A, 0xD362, 0xB8A4, 0x04EE, 0x6F28,
+        0xDABE, 0xB178, 0x0D32, 0x66F4, 0x6A9C, 0x015A, 0xBD10, 0xD6D6,
+        0xA5C0, 0xCE06, 0x724C, 0x198A, 0x15E2, 0x7E24, 0xC26E, 0xA9A8,
+        0x2442, 0x4F84, 0xF3CE, 0x9808, 0x9460, 0xFFA6, 0x43EC, 0x282A,
+        0x5B3C, 0x30FA, 0x8CB0, 0xE776, 0xEB1E, 0x80D8, 0x3C92, 0x5754,
+        0x387C, 0x53BA, 0xEFF0, 0x8436, 0x885E, 0xE398, 0x5FD2, 0x3414,
+        0x4702, 0x2CC4, 0x908E, 0xFB48, 0xF720, 0x9CE6, 0x20AC, 0x4B6A,
+        0xC680, 0xAD46, 0x110C, 0x7ACA, 0x76A2, 0x1D64, 0xA12E, 0xCAE8,
+        0xB9FE, 0xD238, 0x6E72, 0x05B4, 0x09DC, 0x621A, 0xDE50, 0xB596,
+        0xAA46, 0xC180, 0x7DCA, 0x160C, 0x1A64, 0x71A2, 0xCDE8, 0xA62E,
+        0xD538, 0xBEFE, 0x02B4, 0x6972, 0x651A, 0x0EDC, 0xB296, 0xD950,
+        0x54BA, 0x3F7C, 0x8336, 0xE8F0, 0xE498, 0x8F5E, 0x3314, 0x58D2,
+        0x2BC4, 0x4002, 0xFC48, 0x978E, 0x9BE6, 0xF020, 0x4C6A, 0x27AC,
+        0x4884, 0x2342, 0x9F08, 0xF4CE, 0xF8A6, 0x9360, 0x2F2A, 0x44EC,
+        0x37FA, 0x5C3C, 0xE076, 0x8BB0, 0x87D8, 0xEC1E, 0x5054, 0x3B92,
+        0xB678, 0xDDBE, 0x61F4, 0x0A32, 0x065A, 0x6D9C, 0xD1D6, 0xBA10,
+        0xC906, 0xA2C0, 0x1E8A, 0x754C, 0x7924, 0x12E2, 0xAEA8, 0xC56E,
+        0x70F8, 0x1B3E, 0xA774, 0xCCB2, 0xC0DA, 0xAB1C, 0x1756, 0x7C90,
+        0x0F86, 0x6440, 0xD80A, 0xB3CC, 0xBFA4, 0xD462, 0x6828, 0x03EE,
+        0x8E04, 0xE5C2, 0x5988, 0x324E, 0x3E26, 0x55E0, 0xE9AA, 0x826C,
+        0xF17A, 0x9ABC, 0x26F6, 0x4D30, 0x4158, 0x2A9E, 0x96D4, 0xFD12,
+        0x923A, 0xF9FC, 0x45B6, 0x2E70, 0x2218, 0x49DE, 0xF594, 0x9E52,
+        0xED44, 0x8682, 0x3AC8, 0x510E, 0x5D66, 0x36A0, 0x8AEA, 0xE12C,
+        0x6CC6, 0x0700, 0xBB4A, 0xD08C, 0xDCE4, 0xB722, 0x0B68, 0x60AE,
+        0x13B8, 0x787E, 0xC434, 0xAFF2, 0xA39A, 0xC85C, 0x7416, 0x1FD0,
+    },
+    {
+        0x0000, 0x4BB6, 0x976C, 0xDCDA, 0x31E2, 0x7A54, 0xA68E, 0xED38,
+        0x63C4, 0x2872, 0xF4A8, 0xBF1E, 0x5226, 0x1990, 0xC54A, 0x8EFC,
+        0xC788, 0x8C3E, 0x50E4, 0x1B52, 0xF66A, 0xBDDC, 0x6106, 0x2AB0,
+        0xA44C, 0xEFFA, 0x3320, 0x7896, 0x95AE, 0xDE18, 0x02C2, 0x4974,
+        0x902A, 0xDB9C, 0x0746, 0x4CF0, 0xA1C8, 0xEA7E, 0x36A4, 0x7D12,
+        0xF3EE, 0xB858, 0x6482, 0x2F34, 0xC20C, 0x89BA, 0x5560, 0x1ED6,
+        0x57A2, 0x1C14, 0xC0CE, 0x8B78, 0x6640, 0x2DF6, 0xF12C, 0xBA9A,
+        0x3466, 0x7FD0, 0xA30A, 0xE8BC, 0x0584, 0x4E32, 0x92E8, 0xD95E,
+        0x3F6E, 0x74D8, 0xA802, 0xE3B4, 0x0E8C, 0x453A, 0x99E0, 0xD256,
+        0x5CAA, 0x171C, 0xCBC6, 0x8070, 0x6D48, 0x26FE, 0xFA24, 0xB192,
+        0xF8E6, 0xB350, 0x6F8A, 0x243C, 0xC904, 0x82B2, 0x5E68, 0x15DE,
+        0x9B22, 0xD094, 0x0C4E, 0x47F8, 0xAAC0, 0xE176, 0x3DAC, 0x761A,
+        0xAF44, 0xE4F2, 0x3828, 0x739E, 0x9EA6, 0xD510, 0x09CA, 0x427C,
+        0xCC80, 0x8736, 0x5BEC, 0x105A, 0xFD62, 0xB6D4, 0x6A0E, 0x21B8,
+        0x68CC, 0x237A, 0xFFA0, 0xB416, 0x592E, 0x1298, 0xCE42, 0x85F4,
+        0x0B08, 0x40BE, 0x9C64, 0xD7D2, 0x3AEA, 0x715C, 0xAD86, 0xE630,
+        0x7EDC, 0x356A, 0xE9B0, 0xA206, 0x4F3E, 0x0488, 0xD852, 0x93E4,
+        0x1D18, 0x56AE, 0x8A74, 0xC1C2, 0x2CFA, 0x674C, 0xBB96, 0xF020,
+        0xB954, 0xF2E2, 0x2E38, 0x658E, 0x88B6, 0xC300, 0x1FDA, 0x546C,
+        0xDA90, 0x9126, 0x4DFC, 0x064A, 0xEB72, 0xA0C4, 0x7C1E, 0x37A8,
+        0xEEF6, 0xA540, 0x799A, 0x322C, 0xDF14, 0x94A2, 0x4878, 0x03CE,
+        0x8D32, 0xC684, 0x1A5E, 0x51E8, 0xBCD0, 0xF766, 0x2BBC, 0x600A,
+        0x297E, 0x62C8, 0xBE12, 0xF5A4, 0x189C, 0x532A, 0x8FF0, 0xC446,
+        0x4ABA, 0x010C, 0xDDD6, 0x9660, 0x7B58, 0x30EE, 0xEC34, 0xA782,
+        0x41B2, 0x0A04, 0xD6DE, 0x9D68, 0x7050, 0x3BE6, 0xE73C, 0xAC8A,
+        0x2276, 0x69C0, 0xB51A, 0xFEAC, 0x1394, 0x5822, 0x84F8, 0xCF4E,
+        0x863A, 0xCD8C, 0x1156, 0x5AE0, 0xB7D8, 0xFC6E, 0x20B4, 0x6B02,
+        0xE5FE, 0xAE48, 0x7292, 0x3924, 0xD41C, 0x9FAA, 0x4370, 0x08C6,
+        0xD198, 0x9A2E, 0x46F4, 0x0D42, 0xE07A, 0xABCC, 0x7716, 0x3CA0,
+        0xB25C, 0xF9EA, 0x2530, 0x6E86, 0x83BE, 0xC808, 0x14D2, 0x5F64,
+        0x1610, 0x5DA6, 0x817C, 0xCACA, 0x27F2, 0x6C44, 0xB09E, 0xFB28,
+        0x75D4, 0x3E62, 0xE2B8, 0xA90E, 0x4436, 0x0F80, 0xD35A, 0x98EC,
+    },
+};
+// Above tables are generated by:
+//
+// void _initCrcTables()
+// {
+//     for (int i = 0; i < 256; i++)
+//     {
+//         uint16_t crc = i << 8;
+//         for (uint8_t bit = 0; bit < 8; bit++)
+//         {
+//             if (crc & 0x8000) crc = (crc << 1) ^ (VAN_CRC_POLYNOM << 1); else crc <<= 1;
+//         }
+//         crcTables[0][i] = crc;
+//     } // for
+//
+//     for (int k = 1; k < 4; k++)
+//     {
+//         for (int i = 0; i < 256; i++)
+//         {
+//             const uint16_t crc = crcTables[k - 1][i];
+//             crcTables[k][i] = (crc << 8) ^ crcTables[0][crc >> 8];
+//         } // for
+//     } // for
+// } // _initCrcTables
+
+#elif defined VAN_CRC_NIBBLE_TABLE
+
+// Lookup table for calculating the CRC half a byte at a time. The CRC register is kept left-aligned in 16 bits.
+static uint16_t crcNibbleTable[16] =
+{
+    0x0000, 0x1F3A, 0x3E74, 0x214E, 0x7CE8, 0x63D2, 0x429C, 0x5DA6,
+    0xF9D0, 0xE6EA, 0xC7A4, 0xD89E, 0x8538, 0x9A02, 0xBB4C, 0xA476,
+};
+// Above table is generated by:
+//
+// void _initCrcNibbleTable()
+// {
+//     for (int i = 0; i < 16; i++)
+//     {
+//         uint16_t crc = i << 12;
+//         for (uint8_t bit = 0; bit < 4; bit++)
+//         {
+//             if (crc & 0x8000) crc = (crc << 1) ^ (VAN_CRC_POLYNOM << 1); else crc <<= 1;
+//         }
+//         crcNibbleTable[i] = crc;
+//     } // for
+// } // _initCrcNibbleTable
+
+#else
+
 #define VAN_CRC_TABLE_SIZE 256
 static uint16_t crcTable[VAN_CRC_TABLE_SIZE] = 
 {
@@ -77,11 +279,144 @@ static uint16_t crcTable[VAN_CRC_TABLE_SIZE] =
 // See also: https://github.com/0xCAFEDECAF/VanBus/blob/0ef35582dbcc6809175b3e11802e1eb84c561fb2/VanBusRx.cpp#L30
 //
 
-uint16_t _crc(const uint8_t bytes[], int size)
+#endif // VAN_CRC_SLICING_BY_4
+
+// The CRC is linear: flipping a bit in a packet changes the CRC check value by a fixed pattern (the "syndrome") that
+// depends only on the distance of that bit to the end of the packet. Index 0 is the LSB of the last byte (LSB of the
+// CRC field), index 255 is the MSB of byte 1 in a packet of the maximum size (byte 0, the SOF, does not count for
+// CRC).
+#define VAN_CRC_SYNDROME_TABLE_SIZE ((VAN_MAX_PACKET_SIZE - 1) * 8)
+static const uint16_t crcBitSyndromeTable[VAN_CRC_SYNDROME_TABLE_SIZE] =
+{
+    0x0F9D, 0x1F3A, 0x3E74, 0x7CE8, 0x764D, 0x6307, 0x4993, 0x1CBB,
+    0x3976, 0x72EC, 0x6A45, 0x5B17, 0x39B3, 0x7366, 0x6951, 0x5D3F,
+    0x35E3, 0x6BC6, 0x5811, 0x3FBF, 0x7F7E, 0x7161, 0x6D5F, 0x5523,
+    0x25DB, 0x4BB6, 0x18F1, 0x31E2, 0x63C4, 0x4815, 0x1FB7, 0x3F6E,
+    0x7EDC, 0x7225, 0x6BD7, 0x5833, 0x3FFB, 0x7FF6, 0x7071, 0x6F7F,
+    0x5163, 0x2D5B, 0x5AB6, 0x3AF1, 0x75E2, 0x6459, 0x472F, 0x01C3,
+    0x0386, 0x070C, 0x0E18, 0x1C30, 0x3860, 0x70C0, 0x6E1D, 0x53A7,
+    0x28D3, 0x51A6, 0x2CD1, 0x59A2, 0x3CD9, 0x79B2, 0x7CF9, 0x766F,
+    0x6343, 0x491B, 0x1DAB, 0x3B56, 0x76AC, 0x62C5, 0x4A17, 0x1BB3,
+    0x3766, 0x6ECC, 0x5205, 0x2B97, 0x572E, 0x21C1, 0x4382, 0x0899,
+    0x1132, 0x2264, 0x44C8, 0x060D, 0x0C1A, 0x1834, 0x3068, 0x60D0,
+    0x4E3D, 0x13E7, 0x27CE, 0x4F9C, 0x10A5, 0x214A, 0x4294, 0x0AB5,
+    0x156A, 0x2AD4, 0x55A8, 0x24CD, 0x499A, 0x1CA9, 0x3952, 0x72A4,
+    0x6AD5, 0x5A37, 0x3BF3, 0x77E6, 0x6051, 0x4F3F, 0x11E3, 0x23C6,
+    0x478C, 0x0085, 0x010A, 0x0214, 0x0428, 0x0850, 0x10A0, 0x2140,
+    0x4280, 0x0A9D, 0x153A, 0x2A74, 0x54E8, 0x264D, 0x4C9A, 0x16A9,
+    0x2D52, 0x5AA4, 0x3AD5, 0x75AA, 0x64C9, 0x460F, 0x0383, 0x0706,
+    0x0E0C, 0x1C18, 0x3830, 0x7060, 0x6F5D, 0x5127, 0x2DD3, 0x5BA6,
+    0x38D1, 0x71A2, 0x6CD9, 0x562F, 0x23C3, 0x4786, 0x0091, 0x0122,
+    0x0244, 0x0488, 0x0910, 0x1220, 0x2440, 0x4880, 0x1E9D, 0x3D3A,
+    0x7A74, 0x7B75, 0x7977, 0x7D73, 0x757B, 0x656B, 0x454B, 0x050B,
+    0x0A16, 0x142C, 0x2858, 0x50B0, 0x2EFD, 0x5DFA, 0x3469, 0x68D2,
+    0x5E39, 0x33EF, 0x67DE, 0x4021, 0x0FDF, 0x1FBE, 0x3F7C, 0x7EF8,
+    0x726D, 0x6B47, 0x5913, 0x3DBB, 0x7B76, 0x7971, 0x7D7F, 0x7563,
+    0x655B, 0x452B, 0x05CB, 0x0B96, 0x172C, 0x2E58, 0x5CB0, 0x36FD,
+    0x6DFA, 0x5469, 0x274F, 0x4E9E, 0x12A1, 0x2542, 0x4A84, 0x1A95,
+    0x352A, 0x6A54, 0x5B35, 0x39F7, 0x73EE, 0x6841, 0x5F1F, 0x31A3,
+    0x6346, 0x4911, 0x1DBF, 0x3B7E, 0x76FC, 0x6265, 0x4B57, 0x1933,
+    0x3266, 0x64CC, 0x4605, 0x0397, 0x072E, 0x0E5C, 0x1CB8, 0x3970,
+    0x72E0, 0x6A5D, 0x5B27, 0x39D3, 0x73A6, 0x68D1, 0x5E3F, 0x33E3,
+    0x67C6, 0x4011, 0x0FBF, 0x1F7E, 0x3EFC, 0x7DF8, 0x746D, 0x6747,
+    0x4113, 0x0DBB, 0x1B76, 0x36EC, 0x6DD8, 0x542D, 0x27C7, 0x4F8E,
+};
+// Above table is generated by:
+//
+// void _initCrcBitSyndromeTable()
+// {
+//     uint16_t syndrome = VAN_CRC_POLYNOM;  // Bit at distance 0 from the end
+//     for (int i = 0; i < VAN_CRC_SYNDROME_TABLE_SIZE; i++)
+//     {
+//         crcBitSyndromeTable[i] = syndrome;
+//         if (syndrome & 0x4000) syndrome = (syndrome << 1) ^ VAN_CRC_POLYNOM; else syndrome <<= 1;
+//         syndrome &= 0x7FFF;
+//     } // for
+// } // _initCrcBitSyndromeTable
+
+// Error locators: indexes into crcBitSyndromeTable, sorted by ascending syndrome value, so that the position of a
+// single bit error, or of two consecutive bit errors, can be found by a binary search on the observed syndrome.
+// Within the maximum packet size, all these syndromes are unique.
+static const uint8_t crcOneBitErrorLocator[VAN_CRC_SYNDROME_TABLE_SIZE] =
+{
+    0x71, 0x96, 0x72, 0x97, 0x2F, 0x73, 0x98, 0x86, 0x30, 0xE3, 0x74, 0x99, 0xA7, 0xC2, 0x53, 0x87,
+    0x31, 0xE4, 0x75, 0x4F, 0x9A, 0xA8, 0x79, 0x5F, 0xC3, 0x54, 0xF9, 0x88, 0x32, 0xE5, 0x00, 0xF2,
+    0xB4, 0x76, 0x5C, 0x50, 0x6E, 0x9B, 0xCC, 0x59, 0xA9, 0x7A, 0x60, 0x7F, 0xC4, 0x55, 0x1A, 0xDF,
+    0xCF, 0xFA, 0x47, 0x89, 0x33, 0x65, 0xE6, 0x07, 0x42, 0xDA, 0x9E, 0x01, 0xF3, 0x1E, 0xB5, 0x77,
+    0x5D, 0x4D, 0x51, 0x94, 0x6F, 0x9C, 0x63, 0xCD, 0x18, 0x7D, 0xCA, 0xFE, 0x5A, 0xAA, 0x38, 0x7B,
+    0x61, 0x4B, 0x3A, 0x80, 0x29, 0x8E, 0xC5, 0xAC, 0x56, 0xD7, 0x1B, 0xE0, 0xEF, 0xB1, 0xAE, 0xD0,
+    0x10, 0xFB, 0xC7, 0x48, 0x8A, 0x34, 0x90, 0x66, 0xE7, 0x08, 0x0C, 0xEB, 0xD3, 0x82, 0x2B, 0x43,
+    0xDB, 0x6A, 0x3C, 0x9F, 0xBB, 0x02, 0xF4, 0x1F, 0xB6, 0x13, 0x24, 0xF1, 0xB3, 0xF8, 0x78, 0x5E,
+    0x4E, 0x52, 0xC1, 0xA6, 0xE2, 0x85, 0x2E, 0x95, 0x70, 0x1D, 0x9D, 0xD9, 0x41, 0x06, 0x64, 0x46,
+    0xCE, 0xDE, 0x19, 0x7E, 0x58, 0xCB, 0x6D, 0xFF, 0x5B, 0xAB, 0x8D, 0x28, 0x39, 0x4A, 0x37, 0xFD,
+    0xC9, 0x7C, 0x17, 0x62, 0x93, 0x4C, 0x12, 0x23, 0xBA, 0x3B, 0x69, 0x81, 0x2A, 0x0B, 0xEA, 0xD2,
+    0x8F, 0xC6, 0x0F, 0xAD, 0xB0, 0xEE, 0xD6, 0x6C, 0x57, 0xDD, 0x45, 0x05, 0x40, 0xD8, 0x1C, 0x2D,
+    0x84, 0xE1, 0xC0, 0xA5, 0xF7, 0xF0, 0xB2, 0xD5, 0xED, 0xAF, 0x0E, 0x0A, 0xD1, 0xE9, 0x68, 0xB9,
+    0x11, 0x22, 0x92, 0x16, 0xFC, 0xC8, 0x36, 0x49, 0x8C, 0x27, 0x8B, 0x26, 0x35, 0x15, 0x91, 0x21,
+    0xB8, 0x67, 0xE8, 0x09, 0x0D, 0xEC, 0xD4, 0xF6, 0xBF, 0xA4, 0x83, 0x2C, 0x04, 0x3F, 0x44, 0xDC,
+    0x6B, 0xBD, 0xA2, 0x3D, 0xA0, 0xA1, 0xBC, 0x03, 0x3E, 0xA3, 0xBE, 0xF5, 0x20, 0xB7, 0x14, 0x25,
+};
+
+static const uint8_t crcTwoConsecutiveBitErrorLocator[VAN_CRC_SYNDROME_TABLE_SIZE - 1] =
+{
+    0xA0, 0x71, 0x96, 0xA1, 0xBC, 0x2F, 0x72, 0x97, 0xA2, 0xBD, 0x86, 0x30, 0xE3, 0x3D, 0x73, 0x98,
+    0xA3, 0xBE, 0x87, 0x31, 0xE4, 0xF5, 0x53, 0x3E, 0x03, 0x74, 0xB7, 0x20, 0x99, 0x14, 0xC2, 0xA7,
+    0x25, 0xA4, 0xBF, 0xB4, 0x00, 0xF2, 0x83, 0x2C, 0x88, 0x32, 0xE5, 0xF6, 0x54, 0x44, 0xDC, 0x3F,
+    0x04, 0xF9, 0x6B, 0x67, 0x09, 0xE8, 0x75, 0xB8, 0x4F, 0x21, 0x0D, 0x9A, 0xEC, 0xD4, 0x15, 0xC3,
+    0x91, 0xA8, 0x35, 0x26, 0x8B, 0x79, 0x5F, 0xA5, 0xC0, 0xB5, 0x1E, 0x01, 0xF3, 0x84, 0xE1, 0x2D,
+    0x9E, 0x89, 0x33, 0xE6, 0x07, 0x65, 0xF7, 0xDA, 0x42, 0xF0, 0xB2, 0x55, 0x45, 0x1A, 0xDD, 0xD8,
+    0x40, 0x05, 0xDF, 0x1C, 0x47, 0xFA, 0x57, 0x6C, 0xCF, 0x68, 0x0A, 0xD1, 0xE9, 0x76, 0x5C, 0x6E,
+    0xB9, 0x50, 0x11, 0x22, 0x59, 0x0E, 0x9B, 0xAF, 0xED, 0xD5, 0xCC, 0x16, 0xC4, 0xC8, 0xFC, 0x92,
+    0x7F, 0xA9, 0x49, 0x36, 0x27, 0x8C, 0x7A, 0x60, 0x24, 0xA6, 0x13, 0xC1, 0xB6, 0x1F, 0x02, 0x52,
+    0xF4, 0x3C, 0x85, 0xE2, 0xBB, 0x2E, 0x70, 0x95, 0x9F, 0x78, 0x5E, 0x8A, 0x34, 0x90, 0xD3, 0xEB,
+    0x0C, 0x4E, 0xE7, 0x08, 0x66, 0x6A, 0xF8, 0xDB, 0x43, 0x2B, 0x82, 0xF1, 0xB3, 0xCE, 0x56, 0x46,
+    0x1B, 0xDE, 0xD7, 0x19, 0xEF, 0xB1, 0xD9, 0x41, 0x06, 0x64, 0x9D, 0xE0, 0x1D, 0x48, 0x7E, 0xC7,
+    0xFB, 0xCB, 0xAE, 0x58, 0x10, 0x6D, 0x5B, 0xD0, 0x2A, 0x81, 0x69, 0x4D, 0x0B, 0xD2, 0xEA, 0x8F,
+    0x77, 0x5D, 0x94, 0x6F, 0xBA, 0x3B, 0x51, 0x12, 0x23, 0xFE, 0x5A, 0x0F, 0xAD, 0xCA, 0xC6, 0x7D,
+    0x9C, 0x63, 0xB0, 0xEE, 0x18, 0xD6, 0xCD, 0x17, 0x62, 0x7C, 0xC5, 0xAC, 0xC9, 0xFD, 0x3A, 0x93,
+    0x8E, 0x4C, 0x29, 0x80, 0xAA, 0x38, 0x4A, 0x37, 0x28, 0x4B, 0x8D, 0x39, 0xAB, 0x7B, 0x61,
+};
+
+// Above tables are generated by sorting the indexes 0...255 (resp. 0...254) by ascending value of
+// crcBitSyndromeTable[i] (resp. crcBitSyndromeTable[i] ^ crcBitSyndromeTable[i + 1]).
+
+uint16_t _crcUpdate(uint16_t crc15, const uint8_t bytes[], int n)
 {
-    uint16_t crc15 = 0x7FFF;
+  #if defined VAN_CRC_SLICING_BY_4
+
+    uint16_t crc = crc15 << 1;  // Left-aligned
+
+    // The CRC register covers the first two of each four bytes
+    for (; n >= 4; n -= 4, bytes += 4)
+    {
+        crc =
+            crcTables[3][(uint8_t)((crc >> 8) ^ bytes[0])]
+            ^ crcTables[2][(uint8_t)(crc ^ bytes[1])]
+            ^ crcTables[1][bytes[2]]
+            ^ crcTables[0][bytes[3]];
+    } // for
+
+    // Remaining bytes, one at a time
+    for (; n > 0; n--, bytes++) crc = (uint16_t)((crc << 8) ^ crcTables[0][(uint8_t)((crc >> 8) ^ *bytes)]);
+
+    return crc >> 1;
+
+  #elif defined VAN_CRC_NIBBLE_TABLE
 
-    for (int i = 1; i < size - 2; i++)  // Skip first byte (SOF, 0x0E) and last 2 (CRC)
+    uint16_t crc = crc15 << 1;  // Left-aligned
+
+    for (int i = 0; i < n; i++)
+    {
+        // Most significant nibble first
+        crc = (uint16_t)((crc << 4) ^ crcNibbleTable[(crc >> 12) ^ (bytes[i] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ crcNibbleTable[(crc >> 12) ^ (bytes[i] & 0x0F)]);
+    } // for
+
+    return crc >> 1;
+
+  #else
+
+    for (int i = 0; i < n; i++)
     {
         uint8_t byte = bytes[i];
 
@@ -92,6 +427,56 @@ uint16_t _crc(const uint8_t bytes[], int size)
         crc15 = (uint16_t)((crc15 << 8) ^ (uint16_t)(crcTable[pos]));
     } // for
 
+    return crc15;
+
+  #endif // VAN_CRC_SLICING_BY_4
+} // _crcUpdate
+
+// Number of CPU cycles that the CPU cycle counter lags behind the system timer, modulo 2^32. Set by
+// '_rebaseCycleCount64'.
+static volatile uint32_t cycleCountOffset = 0;
+
+// The system timer value, converted to CPU cycles
+static inline __attribute__((always_inline)) uint64_t SystemTimerCycles()
+{
+  #ifdef ARDUINO_ARCH_ESP32
+    return (uint64_t)esp_timer_get_time() * (F_CPU / 1000000);
+  #else // ! ARDUINO_ARCH_ESP32
+    return micros64() * (F_CPU / 1000000);
+  #endif // ARDUINO_ARCH_ESP32
+} // SystemTimerCycles
+
+uint64_t IRAM_ATTR _cycleCount64(uint32_t cycles)
+{
+    const uint64_t approx = SystemTimerCycles();
+
+    // The CPU cycle counter and the system timer run from the same clock; after correcting for the time spent in
+    // light sleep ('cycleCountOffset'), the difference between the two is far less than 2^31 CPU cycles. So the
+    // nearest value with the same 32 least significant bits is the right one.
+    return approx + (int32_t)(cycles + cycleCountOffset - (uint32_t)approx);  // Arithmetic has safe roll-over
+} // _cycleCount64
+
+uint64_t _cycleCount64(uint32_t cycles, unsigned long nearMillis)
+{
+    // 'millis()' runs from the system timer, so go back from the current system timer value. This leaves an error
+    // of about a millisecond, far less than 2^31 CPU cycles.
+    const uint64_t now = SystemTimerCycles();
+    const uint32_t msAgo = millis() - nearMillis;  // Arithmetic has safe roll-over
+    const uint64_t approx = now - (uint64_t)msAgo * (F_CPU / 1000);
+    return approx + (int32_t)(cycles + cycleCountOffset - (uint32_t)approx);  // Arithmetic has safe roll-over
+} // _cycleCount64
+
+void _rebaseCycleCount64()
+{
+    const uint32_t cycles = ESP.getCycleCount();
+    cycleCountOffset = (uint32_t)SystemTimerCycles() - cycles;  // Arithmetic has safe roll-over
+} // _rebaseCycleCount64
+
+uint16_t _crc(const uint8_t bytes[], int size)
+{
+    // Skip first byte (SOF, 0x0E) and last 2 (CRC)
+    uint16_t crc15 = _crcUpdate(0x7FFF, bytes + 1, size - 3);
+
     crc15 ^= 0x7FFF;
     crc15 <<= 1;  // Shift left 1 bit to turn 15 bit result into 16 bit representation
 
@@ -128,51 +513,146 @@ uint16_t TVanPacketRxDesc::Crc() const
     return _crc(bytes, size);
 } // TVanPacketRxDesc::Crc
 
-// Checks the CRC value of a VAN packet
-bool TVanPacketRxDesc::CheckCrc() const
+// Returns the CRC syndrome of a VAN packet: 0 if the CRC value is correct, otherwise the XOR of the
+// crcBitSyndromeTable entries of the bits that are in error
+uint16_t TVanPacketRxDesc::CrcSyndrome() const
 {
-    uint16_t crc15 = 0x7FFF;
-
-    for (int i = 1; i < size; i++)  // Skip first byte (SOF, 0x0E)
-    {
-        uint8_t byte = bytes[i];
-
-        // XOR-in next input byte into MSB of crc, that's our new intermediate divident
-        uint8_t pos = (uint8_t)( (crc15 >> 7) ^ byte);
-
-        // Shift out the MSB used for division per lookup table and XOR with the remainder
-        crc15 = (uint16_t)((crc15 << 8) ^ (uint16_t)(crcTable[pos]));
-    } // for
+    // Skip first byte (SOF, 0x0E)
+    uint16_t crc15 = _crcUpdate(0x7FFF, bytes + 1, size - 1);
 
     crc15 &= 0x7FFF;
 
     // Packet is OK if crc15 == 0x19B7
-    return crc15 == 0x19B7;
+    return crc15 ^ 0x19B7;
+} // TVanPacketRxDesc::CrcSyndrome
+
+// Checks the CRC value of a VAN packet
+bool TVanPacketRxDesc::CheckCrc() const
+{
+    return CrcSyndrome() == 0;
 } // TVanPacketRxDesc::CheckCrc
 
+// Increases the "repair" counters, if wanted
+void TVanPacketRxDesc::CountRepair(
+    bool (TVanPacketRxDesc::*wantToCount)() const,
+    uint32_t* pCounter1,
+    uint32_t* pCounter2) const
+{
+    if (wantToCount != 0 && ! (this->*wantToCount)()) return;
+
+    // Increase general counters
+    TVanPacketRxQueue& rxQueue = RxQueue();
+    rxQueue.nCorrupt++;
+    rxQueue.nRepaired++;
+
+    // Increase specific counter(s)
+    (*pCounter1)++;
+    if (pCounter2) (*pCounter2)++;
+} // TVanPacketRxDesc::CountRepair
+
 // Checks the CRC value of a VAN packet. If OK, increases the "repair" counters.
 bool TVanPacketRxDesc::CheckCrcFix(bool (TVanPacketRxDesc::*wantToCount)() const, uint32_t* pCounter1, uint32_t* pCounter2)
 {
     if (CheckCrc())
     {
-        if (wantToCount == 0 || (this->*wantToCount)())
-        {
-            // Increase general counters
-            VanBusRx.nCorrupt++;
-            VanBusRx.nRepaired++;
-
-            // Increase specific counter(s)
-            (*pCounter1)++;
-            if (pCounter2) (*pCounter2)++;
-        } // if
+        CountRepair(wantToCount, pCounter1, pCounter2);
         return true;
     } // if
     return false;
 } // TVanPacketRxDesc::CheckCrcFix
 
-// CRC packet errors which can be fixed by inserting an extra bit indicate that the bit time measurements can be
-// extended somewhat.
-static long int addToBitTime = 0;
+// Returns the CRC syndrome of a bit at position 'atBit' (0 = LSB, 7 = MSB) in byte 'atByte'. Returns 0 for bits
+// that do not count for CRC, i.e. in byte 0 (SOF) or beyond the packet size.
+uint16_t TVanPacketRxDesc::BitSyndrome(int atByte, int atBit) const
+{
+    if (atByte < 1 || atByte >= size) return 0;
+    return crcBitSyndromeTable[(size - 1 - atByte) * 8 + atBit];
+} // TVanPacketRxDesc::BitSyndrome
+
+// Looks up which bit is to be flipped to repair a packet with the specified CRC syndrome. Returns the bit index
+// (distance from the end of the packet, see crcBitSyndromeTable), or -1 if flipping a single bit will not repair
+// the packet.
+int TVanPacketRxDesc::LocateOneBitError(uint16_t syndrome) const
+{
+    int lo = 0;
+    int hi = VAN_CRC_SYNDROME_TABLE_SIZE - 1;
+    while (lo <= hi)
+    {
+        const int mid = (lo + hi) / 2;
+        const uint8_t i = crcOneBitErrorLocator[mid];
+        const uint16_t s = crcBitSyndromeTable[i];
+
+        if (s == syndrome) return i < (size - 1) * 8 ? i : -1;  // Must be within the packet
+        if (s < syndrome) lo = mid + 1; else hi = mid - 1;
+    } // while
+    return -1;
+} // TVanPacketRxDesc::LocateOneBitError
+
+// Looks up which two consecutive bits are to be flipped to repair a packet with the specified CRC syndrome. Returns
+// the index of the last of the two bits (distance from the end of the packet, see crcBitSyndromeTable), or -1 if
+// flipping two consecutive bits will not repair the packet.
+int TVanPacketRxDesc::LocateTwoConsecutiveBitErrors(uint16_t syndrome) const
+{
+    int lo = 0;
+    int hi = VAN_CRC_SYNDROME_TABLE_SIZE - 2;
+    while (lo <= hi)
+    {
+        const int mid = (lo + hi) / 2;
+        const uint8_t i = crcTwoConsecutiveBitErrorLocator[mid];
+        const uint16_t s = crcBitSyndromeTable[i] ^ crcBitSyndromeTable[i + 1];
+
+        if (s == syndrome) return i + 1 < (size - 1) * 8 ? i : -1;  // Both bits must be within the packet
+        if (s < syndrome) lo = mid + 1; else hi = mid - 1;
+    } // while
+    return -1;
+} // TVanPacketRxDesc::LocateTwoConsecutiveBitErrors
+
+// Flips the bit at index 'i' (distance from the end of the packet, see crcBitSyndromeTable)
+void TVanPacketRxDesc::FlipBit(int i)
+{
+    bytes[size - 1 - (i >> 3)] ^= 1 << (i & 0x07);
+} // TVanPacketRxDesc::FlipBit
+
+// Returns the position of the bit at index 'i' (distance from the end of the packet, see crcBitSyndromeTable) in
+// the order of a bit-by-bit search: from byte 1 to the last byte, and within each byte from LSB to MSB
+int TVanPacketRxDesc::SearchOrder(int i) const
+{
+    return (size - 1 - (i >> 3)) * 8 + (i & 0x07);
+} // TVanPacketRxDesc::SearchOrder
+
+// Returns true if the bit at position 'atBit' (0 = LSB, 7 = MSB) in byte 'atByte', preceded by the bit value
+// 'prevBit', is the last bit in a sequence of equal bits, taking into account the Manchester bits
+bool TVanPacketRxDesc::IsLastOfEqualBits(int atByte, int atBit, bool prevBit) const
+{
+    const bool currBit = (bytes[atByte] & 1 << atBit) != 0;
+    if (prevBit != currBit) return false;
+
+    // After bit 4 or bit 0, there is the Manchester bit
+    if (atBit == 4 || atBit == 0) return true;
+
+    const bool nextBit = (bytes[atByte] & 1 << (atBit - 1)) != 0;
+    return currBit != nextBit;
+} // TVanPacketRxDesc::IsLastOfEqualBits
+
+// Returns the bit value with which IsLastOfEqualBits(...) must compare the bit at position 'atBit' in byte 'atByte'
+bool TVanPacketRxDesc::PrevBitOf(int atByte, int atBit) const
+{
+    // Previous bit in order of reception (MSB first)
+    if (atBit == 7)
+    {
+        atByte--;
+        atBit = 0;
+    }
+    else
+    {
+        atBit++;
+    } // if
+
+    const bool prevBit = (bytes[atByte] & 1 << atBit) != 0;
+
+    // After bit 4 or bit 0, there was the Manchester bit
+    return atBit == 4 || atBit == 0 ? ! prevBit : prevBit;
+} // TVanPacketRxDesc::PrevBitOf
 
 // Checks the CRC value of a VAN packet. If not, tries to repair it by flipping each bit.
 // Yes, we can sometimes repair a corrupt packet by flipping one or two bits :-)
@@ -183,23 +663,71 @@ static long int addToBitTime = 0;
 //
 //   if (! pkt.CheckCrcAndRepair(&TVanPacketRxDesc::IsSatnavPacket)) return -1; // Unrecoverable CRC error
 //
-// Note: let's keep the counters sane by calling this only once.
+// The outcome is kept with the packet (see 'IsRepaired'), so calling this more than once does not repeat the work,
+// nor does it increase the counters again. The outcome is also kept if the packet was already repaired by the
+// deferred repair (see 'TVanPacketRxQueue::SetRepairBudget'); 'wantToCount' is then ignored.
+//
+// The CRC is calculated only once. Since the CRC is linear, each candidate bit flip is checked by XOR-ing its
+// syndrome (see crcBitSyndromeTable) into the observed syndrome. Single and two consecutive bit errors are found
+// directly by looking up the observed syndrome in the error locator tables.
 bool TVanPacketRxDesc::CheckCrcAndRepair(bool (TVanPacketRxDesc::*wantToCount)() const)
 {
+    // Already done? Note: a packet skipped by the deferred repair was not tried yet.
+    if (crcStatus != VAN_RX_CRC_UNCHECKED && crcStatus != VAN_RX_CRC_REPAIR_SKIPPED)
+    {
+        return crcStatus != VAN_RX_CRC_ERROR;
+    } // if
+
+  #ifdef VAN_RX_STATS
+    const uint32_t start = ESP.getCycleCount();
+    const bool result = Repair(wantToCount);
+    RxQueue().stats._CountRepair(ESP.getCycleCount() - start);  // Arithmetic has safe roll-over
+    return result;
+  #else
+    return Repair(wantToCount);
+  #endif // VAN_RX_STATS
+} // TVanPacketRxDesc::CheckCrcAndRepair
+
+// Does the actual work for 'CheckCrcAndRepair'
+bool TVanPacketRxDesc::Repair(bool (TVanPacketRxDesc::*wantToCount)() const)
+{
+    uint16_t syndrome;
+    crcStatus = RepairQuick(wantToCount, syndrome);
+
+    if (crcStatus == VAN_RX_CRC_UNCHECKED)
+    {
+        int atByte1 = 1;
+        bool prevBit1 = false;
+        crcStatus = RepairTwoSeparateBits(wantToCount, syndrome, atByte1, prevBit1, 0);
+    } // if
+
+    return crcStatus != VAN_RX_CRC_ERROR;
+} // TVanPacketRxDesc::Repair
+
+// First stage of 'Repair': checks the CRC value, then tries all repairs except flipping two separate bits. Returns
+// VAN_RX_CRC_UNCHECKED if 'RepairTwoSeparateBits' must be tried next, passing the CRC syndrome as found here.
+PacketCrcStatus_t TVanPacketRxDesc::RepairQuick(bool (TVanPacketRxDesc::*wantToCount)() const, uint16_t& syndrome)
+{
+    TVanPacketRxQueue& rxQueue = RxQueue();
+
     uint8_t lastBit = bytes[size - 1] & 0x01;
 
     bytes[size - 1] &= 0xFE;  // Last bit of last byte (LSB of CRC) is always 0
 
-    if (CheckCrc())
+    syndrome = CrcSyndrome();
+
+    if (syndrome == 0)
     {
-        // Is flipping the last bit fixing the packet?
-        if (lastBit == 0x01 && (wantToCount == 0 || (this->*wantToCount)()))
+        if (lastBit != 0x01) return VAN_RX_CRC_OK;
+
+        // Flipping the last bit fixed the packet
+        if (wantToCount == 0 || (this->*wantToCount)())
         {
-            VanBusRx.nRepaired++;
-            VanBusRx.nOneBitErrors++;
-            VanBusRx.nCorrupt++;
+            rxQueue.nRepaired++;
+            rxQueue.nOneBitErrors++;
+            rxQueue.nCorrupt++;
         } // if
-        return true;
+        return VAN_RX_CRC_REPAIRED;
     } // if
 
     if (lastBit != 0x01)
@@ -215,6 +743,8 @@ bool TVanPacketRxDesc::CheckCrcAndRepair(bool (TVanPacketRxDesc::*wantToCount)()
         uint8_t savedBytes[VAN_MAX_PACKET_SIZE];
         memcpy(savedBytes, bytes, size);
 
+        uint16_t shiftedSyndrome = syndrome;
+
         // Byte 0 can be skipped; it does not count for CRC
         for (int atByte = size - 1; atByte > 0; atByte--)
         {
@@ -242,11 +772,18 @@ bool TVanPacketRxDesc::CheckCrcAndRepair(bool (TVanPacketRxDesc::*wantToCount)()
                 // 11 = 0001 0001 --> 0001 0000 --> 0000 0000 = 00
                 bytes[atByte] = (bytes[atByte] & invMask) | rBit;
 
-                if (CheckCrcFix(wantToCount, &VanBusRx.nBitDeletionErrors))
+                // This has flipped the bit at 'atBit - 1'
+                shiftedSyndrome ^= BitSyndrome(atByte, atBit - 1);
+
+                if (shiftedSyndrome == 0)
                 {
-                    addToBitTime += CPU_CYCLES(4);
-                    if (addToBitTime > CPU_CYCLES(20)) addToBitTime = CPU_CYCLES(20);
-                    return true;
+                    CountRepair(wantToCount, &rxQueue.nBitDeletionErrors);
+
+                  #ifndef VAN_RX_ADAPTIVE_BIT_TIMING
+                    rxQueue.decoder.addToBitTime += CPU_CYCLES(4);
+                    if (rxQueue.decoder.addToBitTime > CPU_CYCLES(20)) rxQueue.decoder.addToBitTime = CPU_CYCLES(20);
+                  #endif // VAN_RX_ADAPTIVE_BIT_TIMING
+                    return VAN_RX_CRC_REPAIRED;
                 } // if
             } // for
         } // for
@@ -255,184 +792,167 @@ bool TVanPacketRxDesc::CheckCrcAndRepair(bool (TVanPacketRxDesc::*wantToCount)()
         memcpy(bytes, savedBytes, size);
     } // if
 
+    uint16_t uncertainSyndrome = 0;
+    int uncertainAtByte = 0;
+    uint8_t uncertainMask = 0;
+
     if (uncertainBit1 != NO_UNCERTAIN_BIT)
     {
         // Flip the bit which is at the position that is marked as "uncertain"
 
-        int uncertainAtByte = (uncertainBit1 - 1) >> 3;
+        uncertainAtByte = (uncertainBit1 - 1) >> 3;
 
         int uncertainAtBit = (uncertainBit1 - 1) & 0x07;  // 0 = MSB, 7 = LSB
         uncertainAtBit = 7 - uncertainAtBit;  // 0 = LSB, 7 = MSB
 
-        uint8_t uncertainMask = 1 << uncertainAtBit;
-        bytes[uncertainAtByte] ^= uncertainMask;  // Flip
+        uncertainMask = 1 << uncertainAtBit;
+        uncertainSyndrome = BitSyndrome(uncertainAtByte, uncertainAtBit);
 
-        if (CheckCrcFix(wantToCount, &VanBusRx.nOneBitErrors, &VanBusRx.nUncertainBitErrors)) return true;
-
-        bytes[uncertainAtByte] ^= uncertainMask;  // Flip back
+        if (uncertainSyndrome == syndrome)
+        {
+            bytes[uncertainAtByte] ^= uncertainMask;  // Flip
+            CountRepair(wantToCount, &rxQueue.nOneBitErrors, &rxQueue.nUncertainBitErrors);
+            return VAN_RX_CRC_REPAIRED;
+        } // if
     } // if
 
     // One cycle without the uncertain bit flipped, plus (optionally) one cycle with the uncertain bit flipped
     for (int i = 0; i < (uncertainBit1 == NO_UNCERTAIN_BIT ? 1 : 2); i++)
     {
-        int uncertainAtByte;
-        uint8_t uncertainMask;
+        // Second cycle: pretend the bit which is at the position that is marked as "uncertain" is flipped
+        const uint16_t remainingSyndrome = i == 1 ? syndrome ^ uncertainSyndrome : syndrome;
 
-        // Second cycle?
-        if (i == 1)
-        {
-            // Flip the bit which is at the position that is marked as "uncertain"
-
-            uncertainAtByte = (uncertainBit1 - 1) >> 3;
+        // There is at most one single bit and at most one pair of consecutive bits that repairs the packet. If both
+        // exist, take the one that a bit-by-bit search would find first: going from byte 1 to the last byte, and
+        // within each byte from LSB to MSB, it tries at each bit first flipping that bit, then also flipping the
+        // preceding bit (the next higher bit index, see crcBitSyndromeTable).
+        const int oneBitAt = LocateOneBitError(remainingSyndrome);
+        const int twoBitsAt = LocateTwoConsecutiveBitErrors(remainingSyndrome);
 
-            int uncertainAtBit = (uncertainBit1 - 1) & 0x07;  // 0 = MSB, 7 = LSB
-            uncertainAtBit = 7 - uncertainAtBit;  // 0 = LSB, 7 = MSB
-
-            uncertainMask = 1 << uncertainAtBit;
-            bytes[uncertainAtByte] ^= uncertainMask;  // Flip
+        if (oneBitAt >= 0 && (twoBitsAt < 0 || SearchOrder(oneBitAt) <= SearchOrder(twoBitsAt)))
+        {
+            if (i == 1) bytes[uncertainAtByte] ^= uncertainMask;  // Flip
+            FlipBit(oneBitAt);
+            CountRepair(wantToCount, &rxQueue.nOneBitErrors);
+            if (i == 1) rxQueue.nUncertainBitErrors++;
+            return VAN_RX_CRC_REPAIRED;
         } // if
 
-        // Byte 0 can be skipped; it does not count for CRC
-        for (int atByte = 1; atByte < size; atByte++)
+        if (twoBitsAt >= 0)
         {
-            for (int atBit = 0; atBit < 8; atBit++)
-            {
-                uint8_t mask = 1 << atBit;
-                bytes[atByte] ^= mask;  // Flip
-
-                // TODO - is there a way to quickly re-calculate the CRC value when bit is flipped?
-
-                if (CheckCrcFix(wantToCount, &VanBusRx.nOneBitErrors))
-                {
-                    if (i == 1) VanBusRx.nUncertainBitErrors++;
-                    return true;
-                } // if
-
-                // Try also to flip the preceding bit
-                if (atBit != 7)
-                {
-                    uint8_t mask2 = 1 << (atBit + 1);
-                    bytes[atByte] ^= mask2;  // Flip
-
-                    if (CheckCrcFix(wantToCount, &VanBusRx.nTwoConsecutiveBitErrors))
-                    {
-                        if (i == 1) VanBusRx.nUncertainBitErrors++;
-                        return true;
-                    } // if
-
-                    bytes[atByte] ^= mask2;  // Flip back
-                }
-                else // atBit == 7
-                {
-                    // atByte > 0, so atByte - 1 is safe
-                    bytes[atByte - 1] ^= 1 << 0;  // Flip
-
-                    if (CheckCrcFix(wantToCount, &VanBusRx.nTwoConsecutiveBitErrors))
-                    {
-                        if (i == 1) VanBusRx.nUncertainBitErrors++;
-                        return true;
-                    } // if
-
-                    bytes[atByte - 1] ^= 1 << 0;  // Flip back
-                } // if
-
-                bytes[atByte] ^= mask;  // Flip back
-            } // for
-        } // for
-
-        if (i == 1) bytes[uncertainAtByte] ^= uncertainMask;  // Flip back
+            if (i == 1) bytes[uncertainAtByte] ^= uncertainMask;  // Flip
+            FlipBit(twoBitsAt);
+            FlipBit(twoBitsAt + 1);
+            CountRepair(wantToCount, &rxQueue.nTwoConsecutiveBitErrors);
+            if (i == 1) rxQueue.nUncertainBitErrors++;
+            return VAN_RX_CRC_REPAIRED;
+        } // if
     } // for
 
-    // Flip two bits. Getting to this point happens very rarely, luckily...
-
-    bool prevBit1 = false;
+    return VAN_RX_CRC_UNCHECKED;
+} // TVanPacketRxDesc::RepairQuick
+
+// Second stage of 'Repair': tries to flip two separate bits. Getting to this point happens very rarely, luckily...
+// This is by far the most time consuming stage, so it can be done in steps: the search starts at byte 'atByte1'
+// (start with 1), with 'prevBit1' the value of the bit just before it (start with false). If 'maxCycles' is not 0
+// and the time spent reaches 'maxCycles', stops after the current byte and returns VAN_RX_CRC_UNCHECKED; 'atByte1'
+// and 'prevBit1' are then updated, so that the next call continues the search.
+PacketCrcStatus_t TVanPacketRxDesc::RepairTwoSeparateBits(
+    bool (TVanPacketRxDesc::*wantToCount)() const,
+    uint16_t syndrome,
+    int& atByte1,
+    bool& prevBit1,
+    uint32_t maxCycles)
+{
+    TVanPacketRxQueue& rxQueue = RxQueue();
+    const uint32_t start = ESP.getCycleCount();
 
-    for (int atByte1 = 1; atByte1 < size; atByte1++)
+    for (; atByte1 < size; atByte1++)
     {
-        // This may take really long...
-        wdt_reset();
 
         for (int atBit1 = 7; atBit1 >= 0; atBit1--)
         {
             // Only flip the last bit in a sequence of equal bits; take into account the Manchester bits
 
-            uint8_t currMask1 = 1 << atBit1;
-            bool currBit1 = (bytes[atByte1] & currMask1) != 0;
-            bool skip1 = prevBit1 != currBit1;
+            const bool skip1 = ! IsLastOfEqualBits(atByte1, atBit1, prevBit1);
 
-            // After bit 4 or bit 0, there was the Manchester bit
-            if (atBit1 == 4 || atBit1 == 0)
-            {
-                prevBit1 = ! currBit1;
-            }
-            else
-            {
-                prevBit1 = currBit1;
-                uint8_t nextMask1 = 1 << (atBit1 - 1);
-                bool nextBit1 = (bytes[atByte1] & nextMask1) != 0;
-                skip1 = skip1 || (currBit1 == nextBit1);
-            } // if
+            const bool currBit1 = (bytes[atByte1] & 1 << atBit1) != 0;
+            prevBit1 = atBit1 == 4 || atBit1 == 0 ? ! currBit1 : currBit1;
 
             if (skip1) continue;
 
-            bytes[atByte1] ^= currMask1;  // Flip
-
-            // Flip second bit
-
-            bool prevBit2 = false;
+            // Which second bit would repair the packet? Thanks to the error locator, there is at most one candidate.
+            const int at2 = LocateOneBitError(syndrome ^ BitSyndrome(atByte1, atBit1));
+            if (at2 < 0) continue;
 
-            for (int atByte2 = atByte1; atByte2 < size; atByte2++)
-            {
-                for (int atBit2 = 7; atBit2 >= 0; atBit2--)
-                {
-                    // Only flip the last bit in a sequence of equal bits; take into account the Manchester bits
-
-                    uint8_t currMask2 = 1 << atBit2;
-                    bool currBit2 = (bytes[atByte2] & currMask2) != 0;
-                    bool skip2 = prevBit2 != currBit2;
-
-                    // After bit 4 or bit 0, there was the Manchester bit
-                    if (atBit2 == 4 || atBit2 == 0)
-                    {
-                        prevBit2 = ! currBit2;
-                    }
-                    else
-                    {
-                        prevBit2 = currBit2;
-                        uint8_t nextMask2 = 1 << (atBit2 - 1);
-                        bool nextBit2 = (bytes[atByte2] & nextMask2) != 0;
-                        skip2 = skip2 || (currBit2 == nextBit2);
-                    } // if
+            const int atByte2 = size - 1 - (at2 >> 3);
+            const int atBit2 = at2 & 0x07;
 
-                    if (skip2) continue;
+            // The second bit is searched for starting at the MSB of the same byte
+            if (atByte2 < atByte1) continue;
 
-                    bytes[atByte2] ^= currMask2;  // Flip
-
-                    if (CheckCrcFix(wantToCount, &VanBusRx.nTwoSeparateBitErrors)) return true;
+            const uint8_t currMask1 = 1 << atBit1;
+            bytes[atByte1] ^= currMask1;  // Flip
 
-                    bytes[atByte2] ^= currMask2;  // Flip back
-                } // for
-            } // for
+            // Only flip the last bit in a sequence of equal bits; take into account the Manchester bits
+            const bool prevBit2 = atByte2 == atByte1 && atBit2 == 7 ? false : PrevBitOf(atByte2, atBit2);
+            if (IsLastOfEqualBits(atByte2, atBit2, prevBit2))
+            {
+                bytes[atByte2] ^= 1 << atBit2;  // Flip
+                CountRepair(wantToCount, &rxQueue.nTwoSeparateBitErrors);
+                return VAN_RX_CRC_REPAIRED;
+            } // if
 
             bytes[atByte1] ^= currMask1;  // Flip back
         } // for
+
+        // Out of time? Then continue with the next byte at the next call.
+        if (maxCycles != 0 && atByte1 < size - 1 && ESP.getCycleCount() - start >= maxCycles)  // Safe roll-over
+        {
+            atByte1++;
+            return VAN_RX_CRC_UNCHECKED;
+        } // if
     } // for
 
-    if (wantToCount == 0 || (this->*wantToCount)()) VanBusRx.nCorrupt++;
+    if (wantToCount == 0 || (this->*wantToCount)()) rxQueue.nCorrupt++;
 
-    return false;
-} // TVanPacketRxDesc::CheckCrcAndRepair
+    return VAN_RX_CRC_ERROR;
+} // TVanPacketRxDesc::RepairTwoSeparateBits
+
+// Stores the packet time stamps, given as CPU cycle counter values. Only to be called from ISR, or from the task
+// decoding the packet.
+void IRAM_ATTR TVanPacketRxDesc::SetTimeStamps(uint32_t sofAt, uint32_t eofAt)
+{
+    this->eofAt = eofAt;
+    const uint32_t delta = (eofAt - sofAt) >> VAN_RX_SOF_DELTA_SHIFT;  // Arithmetic has safe roll-over
+    sofDelta = delta > UINT16_MAX ? UINT16_MAX : delta;
+} // TVanPacketRxDesc::SetTimeStamps
+
+// Number of CPU cycles from the start of the SOF until the end of the packet
+uint32_t IRAM_ATTR TVanPacketRxDesc::DurationCycles() const
+{
+    return (uint32_t)sofDelta << VAN_RX_SOF_DELTA_SHIFT;
+} // TVanPacketRxDesc::DurationCycles
 
 // Dumps the raw packet bytes to a stream (e.g. 'Serial').
 // Optionally specify the last character; default is "\n" (newline).
 // If the last character is "\n", will also print the ASCII representation of each byte (if possible).
 void TVanPacketRxDesc::DumpRaw(Stream& s, char last) const
 {
-    s.printf("Raw: #%04" PRIu32 " (%*" PRIu16 "/%d) %2d(%2d) ",
-        seqNo % 10000,
-        VanBusRx.size > 100 ? 3 : VanBusRx.size > 10 ? 2 : 1,
-        slot + 1,
-        VanBusRx.size,
+    const int queueSize = RxQueue().size;
+
+  #ifdef VAN_RX_COMPACT_DESC
+    // The queue slot is not stored; show where it would be without dropped packets, like VanLogToText does
+    const int slotNo = seqNo % queueSize + 1;
+  #else
+    const int slotNo = slot + 1;
+  #endif // VAN_RX_COMPACT_DESC
+
+    s.printf("Raw: #%04" PRIu32 " (%*d/%d) %2d(%2d) ",
+        (uint32_t)seqNo % 10000,
+        queueSize > 100 ? 3 : queueSize > 10 ? 2 : 1,
+        slotNo,
+        queueSize,
         size - 5 < 0 ? 0 : size - 5,
         size);
 
@@ -453,7 +973,7 @@ void TVanPacketRxDesc::DumpRaw(Stream& s, char last) const
     {
         // Print also ASCII character representation of each byte, if possible, otherwise a small center-dot
 
-        s.printf("\n%*s", VanBusRx.size > 100 ? 43 : VanBusRx.size > 10 ? 41 : 39, " ");
+        s.printf("\n%*s", queueSize > 100 ? 43 : queueSize > 10 ? 41 : 39, " ");
         for (int i = 3; i < size - 2; i++)
         {
             if (bytes[i] >= 0x20 && bytes[i] <= 0x7E) s.printf("%2c ", bytes[i]); else s.print(" \u00b7 ");
@@ -463,86 +983,77 @@ void TVanPacketRxDesc::DumpRaw(Stream& s, char last) const
     s.print(last);
 } // TVanPacketRxDesc::DumpRaw
 
-// Normal bit time (8 microseconds), expressed as number of CPU cycles
-#define VAN_NORMAL_BIT_TIME_CPU_CYCLES (CPU_CYCLES(667))
-
-inline __attribute__((always_inline)) unsigned int nBits(uint32_t nCycles)
-{
-    return (nCycles + CPU_CYCLES(200)) / VAN_NORMAL_BIT_TIME_CPU_CYCLES;
-} // nBits
-
-uint32_t averageOneBitTime = 0;
-
-// Calculate number of bits from a number of elapsed CPU cycles
-inline __attribute__((always_inline)) unsigned int nBitsTakingIntoAccountJitter(uint32_t nCycles, uint32_t& jitter)
+// Writes 'value' as unsigned LEB128 number: 7 bits per byte, least significant first; MSB set if more bytes follow
+static int WriteVarint(uint8_t* buf, uint32_t value)
 {
-    // Here is the heart of the machine; lots of voodoo magic here...
-
-    // Theory:
-    // - VAN bus rate = 125 kbit/sec = 125 000 bits/sec
-    //   1 bit = 1/125000 = 0.000008 sec = 8.0 usec
-    // - CPU rate is 80 MHz
-    //   1 cycle @ 80 MHz = 0.0000000125 sec = 0.0125 usec
-    // --> So, 1 VAN-bus bit is 8.0 / 0.0125 = 640 cycles
-
-    // Sometimes, samples are stretched, because the ISR is called too late: ESP8266 interrupt service latency can
-    // vary. If that happens, we must compress the "sample time" for the next bit.
-
-    // All timing values were found by trial and error
-    jitter = 0;
-
-    if (nCycles < CPU_CYCLES(555))
-    {
-        if (nCycles > CPU_CYCLES(112)) jitter = nCycles - CPU_CYCLES(112);
-        return 0;
-    } // if
-
-  #define ONE_BIT_BOUNDARY CPU_CYCLES(1281)
-    if (nCycles < ONE_BIT_BOUNDARY)
+    int n = 0;
+    while (value >= 0x80)
     {
-        if (nCycles > CPU_CYCLES(712)) jitter = nCycles - CPU_CYCLES(712);  // 712 --> 1281 = 569
-        return 1;
-    } // if
+        buf[n++] = value | 0x80;
+        value >>= 7;
+    } // while
+    buf[n++] = value;
+    return n;
+} // WriteVarint
+
+// Binary record format, as written by 'TVanPacketRxDesc::ToBinary'. Multi-byte numbers are little endian.
+// - SOF time stamp in microseconds, minus that of the previous record (LEB128, 1 ... 5 bytes)
+// - Status byte:
+//   bits 0-1: result (PacketReadResult_t)
+//   bit 2: ack (PacketAck_t)
+//   bit 3: followed by the uncertain bit position ('uBit' in 'DumpRaw'), 2 bytes
+//   bit 4: followed by the sequence number increment (LEB128); if clear, the increment is 1
+//   bit 5: SOF byte is not 0x0E: it is stored as first packet byte
+//   bits 6-7: 0 (reserved)
+// - Size byte: total number of bytes in the packet, including SOF and CRC, as shown by 'DumpRaw'
+// - Packet bytes: the SOF byte (only if status bit 5 is set), then the 12-bit IDEN and 4-bit COM flags, the data
+//   bytes and the 2 CRC bytes, as received
+// So a typical record with 'n' data bytes takes 8 + n bytes, versus around 100 + 6 * n characters of 'DumpRaw' text.
+int TVanPacketRxDesc::ToBinary(uint8_t* buf, uint32_t& prevMicros, uint32_t& prevSeqNo) const
+{
+    const uint32_t sofMicros = SofMicros();
+    int n = WriteVarint(buf, sofMicros - prevMicros);  // Arithmetic has safe roll-over
+    prevMicros = sofMicros;
 
-    if (nCycles < CPU_CYCLES(1863))
-    {
-        if (nCycles > CPU_CYCLES(1349)) jitter = nCycles - CPU_CYCLES(1349);  // 1349 --> 1863 = 514
-        return 2;
-    } // if
+    uint8_t* status = buf + n++;
+    *status = (result & 0x03) | (ack == VAN_NO_ACK ? 0x04 : 0);
 
-  #define THREE_BIT_BOUNDARY CPU_CYCLES(2500)
-    if (nCycles < THREE_BIT_BOUNDARY)
-    {
-        if (nCycles > CPU_CYCLES(1998)) jitter = nCycles - CPU_CYCLES(1998);  // 1998 --> 2500 = 502
-        return 3;
-    } // if
+  #ifdef VAN_RX_COMPACT_DESC
+    const uint32_t seqNoIncrement = (uint16_t)(seqNo - prevSeqNo);  // Only 16 bits are stored
+  #else
+    const uint32_t seqNoIncrement = seqNo - prevSeqNo;  // Arithmetic has safe roll-over
+  #endif // VAN_RX_COMPACT_DESC
 
-    if (nCycles < CPU_CYCLES(3166))
+    if (seqNoIncrement != 1)
     {
-        if (nCycles > CPU_CYCLES(2636)) jitter = nCycles - CPU_CYCLES(2636);  // 2636 --> 3166 = 530
-        return 4;
+        *status |= 0x10;
+        n += WriteVarint(buf + n, seqNoIncrement);
     } // if
+    prevSeqNo = seqNo;
 
-    if (nCycles < CPU_CYCLES(3819))
+    if (uncertainBit1 != NO_UNCERTAIN_BIT)
     {
-        if (nCycles > CPU_CYCLES(3262)) jitter = nCycles - CPU_CYCLES(3262);  // 3262 --> 3819 = 557
-        return 5;
+        *status |= 0x08;
+        buf[n++] = uncertainBit1 & 0xFF;
+        buf[n++] = uncertainBit1 >> 8;
     } // if
 
-    // We hardly ever get to this point
-    if (nCycles < CPU_CYCLES(4468))
+    int from = 1;
+    if (size >= 1 && bytes[0] != 0x0E)
     {
-        if (nCycles > CPU_CYCLES(3930)) jitter = nCycles - CPU_CYCLES(3930);  // 3930 --> 4468 = 538
-        return 6;
+        *status |= 0x20;
+        from = 0;
     } // if
 
-    const unsigned int _nBits = nBits(nCycles);
-    if (nCycles > _nBits * VAN_NORMAL_BIT_TIME_CPU_CYCLES) jitter = nCycles - _nBits * VAN_NORMAL_BIT_TIME_CPU_CYCLES;
+    buf[n++] = size;
+    for (int i = from; i < size; i++) buf[n++] = bytes[i];
 
-    return _nBits;
-} // nBitsTakingIntoAccountJitter
+    return n;
+} // TVanPacketRxDesc::ToBinary
 
-void IRAM_ATTR SetTxBitTimer()
+// Arms a single-shot timer that calls the transmitter ISR as soon as the bus has been idle for 'idleBits' bit times
+// (carrier sense). The transmitter ISR turns on the repetitive bit timer only when it actually starts transmitting.
+void IRAM_ATTR ArmTxTimer(unsigned int idleBits)
 {
   #ifdef ARDUINO_ARCH_ESP32
     timerAlarmDisable(timer);
@@ -552,12 +1063,24 @@ void IRAM_ATTR SetTxBitTimer()
 
     if (VanBusRx.txTimerIsr)
     {
-        // Turn on the Tx bit timer
+        // Timer ticks are 16 APB clock cycles (0.2 microseconds); 'txTimerTicks' is the time of one bit
+        const uint32_t ifsCycles = idleBits * VanBusRx.txTimerTicks * 16 * CPU_F_FACTOR;
+        const uint32_t idleCycles = ESP.getCycleCount() - VanBusRx.lastMediaAccessAt;  // Arithmetic has safe roll-over
+        uint32_t ticks = idleCycles < ifsCycles ? (ifsCycles - idleCycles) / (16 * CPU_F_FACTOR) : 0;
+        if (ticks < VanBusRx.txTimerTicks) ticks = VanBusRx.txTimerTicks;  // At least one bit time
+
+        // While a packet is being received, the timer is armed again at the end of that packet (see 'WaitAckIsr').
+        // The timeout here is then only a fall-back, in case the packet is broken off.
+        if (VanBusRx.decoder.state == VAN_RX_LOADING)
+        {
+            ticks = (VAN_MAX_PACKET_SIZE * 10 + VAN_CARRIER_SENSE_BITS) * VanBusRx.txTimerTicks;
+        } // if
 
       #ifdef ARDUINO_ARCH_ESP32
 
         timerAttachInterrupt(timer, VanBusRx.txTimerIsr, true);
-        timerAlarmWrite(timer, VanBusRx.txTimerTicks, true);
+        timerWrite(timer, 0);
+        timerAlarmWrite(timer, ticks, false);
         timerAlarmEnable(timer);
 
       #else // ! ARDUINO_ARCH_ESP32
@@ -565,158 +1088,213 @@ void IRAM_ATTR SetTxBitTimer()
         timer1_attachInterrupt(VanBusRx.txTimerIsr);
 
         // Clock to timer (prescaler) is always 80MHz, even F_CPU is 160 MHz
-        timer1_enable(TIM_DIV16, TIM_EDGE, TIM_LOOP);
+        timer1_enable(TIM_DIV16, TIM_EDGE, TIM_SINGLE);
 
-        timer1_write(VanBusRx.txTimerTicks);
+        timer1_write(ticks);
 
       #endif // ARDUINO_ARCH_ESP32
 
     } // if
-} // SetTxBitTimer
-
-// If the timeout expires, the packet is VAN_RX_DONE. 'ack' has already been initially set to VAN_NO_ACK,
-// and then to VAN_ACK if a new bit was received within the time-out period.
-void IRAM_ATTR WaitAckIsr()
-{
-    SetTxBitTimer();
-
-    NO_INTERRUPTS;
-    if (VanBusRx._head->state == VAN_RX_WAITING_ACK) VanBusRx._AdvanceHead();
-    INTERRUPTS;
-} // WaitAckIsr
+} // ArmTxTimer
 
 #ifdef ARDUINO_ARCH_ESP32
 hw_timer_t * timer = NULL;
 portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
-#define EXIT_CRITICAL_ISR portEXIT_CRITICAL_ISR(&mux)
+
+#if VAN_RX_MAX_QUEUES > 1
+// Of the receive queues other than 'VanBusRx'
+static portMUX_TYPE rxQueueMux[VAN_RX_MAX_QUEUES - 1] =
+{
+    portMUX_INITIALIZER_UNLOCKED
+  #if VAN_RX_MAX_QUEUES > 2
+    , portMUX_INITIALIZER_UNLOCKED
+  #endif
+  #if VAN_RX_MAX_QUEUES > 3
+    , portMUX_INITIALIZER_UNLOCKED
+  #endif
+};
+#endif // VAN_RX_MAX_QUEUES > 1
+
+// Like NO_INTERRUPTS and INTERRUPTS, but only for the receive queue at hand
+#define RX_NO_INTERRUPTS portENTER_CRITICAL(isrMux)
+#define RX_INTERRUPTS portEXIT_CRITICAL(isrMux)
+#define ENTER_CRITICAL_ISR portENTER_CRITICAL_ISR(isrMux)
+#define EXIT_CRITICAL_ISR portEXIT_CRITICAL_ISR(isrMux)
 #else // ! ARDUINO_ARCH_ESP32
+#define RX_NO_INTERRUPTS noInterrupts()
+#define RX_INTERRUPTS interrupts()
+#define ENTER_CRITICAL_ISR
 #define EXIT_CRITICAL_ISR
 #endif // ARDUINO_ARCH_ESP32
 
-// Pin level change interrupt handler
-void IRAM_ATTR RxPinChangeIsr()
-{
-    // Pin levels
+// All receive queues that are set up, by index. 'VanBusRx' is always the first.
+static TVanPacketRxQueue* rxQueues[VAN_RX_MAX_QUEUES] = { &VanBusRx };
 
-    // The logic is:
-    // - if pinLevel == VAN_LOGICAL_HIGH, we've just had a series of VAN_LOGICAL_LOW bits.
-    // - if pinLevel == VAN_LOGICAL_LOW, we've just had a series of VAN_LOGICAL_HIGH bits.
+TVanPacketRxQueue& TVanPacketRxDesc::RxQueue() const
+{
+    return *rxQueues[queue];
+} // TVanPacketRxDesc::RxQueue
 
-  #ifdef ARDUINO_ARCH_ESP32
-    #define GPIP(X_) digitalRead(X_)
-  #endif // ARDUINO_ARCH_ESP32
+// If the timeout expires, the packet is VAN_RX_DONE. 'ack' has already been initially set to VAN_NO_ACK,
+// and then to VAN_ACK if a new bit was received within the time-out period.
+void IRAM_ATTR TVanPacketRxQueue::_OnAckTimeout()
+{
+    PROFILE_ISR(waitAckIsrProfile, ESP.getCycleCount(), isrMux);
 
-    const int pinLevel = GPIP(VanBusRx.pin);
-    static int prevPinLevel = VAN_BIT_RECESSIVE;
-    static bool pinLevelChangedDuringInterruptHandling = false;
+    // The timer of 'VanBusRx' is shared with the transmitter
+    if (index == 0) ArmTxTimer();
 
-    // Number of elapsed CPU cycles
-    static uint32_t prev = 0;
-    const uint32_t curr = ESP.getCycleCount();  // Store CPU cycle counter value as soon as possible
-    const uint32_t nCyclesMeasured = curr - prev;  // Arithmetic has safe roll-over
-    prev = curr;
+    RX_NO_INTERRUPTS;
+    if (decoder.AckTimeout()) _AdvanceHead();
+    RX_INTERRUPTS;
+} // TVanPacketRxQueue::_OnAckTimeout
 
-    const bool samePinLevel = (pinLevel == prevPinLevel);
+#ifdef ARDUINO_ARCH_ESP32
+  #define GPIP(X_) digitalRead(X_)
+#endif // ARDUINO_ARCH_ESP32
+
+// Feeds one bus level change into the packet decoder ('TVanRxDecoder'), and handles the outcome: the locking, the
+// ACK time-out timer, the acceptance filter, the in-frame reply, the statistics and the debugging. 'curr' is the CPU
+// cycle counter value at the level change, 'pinLevel' is the new bus level.
+// Called by the pin level change interrupt handler, or with 'replay' = true by 'ReplayEdge' to decode recorded bus
+// level changes. When replaying, no hardware is touched: the pin is not read back, the ACK time-out timer is
+// emulated, no in-frame reply is sent and the time of the last media access (for carrier sense) is left alone.
+// All state is kept per receive queue, so multiple receive queues can decode at the same time.
+// Note: always inlined, so that the 'replay' branches are optimized out of the interrupt handler.
+inline __attribute__((always_inline)) void TVanPacketRxQueue::DecodeEdge(uint32_t curr, int pinLevel, bool replay)
+{
+    // Retrieve context
+    TVanPacketRxDesc* rxDesc = _head;
+
+    PROFILE_ISR(rxIsrProfile[decoder.state - VAN_RX_VACANT], curr, isrMux);
+
+    ENTER_CRITICAL_ISR;
+
+    // If the head slot still holds a packet, the circular buffer is completely full: no room for the next one
+    const unsigned int events = decoder.Decode(curr, pinLevel, rxDesc->state == VAN_RX_DONE ? NULL : rxDesc->bytes);
 
-    // Prevent CPU monopolization by noise on bus
-    static int noiseCounter = 0;
-    if (nCyclesMeasured < 510 || samePinLevel)
+    if (events & VAN_RX_EV_NOISE)
     {
-        if (++noiseCounter > 30)
-        {
-            VanBusRx.Disable();
-            return;
-        } // if
-    }
-    else
+        EXIT_CRITICAL_ISR;
+        if (! replay) Disable();
+        return;
+    } // if
+
+    // Media access detection for packet transmission. Not when replaying: 'curr' is then in the time base of the
+    // recording.
+    if (! replay && pinLevel == VAN_BIT_RECESSIVE)
     {
-        noiseCounter = 0;
+        // Pin level just changed to 'recessive', so that was the end of the media access ('dominant')
+        lastMediaAccessAt = curr;
     } // if
 
-    // Retrieve context
-    TVanPacketRxDesc* rxDesc = VanBusRx._head;
-    const PacketReadState_t state = rxDesc->state;
+    // Just woken up from light sleep (see 'LightSleep'), somewhere in the packet that caused the wake-up
+    if (events & VAN_RX_EV_IGNORED)
+    {
+        if (events & VAN_RX_EV_LOST) nLostAtWakeUp++;
+        EXIT_CRITICAL_ISR;
+        return;
+    } // if
 
-    // Conversion from elapsed CPU cycles to number of bits, including built-up jitter
-    static uint32_t jitter = 0;
-    uint32_t nCycles = nCyclesMeasured + jitter;
+  #ifdef VAN_RX_STATS
+    if (decoder.edge.fromState == VAN_RX_LOADING) stats._CountPulse(decoder.edge.nCyclesMeasured, decoder.edge.jitter);
+  #endif // VAN_RX_STATS
 
-    nCycles += addToBitTime;
+  #ifdef VAN_RX_IFS_DEBUGGING
 
-    // Experiment
+    TIfsDebugPacket* ifsDebugPacket = &rxDesc->ifsDebugPacket;
 
-    if (nCyclesMeasured > CPU_CYCLES(600) && nCyclesMeasured < CPU_CYCLES(800))
+    // Only write into sample buffer if there is space
+    if ((decoder.edge.fromState == VAN_RX_VACANT || decoder.edge.fromState == VAN_RX_SEARCHING)
+        && ifsDebugPacket->at < VAN_IFS_DEBUG_BUFFER_SIZE)
     {
-        averageOneBitTime = averageOneBitTime == 0 ? CPU_CYCLES(700) : (averageOneBitTime * 99 + nCyclesMeasured + 50) / 100;
+        TIfsDebugData* debugIfs = ifsDebugPacket->samples + ifsDebugPacket->at;
+        debugIfs->nCyclesMeasured = _min(decoder.edge.nCyclesMeasured / CPU_F_FACTOR, USHRT_MAX);
+        debugIfs->nBits = _min(decoder.edge.nBits, UCHAR_MAX);
+        debugIfs->pinLevel = pinLevel;
+        debugIfs->fromState = decoder.edge.fromState;
+        debugIfs->toState = decoder.state;
+        ifsDebugPacket->at++;
     } // if
 
-  #if 0
-    if (averageOneBitTime > CPU_CYCLES(660))
+  #endif // VAN_RX_IFS_DEBUGGING
+
+    // If the current head packet is already VAN_RX_DONE, the circular buffer is completely full
+    if (events & VAN_RX_EV_OVERRUN) nOverruns++;
+
+    if (events & VAN_RX_EV_CANCEL_ACK_TIMER)
     {
-        if (averageOneBitTime < CPU_CYCLES(693))
+        if (replay || softAckTimer)
         {
-            //nCycles = (4 * nCycles + CPU_CYCLES(700) - averageOneBitTime + 2) / 4;
-            nCycles += CPU_CYCLES(5);
+            ackTimerArmed = false;
         }
-        else if (averageOneBitTime > CPU_CYCLES(714))
+        else
         {
-            nCycles -= CPU_CYCLES(10);
+          #ifdef ARDUINO_ARCH_ESP32
+            timerAlarmDisable(ackTimer);
+          #else // ! ARDUINO_ARCH_ESP32
+            timer1_disable();
+          #endif // ARDUINO_ARCH_ESP32
         } // if
     } // if
-  #endif
 
-    if (state == VAN_RX_VACANT || state == VAN_RX_SEARCHING)
+    // IDEN complete? Then apply the acceptance filter. A rejected packet is still read to its end, but never
+    // committed to the queue.
+    if (events & VAN_RX_EV_HEADER)
     {
-        // During SOF, timing is slightly different. Timing values were found by trial and error.
+        headFiltered = ! IsIdenAccepted(rxDesc->Iden());
 
-      #define FOUR_BITS THREE_BIT_BOUNDARY + CPU_CYCLES(10)
-        if (nCycles > CPU_CYCLES(2284) && nCycles < FOUR_BITS) nCycles = FOUR_BITS;
-        //else if (nCycles > CPU_CYCLES(600) && nCycles < CPU_CYCLES(800)) nCycles -= CPU_CYCLES(20);
-        else if (nCycles > CPU_CYCLES(1100) && nCycles < ONE_BIT_BOUNDARY) nCycles -= CPU_CYCLES(20);
-    }
-    else
+      #ifndef VAN_RX_ESP32_RMT
+        // Header complete, and the bus released right after the COM field? Then the transmitter may fill in the
+        // data, if it has an in-frame reply registered for this header. Not when replaying: that would drive the Tx
+        // pin.
+        if (! replay && inFrameReplyIsr != NULL && decoder.atBit == 0 && pinLevel == VAN_BIT_RECESSIVE)
+        {
+            inFrameReplyIsr(rxDesc->bytes[1] << 8 | rxDesc->bytes[2]);
+        } // if
+      #endif // VAN_RX_ESP32_RMT
+    } // if
+
+    if (events & VAN_RX_EV_PACKET) _AdvanceHead();
+
+    if (events & VAN_RX_EV_ARM_ACK_TIMER)
     {
-        // Sometimes, one long bit is in fact two bits
+        // Set a timeout for the ACK bit
 
-        if (jitter < CPU_CYCLES(300))
+        if (replay || softAckTimer)
         {
-          #define MOVE_TOWARDS_TWO_BITS_AT CPU_CYCLES(1229)
-          #define MOVE_TOWARDS_TWO_BITS ONE_BIT_BOUNDARY - MOVE_TOWARDS_TWO_BITS_AT
-            if (nCyclesMeasured > CPU_CYCLES(987) && nCyclesMeasured < ONE_BIT_BOUNDARY && nCycles >= CPU_CYCLES(1220))
-            {
-                nCycles += MOVE_TOWARDS_TWO_BITS;
-            } // if
+            ackTimerArmed = true;
+            ackTimerArmedAt = curr;
         }
-        else if (jitter < CPU_CYCLES(400))
+        else
         {
-            if (nCyclesMeasured > CPU_CYCLES(900) && nCyclesMeasured < CPU_CYCLES(988))
-            {
-                nCycles += CPU_CYCLES(22);
-            } // if
-        } // if
-    } // if
+          #ifdef ARDUINO_ARCH_ESP32
 
-    const uint32_t prevJitter = jitter;
+            timerAlarmDisable(ackTimer);
 
-    unsigned int nBits = nBitsTakingIntoAccountJitter(nCycles, jitter);
+            // The timer of 'VanBusRx' is shared with the transmitter, which attaches its own handler
+            if (index == 0) timerAttachInterrupt(ackTimer, &WaitAckIsr, true);
 
-    // Experiment
-  #define SMALLEST_JITTER CPU_CYCLES(20)
-    if (jitter < SMALLEST_JITTER)
-    {
-        jitter = 0;
-    }
-    else if (jitter <= CPU_CYCLES(200))
-    {
-      #define SMALL_JITTER_RUNDOWN SMALLEST_JITTER
-        if (jitter > prevJitter - CPU_CYCLES(15) && jitter < prevJitter + CPU_CYCLES(18)) jitter -= SMALL_JITTER_RUNDOWN;
-    }
-    else
-    {
-      #define LARGE_JITTER_RUNDOWN CPU_CYCLES(30)
-        if (jitter > prevJitter - CPU_CYCLES(30) && jitter < prevJitter + CPU_CYCLES(5)) jitter -= LARGE_JITTER_RUNDOWN;
+            timerAlarmWrite(ackTimer, 40 * 5, false); // 5 time slots = 5 * 8 us = 40 us
+            timerAlarmEnable(ackTimer);
+
+          #else // ! ARDUINO_ARCH_ESP32
+
+            timer1_disable();
+            timer1_attachInterrupt(WaitAckIsr);
+
+            // Clock to timer (prescaler) is always 80MHz, even F_CPU is 160 MHz
+            timer1_enable(TIM_DIV16, TIM_EDGE, TIM_SINGLE);
+            timer1_write(40 * 5); // 5 time slots = 5 * 8 us = 40 us
+
+          #endif // ARDUINO_ARCH_ESP32
+        } // if
     } // if
 
+    // Just before returning from this ISR, record the pin level
+    const int pinLevelAtReturnFromIsr = replay ? pinLevel : GPIP(pin);
+    decoder.CheckPinLevelAtReturn(pinLevel, pinLevelAtReturnFromIsr);
+
   #ifdef VAN_RX_ISR_DEBUGGING
 
     // Record some data to be used for debugging outside this ISR
@@ -725,484 +1303,688 @@ void IRAM_ATTR RxPinChangeIsr()
 
     isrDebugPacket->slot = rxDesc->slot;
 
-    TIsrDebugData* debugIsr =
-        isrDebugPacket->at < VAN_ISR_DEBUG_BUFFER_SIZE ?
-            isrDebugPacket->samples + isrDebugPacket->at :
-            NULL;
-
     // Only write into sample buffer if there is space
-    if (debugIsr != NULL)
+    if (isrDebugPacket->at < VAN_ISR_DEBUG_BUFFER_SIZE)
     {
-        debugIsr->nCyclesMeasured = _min(nCyclesMeasured / CPU_F_FACTOR, USHRT_MAX);
-        debugIsr->fromJitter = _min(prevJitter / CPU_F_FACTOR, (1 << 10) - 1);
-        debugIsr->nBits = _min(nBits, UCHAR_MAX);
-        debugIsr->prevPinLevel = prevPinLevel;
+        TIsrDebugData* debugIsr = isrDebugPacket->samples + isrDebugPacket->at;
+        debugIsr->nCyclesMeasured = _min(decoder.edge.nCyclesMeasured / CPU_F_FACTOR, USHRT_MAX);
+        debugIsr->fromJitter = _min(decoder.edge.fromJitter / CPU_F_FACTOR, (1 << 10) - 1);
+        debugIsr->nBits = _min(decoder.edge.nBits, UCHAR_MAX);
+        debugIsr->prevPinLevel = decoder.edge.prevPinLevel;
         debugIsr->pinLevel = pinLevel;
-        debugIsr->fromState = state;
-        debugIsr->readBits = 0;
+        debugIsr->fromState = decoder.edge.fromState;
+        debugIsr->readBits = decoder.edge.readBits;
+        debugIsr->toJitter = _min(decoder.jitter / CPU_F_FACTOR, (1 << 10) - 1);
+        debugIsr->flipBits = decoder.edge.flipBits;
+        debugIsr->toState = decoder.state;
+        debugIsr->pinLevelAtReturnFromIsr = pinLevelAtReturnFromIsr;
+        debugIsr->atBit = decoder.atBit;
+        isrDebugPacket->at++;
     } // if
 
-    // Macros useful for debugging
+  #endif // VAN_RX_ISR_DEBUGGING
 
-    // Just before returning from this ISR, record the pin level, plus some data for debugging
-    #define RETURN \
-    { \
-        const int pinLevelAtReturnFromIsr = GPIP(VanBusRx.pin); \
-        pinLevelChangedDuringInterruptHandling = jitter < CPU_CYCLES(100) && pinLevelAtReturnFromIsr != pinLevel; \
-        \
-        if (debugIsr != NULL) \
-        { \
-            debugIsr->toJitter = _min(jitter / CPU_F_FACTOR, (1 << 10) - 1); \
-            debugIsr->flipBits = flipBits; \
-            debugIsr->toState = rxDesc->state; \
-            debugIsr->pinLevelAtReturnFromIsr = pinLevelAtReturnFromIsr; \
-            debugIsr->atBit = atBit; \
-            isrDebugPacket->at++; \
-        } \
-        EXIT_CRITICAL_ISR; \
-        return; \
-    }
+    EXIT_CRITICAL_ISR;
+} // TVanPacketRxQueue::DecodeEdge
 
-    #define DEBUG_ISR(TO_, FROM_) if (debugIsr != NULL) debugIsr->TO_ = (FROM_);
-    #define DEBUG_ISR_M(TO_, FROM_, MAX_) if (debugIsr != NULL) debugIsr->TO_ = _min((FROM_), (MAX_));
+// Emulation of the ACK time-out timer: completes the packet if the ACK time-out has expired at 'now'. Only to be
+// called from ISR, or with interrupts disabled.
+inline __attribute__((always_inline)) void TVanPacketRxQueue::_ExpireAckTimer(uint32_t now)
+{
+    if (! ackTimerArmed || now - ackTimerArmedAt < VAN_ACK_TIMEOUT_CPU_CYCLES) return;  // Safe roll-over
 
-  #else
+    ackTimerArmed = false;
+    if (decoder.AckTimeout()) _AdvanceHead();
+} // TVanPacketRxQueue::_ExpireAckTimer
 
-    // Just before returning from this ISR, record the pin level
-    #define RETURN \
-    { \
-        const int pinLevelAtReturnFromIsr = GPIP(VanBusRx.pin); \
-        pinLevelChangedDuringInterruptHandling = jitter < CPU_CYCLES(100) && pinLevelAtReturnFromIsr != pinLevel; \
-        EXIT_CRITICAL_ISR; \
-        return; \
-    }
+// Pin level change interrupt handler. Not inlined: this is the one copy of the packet decoder ('DecodeEdge') in IRAM,
+// shared by the interrupt service routines of all receive queues.
+void __attribute__((noinline)) IRAM_ATTR TVanPacketRxQueue::_OnPinChange()
+{
+    const int pinLevel = GPIP(pin);
+    const uint32_t curr = ESP.getCycleCount();  // Store CPU cycle counter value as soon as possible
 
-    #define DEBUG_ISR(TO_, FROM_)
-    #define DEBUG_ISR_M(TO_, FROM_, MAX_)
+  #ifdef VAN_TX_ESP32_RMT
+    // Check for collisions with the packet being transmitted
+    if (index == 0) TxRmtCheckEdge(curr, pinLevel);
+  #endif // VAN_TX_ESP32_RMT
 
-  #endif // VAN_RX_ISR_DEBUGGING
+    // Without a hardware timer, the ACK time-out is checked at the next bus level change
+    if (softAckTimer)
+    {
+        ENTER_CRITICAL_ISR;
+        _ExpireAckTimer(curr);
+        EXIT_CRITICAL_ISR;
+    } // if
 
-    prevPinLevel = pinLevel;
+    DecodeEdge(curr, pinLevel, false);
+} // TVanPacketRxQueue::_OnPinChange
 
-    uint16_t flipBits = 0;
+// The interrupt service routines of each receive queue. These are plain functions, as needed by 'attachInterrupt'
+// and 'timerAttachInterrupt'. The ones of 'VanBusRx' are also attached by the transmitter (see VanBusTx.cpp).
+void IRAM_ATTR RxPinChangeIsr() { VanBusRx._OnPinChange(); }
+void IRAM_ATTR WaitAckIsr() { VanBusRx._OnAckTimeout(); }
 
-  #ifdef ARDUINO_ARCH_ESP32
-    portENTER_CRITICAL_ISR(&mux);
-  #endif // ARDUINO_ARCH_ESP32
+#define VAN_RX_DEFINE_ISRS(N_) \
+    void IRAM_ATTR RxPinChangeIsr##N_() { rxQueues[N_]->_OnPinChange(); } \
+    void IRAM_ATTR WaitAckIsr##N_() { rxQueues[N_]->_OnAckTimeout(); }
 
-    // Media access detection for packet transmission
-    if (pinLevel == VAN_BIT_RECESSIVE)
-    {
-        // Pin level just changed to 'recessive', so that was the end of the media access ('dominant')
-        VanBusRx.lastMediaAccessAt = curr;
-    } // if
+#if VAN_RX_MAX_QUEUES > 1
+VAN_RX_DEFINE_ISRS(1)
+#endif
+#if VAN_RX_MAX_QUEUES > 2
+VAN_RX_DEFINE_ISRS(2)
+#endif
+#if VAN_RX_MAX_QUEUES > 3
+VAN_RX_DEFINE_ISRS(3)
+#endif
+
+// By index in 'rxQueues'
+static void (* const rxPinChangeIsrs[VAN_RX_MAX_QUEUES])() =
+{
+    RxPinChangeIsr
+  #if VAN_RX_MAX_QUEUES > 1
+    , RxPinChangeIsr1
+  #endif
+  #if VAN_RX_MAX_QUEUES > 2
+    , RxPinChangeIsr2
+  #endif
+  #if VAN_RX_MAX_QUEUES > 3
+    , RxPinChangeIsr3
+  #endif
+};
+static void (* const waitAckIsrs[VAN_RX_MAX_QUEUES])() =
+{
+    WaitAckIsr
+  #if VAN_RX_MAX_QUEUES > 1
+    , WaitAckIsr1
+  #endif
+  #if VAN_RX_MAX_QUEUES > 2
+    , WaitAckIsr2
+  #endif
+  #if VAN_RX_MAX_QUEUES > 3
+    , WaitAckIsr3
+  #endif
+};
 
-    static unsigned int atBit = 0;
-    static uint16_t readBits = 0;
+// Without a hardware timer, the ACK time-out is also checked each time the consumer looks for a packet
+void TVanPacketRxQueue::PollAckTimeout()
+{
+    // When replaying, the time base is that of the recording; see 'ReplayEdge'
+    if (! enabled || ! ackTimerArmed) return;
 
-  #ifdef VAN_RX_IFS_DEBUGGING
+    RX_NO_INTERRUPTS;
+    _ExpireAckTimer(ESP.getCycleCount());
+    RX_INTERRUPTS;
+} // TVanPacketRxQueue::PollAckTimeout
 
-    TIfsDebugPacket* ifsDebugPacket = &rxDesc->ifsDebugPacket;
+// Does the checks that need polling by the consumer
+void TVanPacketRxQueue::Poll()
+{
+    if (softAckTimer) PollAckTimeout();
+    if (idleTimeoutMs != 0) PollBusIdle();
+} // TVanPacketRxQueue::Poll
+
+// Feeds one recorded bus level change into the packet decoder
+bool TVanPacketRxQueue::ReplayEdge(uint32_t cycles, int pinLevel)
+{
+  #ifdef VAN_RX_ESP32_RMT
+    (void)cycles;
+    (void)pinLevel;
+    return false;
+  #else // ! VAN_RX_ESP32_RMT
 
-    TIfsDebugData* debugIfs =
-        ifsDebugPacket->at < VAN_IFS_DEBUG_BUFFER_SIZE ?
-            ifsDebugPacket->samples + ifsDebugPacket->at :
-            NULL;
+    if (pin == VAN_NO_PIN_ASSIGNED || enabled) return false;  // Call Setup, then Disable first!
 
-    if (state == VAN_RX_VACANT || state == VAN_RX_SEARCHING)
+    // Emulate the ACK time-out timer (see '_OnAckTimeout')
+    if (ackTimerArmed && cycles - ackTimerArmedAt >= VAN_ACK_TIMEOUT_CPU_CYCLES)  // Safe roll-over
     {
-        // Only write into sample buffer if there is space
-        if (debugIfs != NULL)
-        {
-            debugIfs->nCyclesMeasured = _min(nCyclesMeasured / CPU_F_FACTOR, USHRT_MAX);
-            debugIfs->nBits = _min(nBits, UCHAR_MAX);
-            debugIfs->pinLevel = pinLevel;
-            debugIfs->fromState = state;
-            debugIfs->toState = state;  // Can be overwritten later
-            ifsDebugPacket->at++;
-        } // if
+        ReplayEnd();
     } // if
 
-    // Macro useful for debugging
-    #define DEBUG_IFS(TO_, FROM_) if (debugIfs != NULL) debugIfs->TO_ = (FROM_);
+    DecodeEdge(cycles, pinLevel, true);
+    replayLastEdgeAt = cycles;
 
-  #else
+    // A level change during the ACK time-out either confirms the ACK, or cancels the time-out
+    if (decoder.state != VAN_RX_WAITING_ACK) ackTimerArmed = false;
 
-    #define DEBUG_IFS(TO, FROM)
+    return true;
 
-  #endif // VAN_RX_IFS_DEBUGGING
+  #endif // VAN_RX_ESP32_RMT
+} // TVanPacketRxQueue::ReplayEdge
 
-    if (state == VAN_RX_WAITING_ACK)
-    {
-        if (
-            // If another bit came after the "ACK", it is not an "ACK" but the first "1" bit of the next byte
-            (rxDesc->ack == VAN_ACK && pinLevel == VAN_LOGICAL_LOW)
-
-            // If the "ACK" came too soon or lasted more than 1 time slot, it is not an "ACK" but the first
-            // "1" bit of the next byte
-            || pinLevelChangedDuringInterruptHandling
-            || nCycles < CPU_CYCLES(650)
-            || nCycles > CPU_CYCLES(1000)
-           )
-        {
-          #ifdef ARDUINO_ARCH_ESP32
-            timerAlarmDisable(timer);
-          #else // ! ARDUINO_ARCH_ESP32
-            timer1_disable();
-          #endif // ARDUINO_ARCH_ESP32
+// Completes the packet currently being received, if any. Call after the last recorded level change.
+void TVanPacketRxQueue::ReplayEnd()
+{
+  #ifndef VAN_RX_ESP32_RMT
 
-            // Go back to state VAN_RX_LOADING
-            rxDesc->state = VAN_RX_LOADING;
-            DEBUG_IFS(toState, VAN_RX_LOADING);
+    if (ackTimerArmed)
+    {
+        // Emulate the expiry of the ACK time-out timer (see '_OnAckTimeout')
+        ackTimerArmed = false;
 
-            rxDesc->ack = VAN_NO_ACK;
-        }
-        else
-        {
-            // TODO - move (under condition) into timer ISR 'WaitAckIsr'?
-            rxDesc->ack = VAN_ACK;
+        RX_NO_INTERRUPTS;
+        if (decoder.AckTimeout()) _AdvanceHead();
+        RX_INTERRUPTS;
 
-            // The timer ISR 'WaitAckIsr' will call 'VanBusRx._AdvanceHead()'
-        } // if
+        return;
     } // if
 
-    if (state == VAN_RX_VACANT)
+    // Without an ACK time-out, a packet is completed by the first level change after a long enough idle time.
+    // Emulate that level change.
+    if (decoder.state == VAN_RX_SEARCHING || decoder.state == VAN_RX_LOADING)
     {
-        readBits = 0;
+        replayLastEdgeAt += VAN_REPLAY_IDLE_CPU_CYCLES;
+        DecodeEdge(replayLastEdgeAt, VAN_LOGICAL_HIGH, true);
+    } // if
 
-        if (pinLevel == VAN_LOGICAL_LOW)
-        {
-            // Normal detection: we've seen a series of VAN_LOGICAL_HIGH bits
+  #endif // VAN_RX_ESP32_RMT
+} // TVanPacketRxQueue::ReplayEnd
 
-            rxDesc->state = VAN_RX_SEARCHING;
-            DEBUG_IFS(toState, VAN_RX_SEARCHING);
+#ifdef VAN_RX_ESP32_RMT
 
-            if (nBits == 7 || nBits == 8) atBit = nBits; else atBit = 0;
-            jitter = 0;
+// RMT clock is the APB clock (80 MHz) divided by 8, so 1 tick is 0.1 microsecond
+#define VAN_RMT_CLK_DIV 8
+#define VAN_RMT_TICKS_PER_BIT (8 * TIMER_BASE_CLK / 1000000 / VAN_RMT_CLK_DIV)  // 8 microseconds per bit
+#define VAN_RMT_TICKS_PER_MICRO (VAN_RMT_TICKS_PER_BIT / 8)
 
-            pinLevelChangedDuringInterruptHandling = false;
-        }
-        else if (pinLevel == VAN_LOGICAL_HIGH)
-        {
-            if (nBits >= 2 && nBits <= 8)
-            {
-                // Late detection
+// After waking up from light sleep, the first packet must start at least 8 bit times later (see 'RmtRxTask')
+#define VAN_RESYNC_IDLE_MICROS (8 * 8)
 
-                rxDesc->state = VAN_RX_SEARCHING;
-                DEBUG_IFS(toState, VAN_RX_SEARCHING);
+// Within a packet, Enhanced Manchester encoding guarantees at most 6 equal bits. Between packets, the bus is idle
+// for at least 8 (EOF) + 4 (IFS) bits. Halfway is a good point to decide that the packet has ended.
+#define VAN_RMT_IDLE_THRESHOLD_BITS 10
 
-                atBit = nBits;
-                if (nBits > 5) jitter = 0;
-            } // if
-        } // if
+// Ring buffer between the RMT driver and the decoding task. Room for a few packets of maximum size.
+#define VAN_RMT_RING_BUFFER_SIZE 4096
 
-        RETURN;
-    } // if
+// Duration (in ticks) and pin level of RMT pulse 'i'. Each RMT item holds two pulses.
+inline __attribute__((always_inline)) uint16_t RmtDuration(const rmt_item32_t* items, int i)
+{
+    return i & 1 ? items[i >> 1].duration1 : items[i >> 1].duration0;
+} // RmtDuration
 
-    // If the current head packet is already VAN_RX_DONE, the circular buffer is completely full
-    if (state == VAN_RX_DONE)
-    {
-        VanBusRx._overrun = true;
+inline __attribute__((always_inline)) int RmtLevel(const rmt_item32_t* items, int i)
+{
+    return i & 1 ? items[i >> 1].level1 : items[i >> 1].level0;
+} // RmtLevel
 
-        RETURN;
-    } // if
+// Number of bits in RMT pulse 'i'. Returns 0 if the pulse marks the end of the packet (bus idle).
+inline __attribute__((always_inline)) unsigned int RmtNBits(const rmt_item32_t* items, int nPulses, int i)
+{
+    if (i >= nPulses) return 0;
+    const uint16_t duration = RmtDuration(items, i);
+
+    // The RMT driver marks the end of the received data with a zero duration
+    if (duration == 0) return 0;
 
-    // During packet reception, the "Enhanced Manchester" encoding guarantees at most 5 bits are the same,
-    // except during EOD when it can be 6.
-    // However, sometimes the Manchester bit is missed. Let's be tolerant with that, and just pretend it
-    // was there, by accepting up to 10 equal bits.
-    if (nBits > 10)
+    const unsigned int nBits = (duration + VAN_RMT_TICKS_PER_BIT / 2) / VAN_RMT_TICKS_PER_BIT;
+    if (nBits > VAN_RMT_IDLE_THRESHOLD_BITS) return 0;
+    return nBits == 0 ? 1 : nBits;  // Every pulse is at least one bit
+} // RmtNBits
+
+// Decode one VAN packet from the pulses as captured by the RMT peripheral. Returns false if the pulses do not form
+// a VAN packet (e.g. noise on the bus).
+bool DecodeRmtPacket(TVanPacketRxDesc* rxDesc, const rmt_item32_t* items, int nItems)
+{
+    const int nPulses = nItems * 2;
+    unsigned int atBit = 0;
+    uint16_t readBits = 0;
+
+    // Pulse with the largest timing deviation; its last bit is the best candidate for repair by CheckCrcAndRepair
+    unsigned int largestDeviation = 0;
+    int uncertainBit = NO_UNCERTAIN_BIT;
+
+    bool complete = false;  // Set when EOD is seen
+
+    for (int i = 0; i < nPulses && ! complete; i++)
     {
-        jitter = 0;
+        const unsigned int nBits = RmtNBits(items, nPulses, i);
+        if (nBits == 0) break;  // Bus idle
+
+        // Pin level VAN_LOGICAL_HIGH means: a series of '1' bits
+        const uint16_t bit = RmtLevel(items, i) == VAN_LOGICAL_HIGH ? 1 : 0;
 
-        if (state == VAN_RX_SEARCHING)
+        for (unsigned int n = 1; n <= nBits; n++)
         {
+            readBits = readBits << 1 | bit;
+            if (++atBit < 10) continue;
+
+            // uint16_t, not uint8_t: we are reading 10 bits per byte ("Enhanced Manchester" encoding)
+            const uint16_t currentByte = readBits;
             readBits = 0;
             atBit = 0;
-            rxDesc->size = 0;
 
-            RETURN;
-        } // if
+            // The first 10 bits must be 00 0011 1101 (0x03D) (SOF, Start Of Frame)
+            if (rxDesc->size == 0 && currentByte != 0x03D) return false;
 
-        if (atBit == 9)
-        {
-            uint16_t currentByte = readBits << 1;
-            uint8_t readByte = (currentByte >> 2 & 0xF0) | (currentByte >> 1 & 0x0F);
-            rxDesc->bytes[rxDesc->size++] = readByte;
-        }
-        else
-        {
-            rxDesc->result = VAN_RX_ERROR_NBITS;
-        } // if
+            // Buffer full? This happens if a presumed EOD at the last byte position turned out not to be EOD.
+            if (rxDesc->size >= VAN_MAX_PACKET_SIZE)
+            {
+                rxDesc->result = VAN_RX_ERROR_MAX_PACKET;
+                complete = true;
+                break;
+            } // if
 
-        VanBusRx._AdvanceHead();
+            // Remove the 2 Manchester bits 'm'; the relevant 8 bits are 'X':
+            //   9 8 7 6 5 4 3 2 1 0
+            //   X X X X m X X X X m
+            rxDesc->bytes[rxDesc->size++] = (currentByte >> 2 & 0xF0) | (currentByte >> 1 & 0x0F);
 
-        RETURN;
-    } // if
+            // EOD detected if last two bits are 0 followed by a 1, but never in bytes 0...4
+            if ((currentByte & 0x003) == 0 && n == nBits && rxDesc->size >= 5)
+            {
+                // After EOD follows the ACK field: one '1' bit, then a '0' bit if any receiver acknowledged, then
+                // EOF. If anything else follows, it was not EOD after all.
+                if (RmtNBits(items, nPulses, i + 1) == 0)
+                {
+                    rxDesc->ack = VAN_NO_ACK;
+                    complete = true;
+                    break;
+                } // if
 
-    // Experimental handling of special situations caused by a missed interrupt or a very late ISR invocation.
-    // All cases were found by trial and error.
-    if (nBits == 0)
-    {
-        if (state == VAN_RX_SEARCHING)
-        {
-            nBits = 1;
-            DEBUG_ISR(nBits, 1);
+                if (RmtNBits(items, nPulses, i + 1) == 1
+                    && RmtNBits(items, nPulses, i + 2) == 1
+                    && RmtNBits(items, nPulses, i + 3) == 0)
+                {
+                    rxDesc->ack = VAN_ACK;
+                    complete = true;
+                    break;
+                } // if
+            }
+            else if (rxDesc->size >= VAN_MAX_PACKET_SIZE)
+            {
+                rxDesc->result = VAN_RX_ERROR_MAX_PACKET;
+                complete = true;
+                break;
+            } // if
+        } // for
 
-            jitter = 0;
-        }
-        else if (atBit > 0)
-        {
-            const uint16_t prev = readBits;
+        if (complete || rxDesc->size == 0) continue;
 
-            // Set or clear the last read bit
-            readBits = pinLevel == VAN_LOGICAL_LOW ? readBits | 0x0001 : readBits & 0xFFFE;
+        const unsigned int duration = RmtDuration(items, i);
+        const unsigned int expected = nBits * VAN_RMT_TICKS_PER_BIT;
+        const unsigned int deviation = duration > expected ? duration - expected : expected - duration;
+        if (deviation > largestDeviation)
+        {
+            largestDeviation = deviation;
 
-            // If last bit was actually flipped, reset jitter
-            //if (atBit > 0 && prev != readBits) jitter = 0;
-            if (prev != readBits) jitter -= _min(jitter, CPU_CYCLES(157U));
+            // Position of the last received bit (in order of reception: MSB first), counting only the "real" bits,
+            // not the Manchester bits
+            uncertainBit = rxDesc->size * 8 + atBit;
+            if (atBit > 4) uncertainBit--;
         } // if
-    }
-    else if (samePinLevel)
+    } // for
+
+    // Bus went idle before a complete SOF was seen?
+    if (rxDesc->size == 0) return false;
+
+    if (! complete)
     {
-        if (nBits == 1)
+        // Bus went idle before EOD
+        if (atBit == 9 && rxDesc->size >= VAN_MAX_PACKET_SIZE)
         {
-            flipBits = 0x0001;
+            rxDesc->result = VAN_RX_ERROR_MAX_PACKET;
         }
-        else if (nBits == 2)
+        else if (atBit == 9)
         {
-            // Flip the last 'nBits' except the very last bit, e.g. flip the bits -- ---- --X-
-            flipBits = 0x0002;
+            // Only the very last bit is missing
+            const uint16_t currentByte = readBits << 1;
+            rxDesc->bytes[rxDesc->size++] = (currentByte >> 2 & 0xF0) | (currentByte >> 1 & 0x0F);
         }
-        else if (nBits > 2)
+        else
         {
-            // Flip the last 'nBits' except the very last bit, e.g. if nBits == 4 ==> flip the bits -- ---- XXX-
-            flipBits = (1 << nBits) - 1 - 1;
-
-            // If the interrupt was so late that the pin level has already changed again, then flip also the very
-            // last bit
-            if (jitter > CPU_CYCLES(280)) flipBits |= 0x0001;
+            rxDesc->result = VAN_RX_ERROR_NBITS;
         } // if
-
-        if ((flipBits & 0x0001) == 0x0001) prevPinLevel = 2; // next ISR, samePinLevel must always be false.
     } // if
 
-    readBits <<= nBits;
-    atBit += nBits;
+    // Mark the bit position as candidate for later repair by the CheckCrcAndRepair(...) method, but only if the
+    // timing was really off. Position 1 = MSB, bit 8 = LSB.
+    if (largestDeviation > VAN_RMT_TICKS_PER_BIT / 4) rxDesc->uncertainBit1 = uncertainBit;
 
-    // Calculate the position of the last received bit (in order of reception: MSB first)
-    int bitPosition = rxDesc->size * 8 + atBit;
-
-    // Count only the "real" bits, not the Manchester bits
-    if (atBit > 4) bitPosition--;
-    if (atBit > 9) bitPosition--;
+    return true;
+} // DecodeRmtPacket
 
-    if (pinLevel == VAN_LOGICAL_LOW)
+// Total duration (in ticks) of the RMT pulses of a packet
+static uint32_t RmtPacketTicks(const rmt_item32_t* items, int nItems)
+{
+    uint32_t nTicks = 0;
+    for (int i = 0; i < nItems * 2; i++)
     {
-        // Just had a series of VAN_LOGICAL_HIGH bits
-        uint16_t pattern = (1 << nBits) - 1;
-        readBits |= pattern;
-    } // if
+        const uint16_t duration = RmtDuration(items, i);
+        if (duration == 0) break;
+        nTicks += duration;
+    } // for
+    return nTicks;
+} // RmtPacketTicks
 
-    if (flipBits == 0 && nBits == 3 && (atBit == 5 || atBit == 10) && rxDesc->uncertainBit1 == NO_UNCERTAIN_BIT)
-    {
-        // 4-th or 8-th bit same as Manchester bit? Then mark that bit position as candidate for
-        // later repair by the CheckCrcAndRepair(...) method.
-        rxDesc->uncertainBit1 = bitPosition;  // Position 1 = MSB, bit 8 = LSB
-    } // if
+// Task that decodes the packets as captured by the RMT peripheral. This task is the only producer into the receive
+// queue, which is passed as 'param'.
+void RmtRxTask(void* param)
+{
+    TVanPacketRxQueue* rxQueue = (TVanPacketRxQueue*)param;
 
-    if (flipBits != 0)
+    for (;;)
     {
-        readBits ^= flipBits;
+        size_t nBytes = 0;
+        rmt_item32_t* items = (rmt_item32_t*)xRingbufferReceive(rxQueue->rmtRingBuffer, &nBytes, portMAX_DELAY);
+        if (items == NULL) continue;
+
+        // The RMT receiver has just seen the bus become idle
+        const uint32_t now = ESP.getCycleCount();
+        rxQueue->lastMediaAccessAt = now;
 
-        if (nBits > 1 && rxDesc->uncertainBit1 == NO_UNCERTAIN_BIT)
+        const int nItems = nBytes / sizeof(rmt_item32_t);
+
+        // Just woken up from light sleep (see 'LightSleep')? Then the first capture may be the rest of the packet
+        // that caused the wake-up. Drop it, unless it started with a 'dominant' level at least 8 bits after waking up,
+        // like a real SOF. After any capture, the bus has been idle, so the receiver is in sync again.
+        if (rxQueue->decoder.resync)
         {
-            // The last bit is very uncertain: mark the bit position as candidate for later repair by the
-            // CheckCrcAndRepair(...) method
-            rxDesc->uncertainBit1 = bitPosition;  // Position 1 = MSB, bit 8 = LSB
+            rxQueue->decoder.resync = false;
 
-            // Note: the one-but-last bit is also very uncertain, but for now we mark only the last bit.
-            // In a later version, more than one "uncertain bit" marking may be implemented.
+            const uint32_t nTicks = VAN_RMT_IDLE_THRESHOLD_BITS * VAN_RMT_TICKS_PER_BIT + RmtPacketTicks(items, nItems);
+            const uint32_t sofMicros = (uint32_t)esp_timer_get_time() - nTicks / VAN_RMT_TICKS_PER_MICRO;
+            if (sofMicros - rxQueue->resyncFromMicros < VAN_RESYNC_IDLE_MICROS  // Safe roll-over
+                || RmtLevel(items, 0) != VAN_BIT_DOMINANT)
+            {
+                rxQueue->nLostAtWakeUp++;
+                vRingbufferReturnItem(rxQueue->rmtRingBuffer, items);
+                continue;
+            } // if
         } // if
-    } // if
 
-    if (state == VAN_RX_SEARCHING)
-    {
-        // The bit timing is slightly different during SOF: apply alternative jitter calculations
-        if (nBits == 3)
-        {
-            // Decrease jitter value by 168, but don't go below 0
-            if (jitter > CPU_CYCLES(168)) jitter = jitter - CPU_CYCLES(168); else jitter = 0;
-        }
-        else if (atBit == 4)
+        TVanPacketRxDesc* rxDesc = rxQueue->_head;
+
+        // If the current head packet is already VAN_RX_DONE, the circular buffer is completely full
+        if (rxDesc->state == VAN_RX_DONE)
         {
-            if (nBits == 4)
-            {
-                // Timing seems to be around 2590 for the first 4-bit sequence ("----") during SOF
-                // (normally it is around 2639)
-                if (nCycles > CPU_CYCLES(2624)) jitter = nCycles - CPU_CYCLES(2624); else jitter = 0;
-            }
+            rxQueue->nOverruns++;
         }
-        else if (atBit == 7/* || atBit == 8*/)
+        else
         {
-            if (nBits == 1)
-            {
-                // Decrease jitter value by 130, but don't go below 0
-                if (jitter > CPU_CYCLES(130)) jitter = jitter - CPU_CYCLES(130); else jitter = 0;
-            }
-            else if (nBits == 2)
+            rxDesc->state = VAN_RX_LOADING;
+            if (DecodeRmtPacket(rxDesc, items, nItems))
             {
-                // Decrease jitter value by 168, but don't go below 0
-                if (jitter > CPU_CYCLES(168)) jitter = jitter - CPU_CYCLES(168); else jitter = 0;
+                // The RMT peripheral reports a packet only after the bus has been idle for
+                // VAN_RMT_IDLE_THRESHOLD_BITS. One RMT tick is VAN_RMT_CLK_DIV APB clock cycles.
+                const uint32_t eofAt =
+                    now - CPU_CYCLES(VAN_RMT_IDLE_THRESHOLD_BITS * VAN_RMT_TICKS_PER_BIT * VAN_RMT_CLK_DIV);
+                rxDesc->SetTimeStamps(eofAt - CPU_CYCLES(RmtPacketTicks(items, nItems) * VAN_RMT_CLK_DIV), eofAt);
+
+                rxQueue->headFiltered = rxDesc->size >= 3 && ! rxQueue->IsIdenAccepted(rxDesc->Iden());
+                rxQueue->_AdvanceHead();
             }
-            else if (nBits == 4)
+            else
             {
-                // Timing seems to be around 2530 for the second 4-bit sequence ("1111") during SOF
-                // (normally it is around 2639)
-                if (nCycles > CPU_CYCLES(2514)) jitter = nCycles - CPU_CYCLES(2514); else jitter = 0;
+                rxDesc->Init();
             } // if
         } // if
 
-        // Be flexible in SOF detection. All cases were found by trial and error.
-        if ((atBit == 6 || atBit == 7 || atBit == 8) && (readBits & 0x00F) == 0x00D)  // e.g. 11 11-1, --- 11-1, -11 11-1, ---1 11-1, --11 11-1, ---- 11-1
-        {
-            atBit = 10;
-        }
-        else if ((atBit == 8 || atBit == 9) && (readBits & 0x00E) == 0x00A)  // e.g. -11 11-1 1, --11 11-1 1
-        {
-            atBit = 11;
-        }
-        else if (atBit == 9 && (readBits & 0x003) == 0x001)  // e.g. - --11 11-1, - ---- ---1, - ---- -1-1
-        {
-            atBit = 10;
-        }
-        else if (atBit == 10 && (readBits & 0x006) == 0x002) // e.g. - --11 11-1 -, - --11 11-1 1, - ---- -1-1 1
-        {
-            atBit = 11;
-        } // if
-        else if (atBit == 12 && (readBits & 0x018) == 0x008) // e.g. - ---- 11-1 111
-        {
-            atBit = 13;
-        } // if
-        else if (atBit == 13 && readBits == 0x1FF) // e.g. - ---1 1111 1111
-        {
-            // This is not a SOF pattern
-            readBits = 0x000; // Force to state VAN_RX_VACANT, below
-        } // if
-        else if (atBit == 14 && readBits == 0x3FF) // e.g. -- --11 1111 1111
+        vRingbufferReturnItem(rxQueue->rmtRingBuffer, items);
+    } // for
+} // RmtRxTask
+
+// Set up the RMT peripheral to capture the pulses on the VAN bus Rx pin, and start the decoding task
+bool TVanPacketRxQueue::SetupRmtRx(uint8_t rxPin)
+{
+    if (index > 0)
+    {
+      #ifdef VAN_RX_RMT_SECOND_CHANNEL
+        // There is room for only one more RMT receiver
+        for (int i = 1; i < VAN_RX_MAX_QUEUES; i++)
         {
-            // This is not a SOF pattern
-            readBits = 0x000; // Force to state VAN_RX_VACANT, below
-        } // if
+            if (rxQueues[i] != NULL && rxQueues[i] != this && rxQueues[i]->IsSetup()) return false;
+        } // for
+        rmtChannel = VAN_RX_RMT_SECOND_CHANNEL;
+      #else
+        return false;
+      #endif // VAN_RX_RMT_SECOND_CHANNEL
+    } // if
+
+    rmt_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.rmt_mode = RMT_MODE_RX;
+    config.channel = rmtChannel;
+    config.gpio_num = (gpio_num_t)rxPin;
+    config.clk_div = VAN_RMT_CLK_DIV;
+    config.mem_block_num = VAN_RX_RMT_MEM_BLOCKS;
+    config.rx_config.filter_en = true;
+    config.rx_config.filter_ticks_thresh = 100;  // Ignore glitches shorter than 100 APB clock cycles (1.25 usec)
+    config.rx_config.idle_threshold = VAN_RMT_IDLE_THRESHOLD_BITS * VAN_RMT_TICKS_PER_BIT;
+
+    if (rmt_config(&config) != ESP_OK) return false;
+    if (rmt_driver_install(rmtChannel, VAN_RMT_RING_BUFFER_SIZE, 0) != ESP_OK) return false;
+
+    // Higher priority than the loop() task, so that packets are decoded as soon as they come in. Run on the same
+    // core as the RMT interrupt handler.
+    if (rmt_get_ringbuf_handle(rmtChannel, &rmtRingBuffer) == ESP_OK
+        && xTaskCreatePinnedToCore(RmtRxTask, "VanBusRx", 2048, this, 5, &rmtRxTask, xPortGetCoreID()) == pdPASS)
+    {
+        if (rmt_rx_start(rmtChannel, true) == ESP_OK) return true;
+
+        vTaskDelete(rmtRxTask);
+        rmtRxTask = NULL;
     } // if
 
-    DEBUG_ISR(readBits, readBits);
+    // Leave the RMT channel as it was, so that 'Setup' can be tried again
+    rmt_driver_uninstall(rmtChannel);
+    rmtRingBuffer = NULL;
+    return false;
+} // TVanPacketRxQueue::SetupRmtRx
+
+#endif // VAN_RX_ESP32_RMT
+
+#if defined ARDUINO_ARCH_ESP32 && ! defined VAN_RX_ESP32_RMT
+
+// GPIO interrupt handler of this library, at most one per core. Allocated by 'RoutePinIsr'.
+static intr_handle_t gpioIntrHandles[portNUM_PROCESSORS];
+
+// Value of the 'int_ena' field of a GPIO pin register, to have the pin interrupt serviced by 'core'
+#define VAN_GPIO_INT_ENA(core) ((core) == PRO_CPU_NUM ? 0x04 : 0x01)
+
+static inline void IRAM_ATTR ClearGpioIntStatus(uint8_t pin)
+{
+    if (pin < 32) GPIO.status_w1tc = 1UL << pin; else GPIO.status1_w1tc.val = 1UL << (pin - 32);
+} // ClearGpioIntStatus
+
+// Services the pin interrupts of the receive queues that were taken over from the ESP32 Arduino core
+void IRAM_ATTR GpioIsr(void* arg)
+{
+    const int core = (int)arg;
 
-    if (atBit >= 10)
+    // Only the pins that are enabled for this core
+    const uint32_t statusLow = core == PRO_CPU_NUM ? GPIO.pcpu_int : GPIO.acpu_int;
+    const uint32_t statusHigh = core == PRO_CPU_NUM ? GPIO.pcpu_int1.intr : GPIO.acpu_int1.intr;
+
+    for (int i = 0; i < VAN_RX_MAX_QUEUES; i++)
     {
-        atBit -= 10;
+        TVanPacketRxQueue* rxQueue = rxQueues[i];
+        if (rxQueue == NULL || ! rxQueue->ownGpioIsr || rxQueue->gpioIsrCore != core) continue;
 
-        // uint16_t, not uint8_t: we are reading 10 bits per byte ("Enhanced Manchester" encoding)
-        uint16_t currentByte = readBits >> atBit;
+        const uint8_t pin = rxQueue->gpioIsrPin;
+        const uint32_t status = pin < 32 ? statusLow >> pin : statusHigh >> (pin - 32);
+        if ((status & 1) == 0) continue;
 
-        // Get ready for next byte
-        readBits &= (1 << atBit) - 1;
+        // Clear first, so that a level change during the decoding triggers the interrupt again
+        ClearGpioIntStatus(pin);
+        rxQueue->pinChangeIsr();
+    } // for
+} // GpioIsr
 
-        if (state == VAN_RX_SEARCHING)
-        {
-            // Ideally, the first 10 bits are 00 0011 1101 (0x03D) (SOF, Start Of Frame)
-            if (currentByte != 0x03D
-
-                // Accept also (found through trial and error):
-                && currentByte != 0x009 // 00 0000 1001
-                && currentByte != 0x01D // 00 0001 1101
-                && currentByte != 0x039 // 00 0011 1001
-                && currentByte != 0x03E // 00 0011 1110
-                && currentByte != 0x019 // 00 0001 1001
-                && currentByte != 0x03B // 00 0011 1011
-                && currentByte != 0x03C // 00 0011 1100
-                && currentByte != 0x01E // 00 0001 1110
-                && currentByte != 0x00D // 00 0000 1101
-                && currentByte != 0x005 // 00 0000 0101
-                && currentByte != 0x001 // 00 0000 0001
-                && currentByte != 0x03F // 00 0011 1111
-                && currentByte != 0x3FD // 11 1111 1101
-                && currentByte != 0x079 // 00 0111 1001
-                && currentByte != 0x07D // 00 0111 1101
-               )
-            {
-                rxDesc->state = VAN_RX_VACANT;
-                DEBUG_IFS(toState, VAN_RX_VACANT);
+// The ESP32 Arduino core services all pin interrupts on one core: the core that attached the first pin interrupt,
+// whether by this library or by the sketch. If that is not the core running this function (see 'isrCore'), the pin
+// interrupt is taken over from the Arduino core, and serviced by 'GpioIsr' on this core instead.
+bool TVanPacketRxQueue::RoutePinIsr(uint8_t rxPin)
+{
+    const int core = xPortGetCoreID();
+    gpioIsrPin = rxPin;
+    gpioIsrCore = core;
 
-                jitter = 0;
+    // Already serviced by this core?
+    if (GPIO.pin[rxPin].int_ena == VAN_GPIO_INT_ENA(core)) return true;
 
-                RETURN;
-            } // if
+    detachInterrupt(digitalPinToInterrupt(rxPin));
 
-            currentByte = 0x03D;
+    // The interrupt matrix of each core is separate, so this does not disturb the handler on the other core
+    if (gpioIntrHandles[core] == NULL
+        && esp_intr_alloc(ETS_GPIO_INTR_SOURCE, ESP_INTR_FLAG_IRAM, GpioIsr, (void*)core, gpioIntrHandles + core)
+            != ESP_OK)
+    {
+        gpioIntrHandles[core] = NULL;
+        return false;
+    } // if
 
-            rxDesc->state = VAN_RX_LOADING;
-            DEBUG_IFS(toState, VAN_RX_LOADING);
-        } // if
+    GPIO.pin[rxPin].int_type = GPIO_INTR_ANYEDGE;
+    ownGpioIsr = true;
+    AttachPinIsr();
 
-        // Remove the 2 Manchester bits 'm'; the relevant 8 bits are 'X':
-        //   9 8 7 6 5 4 3 2 1 0
-        //   X X X X m X X X X m
-        uint8_t readByte = (currentByte >> 2 & 0xF0) | (currentByte >> 1 & 0x0F);
+    // Check that 'isrCore' really decides
+    return esp_intr_get_cpu(gpioIntrHandles[core]) == (uint32_t)core
+        && GPIO.pin[rxPin].int_ena == VAN_GPIO_INT_ENA(core);
+} // TVanPacketRxQueue::RoutePinIsr
 
-        rxDesc->bytes[rxDesc->size++] = readByte;
+#endif // defined ARDUINO_ARCH_ESP32 && ! defined VAN_RX_ESP32_RMT
 
-        // EOD detected if last two bits are 0 followed by a 1, but never in bytes 0...4
-        if ((currentByte & 0x003) == 0 && atBit == 0 && rxDesc->size >= 5
+#ifndef VAN_RX_ESP32_RMT
 
-            // Experiment for 3 last "0"-bits: too short means it is not EOD
-            && (nBits != 3 || nCycles > CPU_CYCLES(1963)))
-        {
-            rxDesc->state = VAN_RX_WAITING_ACK;
-            DEBUG_IFS(toState, VAN_RX_WAITING_ACK);
+void IRAM_ATTR TVanPacketRxQueue::AttachPinIsr()
+{
+  #ifdef ARDUINO_ARCH_ESP32
+    if (ownGpioIsr)
+    {
+        // Forget any level change from while detached, e.g. of my own transmission
+        ClearGpioIntStatus(gpioIsrPin);
+        GPIO.pin[gpioIsrPin].int_ena = VAN_GPIO_INT_ENA(gpioIsrCore);
+        return;
+    } // if
+  #endif // ARDUINO_ARCH_ESP32
 
-            // Set a timeout for the ACK bit
+    attachInterrupt(digitalPinToInterrupt(pin), pinChangeIsr, CHANGE);
+} // TVanPacketRxQueue::AttachPinIsr
 
-          #ifdef ARDUINO_ARCH_ESP32
+void IRAM_ATTR TVanPacketRxQueue::DetachPinIsr()
+{
+  #ifdef ARDUINO_ARCH_ESP32
+    if (ownGpioIsr)
+    {
+        GPIO.pin[gpioIsrPin].int_ena = 0;
+        return;
+    } // if
+  #endif // ARDUINO_ARCH_ESP32
 
-            timerAlarmDisable(timer);
-            timerAttachInterrupt(timer, &WaitAckIsr, true);
-            timerAlarmWrite(timer, 40 * 5, false); // 5 time slots = 5 * 8 us = 40 us
-            timerAlarmEnable(timer);
+    detachInterrupt(digitalPinToInterrupt(pin));
+} // TVanPacketRxQueue::DetachPinIsr
 
-          #else // ! ARDUINO_ARCH_ESP32
+#endif // VAN_RX_ESP32_RMT
 
-            timer1_disable();
-            timer1_attachInterrupt(WaitAckIsr);
+// Install the interrupt handlers for the VAN packet receiver. On ESP32, the interrupts will be serviced by the core
+// that runs this function.
+bool TVanPacketRxQueue::InstallIsrs(uint8_t rxPin)
+{
+    pinChangeIsr = rxPinChangeIsrs[index];
 
-            // Clock to timer (prescaler) is always 80MHz, even F_CPU is 160 MHz
-            timer1_enable(TIM_DIV16, TIM_EDGE, TIM_SINGLE);
-            timer1_write(40 * 5); // 5 time slots = 5 * 8 us = 40 us
+  #ifdef VAN_RX_ESP32_RMT
+    if (! SetupRmtRx(rxPin)) return false;
+  #else // ! VAN_RX_ESP32_RMT
+    attachInterrupt(digitalPinToInterrupt(rxPin), pinChangeIsr, CHANGE);
+  #ifdef ARDUINO_ARCH_ESP32
+    if (! RoutePinIsr(rxPin)) return false;
+  #endif // ARDUINO_ARCH_ESP32
+  #endif // VAN_RX_ESP32_RMT
 
-          #endif // ARDUINO_ARCH_ESP32
+  #ifdef ARDUINO_ARCH_ESP32
 
-        }
-        else if (rxDesc->size >= VAN_MAX_PACKET_SIZE)
-        {
-            rxDesc->result = VAN_RX_ERROR_MAX_PACKET;
-            VanBusRx._AdvanceHead();
+  #ifdef VAN_RX_ESP32_RMT
+    // The RMT receiver needs no ACK time-out timer; only the transmitter needs the timer of 'VanBusRx'
+    if (index > 0) return true;
+  #endif // VAN_RX_ESP32_RMT
 
-            jitter = 0;
-        } // if
+    // Each receive queue has its own hardware timer. Clock to timer (prescaler) is always 80MHz, even F_CPU is
+    // 160 MHz. We want 0.2 microsecond resolution.
+    ackTimer = timerBegin(index, 80 / 5, true);
+    if (index == 0) timer = ackTimer;
+
+    if (ackTimer == NULL)
+    {
+        // The transmitter needs the timer of 'VanBusRx'. For the other receive queues, emulate the timer.
+        if (index == 0) return false;
+        softAckTimer = true;
+        return true;
     } // if
 
-    RETURN;
-} // RxPinChangeIsr
+    timerAlarmDisable(ackTimer);
 
-// Initializes the VAN packet receiver
-bool TVanPacketRxQueue::Setup(uint8_t rxPin, int queueSize)
+    // The timer interrupt is allocated on the core that attaches the first handler. Later attachments (e.g. by
+    // 'ArmTxTimer') stay on that core.
+    timerAttachInterrupt(ackTimer, waitAckIsrs[index], true);
+
+  #else // ! ARDUINO_ARCH_ESP32
+
+    if (index == 0)
+    {
+        timer1_isr_init();
+        timer1_disable();
+    }
+    else
+    {
+        // timer1 is the only hardware timer, taken by 'VanBusRx' and the transmitter: emulate it
+        softAckTimer = true;
+    } // if
+
+  #endif // ARDUINO_ARCH_ESP32
+
+    return true;
+} // TVanPacketRxQueue::InstallIsrs
+
+#ifdef ARDUINO_ARCH_ESP32
+
+struct TInstallRxIsrsParams
+{
+    TVanPacketRxQueue* rxQueue;
+    uint8_t rxPin;
+    TaskHandle_t caller;
+    bool result;
+}; // struct TInstallRxIsrsParams
+
+// Short-lived task, pinned to the core that is to service the interrupts
+void InstallRxIsrsTask(void* param)
+{
+    TInstallRxIsrsParams* params = (TInstallRxIsrsParams*)param;
+    params->result = params->rxQueue->InstallIsrs(params->rxPin);
+    xTaskNotifyGive(params->caller);
+    vTaskDelete(NULL);
+} // InstallRxIsrsTask
+
+#endif // ARDUINO_ARCH_ESP32
+
+// Initializes the VAN packet receiver.
+// On ESP32, 'isrCore' selects the core that services the interrupts, e.g. APP_CPU_NUM to keep them away from the
+// Wi-Fi stack. Each receive queue can have its own 'isrCore'; see 'RoutePinIsr' for the pin interrupt.
+bool TVanPacketRxQueue::Setup(uint8_t rxPin, int queueSize, int isrCore)
 {
     if (pin != VAN_NO_PIN_ASSIGNED) return false; // Already setup
+    if (queueSize <= 0) return false;
+
+    // Take a place in the list of receive queues; 'VanBusRx' is always the first
+    if (this != &VanBusRx)
+    {
+        int i = 1;
+        while (i < VAN_RX_MAX_QUEUES && rxQueues[i] != NULL && rxQueues[i] != this) i++;
+        if (i == VAN_RX_MAX_QUEUES) return false;  // Too many receive queues
+        rxQueues[i] = this;
+        index = i;
+
+      #if defined ARDUINO_ARCH_ESP32 && VAN_RX_MAX_QUEUES > 1
+        isrMux = rxQueueMux + i - 1;
+      #endif // defined ARDUINO_ARCH_ESP32 && VAN_RX_MAX_QUEUES > 1
+    } // if
 
     pinMode(rxPin, INPUT_PULLUP);
 
     size = queueSize;
     startDroppingPacketsAt = queueSize;
+    bulkMaxDepth = bulkDepth == 0 ? _max(1, queueSize / 2) : _min(bulkDepth, queueSize);
     pool = new TVanPacketRxDesc[queueSize];
     _head = pool;
     tail = pool;
@@ -1212,63 +1994,445 @@ bool TVanPacketRxQueue::Setup(uint8_t rxPin, int queueSize)
     _head->isrDebugPacket = isrDebugPacket;
   #endif // VAN_RX_ISR_DEBUGGING
 
-    for (TVanPacketRxDesc* rxDesc = pool; rxDesc < end; rxDesc++) rxDesc->slot = rxDesc - pool;
-
-    attachInterrupt(digitalPinToInterrupt(rxPin), RxPinChangeIsr, CHANGE);
-    enabled = true;
+    for (TVanPacketRxDesc* rxDesc = pool; rxDesc < end; rxDesc++)
+    {
+      #ifndef VAN_RX_COMPACT_DESC
+        rxDesc->slot = rxDesc - pool;
+      #endif // VAN_RX_COMPACT_DESC
+        rxDesc->queue = index;
+    } // for
 
   #ifdef ARDUINO_ARCH_ESP32
-    // Clock to timer (prescaler) is always 80MHz, even F_CPU is 160 MHz. We want 0.2 microsecond resolution.
-    timer = timerBegin(0, 80 / 5, true);
-    timerAlarmDisable(timer);
+    if (isrCore != VAN_ISR_CORE_CALLER && isrCore != xPortGetCoreID())
+    {
+        TInstallRxIsrsParams params = { this, rxPin, xTaskGetCurrentTaskHandle(), false };
+        if (xTaskCreatePinnedToCore(InstallRxIsrsTask, "VanBusRxSetup", 2048, &params, configMAX_PRIORITIES - 1, NULL,
+                isrCore) != pdPASS)
+        {
+            return AbortSetup(rxPin);
+        } // if
+
+        // Wait until done
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        if (! params.result) return AbortSetup(rxPin);
+    }
+    else
+    {
+        if (! InstallIsrs(rxPin)) return AbortSetup(rxPin);
+    } // if
   #else // ! ARDUINO_ARCH_ESP32
-    timer1_isr_init();
-    timer1_disable();
+    (void)isrCore;  // Single core
+    if (! InstallIsrs(rxPin)) return AbortSetup(rxPin);
   #endif // ARDUINO_ARCH_ESP32
 
+    enabled = true;
     pin = rxPin;
 
     return true;
 } // TVanPacketRxQueue::Setup
 
+// Undoes what 'Setup' did so far, so that 'Setup' can be tried again, and the place in the list of receive queues is
+// free for another receive queue. Always returns false.
+bool TVanPacketRxQueue::AbortSetup(uint8_t rxPin)
+{
+  #ifndef VAN_RX_ESP32_RMT
+    // 'InstallIsrs' may have failed after attaching the pin interrupt
+    detachInterrupt(digitalPinToInterrupt(rxPin));
+  #ifdef ARDUINO_ARCH_ESP32
+    if (ownGpioIsr) GPIO.pin[rxPin].int_ena = 0;
+    ownGpioIsr = false;
+  #endif // ARDUINO_ARCH_ESP32
+  #else // VAN_RX_ESP32_RMT
+    (void)rxPin;
+  #endif // VAN_RX_ESP32_RMT
+
+    delete[] pool;
+    pool = NULL;
+    _head = NULL;
+    tail = NULL;
+    end = NULL;
+    size = 0;
+    bulkMaxDepth = bulkDepth;
+
+    if (this != &VanBusRx)
+    {
+        rxQueues[index] = NULL;
+        index = 0;
+
+      #if defined ARDUINO_ARCH_ESP32 && VAN_RX_MAX_QUEUES > 1
+        isrMux = &mux;
+      #endif // defined ARDUINO_ARCH_ESP32 && VAN_RX_MAX_QUEUES > 1
+    } // if
+
+    return false;
+} // TVanPacketRxQueue::AbortSetup
+
 // Copy a VAN packet out of the receive queue, if available. Otherwise, returns false.
 // If a valid pointer is passed to 'isQueueOverrun', will report then clear any queue overrun condition.
 bool TVanPacketRxQueue::Receive(TVanPacketRxDesc& pkt, bool* isQueueOverrun)
 {
-    if (pin == VAN_NO_PIN_ASSIGNED) return false; // Call Setup first!
-
-    if (! Available()) return false;
+    TVanPacketRxDesc* rxDesc = Peek(isQueueOverrun);
+    if (rxDesc == NULL) return false;
 
     // Copy the whole packet descriptor out (including the debug info)
     // Note:
-    // Instead of copying out, we could also just pass the pointer to the descriptor. However, then we would have to
-    // wait with freeing the descriptor, thus keeping one precious queue slot allocated. It is better to copy the
-    // packet into the (usually stack-allocated) memory of 'pkt' and free the queue slot as soon as possible. The
-    // caller can now keep the packet as long as needed.
-    pkt = *tail;
+    // Instead of copying out, we could also just pass the pointer to the descriptor (see 'Peek'). However, then we
+    // would have to wait with freeing the descriptor, thus keeping one precious queue slot allocated. It is better to
+    // copy the packet into the (usually stack-allocated) memory of 'pkt' and free the queue slot as soon as possible.
+    // The caller can now keep the packet as long as needed.
+    pkt = *rxDesc;
+
+    Release();
+
+    return true;
+} // TVanPacketRxQueue::Receive
+
+// Copy up to 'max' VAN packets out of the receive queue, into the array 'pkts'. Returns the number of packets
+// copied, which is 0 if none were available.
+// If a valid pointer is passed to 'isQueueOverrun', will report then clear any queue overrun condition.
+// Useful to quickly catch up after the main loop has been stalled for a while: the queue fill level is read and
+// updated only once, regardless of the number of packets copied.
+int TVanPacketRxQueue::ReceiveMany(TVanPacketRxDesc* pkts, int max, bool* isQueueOverrun)
+{
+    if (pin == VAN_NO_PIN_ASSIGNED) return 0; // Call Setup first!
+    if (max < 0) max = 0;  // A negative count would be subtracted from the fill level
+
+    Poll();
+
+    if (repairBudgetCycles != 0 || nRepairQueued != 0)
+    {
+        // One by one, so that packets with a CRC error can be set aside (see 'PeekDeferred')
+        if (isQueueOverrun) *isQueueOverrun = IsQueueOverrun();
+        int n = 0;
+        while (n < max && Receive(pkts[n])) n++;
+        return n;
+    } // if
+
+    // First the high priority lane
+    int nHigh = GetNQueuedHigh();
+    VAN_ACQUIRE_BARRIER;  // Don't read the slots before knowing they are filled
+    if (nHigh > max) nHigh = max;
+
+    for (int i = 0; i < nHigh; i++)
+    {
+      #ifdef VAN_RX_STATS
+        stats._CountLatency(ESP.getCycleCount() - (uint32_t)highTail->eofAt);  // Arithmetic has safe roll-over
+      #endif // VAN_RX_STATS
+
+        pkts[i] = *highTail;
+        highTail->Init();
+        if (++highTail == highEnd) highTail = highPool;  // Roll over if needed
+    } // for
+
+    nHighDequeued += nHigh;
+
+    // All slots from 'tail' onwards, up to the snapshot of the fill level, are VAN_RX_DONE; the ISR will not touch
+    // these
+    int nAvailable = GetNQueuedNormal();
+    VAN_ACQUIRE_BARRIER;  // Don't read the slots before knowing they are filled
+    if (nAvailable > max - nHigh) nAvailable = max - nHigh;
+
+    int nBulk = 0;
+    for (int i = 0; i < nAvailable; i++)
+    {
+      #ifdef VAN_RX_STATS
+        stats._CountLatency(ESP.getCycleCount() - (uint32_t)tail->eofAt);  // Arithmetic has safe roll-over
+      #endif // VAN_RX_STATS
+
+        pkts[nHigh + i] = *tail;
+        if (tail->lane == VAN_RX_LANE_BULK) nBulk++;
+
+        // Indicate packet buffer is available for next packet
+        tail->Init();
+
+        if (++tail == end) tail = pool;  // Roll over if needed
+    } // for
+
+    nDequeued += nAvailable;
+    nBulkDequeued += nBulk;
+
+    if (isQueueOverrun) *isQueueOverrun = IsQueueOverrun();
+
+    return nHigh + nAvailable;
+} // TVanPacketRxQueue::ReceiveMany
+
+// Returns a pointer to the oldest VAN packet in the receive queue, if available. Otherwise, returns NULL.
+// If a valid pointer is passed to 'isQueueOverrun', will report then clear any queue overrun condition.
+// The packet is not copied: it stays in its queue slot, where it can be inspected (and repaired by
+// 'CheckCrcAndRepair') in place. The ISR will not touch the slot until it is freed by calling 'Release'. Don't keep
+// the slot allocated for longer than needed; use 'Receive' to obtain a copy that can be kept for a long time.
+TVanPacketRxDesc* TVanPacketRxQueue::Peek(bool* isQueueOverrun)
+{
+    if (pin == VAN_NO_PIN_ASSIGNED) return NULL; // Call Setup first!
+
+    Poll();
+
+    if (repairBudgetCycles != 0 || nRepairQueued != 0) return PeekDeferred(isQueueOverrun);
+    return PeekQueued(isQueueOverrun);
+} // TVanPacketRxQueue::Peek
+
+// Returns a pointer to the oldest VAN packet in the receive queue, if available. Otherwise, returns NULL.
+TVanPacketRxDesc* TVanPacketRxQueue::PeekQueued(bool* isQueueOverrun)
+{
+    if (! Available()) return NULL;
+
+    if (isQueueOverrun) *isQueueOverrun = IsQueueOverrun();
+
+    // Serve the high priority lane first
+    TVanPacketRxDesc* const pkt = GetNQueuedHigh() > 0 ? highTail : tail;
+
+  #ifdef VAN_RX_STATS
+    // Count only once, even if the same packet is peeked at multiple times
+    if (pkt != peeked) stats._CountLatency(ESP.getCycleCount() - (uint32_t)pkt->eofAt);  // Safe roll-over
+  #endif // VAN_RX_STATS
+
+    peeked = pkt;
+    return peeked;
+} // TVanPacketRxQueue::PeekQueued
+
+// 'Peek' with deferred CRC repair (see 'SetRepairBudget'). Packets with a correct CRC are passed on right away, in
+// their queue slot. Packets with a CRC error are copied into 'repairQueue', and their queue slot is freed. If no
+// packet is available, one repair step is done on the oldest packet in 'repairQueue'. When its repair is finished,
+// successful or not, that packet is passed on, in its 'repairQueue' entry. Its sequence number is not changed, so
+// it may be passed on after packets that were received later.
+TVanPacketRxDesc* TVanPacketRxQueue::PeekDeferred(bool* isQueueOverrun)
+{
+    if (peeked != NULL) return peeked;  // Not released yet
+
+    TVanPacketRxDesc* pkt;
+    while ((pkt = PeekQueued(isQueueOverrun)) != NULL)
+    {
+        isQueueOverrun = NULL;  // Already reported
+
+        if (repairBudgetCycles == 0 || pkt->CheckCrc()) return pkt;
+
+        if (nRepairQueued == VAN_RX_REPAIR_QUEUE_SIZE)
+        {
+            // No room to set the packet aside. Pass it on as it is, instead of repairing it here: that would hold up
+            // the caller. The caller can still repair it, by 'CheckCrcAndRepair', which then also counts it.
+            nRepairsSkipped++;
+            pkt->crcStatus = VAN_RX_CRC_REPAIR_SKIPPED;
+            return pkt;
+        } // if
+
+        int i = repairFirst + nRepairQueued;
+        if (i >= VAN_RX_REPAIR_QUEUE_SIZE) i -= VAN_RX_REPAIR_QUEUE_SIZE;  // Roll over if needed
+        repairQueue[i] = *pkt;
+        nRepairQueued++;
+
+        Release();
+    } // while
+
+    if (nRepairQueued == 0) return NULL;
+
+    pkt = repairQueue + repairFirst;
+
+    // When no longer deferring, pass on the packet unrepaired; 'CheckCrcAndRepair' will do the rest
+    if (repairBudgetCycles != 0 && ! RepairStep(*pkt)) return NULL;
+
+    peeked = pkt;
+    return peeked;
+} // TVanPacketRxQueue::PeekDeferred
+
+// Spends at most 'repairBudgetCycles' CPU cycles on repairing 'pkt' (the oldest packet in 'repairQueue'). Returns
+// true if the repair is finished, successful or not. Note: the first step always checks the CRC value and tries all
+// quick repairs, even if that takes longer.
+bool TVanPacketRxQueue::RepairStep(TVanPacketRxDesc& pkt)
+{
+    const uint32_t start = ESP.getCycleCount();
+
+    if (repairAtByte == 0)
+    {
+        pkt.crcStatus = pkt.RepairQuick(repairWantToCount, repairSyndrome);
+        repairAtByte = 1;
+        repairPrevBit = false;
+    } // if
+
+    if (pkt.crcStatus == VAN_RX_CRC_UNCHECKED)
+    {
+        // Always at least one byte, so that each step makes progress
+        const uint32_t spent = ESP.getCycleCount() - start;  // Arithmetic has safe roll-over
+        pkt.crcStatus = pkt.RepairTwoSeparateBits(
+            repairWantToCount,
+            repairSyndrome,
+            repairAtByte,
+            repairPrevBit,
+            spent < repairBudgetCycles ? repairBudgetCycles - spent : 1);
+    } // if
+
+  #ifdef VAN_RX_STATS
+    stats._CountRepair(ESP.getCycleCount() - start);  // Arithmetic has safe roll-over
+  #endif // VAN_RX_STATS
+
+    return pkt.crcStatus != VAN_RX_CRC_UNCHECKED;
+} // TVanPacketRxQueue::RepairStep
+
+// Deferred CRC repair. Packets with a CRC error are set aside in a small repair queue, so that the packets behind
+// them are passed on right away by 'Peek', 'Receive', 'ReceiveMany' and 'OnPacket'. Each of these calls that finds
+// no other packet to pass on, spends at most 'budgetMicros' microseconds on repairing the oldest packet set aside
+// (see 'TVanPacketRxDesc::CheckCrcAndRepair'), and passes it on when its repair is finished. Packets needing the
+// lengthy search for two separate bit errors take multiple calls. 'wantToCount' is as with 'CheckCrcAndRepair'.
+// On ESP32, use 'OnPacket' with another core to have the repairs done on that core.
+// Pass 0 as 'budgetMicros' to stop deferring; packets already set aside are then passed on unrepaired.
+// Note: 'Available' does not take into account the packets set aside.
+void TVanPacketRxQueue::SetRepairBudget(unsigned int budgetMicros, bool (TVanPacketRxDesc::*wantToCount)() const)
+{
+    if (budgetMicros > 0 && repairQueue == NULL) repairQueue = new TVanPacketRxDesc[VAN_RX_REPAIR_QUEUE_SIZE];
+
+    repairWantToCount = wantToCount;
+    repairBudgetCycles = budgetMicros * (F_CPU / 1000000);
+} // TVanPacketRxQueue::SetRepairBudget
+
+// Frees the queue slot of the packet as returned by 'Peek'. After this, the pointer as returned by 'Peek' must no
+// longer be used.
+void TVanPacketRxQueue::Release()
+{
+    if (pin == VAN_NO_PIN_ASSIGNED) return; // Call Setup first!
+
+    // Packet from the repair queue (see 'PeekDeferred')?
+    if (repairQueue != NULL && peeked == repairQueue + repairFirst)
+    {
+        peeked = NULL;
+        repairAtByte = 0;
+        if (++repairFirst == VAN_RX_REPAIR_QUEUE_SIZE) repairFirst = 0;  // Roll over if needed
+        nRepairQueued--;
+        return;
+    } // if
+
+    // Nothing to release? Then don't touch the slot; it may be in use by the ISR.
+    if (! Available()) return;
+
+    // Release the slot as returned by 'Peek', even if a high priority packet came in meanwhile
+    const bool high = peeked != NULL ? peeked == highTail : GetNQueuedHigh() > 0;
+    peeked = NULL;
+
+    if (high)
+    {
+        highTail->Init();
+        if (++highTail == highEnd) highTail = highPool;  // Roll over if needed
+        nHighDequeued++;
+        return;
+    } // if
+
+    if (tail->lane == VAN_RX_LANE_BULK) nBulkDequeued++;
+
+    // Indicate packet buffer is available for next packet
+    tail->Init();
+
+    AdvanceTail();
+} // TVanPacketRxQueue::Release
+
+// Pass all queued packets to the 'OnPacket' callback
+void TVanPacketRxQueue::DeliverPackets()
+{
+    TVanPacketRxDesc* pkt;
+    while (onPacket != NULL && (pkt = Peek()) != NULL)
+    {
+        (*onPacket)(*pkt);
+        Release();
+    } // while
+} // TVanPacketRxQueue::DeliverPackets
+
+#ifdef ARDUINO_ARCH_ESP32
+
+#ifndef VAN_RX_CONSUMER_TASK_STACK_SIZE
+  #define VAN_RX_CONSUMER_TASK_STACK_SIZE 4096
+#endif // VAN_RX_CONSUMER_TASK_STACK_SIZE
+
+// Task that sleeps until notified by '_AdvanceHead', then passes the received packets to the 'OnPacket' callback.
+// The receive queue is passed as 'param'.
+void RxConsumerTask(void* param)
+{
+    TVanPacketRxQueue* rxQueue = (TVanPacketRxQueue*)param;
+
+    for (;;)
+    {
+        // While packets are set aside for deferred repair, continue with the next repair step every tick
+        ulTaskNotifyTake(pdTRUE, rxQueue->nRepairQueued > 0 ? 1 : portMAX_DELAY);
+        rxQueue->DeliverPackets();
+    } // for
+} // RxConsumerTask
+
+#else // ! ARDUINO_ARCH_ESP32
+
+// Scheduled by '_AdvanceHead'; runs from the main loop context, between two 'loop()' invocations
+void TVanPacketRxQueue::DeliverScheduledPackets()
+{
+    // Clear the flag before delivering: a packet coming in while delivering must schedule a new delivery
+    deliveryScheduled = false;
+    DeliverPackets();
+
+    // While packets are set aside for deferred repair, continue with the next repair step after the next 'loop()'
+    if (nRepairQueued > 0 && onPacket != NULL && ! deliveryScheduled)
+    {
+        deliveryScheduled = true;
+        if (! schedule_function([this]() { DeliverScheduledPackets(); })) deliveryScheduled = false;
+    } // if
+} // TVanPacketRxQueue::DeliverScheduledPackets
+
+#endif // ARDUINO_ARCH_ESP32
+
+// Register a function to be called for each received packet, instead of polling 'Receive' in 'loop()'. Pass NULL
+// to stop. The packet is passed in its queue slot (see 'Peek'); the slot is freed when the callback returns.
+// - On ESP32, the callback is invoked by a task (running on core 'core') that sleeps until a packet is received.
+// - On ESP8266, the callback is invoked from the main loop context, between two 'loop()' invocations. 'core' is
+//   ignored.
+// Don't call 'Receive', 'ReceiveMany' or 'Peek' while a callback is registered.
+bool TVanPacketRxQueue::OnPacket(void (*callback)(TVanPacketRxDesc& pkt), int core)
+{
+    if (pin == VAN_NO_PIN_ASSIGNED) return false; // Call Setup first!
+
+  #ifdef ARDUINO_ARCH_ESP32
+
+    if (consumerTask == NULL)
+    {
+        if (core == VAN_ISR_CORE_CALLER) core = xPortGetCoreID();
+
+        // Higher priority than the loop() task, so that packets are delivered as soon as they come in
+        if (xTaskCreatePinnedToCore(RxConsumerTask, "VanBusRxConsumer", VAN_RX_CONSUMER_TASK_STACK_SIZE, this, 2,
+                &consumerTask, core) != pdPASS)
+        {
+            return false;
+        } // if
+    } // if
+
+    onPacket = callback;
+
+    // Deliver the packets that are already waiting
+    xTaskNotifyGive(consumerTask);
+
+  #else // ! ARDUINO_ARCH_ESP32
+
+    (void)core;  // Single core
 
-    if (isQueueOverrun) *isQueueOverrun = IsQueueOverrun();
+    onPacket = callback;
 
-    // Indicate packet buffer is available for next packet
-    tail->Init();
+    // Deliver the packets that are already waiting
+    deliveryScheduled = true;
+    if (! schedule_function([this]() { DeliverScheduledPackets(); })) deliveryScheduled = false;
 
-    AdvanceTail();
+  #endif // ARDUINO_ARCH_ESP32
 
     return true;
-} // TVanPacketRxQueue::Receive
+} // TVanPacketRxQueue::OnPacket
 
 // Disable VAN packet receiver
 void TVanPacketRxQueue::Disable()
 {
     if (pin == VAN_NO_PIN_ASSIGNED) return; // Call Setup first!
 
+    ackTimerArmed = false;
   #ifdef ARDUINO_ARCH_ESP32
-    timerAlarmDisable(timer);
+    if (ackTimer != NULL) timerAlarmDisable(ackTimer);
   #else // ! ARDUINO_ARCH_ESP32
-    timer1_disable();
+    if (! softAckTimer) timer1_disable();
   #endif // ARDUINO_ARCH_ESP32
 
-    detachInterrupt(digitalPinToInterrupt(VanBusRx.pin));
+  #ifdef VAN_RX_ESP32_RMT
+    rmt_rx_stop(rmtChannel);
+  #else // ! VAN_RX_ESP32_RMT
+    DetachPinIsr();
+  #endif // VAN_RX_ESP32_RMT
     enabled = false;
 } // TVanPacketRxQueue::Disable
 
@@ -1276,19 +2440,244 @@ void TVanPacketRxQueue::Disable()
 void TVanPacketRxQueue::Enable()
 {
     if (pin == VAN_NO_PIN_ASSIGNED) return; // Call Setup first!
-    attachInterrupt(digitalPinToInterrupt(VanBusRx.pin), RxPinChangeIsr, CHANGE);
+  #ifdef VAN_RX_ESP32_RMT
+    rmt_rx_start(rmtChannel, true);
+  #else // ! VAN_RX_ESP32_RMT
+    AttachPinIsr();
+  #endif // VAN_RX_ESP32_RMT
     enabled = true;
 } // TVanPacketRxQueue::Enable
 
+void TVanPacketRxQueue::SetIdleTimeout(unsigned long timeoutMs, void (*onIdle)(bool idle), bool lightSleep)
+{
+    idleTimeoutMs = timeoutMs;
+    onBusIdle = onIdle;
+    idleLightSleep = lightSleep;
+    busIdle = false;
+    idleCheckedMediaAccessAt = lastMediaAccessAt;
+    lastBusActivityMs = millis();
+} // TVanPacketRxQueue::SetIdleTimeout
+
+// Check if the bus went idle, or became active again
+void TVanPacketRxQueue::PollBusIdle()
+{
+    if (idleTimeoutMs == 0) return;
+
+    const uint32_t at = lastMediaAccessAt;
+    if (at != idleCheckedMediaAccessAt)
+    {
+        idleCheckedMediaAccessAt = at;
+        lastBusActivityMs = millis();
+        if (! busIdle) return;
+
+        busIdle = false;
+        if (onBusIdle != 0) onBusIdle(false);
+        return;
+    } // if
+
+    if (busIdle || millis() - lastBusActivityMs < idleTimeoutMs) return;  // Arithmetic has safe roll-over
+
+    // Set before calling back, in case the callback polls again
+    busIdle = true;
+    if (onBusIdle != 0) onBusIdle(true);
+    if (idleLightSleep) LightSleep();
+} // TVanPacketRxQueue::PollBusIdle
+
+// Sleep until the bus level on the receive pin goes 'dominant'
+bool TVanPacketRxQueue::LightSleep()
+{
+    if (pin == VAN_NO_PIN_ASSIGNED || ! enabled) return false;
+
+    // The transmitter needs the CPU (and the bus) until all its packets are sent. Asking the transmitter is the only
+    // way to know: e.g. with VAN_TX_ESP32_RMT, no timer ISR is registered while the RMT shifts out a packet.
+    if (VanBusRx.txIsBusy != NULL && VanBusRx.txIsBusy()) return false;
+
+  #ifdef ARDUINO_ARCH_ESP32
+
+    Disable();
+
+    gpio_wakeup_enable((gpio_num_t)pin, VAN_BIT_DOMINANT == LOW ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+    esp_light_sleep_start();
+
+    // The application may have set up other wake-up sources, e.g. a timer
+    const bool wokenByBus = esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO;
+
+    esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_GPIO);
+    gpio_wakeup_disable((gpio_num_t)pin);
+
+  #else // ! ARDUINO_ARCH_ESP32
+
+    // Forced light sleep is possible only with Wi-Fi off. GPIO 16 cannot wake up from light sleep.
+    if (wifi_get_opmode() != NULL_MODE || pin == 16) return false;
+
+    Disable();
+
+    wifi_fpm_set_sleep_type(LIGHT_SLEEP_T);
+    wifi_fpm_open();
+    gpio_pin_wakeup_enable(GPIO_ID_PIN(pin), VAN_BIT_DOMINANT == LOW ? GPIO_PIN_INTR_LOLEVEL : GPIO_PIN_INTR_HILEVEL);
+    wifi_fpm_do_sleep(0xFFFFFFF);  // Longest possible: sleep until woken up by the pin
+
+    // Light sleep starts when the SDK gets control. Keep the delay short: the rest of it runs after waking up, while
+    // the receiver is still disabled.
+    delay(1);
+
+    gpio_pin_wakeup_disable();
+    wifi_fpm_close();
+
+    const bool wokenByBus = true;
+
+  #endif // ARDUINO_ARCH_ESP32
+
+    // Resynchronize: the bus is somewhere in the packet that caused the wake-up. There was no packet in progress
+    // when going to sleep, since the bus was idle.
+    RX_NO_INTERRUPTS;
+    _rebaseCycleCount64();  // The CPU cycle counter stopped while sleeping
+    const uint32_t now = ESP.getCycleCount();
+    decoder.prev = now;
+    decoder.prevPinLevel = GPIP(pin);
+    decoder.noiseCounter = 0;
+    decoder.jitter = 0;
+    decoder.resync = true;
+    decoder.resyncDropping = false;
+  #ifdef VAN_RX_ESP32_RMT
+    resyncFromMicros = esp_timer_get_time();
+  #endif // VAN_RX_ESP32_RMT
+    if (wokenByBus) lastMediaAccessAt = now;
+    RX_INTERRUPTS;
+
+    Enable();
+
+    nLightSleeps++;
+
+    return true;
+} // TVanPacketRxQueue::LightSleep
+
 void TVanPacketRxQueue::SetDropPolicy(int startAt, bool (*isEssential)(const TVanPacketRxDesc& pkt) = 0)
 {
     startDroppingPacketsAt = startAt;
     isEssentialPacket = isEssential;
 } // TVanPacketRxQueue::SetDropPolicy
 
+// Put all IDENs that match 'iden' in the bits that are set in 'mask', into priority lane 'lane'
+bool TVanPacketRxQueue::SetIdenLane(uint16_t iden, VanRxLane_t lane, uint16_t mask)
+{
+    if (lane >= VAN_RX_N_LANES) return false;
+
+    if (lane == VAN_RX_LANE_HIGH && highPool == NULL)
+    {
+        TVanPacketRxDesc* newPool = new TVanPacketRxDesc[highSize];
+        highHead = newPool;
+        highTail = newPool;
+        highEnd = newPool + highSize;
+        VAN_RELEASE_BARRIER;
+        highPool = newPool;
+    } // if
+
+    if (idenLanes == NULL)
+    {
+        // Start with all IDENs in the normal lane; the ISR may start using the map as soon as it is assigned
+        uint32_t* lanes = new uint32_t[VAN_N_IDENS / 16];
+        memset(lanes, 0, VAN_N_IDENS / 4);
+        VAN_RELEASE_BARRIER;
+        idenLanes = lanes;
+    } // if
+
+    for (uint16_t i = 0; i < VAN_N_IDENS; i++)
+    {
+        if ((i & mask) != (iden & mask)) continue;
+
+        // The ISR only reads the map, and reading an aligned 32-bit value is atomic: no need to disable interrupts
+        const int shift = (i & 0x0F) * 2;
+        idenLanes[i >> 4] = (idenLanes[i >> 4] & ~ (0x03UL << shift)) | (uint32_t)lane << shift;
+    } // for
+
+    return true;
+} // TVanPacketRxQueue::SetIdenLane
+
+bool TVanPacketRxQueue::SetLaneDepth(VanRxLane_t lane, int depth)
+{
+    if (depth <= 0) return false;
+
+    if (lane == VAN_RX_LANE_HIGH)
+    {
+        // Cannot resize the high priority lane once it is in use
+        if (highPool != NULL) return false;
+        highSize = depth;
+        return true;
+    } // if
+
+    if (lane == VAN_RX_LANE_BULK)
+    {
+        bulkDepth = depth;
+
+        // Once the receive queue size is known, the bulk lane cannot be deeper than the receive queue
+        bulkMaxDepth = size > 0 ? _min(depth, size) : depth;
+        return true;
+    } // if
+
+    // The depth of the normal lane is the receive queue size, as passed to 'Setup'
+    return false;
+} // TVanPacketRxQueue::SetLaneDepth
+
+// Accept or reject all IDENs that match 'iden' in the bits that are set in 'mask'
+void TVanPacketRxQueue::SetIdenFilter(uint16_t iden, uint16_t mask, bool accept)
+{
+    if (idenFilter == NULL)
+    {
+        // Start with accepting all IDENs; the ISR may start using the filter as soon as it is assigned
+        uint32_t* filter = new uint32_t[VAN_N_IDENS / 32];
+        memset(filter, 0xFF, VAN_N_IDENS / 8);
+        VAN_RELEASE_BARRIER;
+        idenFilter = filter;
+    } // if
+
+    for (uint16_t i = 0; i < VAN_N_IDENS; i++)
+    {
+        if ((i & mask) != (iden & mask)) continue;
+
+        // The ISR only reads the filter, and reading an aligned 32-bit value is atomic: no need to disable interrupts
+        if (accept) idenFilter[i >> 5] |= 1UL << (i & 0x1F); else idenFilter[i >> 5] &= ~ (1UL << (i & 0x1F));
+    } // for
+} // TVanPacketRxQueue::SetIdenFilter
+
 void IRAM_ATTR TVanPacketRxQueue::_AdvanceHead()
 {
-    _head->millis_ = millis();
+  #ifndef VAN_RX_ESP32_RMT
+    // The decoder has written the packet bytes straight into the head slot; copy the rest. The time stamp is the end
+    // of the last 'dominant' bit. Note: with VAN_RX_ESP32_RMT, the decoding task has already filled in the slot.
+    _head->size = decoder.size;
+    _head->result = decoder.result;
+    _head->ack = decoder.ack;
+    _head->uncertainBit1 = decoder.uncertainBit1;
+    _head->SetTimeStamps(decoder.sofAt, lastMediaAccessAt);
+  #endif // VAN_RX_ESP32_RMT
+
+    const unsigned long now = millis();
+
+  #ifdef VAN_RX_STATS
+    // Also count the packets that are rejected by the acceptance filter: they load the bus all the same
+    stats._CountPacket(
+        _head->size >= 3 ? _head->Iden() : VAN_N_IDENS,
+        now,
+        _head->DurationCycles());
+  #endif // VAN_RX_STATS
+
+    // Rejected by the acceptance filter? Then just re-use the slot for the next packet.
+    if (headFiltered)
+    {
+        headFiltered = false;
+        nFiltered++;
+        _head->Init();
+
+      #ifdef VAN_RX_ISR_DEBUGGING
+        isrDebugPacket->Init();
+      #endif // VAN_RX_ISR_DEBUGGING
+
+        return;
+    } // if
+
+    _head->millis_ = now;
     _head->state = VAN_RX_DONE;
     _head->seqNo = count++;
 
@@ -1308,14 +2697,43 @@ void IRAM_ATTR TVanPacketRxQueue::_AdvanceHead()
     } // if
   #endif // VAN_RX_ISR_DEBUGGING
 
+    // Select the priority lane
+    const VanRxLane_t lane = _head->size >= 3 ? GetIdenLane(_head->Iden()) : VAN_RX_LANE_NORMAL;
+    _head->lane = lane;
+
     // Implement simple drop policy
-    if (nQueued <= startDroppingPacketsAt || (isEssentialPacket != 0 && (*isEssentialPacket)(*_head)))
+    const int nQueued = nEnqueued - nDequeued;  // Arithmetic has safe roll-over
+    const int nBulkQueued = nBulkEnqueued - nBulkDequeued;
+    if (lane == VAN_RX_LANE_HIGH && _CommitToHighLane())
+    {
+        // Copied into the high priority lane; free current slot in queue
+        _head->Init();
+    }
+    else if (lane == VAN_RX_LANE_BULK && nBulkQueued >= bulkMaxDepth)
+    {
+        // Too many bulk packets queued: drop just read packet; free current slot in queue
+        laneOverruns[VAN_RX_LANE_BULK]++;
+        _head->Init();
+    }
+    else if (nQueued <= startDroppingPacketsAt || (isEssentialPacket != 0 && (*isEssentialPacket)(*_head)))
     {
         // Move to next slot in queue
         if (++_head == end) _head = pool;  // Roll over if needed
 
+        // Hand the filled slot over to the consumer. Its contents must be visible before the new fill level.
+        VAN_RELEASE_BARRIER;
+        nEnqueued++;
+
         // Keep track of queue fill level
-        if (++nQueued > maxQueued) maxQueued = nQueued;
+        if (nQueued + 1 > maxQueued) maxQueued = nQueued + 1;
+
+        if (lane == VAN_RX_LANE_BULK)
+        {
+            nBulkEnqueued++;
+            if (nBulkQueued + 1 > laneMaxQueued[VAN_RX_LANE_BULK]) laneMaxQueued[VAN_RX_LANE_BULK] = nBulkQueued + 1;
+        } // if
+
+        _NotifyConsumer();
     }
     else
     {
@@ -1333,6 +2751,62 @@ void IRAM_ATTR TVanPacketRxQueue::_AdvanceHead()
   #endif // VAN_RX_IFS_DEBUGGING
 } // _AdvanceHead
 
+// Copy the packet in the head slot into the high priority lane. Returns false if that lane is not set up, or full.
+bool IRAM_ATTR TVanPacketRxQueue::_CommitToHighLane()
+{
+    if (highPool == NULL) return false;
+
+    const int nQueued = nHighEnqueued - nHighDequeued;  // Arithmetic has safe roll-over
+    if (nQueued >= highSize)
+    {
+        // High priority lane full: queue the packet in the normal lane instead
+        laneOverruns[VAN_RX_LANE_HIGH]++;
+        return false;
+    } // if
+
+    *highHead = *_head;
+    if (++highHead == highEnd) highHead = highPool;  // Roll over if needed
+
+    // Hand the filled slot over to the consumer. Its contents must be visible before the new fill level.
+    VAN_RELEASE_BARRIER;
+    nHighEnqueued++;
+
+    if (nQueued + 1 > laneMaxQueued[VAN_RX_LANE_HIGH]) laneMaxQueued[VAN_RX_LANE_HIGH] = nQueued + 1;
+
+    _NotifyConsumer();
+
+    return true;
+} // TVanPacketRxQueue::_CommitToHighLane
+
+// Wake up the 'OnPacket' consumer, if registered.
+// Note: called from ISR context, but with VAN_RX_ESP32_RMT also from task context.
+void IRAM_ATTR TVanPacketRxQueue::_NotifyConsumer()
+{
+    if (onPacket == NULL) return;
+
+  #ifdef ARDUINO_ARCH_ESP32
+
+    if (xPortInIsrContext())
+    {
+        BaseType_t higherPriorityTaskWoken = pdFALSE;
+        vTaskNotifyGiveFromISR(consumerTask, &higherPriorityTaskWoken);
+        if (higherPriorityTaskWoken) portYIELD_FROM_ISR();
+    }
+    else
+    {
+        xTaskNotifyGive(consumerTask);
+    } // if
+
+  #else // ! ARDUINO_ARCH_ESP32
+
+    // One pending delivery is enough: it will pass all queued packets
+    if (deliveryScheduled) return;
+    deliveryScheduled = true;
+    if (! schedule_function([this]() { DeliverScheduledPackets(); })) deliveryScheduled = false;
+
+  #endif // ARDUINO_ARCH_ESP32
+} // TVanPacketRxQueue::_NotifyConsumer
+
 // Simple function to generate a string representation of a float value.
 // Note: passed buffer size must be (at least) MAX_FLOAT_SIZE bytes, e.g. declare like this:
 //   char buffer[MAX_FLOAT_SIZE];
@@ -1404,11 +2878,384 @@ void TVanPacketRxQueue::DumpStats(Stream& s, bool longForm) const
                 : FloatToStr(floatBuf, 100.0 * overallCorrupt / pktCount, 3));
     } // if
 
-    s.printf_P(PSTR(", addBitTime: %ld"), addToBitTime / CPU_F_FACTOR);
+  #ifdef VAN_RX_ADAPTIVE_BIT_TIMING
+    // In CPU cycles at 80 MHz
+    s.printf_P(
+        PSTR(", bitTime: %s"),
+        FloatToStr(floatBuf, (float)decoder.busBitTime / (CPU_F_FACTOR << VAN_BIT_TIME_FRAC_BITS), 1));
+  #else // ! VAN_RX_ADAPTIVE_BIT_TIMING
+    s.printf_P(PSTR(", addBitTime: %ld"), decoder.addToBitTime / CPU_F_FACTOR);
+  #endif // VAN_RX_ADAPTIVE_BIT_TIMING
+
+    s.printf_P(PSTR(", maxQueued: %d/%d"), GetMaxQueued(), QueueSize());
+
+    if (longForm) s.printf_P(PSTR(" (%d bytes/slot)"), SlotSize());
+
+  #ifdef VAN_RX_STATS
+    if (longForm)
+    {
+        s.printf_P(
+            PSTR(", bus load: %s%%, max latency: %" PRIu32 " usec"),
+            FloatToStr(floatBuf, stats.BusLoadPercentAt(millis()), 1),
+            stats.maxLatencyMicros);
+    } // if
+  #endif // VAN_RX_STATS
+
+    if (idenFilter != NULL) s.printf_P(PSTR(", filtered: %" PRIu32), nFiltered);
 
-    s.printf_P(PSTR(", maxQueued: %d/%d\n"), GetMaxQueued(), QueueSize());
+    if (longForm && repairQueue != NULL)
+    {
+        s.printf_P(
+            PSTR(", deferred repairs: %d pending (%" PRIu32 " skipped)"),
+            nRepairQueued,
+            nRepairsSkipped);
+    } // if
+
+    if (longForm && (idleTimeoutMs != 0 || nLightSleeps != 0))
+    {
+        s.printf_P(
+            PSTR(", bus %s, light sleeps: %" PRIu32 " (%" PRIu32 " pkts lost at wake-up)"),
+            busIdle ? "idle" : "active",
+            nLightSleeps,
+            nLostAtWakeUp);
+    } // if
+
+    if (longForm && idenLanes != NULL)
+    {
+        s.printf_P(
+            PSTR(", high lane: %d/%d (%" PRIu32 " overflows), bulk lane: %d/%d (%" PRIu32 " dropped)"),
+            GetLaneMaxQueued(VAN_RX_LANE_HIGH),
+            highPool == NULL ? 0 : highSize,
+            GetLaneOverruns(VAN_RX_LANE_HIGH),
+            GetLaneMaxQueued(VAN_RX_LANE_BULK),
+            bulkMaxDepth,
+            GetLaneOverruns(VAN_RX_LANE_BULK));
+    } // if
+
+    s.print("\n");
 } // TVanPacketRxQueue::DumpStats
 
+#ifdef VAN_ISR_PROFILING
+
+// Prints the execution time statistics of an ISR
+void TIsrProfile::Dump(Stream& s) const
+{
+    char floatBuf[MAX_FLOAT_SIZE];
+
+    s.printf_P(PSTR("n: %" PRIu32), n);
+    if (n == 0)
+    {
+        s.print("\n");
+        return;
+    } // if
+
+    // Using shared buffer floatBuf, so only one invocation per printf
+    s.printf_P(PSTR(", min: %s"), FloatToStr(floatBuf, (float)minCycles / (F_CPU / 1000000), 2));
+    s.printf_P(PSTR(", avg: %s"), FloatToStr(floatBuf, (float)totalCycles / n / (F_CPU / 1000000), 2));
+    s.printf_P(PSTR(", max: %s usec;"), FloatToStr(floatBuf, (float)maxCycles / (F_CPU / 1000000), 2));
+
+    // Histogram; empty bins are not printed
+    for (int i = 0; i < VAN_ISR_PROFILE_N_BINS; i++)
+    {
+        if (hist[i] == 0) continue;
+        s.printf_P(PSTR(" %s%d:%" PRIu32), i == VAN_ISR_PROFILE_N_BINS - 1 ? ">=" : "", i, hist[i]);
+    } // for
+    s.print("\n");
+} // TIsrProfile::Dump
+
+// Prints the execution time statistics of 'RxPinChangeIsr' (per packet read state) and 'WaitAckIsr'
+void TVanPacketRxQueue::DumpIsrProfile(Stream& s, bool reset)
+{
+    // Take a consistent copy, then print at leisure
+    TIsrProfile profile[VAN_RX_N_STATES + 1];
+
+    RX_NO_INTERRUPTS;
+    for (int i = 0; i < VAN_RX_N_STATES; i++)
+    {
+        profile[i] = rxIsrProfile[i];
+        if (reset) rxIsrProfile[i].Init();
+    } // for
+    profile[VAN_RX_N_STATES] = waitAckIsrProfile;
+    if (reset) waitAckIsrProfile.Init();
+    RX_INTERRUPTS;
+
+    s.printf_P(PSTR("ISR profile (bins in usec):\n"));
+    for (int i = 0; i < VAN_RX_N_STATES; i++)
+    {
+        s.printf_P(PSTR("RxPinChangeIsr %-11s "), TVanPacketRxDesc::StateStr(i + VAN_RX_VACANT));
+        profile[i].Dump(s);
+    } // for
+    s.printf_P(PSTR("WaitAckIsr                 "));
+    profile[VAN_RX_N_STATES].Dump(s);
+} // TVanPacketRxQueue::DumpIsrProfile
+
+#endif // VAN_ISR_PROFILING
+
+#ifdef VAN_RX_STATS
+
+// Nominal VAN bit time: 125 kbit/sec
+#define VAN_STATS_BIT_TIME_CPU_CYCLES (F_CPU / 125000)
+
+// Copies the receiver statistics into 'snapshot'; optionally clears them
+void TVanPacketRxQueue::GetStats(TVanRxStats& snapshot, bool reset)
+{
+    const unsigned long now = millis();
+
+    RX_NO_INTERRUPTS;
+    snapshot = stats;
+    if (reset)
+    {
+        // Keep the bus load window: it is sliding anyway
+        memset(&stats, 0, sizeof(stats));
+        memcpy(stats.window, snapshot.window, sizeof(stats.window));
+        stats.sinceMillis = now;
+    } // if
+    RX_INTERRUPTS;
+
+    snapshot.atMillis = now;
+} // TVanPacketRxQueue::GetStats
+
+// Counts a received packet: bus load and packet count per IDEN. Pass 'iden' = VAN_N_IDENS if the packet has no
+// (complete) IDEN.
+void IRAM_ATTR TVanRxStats::_CountPacket(uint16_t iden, unsigned long ms, uint32_t busyCycles)
+{
+    const uint32_t epoch = ms >> VAN_STATS_BUCKET_SHIFT;
+    TWindowBucket* bucket = window + epoch % VAN_STATS_N_WINDOW_BUCKETS;
+    if (bucket->epoch != epoch)
+    {
+        // Bucket is re-used for a new period
+        bucket->epoch = epoch;
+        bucket->busyCycles = 0;
+    } // if
+    bucket->busyCycles += busyCycles;
+
+    if (iden >= VAN_N_IDENS) return;
+
+    // Open addressing with linear probing
+    unsigned int i = (iden ^ iden >> 6) & (VAN_STATS_N_IDENS - 1);
+    for (int n = 0; n < VAN_STATS_N_IDENS; n++)
+    {
+        TIdenCount* entry = idens + i;
+        if (entry->key == iden + 1)
+        {
+            entry->count++;
+            return;
+        } // if
+        if (entry->key == 0)
+        {
+            entry->key = iden + 1;
+            entry->count = 1;
+            return;
+        } // if
+        i = (i + 1) & (VAN_STATS_N_IDENS - 1);
+    } // for
+
+    nUntracked++;
+} // TVanRxStats::_CountPacket
+
+// Counts the measured time between two bus level changes, and the jitter built up so far
+void IRAM_ATTR TVanRxStats::_CountPulse(uint32_t nCycles, uint32_t jitter)
+{
+    uint32_t bin = nCycles / (VAN_STATS_BIT_TIME_CPU_CYCLES / 4);
+    pulseHist[bin < VAN_STATS_N_PULSE_BINS ? bin : VAN_STATS_N_PULSE_BINS - 1]++;
+
+    bin = jitter / (VAN_STATS_BIT_TIME_CPU_CYCLES / 16);
+    jitterHist[bin < VAN_STATS_N_JITTER_BINS ? bin : VAN_STATS_N_JITTER_BINS - 1]++;
+} // TVanRxStats::_CountPulse
+
+// Counts the time a packet spent in the receive queue
+void TVanRxStats::_CountLatency(uint32_t cycles)
+{
+    const uint32_t micros = cycles / (F_CPU / 1000000);
+    if (micros > maxLatencyMicros) maxLatencyMicros = micros;
+
+    const int bin = micros == 0 ? 0 : 32 - __builtin_clz(micros);  // Bin i: from 2^(i-1) up to 2^i usec
+    latencyHist[bin < VAN_STATS_N_LATENCY_BINS ? bin : VAN_STATS_N_LATENCY_BINS - 1]++;
+} // TVanRxStats::_CountLatency
+
+// Counts the time spent in one invocation of 'TVanPacketRxDesc::CheckCrcAndRepair'
+void TVanRxStats::_CountRepair(uint32_t cycles)
+{
+    nRepairCalls++;
+    repairCycles += cycles;
+    if (cycles > maxRepairCycles) maxRepairCycles = cycles;
+} // TVanRxStats::_CountRepair
+
+// Percentage of time the bus was busy, over the sliding window ending at 'ms'
+float TVanRxStats::BusLoadPercentAt(unsigned long ms) const
+{
+    const uint32_t epoch = ms >> VAN_STATS_BUCKET_SHIFT;
+
+    uint64_t busyCycles = 0;
+    for (int i = 0; i < VAN_STATS_N_WINDOW_BUCKETS; i++)
+    {
+        // Skip buckets that are not in the window
+        if (epoch - window[i].epoch < VAN_STATS_N_WINDOW_BUCKETS) busyCycles += window[i].busyCycles;
+    } // for
+
+    // The current bucket is only partly filled
+    const uint32_t windowMs =
+        ((VAN_STATS_N_WINDOW_BUCKETS - 1) << VAN_STATS_BUCKET_SHIFT)
+        + (ms & ((1 << VAN_STATS_BUCKET_SHIFT) - 1));
+
+    return 100.0 * busyCycles / ((float)windowMs * (F_CPU / 1000));
+} // TVanRxStats::BusLoadPercentAt
+
+// Number of packets with the specified IDEN since the previous reset
+uint32_t TVanRxStats::IdenCount(uint16_t iden) const
+{
+    unsigned int i = (iden ^ iden >> 6) & (VAN_STATS_N_IDENS - 1);
+    for (int n = 0; n < VAN_STATS_N_IDENS; n++)
+    {
+        if (idens[i].key == iden + 1) return idens[i].count;
+        if (idens[i].key == 0) break;
+        i = (i + 1) & (VAN_STATS_N_IDENS - 1);
+    } // for
+
+    return 0;
+} // TVanRxStats::IdenCount
+
+// Average number of packets per second with the specified IDEN, since the previous reset
+float TVanRxStats::PacketsPerSecond(uint16_t iden) const
+{
+    const unsigned long elapsed = atMillis - sinceMillis;
+    return elapsed == 0 ? 0.0 : 1000.0 * IdenCount(iden) / elapsed;
+} // TVanRxStats::PacketsPerSecond
+
+// Average time spent in 'TVanPacketRxDesc::CheckCrcAndRepair'
+float TVanRxStats::AvgRepairMicros() const
+{
+    return nRepairCalls == 0 ? 0.0 : (float)repairCycles / nRepairCalls / (F_CPU / 1000000);
+} // TVanRxStats::AvgRepairMicros
+
+// Dumps all statistics in a snapshot as obtained by 'TVanPacketRxQueue::GetStats'. Histogram bins that are empty
+// are not printed.
+void TVanRxStats::Dump(Stream& s) const
+{
+    char floatBuf[MAX_FLOAT_SIZE];
+
+    // Using shared buffer floatBuf, so only one invocation per printf
+    s.printf_P(PSTR("bus load: %s%%"), FloatToStr(floatBuf, BusLoadPercent(), 1));
+    s.printf_P(PSTR(", period: %lu msec\n"), atMillis - sinceMillis);
+
+    s.print(F("pkts/sec per IDEN:"));
+    for (int i = 0; i < VAN_STATS_N_IDENS; i++)
+    {
+        if (idens[i].key == 0) continue;
+        const uint16_t iden = idens[i].key - 1;
+        s.printf_P(PSTR(" %03X:%s"), iden, FloatToStr(floatBuf, PacketsPerSecond(iden), 1));
+    } // for
+    if (nUntracked > 0) s.printf_P(PSTR(" (untracked: %" PRIu32 ")"), nUntracked);
+    s.print("\n");
+
+    s.print(F("queue latency (usec):"));
+    for (int i = 0; i < VAN_STATS_N_LATENCY_BINS; i++)
+    {
+        if (latencyHist[i] > 0) s.printf_P(PSTR(" <%lu:%" PRIu32), 1UL << i, latencyHist[i]);
+    } // for
+    s.printf_P(PSTR(", max: %" PRIu32 "\n"), maxLatencyMicros);
+
+    s.print(F("pulse length (1/4 bits):"));
+    for (int i = 0; i < VAN_STATS_N_PULSE_BINS; i++)
+    {
+        if (pulseHist[i] > 0) s.printf_P(PSTR(" %d:%" PRIu32), i, pulseHist[i]);
+    } // for
+    s.print("\n");
+
+    s.print(F("jitter (1/16 bits):"));
+    for (int i = 0; i < VAN_STATS_N_JITTER_BINS; i++)
+    {
+        if (jitterHist[i] > 0) s.printf_P(PSTR(" %d:%" PRIu32), i, jitterHist[i]);
+    } // for
+    s.print("\n");
+
+    s.printf_P(PSTR("CheckCrcAndRepair: %" PRIu32 " calls, avg: %s usec"),
+        nRepairCalls,
+        FloatToStr(floatBuf, AvgRepairMicros(), 1));
+    s.printf_P(PSTR(", max: %" PRIu32 " usec\n"), MaxRepairMicros());
+} // TVanRxStats::Dump
+
+#endif // VAN_RX_STATS
+
+bool TVanIdenMap::Set(uint16_t iden, uint8_t value)
+{
+    if (iden >= VAN_N_IDENS || value == VAN_IDEN_MAP_NONE) return false;
+
+    unsigned int i = Hash(iden);
+    for (int n = 0; n < VAN_IDEN_MAP_SIZE; n++)
+    {
+        if (keys[i] == iden + 1)
+        {
+            values[i] = value;
+            return true;
+        } // if
+        if (keys[i] == 0)
+        {
+            keys[i] = iden + 1;
+            values[i] = value;
+            count++;
+            return true;
+        } // if
+        i = (i + 1) & (VAN_IDEN_MAP_SIZE - 1);
+    } // for
+
+    return false;  // Map is full
+} // TVanIdenMap::Set
+
+// The CRC field directly follows the data bytes
+#define CRC_FIELD(PKT_) ((PKT_).Data()[(PKT_).DataLen()] << 8 | (PKT_).Data()[(PKT_).DataLen() + 1])
+
+bool TVanDupCache::IsDuplicate(const TVanPacketRxDesc& pkt) const
+{
+    const TSlot* slot = Slot(pkt.Iden());
+    if (slot == NULL) return false;
+
+    const int dataLen = pkt.DataLen();
+    if (slot->dataLen != dataLen) return false;
+
+    // With the same IDEN and command flags, a different CRC means different data
+    if (slot->flags == pkt.CommandFlags() && slot->crc != CRC_FIELD(pkt)) return false;
+
+    return memcmp(slot->data, pkt.Data(), dataLen) == 0;
+} // TVanDupCache::IsDuplicate
+
+bool TVanDupCache::Remember(const TVanPacketRxDesc& pkt)
+{
+    const int dataLen = pkt.DataLen();
+    if (dataLen < 0 || dataLen > VAN_MAX_DATA_BYTES) return false;
+
+    const uint16_t iden = pkt.Iden();
+    uint8_t i = slotMap.Get(iden);
+    if (i == VAN_IDEN_MAP_NONE)
+    {
+        if (nSlots >= VAN_DUP_CACHE_SLOTS || ! slotMap.Set(iden, nSlots)) return false;
+        i = nSlots++;
+    } // if
+
+    TSlot* slot = slots + i;
+    slot->crc = CRC_FIELD(pkt);
+    slot->flags = pkt.CommandFlags();
+    slot->dataLen = dataLen;
+    memcpy(slot->data, pkt.Data(), dataLen);
+
+    return true;
+} // TVanDupCache::Remember
+
+const uint8_t* TVanDupCache::Data(uint16_t iden, int& dataLen) const
+{
+    const TSlot* slot = Slot(iden);
+    if (slot == NULL) return NULL;
+
+    dataLen = slot->dataLen;
+    return slot->data;
+} // TVanDupCache::Data
+
+void TVanDupCache::Forget(uint16_t iden)
+{
+    const uint8_t i = slotMap.Get(iden);
+    if (i != VAN_IDEN_MAP_NONE) slots[i].dataLen = -1;
+} // TVanDupCache::Forget
+
 #ifdef VAN_RX_IFS_DEBUGGING
 
 bool TIfsDebugPacket::IsAbnormal() const
@@ -3,7 +3,7 @@
  *
  * Written by Erik Tromp
  *
- * Version 0.4.1 - September, 2024
+ * Version 0.4.2 - October, 2026
  *
  * MIT license, all text above must be included in any redistribution.
  */
@@ -21,6 +21,17 @@
  *   In loop() :
  *     TVanPacketRxDesc pkt;
  *     if (VanBusRx.Receive(pkt)) pkt.DumpRaw(Serial);
+ *
+ *   Or, without copying the packet out of the receive queue:
+ *     TVanPacketRxDesc* pkt = VanBusRx.Peek();
+ *     if (pkt != NULL)
+ *     {
+ *         pkt->DumpRaw(Serial);
+ *         VanBusRx.Release();
+ *     } // if
+ *
+ *   Or, instead of polling in loop(), have a function called for each received packet. In setup() :
+ *     VanBusRx.OnPacket(OnVanPacket);  // void OnVanPacket(TVanPacketRxDesc& pkt) { pkt.DumpRaw(Serial); }
  */
 
 #ifndef VanBusRx_h
@@ -32,50 +43,172 @@
 //#define VAN_RX_ISR_DEBUGGING
 //#define VAN_RX_IFS_DEBUGGING
 
-// VAN_BIT_DOMINANT, VAN_BIT_RECESSIVE: pick the logic
-#ifndef VAN_BIT_INVERTED_WIRING
-#define VAN_BIT_INVERTED_WIRING 1
+// Define to measure the execution time of the interrupt service routines 'RxPinChangeIsr' (per packet read state),
+// 'WaitAckIsr' and 'SendBitIsr'. Print the results with 'TVanPacketRxQueue::DumpIsrProfile' resp.
+// 'TVanPacketTxQueue::DumpIsrProfile'.
+//#define VAN_ISR_PROFILING
+
+// Define to reduce the memory footprint of each slot in the receive queue, from 72 to 48 bytes. Allows for a deeper
+// receive queue within the same amount of RAM. Notes:
+// - The packet time stamps ('TVanPacketRxDesc::Millis()', 'TVanPacketRxDesc::SofCycles()', ...) are then only valid
+//   within 65 seconds after receiving the packet.
+// - Only the 16 least significant bits of the packet sequence number are kept.
+// - Cannot be combined with VAN_RX_ISR_DEBUGGING or VAN_RX_IFS_DEBUGGING, which need extra memory per slot.
+//#define VAN_RX_COMPACT_DESC
+
+#if defined VAN_RX_COMPACT_DESC && (defined VAN_RX_ISR_DEBUGGING || defined VAN_RX_IFS_DEBUGGING)
+  #error "VAN_RX_COMPACT_DESC cannot be combined with VAN_RX_ISR_DEBUGGING or VAN_RX_IFS_DEBUGGING"
 #endif
 
-#if VAN_BIT_INVERTED_WIRING == 1
-  // MCP2551 CAN_H pin connected to VAN_DATA_BAR, CAN_L connected to VAN_DATA
-  #define VAN_BIT_DOMINANT LOW
-  #define VAN_BIT_RECESSIVE HIGH
-#else
-  // MCP2551 CAN_H pin connected to VAN_DATA, CAN_L connected to VAN_DATA_BAR
-  #define VAN_BIT_DOMINANT HIGH
-  #define VAN_BIT_RECESSIVE LOW
-#endif
+// Define to maintain bus load and latency statistics, readable as a plain struct by 'TVanPacketRxQueue::GetStats'
+// (see 'TVanRxStats'). Costs about 1 kByte of RAM, and a few CPU cycles per bit level change and per packet.
+//#define VAN_RX_STATS
+
+// Define to convert the time between two bus level changes into a number of bits using a bit time that is tracked
+// continuously, instead of the fixed timing values that were found by trial and error. The bit time is seeded at each
+// SOF with the value found in the previous packets, and then measured over the packet being received. Compensates
+// for VAN bus bit rates that deviate from the nominal 125 kbit/sec. Undefine to compare with the fixed timing values,
+// e.g. using the ReplayTrace example.
+//#define VAN_RX_ADAPTIVE_BIT_TIMING
 
-// The CAN bus has two states: dominant and recessive.
-// - For the MCP2551 device: "The dominant and recessive states correspond to the low and high state of the TXD input,
-//   pin, respectively." and "The low and high states of the RXD output pin correspond to the dominant and recessive
-//   states of the CAN bus, respectively."
-//   (see: http://ww1.microchip.com/downloads/en/devicedoc/21667d.pdf#page=3 )
-// - For the SN65HVD23x device: "LOW for dominant and HIGH for recessive bus states"
-//   (see: https://www.ti.com/lit/ds/symlink/sn65hvd230.pdf?ts=1592992149874#page=5 )
-#define VAN_LOGICAL_LOW VAN_BIT_DOMINANT
-#define VAN_LOGICAL_HIGH VAN_BIT_RECESSIVE
-
-// F_CPU is set by the Arduino IDE option as chosen in menu Tools > CPU Frequency. It is always a multiple of 80000000.
-#ifndef TIMER_BASE_CLK
-  #define TIMER_BASE_CLK (80000000)
+// Define to calculate the CRC four bytes at a time, using four lookup tables ("slicing-by-4"), instead of one byte
+// at a time using one lookup table. Faster, at the cost of 1.5 kByte more RAM. Measure the gain with the
+// CrcBenchmark example.
+//#define VAN_CRC_SLICING_BY_4
+
+// Define to calculate the CRC half a byte at a time, using a lookup table of 16 entries instead of 256. Saves 480
+// bytes of RAM, at the cost of speed.
+//#define VAN_CRC_NIBBLE_TABLE
+
+#if defined VAN_CRC_SLICING_BY_4 && defined VAN_CRC_NIBBLE_TABLE
+  #error "VAN_CRC_SLICING_BY_4 and VAN_CRC_NIBBLE_TABLE cannot be combined"
 #endif
-#define CPU_F_FACTOR (F_CPU / TIMER_BASE_CLK)
-#define CPU_CYCLES(_X) ((_X) * CPU_F_FACTOR)
+
+// ESP32 only: define to receive packets using the RMT peripheral instead of an interrupt on each pin level change.
+// The RMT peripheral time-stamps the bit edges in hardware; a task then decodes each complete packet in one go. This
+// saves a lot of CPU time, and the bit timing is no longer disturbed by interrupt latency.
+// Note: the RMT receiver keeps listening during transmission, so the own transmitted packets are also received.
+//#define VAN_RX_ESP32_RMT
+
+#ifdef VAN_RX_ESP32_RMT
+  #ifndef ARDUINO_ARCH_ESP32
+    #error "VAN_RX_ESP32_RMT requires the ESP32 platform"
+  #endif // ARDUINO_ARCH_ESP32
+
+  #include <driver/rmt.h>
+
+  // RMT channel to use. Each channel owns one block of 64 items; a channel using more blocks also takes those of
+  // the next channel(s).
+  #ifndef VAN_RX_RMT_CHANNEL
+    #define VAN_RX_RMT_CHANNEL RMT_CHANNEL_4
+  #endif // VAN_RX_RMT_CHANNEL
+
+  // A VAN packet has at most 33 bytes * 10 bits, so less than 340 level changes. At 2 level changes per item, that
+  // fits in 3 blocks of 64 items.
+  #define VAN_RX_RMT_MEM_BLOCKS 3
+#endif // VAN_RX_ESP32_RMT
+
+// ESP32 only: define to transmit packets using the RMT peripheral instead of a timer interrupt for each bit. The
+// complete packet is shifted out by the hardware. The receiver keeps listening during transmission, so colliding
+// packets (and the own transmitted packets) are also received. Collisions are detected on each level change of the
+// receive pin, by comparing the bus level with the bits that were sent since the previous level change.
+//#define VAN_TX_ESP32_RMT
+
+#ifdef VAN_TX_ESP32_RMT
+  #ifndef ARDUINO_ARCH_ESP32
+    #error "VAN_TX_ESP32_RMT requires the ESP32 platform"
+  #endif // ARDUINO_ARCH_ESP32
+
+  #include <driver/rmt.h>
+
+  // RMT channel to use for transmitting. Must not overlap with the memory blocks of VAN_RX_RMT_CHANNEL.
+  #ifndef VAN_TX_RMT_CHANNEL
+    #define VAN_TX_RMT_CHANNEL RMT_CHANNEL_0
+  #endif // VAN_TX_RMT_CHANNEL
+
+  // A VAN packet with ACK and EOF is at most 34 * 10 bits, so at most 340 level changes. At 2 level changes per
+  // item, plus an end marker, that fits in 3 blocks of 64 items.
+  #define VAN_TX_RMT_MEM_BLOCKS 3
+#endif // VAN_TX_ESP32_RMT
+
+#ifdef VAN_RX_ESP32_RMT
+  // RMT channel to use for a second receive queue (see VAN_RX_MAX_QUEUES). Must not overlap with the memory blocks
+  // of VAN_RX_RMT_CHANNEL, nor with those of VAN_TX_RMT_CHANNEL. With VAN_TX_ESP32_RMT, there is no room left for it
+  // by default, so then only one receive queue is possible.
+  #if ! defined VAN_RX_RMT_SECOND_CHANNEL && ! defined VAN_TX_ESP32_RMT
+    #define VAN_RX_RMT_SECOND_CHANNEL RMT_CHANNEL_0
+  #endif // ! defined VAN_RX_RMT_SECOND_CHANNEL && ! defined VAN_TX_ESP32_RMT
+#endif // VAN_RX_ESP32_RMT
+
+#include "VanBusRxDecoder.h"
 
 #define VAN_NO_PIN_ASSIGNED (0xFF)
 
+// ESP32 only: interrupts are serviced by the core that installs the interrupt handlers. Pass a core number (e.g.
+// APP_CPU_NUM) to 'Setup' to install them on that core, instead of on the core that calls 'Setup'.
+#define VAN_ISR_CORE_CALLER (-1)
+
+// Maximum number of receive queues, i.e. of VAN buses that can be received at the same time. 'VanBusRx' is the
+// first; more can be declared as 'TVanPacketRxQueue' objects, each set up with its own pin. On ESP32, each receive
+// queue uses its own hardware timer, so there can be no more than 4. Each receive queue beyond the first costs a
+// few interrupt handler trampolines in IRAM. On ESP8266, where IRAM is scarce, the default is 1: define
+// VAN_RX_MAX_QUEUES (e.g. with a compiler flag '-DVAN_RX_MAX_QUEUES=2') to receive more than one VAN bus.
+#ifndef VAN_RX_MAX_QUEUES
+  #ifdef ARDUINO_ARCH_ESP32
+    #define VAN_RX_MAX_QUEUES 4
+  #else // ! ARDUINO_ARCH_ESP32
+    #define VAN_RX_MAX_QUEUES 1
+  #endif // ARDUINO_ARCH_ESP32
+#endif // VAN_RX_MAX_QUEUES
+
+#if VAN_RX_MAX_QUEUES < 1 || VAN_RX_MAX_QUEUES > 4
+  #error "VAN_RX_MAX_QUEUES must be 1 ... 4"
+#endif
+
+// Memory barriers. The receive queue is a lock-free ring with a single producer (the ISR) and a single consumer
+// (the main loop). Ownership of a slot is handed over by a single store, which must not become visible before any
+// of the preceding reads and writes of that slot.
+#define VAN_ACQUIRE_BARRIER __atomic_thread_fence(__ATOMIC_ACQUIRE)
+#define VAN_RELEASE_BARRIER __atomic_thread_fence(__ATOMIC_RELEASE)
+
+// Carrier sense: a packet may be transmitted only after the bus has been idle for this number of bit times
+#define VAN_CARRIER_SENSE_BITS (8 /* EOF */ + 5 /* IFS */)
+
 // Forward declarations
 
+class TVanPacketRxQueue;
+
 void WaitAckIsr();
 void RxPinChangeIsr();
+void ArmTxTimer(unsigned int idleBits = VAN_CARRIER_SENSE_BITS);
+#ifdef VAN_TX_ESP32_RMT
+void TxRmtCheckEdge(uint32_t curr, int pinLevel);
+#endif // VAN_TX_ESP32_RMT
 
 #define MAX_FLOAT_SIZE 12
 char* FloatToStr(char* buffer, float f, int prec = 1);
 
 uint16_t _crc(const uint8_t bytes[], int size);
 
+// Continues a CRC calculation over 'n' more bytes. Start with 'crc15' = 0x7FFF; the final CRC value is
+// '(crc15 ^ 0x7FFF) << 1'.
+uint16_t _crcUpdate(uint16_t crc15, const uint8_t bytes[], int n);
+
+// Extends a CPU cycle counter value ('ESP.getCycleCount()'), sampled less than 2^31 CPU cycles ago, to 64 bits.
+// The 32-bit counter rolls over every 53.7 (at 80 MHz) down to 17.9 (at 240 MHz) seconds; the 64-bit microsecond
+// system timer is used to count the roll-overs. The result is in the time base of the system timer.
+uint64_t _cycleCount64(uint32_t cycles);
+
+// Same, for a CPU cycle counter value of the past: 'nearMillis' is the value of 'millis()' at about that time. Gives
+// the right value as long as 'millis()' has not rolled over since then (49 days).
+uint64_t _cycleCount64(uint32_t cycles, unsigned long nearMillis);
+
+// Re-bases '_cycleCount64' on the system timer. Needed after light sleep (see 'TVanPacketRxQueue::LightSleep'),
+// during which the CPU cycle counter stops, while the system timer keeps on counting.
+void _rebaseCycleCount64();
+
+inline uint64_t _cyclesToMicros(uint64_t cycles) { return cycles / (F_CPU / 1000000); }
+
 class Stream;
 
 #ifdef VAN_RX_ISR_DEBUGGING
@@ -118,7 +251,6 @@ class TIsrDebugPacket
     mutable bool rLock;
     bool wLock;
 
-    friend void RxPinChangeIsr();
     friend class TVanPacketRxDesc;
     friend class TVanPacketRxQueue;
 }; // TIsrDebugPacket
@@ -153,46 +285,166 @@ class TIfsDebugPacket
     TIfsDebugData samples[VAN_IFS_DEBUG_BUFFER_SIZE];
     int at;  // Index of next sample to write into
 
-    friend void RxPinChangeIsr();
+    friend class TVanPacketRxQueue;
     friend class TVanPacketRxDesc;
 }; // TIfsDebugPacket
 
 #endif // VAN_RX_IFS_DEBUGGING
 
-enum PacketReadState_t { VAN_RX_VACANT = 2, VAN_RX_SEARCHING, VAN_RX_LOADING, VAN_RX_WAITING_ACK, VAN_RX_DONE };
-enum PacketReadResult_t { VAN_RX_PACKET_OK, VAN_RX_ERROR_NBITS, VAN_RX_ERROR_MANCHESTER, VAN_RX_ERROR_MAX_PACKET };
-enum PacketAck_t { VAN_ACK, VAN_NO_ACK };
+#ifdef VAN_ISR_PROFILING
 
-// VAN packet Rx descriptor
-class TVanPacketRxDesc
+// Execution time histogram: bin i counts i up to i+1 microseconds. The last bin also counts anything longer.
+#define VAN_ISR_PROFILE_N_BINS 16
+
+// Execution time statistics of an interrupt service routine
+struct TIsrProfile
+{
+    uint32_t n;
+    uint64_t totalCycles;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint32_t hist[VAN_ISR_PROFILE_N_BINS];
+
+    void Init()
+    {
+        memset(this, 0, sizeof(*this));
+        minCycles = UINT32_MAX;
+    } // Init
+
+    TIsrProfile() { Init(); }  // Constructor
+
+    __attribute__((always_inline)) void Add(uint32_t cycles)
+    {
+        n++;
+        totalCycles += cycles;
+        if (cycles < minCycles) minCycles = cycles;
+        if (cycles > maxCycles) maxCycles = cycles;
+        const uint32_t bin = cycles / (F_CPU / 1000000);
+        hist[bin < VAN_ISR_PROFILE_N_BINS ? bin : VAN_ISR_PROFILE_N_BINS - 1]++;
+    } // Add
+
+    void Dump(Stream& s) const;
+}; // struct TIsrProfile
+
+// Adds the execution time, from 'start' up to leaving the enclosing scope, to an ISR profile. On ESP32, the profile
+// is updated while holding 'mux', the same lock as taken by 'DumpIsrProfile' while copying the profile: the ISR
+// may run on the other core.
+class TIsrProfileScope
 {
   public:
 
-    // VAN packet layout:
-    // - SOF = 10 time slots (TS) = 8 bits = 1 byte
-    // - IDEN = 15 TS = 12 bits = 1.5 bytes
-    // - COM = 5 TS = 4 bits = 0.5 bytes
-    // - Data = 280 TS max = 28 bytes max
-    // - CRC + EOD = 18 + 2 TS = 2 bytes
-    // - ACK  = 2 TS
-    // - EOF  = 8 TS
-    // Total 1 + 1.5 + 0.5 + 28 + 2 = 33 bytes excluding ACK and EOF
+  #ifdef ARDUINO_ARCH_ESP32
+    __attribute__((always_inline)) TIsrProfileScope(TIsrProfile& profile, uint32_t start, portMUX_TYPE* mux)
+        : profile(profile)
+        , start(start)
+        , mux(mux)
+    { }
+  #else // ! ARDUINO_ARCH_ESP32
+    __attribute__((always_inline)) TIsrProfileScope(TIsrProfile& profile, uint32_t start)
+        : profile(profile)
+        , start(start)
+    { }
+  #endif // ARDUINO_ARCH_ESP32
+
+    __attribute__((always_inline)) ~TIsrProfileScope()
+    {
+        const uint32_t cycles = ESP.getCycleCount() - start;  // Arithmetic has safe roll-over
+
+      #ifdef ARDUINO_ARCH_ESP32
+        portENTER_CRITICAL_ISR(mux);
+        profile.Add(cycles);
+        portEXIT_CRITICAL_ISR(mux);
+      #else // ! ARDUINO_ARCH_ESP32
+        profile.Add(cycles);  // Single core: 'DumpIsrProfile' cannot interrupt an ISR
+      #endif // ARDUINO_ARCH_ESP32
+    } // ~TIsrProfileScope
+
+  private:
+
+    TIsrProfile& profile;
+    const uint32_t start;
+  #ifdef ARDUINO_ARCH_ESP32
+    portMUX_TYPE* const mux;
+  #endif // ARDUINO_ARCH_ESP32
+}; // class TIsrProfileScope
+
+// 'MUX_' is the lock protecting the profile; not used on ESP8266
+#ifdef ARDUINO_ARCH_ESP32
+  #define PROFILE_ISR(PROFILE_, START_, MUX_) TIsrProfileScope isrProfileScope((PROFILE_), (START_), (MUX_))
+#else // ! ARDUINO_ARCH_ESP32
+  #define PROFILE_ISR(PROFILE_, START_, MUX_) TIsrProfileScope isrProfileScope((PROFILE_), (START_))
+#endif // ARDUINO_ARCH_ESP32
+
+#else
+
+#define PROFILE_ISR(PROFILE_, START_, MUX_)
+
+#endif // VAN_ISR_PROFILING
+
+// Outcome of 'TVanPacketRxDesc::CheckCrcAndRepair', kept with the packet. VAN_RX_CRC_REPAIR_SKIPPED: the packet has a
+// CRC error, but the deferred repair had no room for it (see 'TVanPacketRxQueue::SetRepairBudget'); it can still be
+// repaired by 'CheckCrcAndRepair'.
+enum PacketCrcStatus_t
+{
+    VAN_RX_CRC_UNCHECKED, VAN_RX_CRC_OK, VAN_RX_CRC_REPAIRED, VAN_RX_CRC_ERROR, VAN_RX_CRC_REPAIR_SKIPPED
+};
+
+// Priority lanes in the receive queue
+enum VanRxLane_t { VAN_RX_LANE_NORMAL, VAN_RX_LANE_HIGH, VAN_RX_LANE_BULK };
+#define VAN_RX_N_LANES 3
 
-    #define VAN_MAX_DATA_BYTES 28
-    #define VAN_MAX_PACKET_SIZE 33
+// VAN packet Rx descriptor
+class TVanPacketRxDesc
+{
+  public:
 
     TVanPacketRxDesc() { Init(); }
     __attribute__((always_inline)) uint16_t Iden() const { return bytes[1] << 4 | bytes[2] >> 4; }
     uint8_t CommandFlags() const;  // See page 17 of http://ww1.microchip.com/downloads/en/DeviceDoc/doc4205.pdf
     const uint8_t* Data() const;
     int DataLen() const;
-    unsigned long Millis() { return millis_; }  // Packet time stamp in milliseconds
+  #ifdef VAN_RX_COMPACT_DESC
+    // Packet time stamp in milliseconds. Note: only 16 bits are stored, so the returned value is only correct if
+    // called within 65 seconds after the packet was received.
+    unsigned long Millis() const { return millis() - (uint16_t)((uint16_t)millis() - millis_); }
+  #else
+    unsigned long Millis() const { return millis_; }  // Packet time stamp in milliseconds
+  #endif // VAN_RX_COMPACT_DESC
+
+    // Packet time stamps, in CPU cycles since boot: at the start of the SOF, and at the end of the last 'dominant'
+    // bit (the EOD, or the ACK bit if any). Note: with VAN_RX_ESP32_RMT, the end of the packet is only known to within
+    // the latency of the decoding task. Only the 32 least significant bits of the EOF time are stored; they are
+    // extended to 64 bits using the 'Millis()' time stamp. The SOF time is stored as the duration of the packet.
+    uint64_t SofCycles() const { return EofCycles() - DurationCycles(); }
+    uint64_t EofCycles() const { return _cycleCount64(eofAt, Millis()); }
+    uint64_t SofMicros() const { return _cyclesToMicros(SofCycles()); }
+    uint64_t EofMicros() const { return _cyclesToMicros(EofCycles()); }
+
+    // The receive queue that received this packet ('VanBusRx', unless multiple receive queues are set up)
+    TVanPacketRxQueue& RxQueue() const;
+
     uint16_t Crc() const;
     bool CheckCrc() const;
     bool CheckCrcFix(bool (TVanPacketRxDesc::*wantToCount)() const, uint32_t* pCounter1, uint32_t* pCounter2 = nullptr);
     bool CheckCrcAndRepair(bool (TVanPacketRxDesc::*wantToCount)() const = 0);
+
+    // True if the packet had a CRC error, which was repaired by 'CheckCrcAndRepair', or by the deferred repair (see
+    // 'TVanPacketRxQueue::SetRepairBudget')
+    bool IsRepaired() const { return crcStatus == VAN_RX_CRC_REPAIRED; }
+
+    // True if the packet was passed on by the deferred repair without an attempt to repair it, because the repair
+    // queue was full. Call 'CheckCrcAndRepair' to repair it.
+    bool IsRepairSkipped() const { return crcStatus == VAN_RX_CRC_REPAIR_SKIPPED; }
+
     void DumpRaw(Stream& s, char last = '\n') const;
 
+    // Compact binary representation, e.g. for logging to flash (see VanBusRx.cpp for the format). Writes at most
+    // VAN_MAX_BINARY_SIZE bytes into 'buf' and returns the number of bytes written. 'prevMicros' and 'prevSeqNo'
+    // are of the previous record, and are updated; set both to 0 to write a record that does not depend on any
+    // previous record.
+    int ToBinary(uint8_t* buf, uint32_t& prevMicros, uint32_t& prevSeqNo) const;
+    #define VAN_MAX_BINARY_SIZE (5 + 1 + 5 + 2 + 1 + VAN_MAX_PACKET_SIZE)
+
     // String representation of various fields.
     // Notes:
     // - Uses statically allocated buffer, so don't call twice within the same printf invocation.
@@ -250,13 +502,48 @@ class TVanPacketRxDesc
 
   private:
 
+    // Unit of 'sofDelta': 16 CPU cycles, so at most 4.3 milliseconds at 240 MHz
+    #define VAN_RX_SOF_DELTA_SHIFT 4
+
+  #ifdef VAN_RX_COMPACT_DESC
+
+    // Compact layout: narrow types and bit fields, ordered such that there is only 1 byte of padding at the end. The
+    // queue slot is not stored (see 'DumpRaw'), and there are no debug packets (see VAN_RX_COMPACT_DESC).
+    uint32_t eofAt;  // CPU cycle counter value; only the 32 least significant bits
+    uint16_t sofDelta;  // 'eofAt' minus the CPU cycle counter value at SOF, shifted right by VAN_RX_SOF_DELTA_SHIFT
+    uint16_t millis_;  // Packet time stamp in milliseconds; only the 16 least significant bits
+    PacketCrcStatus_t crcStatus:3;
+    PacketReadState_t state:3;
+    PacketReadResult_t result:2;
+    PacketAck_t ack:1;
+    unsigned int uncertainBit1:9;  // At most VAN_MAX_PACKET_SIZE * 8 + 10
+    unsigned int size:6;  // At most VAN_MAX_PACKET_SIZE
+    unsigned int queue:2;  // Index of RxQueue; see VAN_RX_MAX_QUEUES
+    unsigned int lane:2;  // VanRxLane_t
+    uint16_t seqNo;  // Only the 16 least significant bits
+    uint8_t bytes[VAN_MAX_PACKET_SIZE];
+
+  #else
+
+    uint32_t eofAt;  // CPU cycle counter value; only the 32 least significant bits
     uint8_t bytes[VAN_MAX_PACKET_SIZE];
+    uint8_t crcStatus;  // PacketCrcStatus_t
+    uint16_t sofDelta;  // 'eofAt' minus the CPU cycle counter value at SOF, shifted right by VAN_RX_SOF_DELTA_SHIFT
     int size;
     PacketReadState_t state;
     PacketReadResult_t result;
     PacketAck_t ack;
     unsigned long millis_;  // Packet time stamp in milliseconds
 
+    uint32_t seqNo;
+    uint16_t slot;  // in RxQueue
+    uint8_t lane;  // VanRxLane_t
+    uint8_t queue;  // Index of RxQueue; see VAN_RX_MAX_QUEUES
+
+    int uncertainBit1;
+
+  #endif // VAN_RX_COMPACT_DESC
+
   #ifdef VAN_RX_ISR_DEBUGGING
     TIsrDebugPacket* isrDebugPacket;  // For debugging of packet reception inside ISR
   #endif // VAN_RX_ISR_DEBUGGING
@@ -265,24 +552,43 @@ class TVanPacketRxDesc
     TIfsDebugPacket ifsDebugPacket;  // For debugging of inter-frame space
   #endif // VAN_RX_IFS_DEBUGGING
 
-    uint32_t seqNo;
-    uint16_t slot;  // in RxQueue
-
-    int uncertainBit1;
+    void SetTimeStamps(uint32_t sofAt, uint32_t eofAt);
+    uint32_t DurationCycles() const;
+
+    // CRC repair helpers
+    uint16_t CrcSyndrome() const;
+    uint16_t BitSyndrome(int atByte, int atBit) const;
+    int LocateOneBitError(uint16_t syndrome) const;
+    int LocateTwoConsecutiveBitErrors(uint16_t syndrome) const;
+    void FlipBit(int i);
+    int SearchOrder(int i) const;
+    bool IsLastOfEqualBits(int atByte, int atBit, bool prevBit) const;
+    bool PrevBitOf(int atByte, int atBit) const;
+    void CountRepair(bool (TVanPacketRxDesc::*wantToCount)() const, uint32_t* pCounter1, uint32_t* pCounter2 = nullptr) const;
+    bool Repair(bool (TVanPacketRxDesc::*wantToCount)() const);
+    PacketCrcStatus_t RepairQuick(bool (TVanPacketRxDesc::*wantToCount)() const, uint16_t& syndrome);
+    PacketCrcStatus_t RepairTwoSeparateBits(
+        bool (TVanPacketRxDesc::*wantToCount)() const,
+        uint16_t syndrome,
+        int& atByte1,
+        bool& prevBit1,
+        uint32_t maxCycles);
 
     void Init()
     {
         size = 0;
-        state = VAN_RX_VACANT;
         result = VAN_RX_PACKET_OK;
         ack = VAN_NO_ACK;
-
-      #define NO_UNCERTAIN_BIT (0)
         uncertainBit1 = NO_UNCERTAIN_BIT;
+        crcStatus = VAN_RX_CRC_UNCHECKED;
 
       #ifdef VAN_RX_IFS_DEBUGGING
         ifsDebugPacket.Init();
       #endif // VAN_RX_IFS_DEBUGGING
+
+        // Setting the state to VAN_RX_VACANT hands the slot over to the ISR, so this must be the very last store
+        VAN_RELEASE_BARRIER;
+        state = VAN_RX_VACANT;
     } // Init
 
     static const char* StateStr(uint8_t state)
@@ -296,8 +602,11 @@ class TVanPacketRxDesc
             "ERROR_??";
     } // ResultStr
 
-    friend void WaitAckIsr();
-    friend void RxPinChangeIsr();
+    friend void ArmTxTimer(unsigned int idleBits);
+  #ifdef VAN_RX_ESP32_RMT
+    friend bool DecodeRmtPacket(TVanPacketRxDesc* rxDesc, const rmt_item32_t* items, int nItems);
+    friend void RmtRxTask(void* param);
+  #endif // VAN_RX_ESP32_RMT
     friend class TVanPacketRxQueue;
     friend class TIfsDebugPacket;
     friend class TIsrDebugPacket;
@@ -335,6 +644,194 @@ extern portMUX_TYPE mux;
     INTERRUPTS; \
 }
 
+#ifdef VAN_RX_STATS
+
+// Bus load: sliding window of VAN_STATS_N_WINDOW_BUCKETS buckets of 2^VAN_STATS_BUCKET_SHIFT milliseconds
+#define VAN_STATS_N_WINDOW_BUCKETS 8
+#define VAN_STATS_BUCKET_SHIFT 10
+
+// Packet rate: number of IDENs tracked. Must be a power of 2.
+#define VAN_STATS_N_IDENS 64
+
+// Queue residency: bin 0 counts latencies below 1 microsecond; bin i counts latencies from 2^(i-1) up to 2^i
+// microseconds. The last bin also counts anything longer.
+#define VAN_STATS_N_LATENCY_BINS 20
+
+// Measured time between two bus level changes: bin i counts i/4 up to (i+1)/4 bit times. The last bin also counts
+// anything longer.
+#define VAN_STATS_N_PULSE_BINS 32
+
+// Built-up jitter: bin i counts i/16 up to (i+1)/16 bit times. The last bin also counts anything larger.
+#define VAN_STATS_N_JITTER_BINS 16
+
+// Receiver statistics. Obtain a consistent copy with 'TVanPacketRxQueue::GetStats'.
+// Notes:
+// - Numbers can roll over.
+// - With VAN_RX_ESP32_RMT, the pulse and jitter distributions are not collected.
+struct TVanRxStats
+{
+    unsigned long sinceMillis;  // Time of previous reset (or boot)
+    unsigned long atMillis;  // Time of snapshot
+
+    // Bus load: number of CPU cycles the bus was busy (SOF up to end of EOD or ACK), per bucket
+    struct TWindowBucket
+    {
+        uint32_t epoch;  // Time in milliseconds >> VAN_STATS_BUCKET_SHIFT
+        uint32_t busyCycles;
+    } window[VAN_STATS_N_WINDOW_BUCKETS];
+
+    // Number of packets per IDEN, in an open addressing hash table. Includes packets rejected by the acceptance
+    // filter.
+    struct TIdenCount
+    {
+        uint16_t key;  // IDEN + 1; 0 means: empty entry
+        uint32_t count;
+    } idens[VAN_STATS_N_IDENS];
+    uint32_t nUntracked;  // Packets not counted per IDEN, because the table was full
+
+    // Queue residency: from the end of the packet (as received by the ISR) up to 'Receive', 'ReceiveMany', 'Peek'
+    // or 'OnPacket'
+    uint32_t latencyHist[VAN_STATS_N_LATENCY_BINS];
+    uint32_t maxLatencyMicros;
+
+    // Distribution of the measured time between two bus level changes, and of the jitter as built up by the ISR,
+    // while receiving a packet
+    uint32_t pulseHist[VAN_STATS_N_PULSE_BINS];
+    uint32_t jitterHist[VAN_STATS_N_JITTER_BINS];
+
+    // Time spent in 'TVanPacketRxDesc::CheckCrcAndRepair', or in one step of the deferred repair (see
+    // 'TVanPacketRxQueue::SetRepairBudget')
+    uint32_t nRepairCalls;
+    uint64_t repairCycles;
+    uint32_t maxRepairCycles;
+
+    // Derived values
+    float BusLoadPercent() const { return BusLoadPercentAt(atMillis); }  // Over the sliding window
+    float BusLoadPercentAt(unsigned long ms) const;
+    uint32_t IdenCount(uint16_t iden) const;  // Since previous reset
+    float PacketsPerSecond(uint16_t iden) const;  // Average since previous reset
+    uint32_t MaxRepairMicros() const { return _cyclesToMicros(maxRepairCycles); }
+    float AvgRepairMicros() const;
+
+    void Dump(Stream& s) const;
+
+    // Only to be called from ISR, unsafe otherwise
+    void _CountPacket(uint16_t iden, unsigned long ms, uint32_t busyCycles);
+    void _CountPulse(uint32_t nCycles, uint32_t jitter);
+
+    // Only to be called by the consumer
+    void _CountLatency(uint32_t cycles);
+    void _CountRepair(uint32_t cycles);
+}; // struct TVanRxStats
+
+#endif // VAN_RX_STATS
+
+// Number of entries in a 'TVanIdenMap' is 2^VAN_IDEN_MAP_BITS. Lookup is fastest when no more than 3/4 of the
+// entries are used.
+#define VAN_IDEN_MAP_BITS 6
+#define VAN_IDEN_MAP_SIZE (1 << VAN_IDEN_MAP_BITS)
+
+// Value returned by 'TVanIdenMap::Get' for an IDEN that is not in the map
+#define VAN_IDEN_MAP_NONE 0xFF
+
+// Constant-time lookup of a small value (0 ... 254) by IDEN, e.g. the index of a packet parser or filter entry in
+// an array. Open addressing hash table with linear probing, so the lookup time does not depend on the number of
+// IDENs in the map.
+class TVanIdenMap
+{
+  public:
+
+    TVanIdenMap() { Clear(); }  // Constructor
+
+    void Clear()
+    {
+        memset(keys, 0, sizeof(keys));
+        count = 0;
+    } // Clear
+
+    // Stores 'value' for 'iden', replacing any previous value. Returns false if 'iden' or 'value' is out of range,
+    // or if the map is full.
+    bool Set(uint16_t iden, uint8_t value);
+
+    // Returns the value stored for 'iden', or VAN_IDEN_MAP_NONE
+    uint8_t Get(uint16_t iden) const
+    {
+        unsigned int i = Hash(iden);
+        for (int n = 0; n < VAN_IDEN_MAP_SIZE; n++)
+        {
+            if (keys[i] == iden + 1) return values[i];
+            if (keys[i] == 0) break;
+            i = (i + 1) & (VAN_IDEN_MAP_SIZE - 1);
+        } // for
+        return VAN_IDEN_MAP_NONE;
+    } // Get
+
+    int Count() const { return count; }
+
+  private:
+
+    // Fibonacci hashing: multiply by 2^16 / golden ratio, then take the upper bits
+    static unsigned int Hash(uint16_t iden) { return (uint16_t)(iden * 40503U) >> (16 - VAN_IDEN_MAP_BITS); }
+
+    uint16_t keys[VAN_IDEN_MAP_SIZE];  // IDEN + 1; 0 means: empty entry
+    uint8_t values[VAN_IDEN_MAP_SIZE];
+    int count;
+}; // class TVanIdenMap
+
+// Number of IDENs tracked by a 'TVanDupCache'. Must not be more than VAN_IDEN_MAP_SIZE.
+#define VAN_DUP_CACHE_SLOTS 48
+
+// "Changed since last" cache: remembers the data of the last packet per IDEN, in a fixed arena, so that unchanged
+// packets can be skipped before any parsing or memory allocation. The CRC field of the packet serves as hash: if the
+// command flags are the same as those of the remembered packet, but the CRC field is not, the data differs and is not
+// compared. Otherwise the data bytes are compared; the command flags themselves are not, so a packet with the same
+// data but other command flags is a duplicate. Only feed packets with a correct CRC (see
+// 'TVanPacketRxDesc::CheckCrcAndRepair').
+class TVanDupCache
+{
+  public:
+
+    TVanDupCache() : nSlots(0) { }  // Constructor
+
+    // Returns true if 'pkt' has the same data as the remembered packet with the same IDEN
+    bool IsDuplicate(const TVanPacketRxDesc& pkt) const;
+
+    // Remembers the data of 'pkt'. Returns false if all slots are taken by other IDENs.
+    bool Remember(const TVanPacketRxDesc& pkt);
+
+    // Returns the remembered data for 'iden' and sets 'dataLen', or returns NULL if nothing is remembered
+    const uint8_t* Data(uint16_t iden, int& dataLen) const;
+
+    // Forgets the remembered data for 'iden', so that the next packet with that IDEN is not a duplicate
+    void Forget(uint16_t iden);
+
+    void Clear()
+    {
+        slotMap.Clear();
+        nSlots = 0;
+    } // Clear
+
+  private:
+
+    struct TSlot
+    {
+        uint16_t crc;  // CRC field of remembered packet
+        uint8_t flags;  // Command flags of remembered packet
+        int8_t dataLen;  // -1 means: nothing remembered
+        uint8_t data[VAN_MAX_DATA_BYTES];
+    }; // struct TSlot
+
+    const TSlot* Slot(uint16_t iden) const
+    {
+        const uint8_t i = slotMap.Get(iden);
+        return i == VAN_IDEN_MAP_NONE || slots[i].dataLen < 0 ? NULL : slots + i;
+    } // Slot
+
+    TVanIdenMap slotMap;  // Slot index, by IDEN
+    TSlot slots[VAN_DUP_CACHE_SLOTS];
+    int nSlots;  // Number of slots in use
+}; // class TVanDupCache
+
 // Forward declaration
 class TVanPacketTxDesc;
 
@@ -348,14 +845,44 @@ class TVanPacketRxQueue
   public:
 
     #define VAN_DEFAULT_RX_QUEUE_SIZE 15
+    #define VAN_DEFAULT_RX_HIGH_LANE_SIZE 4
 
     // Constructor
     TVanPacketRxQueue()
         : pin(VAN_NO_PIN_ASSIGNED)
         , enabled(false)
-        , _overrun(false)
+        , index(0)
+        , pinChangeIsr(NULL)
+      #ifdef ARDUINO_ARCH_ESP32
+        , ackTimer(NULL)
+        , isrMux(&mux)
+      #endif // ARDUINO_ARCH_ESP32
+        , softAckTimer(false)
+      #if defined ARDUINO_ARCH_ESP32 && ! defined VAN_RX_ESP32_RMT
+        , ownGpioIsr(false)
+        , gpioIsrPin(0)
+        , gpioIsrCore(0)
+      #endif // defined ARDUINO_ARCH_ESP32 && ! defined VAN_RX_ESP32_RMT
+      #ifdef VAN_RX_ESP32_RMT
+        , rmtChannel(VAN_RX_RMT_CHANNEL)
+        , rmtRingBuffer(NULL)
+        , rmtRxTask(NULL)
+      #endif // VAN_RX_ESP32_RMT
+        , ackTimerArmed(false)
+        , ackTimerArmedAt(0)
+        , replayLastEdgeAt(0)
+      #ifdef VAN_RX_ESP32_RMT
+        , resyncFromMicros(0)
+      #endif // VAN_RX_ESP32_RMT
+        , pool(NULL)
+        , nOverruns(0)
+        , nOverrunsReported(0)
         , txTimerTicks(0)
         , txTimerIsr(NULL)
+        , txIsBusy(NULL)
+      #ifndef VAN_RX_ESP32_RMT
+        , inFrameReplyIsr(NULL)
+      #endif // VAN_RX_ESP32_RMT
         , lastMediaAccessAt(0)
       #ifdef VAN_RX_ISR_DEBUGGING
         , isrDebugPacket(isrDebugPacketPool)
@@ -368,14 +895,87 @@ class TVanPacketRxQueue
         , nTwoConsecutiveBitErrors(0)
         , nTwoSeparateBitErrors(0)
         , nUncertainBitErrors(0)
-        , nQueued(0)
+      #ifdef VAN_RX_STATS
+        , stats()
+      #endif // VAN_RX_STATS
+        , nEnqueued(0)
+        , nDequeued(0)
         , maxQueued(0)
         , isEssentialPacket(0)
+        , idenFilter(NULL)
+        , headFiltered(false)
+        , nFiltered(0)
+        , idenLanes(NULL)
+        , highSize(VAN_DEFAULT_RX_HIGH_LANE_SIZE)
+        , highPool(NULL)
+        , highHead(NULL)
+        , highTail(NULL)
+        , highEnd(NULL)
+        , nHighEnqueued(0)
+        , nHighDequeued(0)
+        , bulkDepth(0)
+        , bulkMaxDepth(0)
+        , nBulkEnqueued(0)
+        , nBulkDequeued(0)
+        , laneMaxQueued()
+        , laneOverruns()
+        , peeked(NULL)
+        , repairQueue(NULL)
+        , repairFirst(0)
+        , nRepairQueued(0)
+        , repairBudgetCycles(0)
+        , repairWantToCount(0)
+        , repairAtByte(0)
+        , repairPrevBit(false)
+        , repairSyndrome(0)
+        , nRepairsSkipped(0)
+        , onPacket(NULL)
+      #ifdef ARDUINO_ARCH_ESP32
+        , consumerTask(NULL)
+      #else // ! ARDUINO_ARCH_ESP32
+        , deliveryScheduled(false)
+      #endif // ARDUINO_ARCH_ESP32
+        , idleTimeoutMs(0)
+        , onBusIdle(0)
+        , idleLightSleep(false)
+        , busIdle(false)
+        , idleCheckedMediaAccessAt(0)
+        , lastBusActivityMs(0)
+        , nLightSleeps(0)
+        , nLostAtWakeUp(0)
     { }
 
-    bool Setup(uint8_t rxPin, int queueSize = VAN_DEFAULT_RX_QUEUE_SIZE);
-    bool Available() const { ISR_SAFE_GET(bool, tail->state == VAN_RX_DONE); }
+    // Multiple receive queues can be set up, each on its own pin, up to VAN_RX_MAX_QUEUES. Each receive queue has
+    // its own packet decoder, interrupt handlers, ACK time-out timer and statistics. On ESP32, 'isrCore' selects
+    // the core that services the pin and timer interrupts of the receive queue (see VAN_ISR_CORE_CALLER). The
+    // transmitter ('VanBusTx') always uses 'VanBusRx'.
+    bool Setup(uint8_t rxPin, int queueSize = VAN_DEFAULT_RX_QUEUE_SIZE, int isrCore = VAN_ISR_CORE_CALLER);
+    bool Available() const
+    {
+        const bool available = nEnqueued != nDequeued || nHighEnqueued != nHighDequeued;
+        VAN_ACQUIRE_BARRIER;  // Don't read the slot before knowing it is filled
+        return available;
+    } // Available
     bool Receive(TVanPacketRxDesc& pkt, bool* isQueueOverrun = NULL);
+    int ReceiveMany(TVanPacketRxDesc* pkts, int max, bool* isQueueOverrun = NULL);
+
+    // Checks the ACK time-out of a receive queue without hardware timer, and checks for bus idle. Called by
+    // 'Receive', 'ReceiveMany' and 'Peek'; if only using 'Available' or 'OnPacket', call 'Poll' from loop().
+    void Poll();
+
+    // Zero-copy alternative to 'Receive': inspect the packet in its queue slot, then free the slot
+    TVanPacketRxDesc* Peek(bool* isQueueOverrun = NULL);
+    void Release();
+
+    // Event-driven alternative to polling 'Receive' in loop(): the callback is invoked for each received packet
+    bool OnPacket(void (*callback)(TVanPacketRxDesc& pkt), int core = VAN_ISR_CORE_CALLER);
+
+    // Deferred CRC repair: packets with a CRC error are set aside, and repaired in steps of at most 'budgetMicros'
+    // each, so that 'Peek', 'Receive', 'ReceiveMany' and 'OnPacket' are never held up by a lengthy repair. Pass 0 to
+    // stop deferring.
+    #define VAN_RX_REPAIR_QUEUE_SIZE 4
+    void SetRepairBudget(unsigned int budgetMicros, bool (TVanPacketRxDesc::*wantToCount)() const = 0);
+    int GetNRepairsPending() const { return nRepairQueued; }
 
     // Disabling the VAN bus receiver is necessary for timer-intensive tasks, like e.g. operations on the SPI Flash
     // File System (SPIFFS), which otherwise cause system crash. Unfortunately, after disabling then enabling the
@@ -384,30 +984,158 @@ class TVanPacketRxQueue
     void Enable();
     bool IsEnabled() { return enabled; }
 
+    // Bus idle detection, e.g. to save power while the vehicle is parked. The bus is idle when no bus activity was
+    // seen for 'timeoutMs' milliseconds. This is checked by 'PollBusIdle', which is called by 'Poll' (see there); with
+    // 'OnPacket', call 'Poll' or 'PollBusIdle' from loop(). 'onIdle' is called with 'true' when
+    // the bus goes idle, and with 'false' when bus activity is seen again. If 'lightSleep' is true, 'LightSleep' is
+    // called right after 'onIdle(true)'. Pass 0 as 'timeoutMs' to stop detecting.
+    void SetIdleTimeout(unsigned long timeoutMs, void (*onIdle)(bool idle) = 0, bool lightSleep = false);
+    void PollBusIdle();
+    bool IsBusIdle() const { return busIdle; }
+
+    // Puts the CPU into light sleep, until the bus on the receive pin of this queue goes 'dominant'. Call from the
+    // consumer (e.g. loop()), never from an ISR. The packet that causes the wake-up is lost: after waking up, the
+    // receiver skips the rest of it, and starts decoding again at the next SOF. Returns false without sleeping if the
+    // receiver is not set up or not enabled, if the transmitter is busy, or (ESP8266) if Wi-Fi is not off or the
+    // receive pin is GPIO 16.
+    bool LightSleep();
+    uint32_t GetNLightSleeps() const { return nLightSleeps; }
+
+    // Number of packets of which the receiver saw only the end, after waking up, and dropped. Packets that
+    // completely passed while waking up are not seen, so not counted.
+    uint32_t GetNLostAtWakeUp() const { return nLostAtWakeUp; }
+
     void SetDropPolicy(int startAt, bool (*isEssential)(const TVanPacketRxDesc&));
 
+    // Acceptance filter, like in a CAN controller: packets with a rejected IDEN are dropped by the receiver as soon as
+    // their IDEN is decoded, so they never take a slot in the receive queue. By default, all IDENs are accepted.
+    // 'mask' selects the IDEN bits that must match; e.g. AcceptIden(0x5E0, 0xFF0) accepts 0x5E0 ... 0x5EF.
+    void AcceptIden(uint16_t iden, uint16_t mask = 0xFFF) { SetIdenFilter(iden, mask, true); }
+    void RejectIden(uint16_t iden, uint16_t mask = 0xFFF) { SetIdenFilter(iden, mask, false); }
+    void AcceptAllIdens() { SetIdenFilter(0x000, 0x000, true); }
+    void RejectAllIdens() { SetIdenFilter(0x000, 0x000, false); }
+    bool IsIdenAccepted(uint16_t iden) const
+    {
+        return idenFilter == NULL || (idenFilter[iden >> 5] >> (iden & 0x1F) & 1);
+    } // IsIdenAccepted
+    uint32_t GetNFiltered() const { return nFiltered; }  // Number of packets rejected by the acceptance filter
+
+    // Priority lanes. Packets in the high priority lane are served first by 'Receive', 'ReceiveMany', 'Peek' and
+    // 'OnPacket'. Packets in the bulk lane are dropped when too many of them are queued, so that they never take up
+    // the whole receive queue. By default, all IDENs are in the normal lane.
+    // 'mask' selects the IDEN bits that must match, like with 'AcceptIden'.
+    bool SetIdenLane(uint16_t iden, VanRxLane_t lane, uint16_t mask = 0xFFF);
+    VanRxLane_t GetIdenLane(uint16_t iden) const
+    {
+        return idenLanes == NULL ? VAN_RX_LANE_NORMAL : (VanRxLane_t)(idenLanes[iden >> 4] >> (iden & 0x0F) * 2 & 0x03);
+    } // GetIdenLane
+
+    // Only for VAN_RX_LANE_HIGH (number of slots; call before assigning the first IDEN to that lane) and
+    // VAN_RX_LANE_BULK (maximum number of queued bulk packets; default is half the receive queue size, but at least 1;
+    // never more than the receive queue size)
+    bool SetLaneDepth(VanRxLane_t lane, int depth);
+    int GetLaneMaxQueued(VanRxLane_t lane) const { return laneMaxQueued[lane]; }
+    uint32_t GetLaneOverruns(VanRxLane_t lane) const { return laneOverruns[lane]; }
+
     bool IsSetup() const { return pin != VAN_NO_PIN_ASSIGNED; }
-    uint32_t GetCount() const { return count; }  // TODO - use ISR_SAFE_GET ?
+
+    // Offline decoding of recorded bus level changes, e.g. to validate changes in the bit timing logic against many
+    // packets. Feeds one level change into the packet decoder, as if it was seen by the pin level change interrupt
+    // handler. 'cycles' is the CPU cycle counter value at the level change; 'pinLevel' is the new bus level.
+    // Decoded packets are queued as usual. Returns false if the receiver was not set up, or is enabled: call 'Setup',
+    // then 'Disable' before replaying. Call 'ReplayEnd' after the last level change, to complete the last packet.
+    // Note: the packet time stamps ('SofCycles', 'EofCycles') are in the time base of the recording. With
+    // VAN_RX_ESP32_RMT, no replay is possible. To replay on a PC, see 'TVanRxDecoder' (VanBusRxDecoder.h).
+    bool ReplayEdge(uint32_t cycles, int pinLevel);
+    void ReplayEnd();
+    uint32_t GetCount() const { return count; }
 
     void DumpStats(Stream& s, bool longForm = true) const;
     int QueueSize() const { return size; }
-    int GetNQueued() const { return nQueued; }  // TODO - use ISR_SAFE_GET ?
-    int GetMaxQueued() const { return maxQueued; }  // TODO - use ISR_SAFE_GET ?
+    static int SlotSize() { return sizeof(TVanPacketRxDesc); }  // Number of bytes per slot in the receive queue
+    int GetNQueued() const { return GetNQueuedNormal() + GetNQueuedHigh(); }
+    int GetMaxQueued() const { return maxQueued; }
+
+    // Reading or writing an aligned 32-bit value is atomic, so no need to disable interrupts
+    uint32_t GetLastMediaAccessAt() const { return lastMediaAccessAt; };
 
-    uint32_t GetLastMediaAccessAt() { ISR_SAFE_GET(uint32_t, lastMediaAccessAt); };
+  #ifdef VAN_ISR_PROFILING
+    // Prints the execution time statistics of 'RxPinChangeIsr' and 'WaitAckIsr'. Optionally clears them afterwards.
+    void DumpIsrProfile(Stream& s, bool reset = false);
+  #endif // VAN_ISR_PROFILING
+
+  #ifdef VAN_RX_STATS
+    // Copies the receiver statistics into 'snapshot'. If 'reset' is true, the counters and histograms are then
+    // cleared, so that the next snapshot covers only the period after this one. The bus load window is not cleared.
+    void GetStats(TVanRxStats& snapshot, bool reset = false);
+  #endif // VAN_RX_STATS
 
   private:
 
     uint8_t pin;
     bool enabled;
     int size;
+
+    // Index in the list of receive queues; 0 is 'VanBusRx'. Stored in each packet (see 'TVanPacketRxDesc::RxQueue').
+    uint8_t index;
+
+    // Pin level change interrupt handler: a plain function (as needed by 'attachInterrupt') that calls
+    // '_OnPinChange' of this receive queue
+    void (*pinChangeIsr)();
+
+  #ifdef ARDUINO_ARCH_ESP32
+    hw_timer_t* ackTimer;  // For the ACK time-out. For 'VanBusRx' this is 'timer', shared with the transmitter.
+    portMUX_TYPE* isrMux;  // For 'VanBusRx' this is 'mux', shared with the transmitter
+  #endif // ARDUINO_ARCH_ESP32
+
+    // No hardware timer for the ACK time-out: on ESP8266, timer1 is taken by 'VanBusRx' and the transmitter; on
+    // ESP32, all timers may be in use. The ACK time-out is then checked at the next bus level change, and each time
+    // the consumer looks for a packet.
+    bool softAckTimer;
+
+  #if defined ARDUINO_ARCH_ESP32 && ! defined VAN_RX_ESP32_RMT
+    // The ESP32 Arduino core services all pin interrupts on a single core. If the pin interrupt of this receive queue
+    // is to be serviced by the other core, it is taken over by 'GpioIsr' (see 'RoutePinIsr').
+    bool ownGpioIsr;
+    uint8_t gpioIsrPin;
+    uint8_t gpioIsrCore;
+  #endif // defined ARDUINO_ARCH_ESP32 && ! defined VAN_RX_ESP32_RMT
+
+  #ifdef VAN_RX_ESP32_RMT
+    rmt_channel_t rmtChannel;
+    RingbufHandle_t rmtRingBuffer;  // Between the RMT driver and 'RmtRxTask'
+    TaskHandle_t rmtRxTask;
+  #endif // VAN_RX_ESP32_RMT
+
+    // The packet decoder (see 'DecodeEdge')
+    TVanRxDecoder decoder;
+
+    // Emulation of the ACK time-out timer (see '_OnAckTimeout'), while replaying recorded bus level changes (see
+    // 'ReplayEdge'), or when there is no hardware timer (see 'softAckTimer')
+    volatile bool ackTimerArmed;
+    uint32_t ackTimerArmedAt;
+
+    uint32_t replayLastEdgeAt;  // Time of the last replayed level change
+
+  #ifdef VAN_RX_ESP32_RMT
+    uint32_t resyncFromMicros;  // System timer value at wake-up, see 'decoder.resync' ('RmtRxTask' may run on another core)
+  #endif // VAN_RX_ESP32_RMT
     TVanPacketRxDesc* pool;
     TVanPacketRxDesc* volatile _head;
     TVanPacketRxDesc* tail;
     TVanPacketRxDesc* end;
-    volatile bool _overrun;
+
+    // Queue overrun detection. Written only by the ISR resp. only by the consumer.
+    volatile uint32_t nOverruns;
+    uint32_t nOverrunsReported;
+
     uint32_t txTimerTicks;
     timercallback txTimerIsr;
+    bool (*txIsBusy)();  // Returns true while the transmitter has packets waiting or being sent
+  #ifndef VAN_RX_ESP32_RMT
+    // Called as soon as a packet header (IDEN and COM field) is received, with byte 1 in the MSB and byte 2 in the LSB
+    void (*inFrameReplyIsr)(uint16_t header);
+  #endif // VAN_RX_ESP32_RMT
     volatile uint32_t lastMediaAccessAt;  // For carrier sense: CPU cycle counter value when last sensed
 
   #ifdef VAN_RX_ISR_DEBUGGING
@@ -425,34 +1153,184 @@ class TVanPacketRxQueue
     uint32_t nTwoConsecutiveBitErrors;
     uint32_t nTwoSeparateBitErrors;
     uint32_t nUncertainBitErrors;
-    volatile int nQueued;
+
+  #ifdef VAN_RX_STATS
+    TVanRxStats stats;
+  #endif // VAN_RX_STATS
+
+  #ifdef VAN_ISR_PROFILING
+    TIsrProfile rxIsrProfile[VAN_RX_N_STATES];  // Per packet read state, as seen at entry of 'RxPinChangeIsr'
+    TIsrProfile waitAckIsrProfile;
+  #endif // VAN_ISR_PROFILING
+
+    // Queue fill level. Written only by the ISR resp. only by the consumer, so no locking is needed.
+    volatile uint32_t nEnqueued;
+    volatile uint32_t nDequeued;
     volatile int maxQueued;
 
     // Drop policy
     int startDroppingPacketsAt;
     bool (*isEssentialPacket)(const TVanPacketRxDesc&);
 
+    // Acceptance filter: one bit per IDEN. NULL means: accept all.
+    #define VAN_N_IDENS 4096
+    uint32_t* volatile idenFilter;
+    bool headFiltered;  // Packet being received into the head slot is rejected by the acceptance filter
+    uint32_t nFiltered;
+
+    void SetIdenFilter(uint16_t iden, uint16_t mask, bool accept);
+
+    // Priority lanes: two bits per IDEN. NULL means: all IDENs in the normal lane.
+    uint32_t* volatile idenLanes;
+
+    // High priority lane: a separate circular buffer. Packets are copied into it from the normal receive queue.
+    int highSize;
+    TVanPacketRxDesc* highPool;
+    TVanPacketRxDesc* highHead;  // Written only by the ISR
+    TVanPacketRxDesc* highTail;  // Written only by the consumer
+    TVanPacketRxDesc* highEnd;
+    volatile uint32_t nHighEnqueued;
+    volatile uint32_t nHighDequeued;
+
+    // Bulk lane: packets stay in the normal receive queue, but only up to 'bulkMaxDepth' of them. 'bulkDepth' is the
+    // depth as passed to 'SetLaneDepth' (0 if not set: use the default); 'bulkMaxDepth' is the depth in use, derived
+    // from 'bulkDepth' and the receive queue size.
+    int bulkDepth;
+    int bulkMaxDepth;
+    volatile uint32_t nBulkEnqueued;
+    volatile uint32_t nBulkDequeued;
+
+    // Per-lane statistics. Overruns are: normal lane: see 'nOverruns'; high lane: packets queued in the normal lane
+    // because the high lane was full; bulk lane: packets dropped because too many bulk packets were queued.
+    volatile int laneMaxQueued[VAN_RX_N_LANES];
+    volatile uint32_t laneOverruns[VAN_RX_N_LANES];
+
+    TVanPacketRxDesc* peeked;  // As returned by 'Peek'
+
+    // Deferred CRC repair (see 'SetRepairBudget'): a circular buffer of packets with a CRC error. Only touched by the
+    // consumer.
+    TVanPacketRxDesc* repairQueue;
+    int repairFirst;
+    int nRepairQueued;
+    uint32_t repairBudgetCycles;  // 0 means: repair is not deferred
+    bool (TVanPacketRxDesc::*repairWantToCount)() const;
+
+    // Progress of the repair of the oldest packet in 'repairQueue'; 'repairAtByte' is 0 if not started
+    int repairAtByte;
+    bool repairPrevBit;
+    uint16_t repairSyndrome;
+
+    uint32_t nRepairsSkipped;  // Packets with a CRC error passed on unrepaired, because 'repairQueue' was full
+
+    TVanPacketRxDesc* PeekQueued(bool* isQueueOverrun);
+    TVanPacketRxDesc* PeekDeferred(bool* isQueueOverrun);
+    bool RepairStep(TVanPacketRxDesc& pkt);
+
+    int GetNQueuedNormal() const { return nEnqueued - nDequeued; }  // Arithmetic has safe roll-over
+    int GetNQueuedHigh() const { return nHighEnqueued - nHighDequeued; }
+
+    // Event-driven packet delivery
+    void (* volatile onPacket)(TVanPacketRxDesc&);
+  #ifdef ARDUINO_ARCH_ESP32
+    TaskHandle_t consumerTask;
+  #else // ! ARDUINO_ARCH_ESP32
+    volatile bool deliveryScheduled;
+  #endif // ARDUINO_ARCH_ESP32
+
+    // Bus idle detection (see 'SetIdleTimeout'). Only touched by the consumer.
+    unsigned long idleTimeoutMs;  // 0 means: no idle detection
+    void (*onBusIdle)(bool idle);
+    bool idleLightSleep;
+    bool busIdle;
+    uint32_t idleCheckedMediaAccessAt;  // Value of 'lastMediaAccessAt' at the previous check
+    unsigned long lastBusActivityMs;  // millis() value when bus activity was last seen
+    uint32_t nLightSleeps;
+    volatile uint32_t nLostAtWakeUp;  // Written only by the ISR resp. 'RmtRxTask'
+
     void RegisterTxTimerTicks(uint32_t ticks) { txTimerTicks = ticks; };
     void RegisterTxIsr(timercallback isr) { ISR_SAFE_SET(txTimerIsr, isr); };
+    void RegisterTxBusyCheck(bool (*isBusy)()) { txIsBusy = isBusy; };
+  #ifndef VAN_RX_ESP32_RMT
+    void RegisterInFrameReplyIsr(void (*isr)(uint16_t header)) { ISR_SAFE_SET(inFrameReplyIsr, isr); };
+  #endif // VAN_RX_ESP32_RMT
 
-    void SetLastMediaAccessAt(uint32_t at) { ISR_SAFE_SET(lastMediaAccessAt, at); };
+    void SetLastMediaAccessAt(uint32_t at) { lastMediaAccessAt = at; };
 
-    bool IsQueueOverrun() { NO_INTERRUPTS; bool result = _overrun; _overrun = false; INTERRUPTS; return result; }
+    bool IsQueueOverrun()
+    {
+        const uint32_t n = nOverruns;
+        const bool result = n != nOverrunsReported;
+        nOverrunsReported = n;
+        return result;
+    } // IsQueueOverrun
+
+    // Feeds one bus level change into the packet decoder, and handles the outcome
+    void DecodeEdge(uint32_t curr, int pinLevel, bool replay);
+
+    bool InstallIsrs(uint8_t rxPin);
+  #if defined ARDUINO_ARCH_ESP32 && ! defined VAN_RX_ESP32_RMT
+    bool RoutePinIsr(uint8_t rxPin);
+  #endif // defined ARDUINO_ARCH_ESP32 && ! defined VAN_RX_ESP32_RMT
+    bool AbortSetup(uint8_t rxPin);
+  #ifdef VAN_RX_ESP32_RMT
+    bool SetupRmtRx(uint8_t rxPin);
+  #endif // VAN_RX_ESP32_RMT
+    void PollAckTimeout();
+
+  #ifndef VAN_RX_ESP32_RMT
+    // Start or stop servicing the pin interrupt, on the core chosen at 'Setup'
+    void AttachPinIsr();
+    void DetachPinIsr();
+  #endif // VAN_RX_ESP32_RMT
 
     // Only to be called from ISR, unsafe otherwise
+    void _OnPinChange();
+    void _OnAckTimeout();
+    void _ExpireAckTimer(uint32_t now);
     void _AdvanceHead();
+    bool _CommitToHighLane();
+    void _NotifyConsumer();
+
+    // Pass all queued packets to the 'OnPacket' callback
+    void DeliverPackets();
+  #ifndef ARDUINO_ARCH_ESP32
+    void DeliverScheduledPackets();
+  #endif // ARDUINO_ARCH_ESP32
 
     void AdvanceTail()
     {
         if (++tail == end) tail = pool;  // Roll over if needed
-        ISR_SAFE_SET(nQueued, nQueued - 1);
+        nDequeued++;
     } // AdvanceTail
 
     friend void FinishPacketTransmission(TVanPacketTxDesc* txDesc);
     friend void SendBitIsr();
+    friend void SendReplyBitIsr();
     friend void RxPinChangeIsr();
-    friend void SetTxBitTimer();
+    friend void RxPinChangeIsr1();
+    friend void RxPinChangeIsr2();
+    friend void RxPinChangeIsr3();
+  #ifdef VAN_RX_ESP32_RMT
+    friend void RmtRxTask(void* param);
+  #endif // VAN_RX_ESP32_RMT
+  #ifdef VAN_TX_ESP32_RMT
+    friend void StartRmtTransmission(TVanPacketTxDesc* txDesc);
+    friend void RmtTxTask(void* param);
+    friend void TxRmtCheckEdge(uint32_t curr, int pinLevel);
+    friend void TxRmtEdgeIsr();
+  #endif // VAN_TX_ESP32_RMT
+    friend void ArmTxTimer(unsigned int idleBits);
     friend void WaitAckIsr();
+    friend void WaitAckIsr1();
+    friend void WaitAckIsr2();
+    friend void WaitAckIsr3();
+  #ifdef ARDUINO_ARCH_ESP32
+    friend void InstallRxIsrsTask(void* param);
+  #endif // ARDUINO_ARCH_ESP32
+  #if defined ARDUINO_ARCH_ESP32 && ! defined VAN_RX_ESP32_RMT
+    friend void GpioIsr(void* arg);
+  #endif // defined ARDUINO_ARCH_ESP32 && ! defined VAN_RX_ESP32_RMT
+    friend void RxConsumerTask(void* param);
     friend class TVanPacketRxDesc;
     friend class TVanPacketTxQueue;
 }; // class TVanPacketRxQueue
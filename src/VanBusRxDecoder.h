@@ -0,0 +1,937 @@
+/*
+ * VanBus packet decoder: converts bus level changes into packet bytes
+ *
+ * Written by Erik Tromp
+ *
+ * Version 0.4.2 - October, 2026
+ *
+ * MIT license, all text above must be included in any redistribution.
+ */
+
+/*
+ * This is plain C++, without any dependency on the Arduino core or on the hardware. The pin level change interrupt
+ * handler (see 'TVanPacketRxQueue::DecodeEdge' in VanBusRx.cpp) passes in the time stamp and the new bus level of
+ * each level change, and takes care of the locking and the timers itself. This way, the decoder can also be built
+ * and tested on a PC (see ../extras/DecoderReplay).
+ *
+ * Before including this file, define:
+ * - F_CPU: the CPU clock frequency in Hz; the time stamps are in CPU cycles
+ * - LOW and HIGH: the pin levels
+ * - the compile options VAN_RX_ADAPTIVE_BIT_TIMING, VAN_RX_ISR_DEBUGGING, VAN_RX_IFS_DEBUGGING and VAN_RX_STATS, if
+ *   used (see VanBusRx.h)
+ */
+
+#ifndef VanBusRxDecoder_h
+#define VanBusRxDecoder_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+// VAN_BIT_DOMINANT, VAN_BIT_RECESSIVE: pick the logic
+#ifndef VAN_BIT_INVERTED_WIRING
+#define VAN_BIT_INVERTED_WIRING 1
+#endif
+
+#if VAN_BIT_INVERTED_WIRING == 1
+  // MCP2551 CAN_H pin connected to VAN_DATA_BAR, CAN_L connected to VAN_DATA
+  #define VAN_BIT_DOMINANT LOW
+  #define VAN_BIT_RECESSIVE HIGH
+#else
+  // MCP2551 CAN_H pin connected to VAN_DATA, CAN_L connected to VAN_DATA_BAR
+  #define VAN_BIT_DOMINANT HIGH
+  #define VAN_BIT_RECESSIVE LOW
+#endif
+
+// The CAN bus has two states: dominant and recessive.
+// - For the MCP2551 device: "The dominant and recessive states correspond to the low and high state of the TXD input,
+//   pin, respectively." and "The low and high states of the RXD output pin correspond to the dominant and recessive
+//   states of the CAN bus, respectively."
+//   (see: http://ww1.microchip.com/downloads/en/devicedoc/21667d.pdf#page=3 )
+// - For the SN65HVD23x device: "LOW for dominant and HIGH for recessive bus states"
+//   (see: https://www.ti.com/lit/ds/symlink/sn65hvd230.pdf?ts=1592992149874#page=5 )
+#define VAN_LOGICAL_LOW VAN_BIT_DOMINANT
+#define VAN_LOGICAL_HIGH VAN_BIT_RECESSIVE
+
+// F_CPU is set by the Arduino IDE option as chosen in menu Tools > CPU Frequency. It is always a multiple of 80000000.
+#ifndef TIMER_BASE_CLK
+  #define TIMER_BASE_CLK (80000000)
+#endif
+#define CPU_F_FACTOR (F_CPU / TIMER_BASE_CLK)
+#define CPU_CYCLES(_X) ((_X) * CPU_F_FACTOR)
+
+// Normal bit time (8 microseconds), expressed as number of CPU cycles
+#define VAN_NORMAL_BIT_TIME_CPU_CYCLES (CPU_CYCLES(667))
+
+#ifdef VAN_RX_ADAPTIVE_BIT_TIMING
+  // Number of fractional bits in a tracked bit time (see 'TVanRxDecoder')
+  #define VAN_BIT_TIME_FRAC_BITS 4
+#endif // VAN_RX_ADAPTIVE_BIT_TIMING
+
+// ACK time-out: 5 time slots = 5 * 8 us = 40 us
+#define VAN_ACK_TIMEOUT_CPU_CYCLES (40 * (F_CPU / 1000000))
+
+// More than 10 equal bits end a packet (see 'TVanRxDecoder::Decode')
+#define VAN_REPLAY_IDLE_CPU_CYCLES (12 * VAN_NORMAL_BIT_TIME_CPU_CYCLES)
+
+// After waking up from light sleep, the next SOF is the first 'dominant' level after at least 8 'recessive' bits
+#define VAN_RESYNC_IDLE_CPU_CYCLES (8 * VAN_NORMAL_BIT_TIME_CPU_CYCLES)
+
+// VAN packet layout:
+// - SOF = 10 time slots (TS) = 8 bits = 1 byte
+// - IDEN = 15 TS = 12 bits = 1.5 bytes
+// - COM = 5 TS = 4 bits = 0.5 bytes
+// - Data = 280 TS max = 28 bytes max
+// - CRC + EOD = 18 + 2 TS = 2 bytes
+// - ACK  = 2 TS
+// - EOF  = 8 TS
+// Total 1 + 1.5 + 0.5 + 28 + 2 = 33 bytes excluding ACK and EOF
+
+#define VAN_MAX_DATA_BYTES 28
+#define VAN_MAX_PACKET_SIZE 33
+
+#define NO_UNCERTAIN_BIT (0)
+
+enum PacketReadState_t { VAN_RX_VACANT = 2, VAN_RX_SEARCHING, VAN_RX_LOADING, VAN_RX_WAITING_ACK, VAN_RX_DONE };
+#define VAN_RX_N_STATES (VAN_RX_DONE - VAN_RX_VACANT + 1)
+enum PacketReadResult_t { VAN_RX_PACKET_OK, VAN_RX_ERROR_NBITS, VAN_RX_ERROR_MANCHESTER, VAN_RX_ERROR_MAX_PACKET };
+enum PacketAck_t { VAN_ACK, VAN_NO_ACK };
+
+// Returned by 'TVanRxDecoder::Decode': what the caller must do. More than one can be set.
+enum VanRxDecoderEvent_t
+{
+    VAN_RX_EV_IGNORED = 0x01,  // Level change skipped while resynchronizing after light sleep (see 'resync')
+    VAN_RX_EV_LOST = 0x02,  // The packet that caused the wake-up is lost
+    VAN_RX_EV_NOISE = 0x04,  // Noise on the bus: stop decoding, to prevent CPU monopolization
+    VAN_RX_EV_OVERRUN = 0x08,  // No room for the packet
+    VAN_RX_EV_CANCEL_ACK_TIMER = 0x10,
+    VAN_RX_EV_HEADER = 0x20,  // IDEN and COM fields complete, e.g. for an acceptance filter or an in-frame reply
+    VAN_RX_EV_ARM_ACK_TIMER = 0x40,  // EOD: call 'AckTimeout' after VAN_ACK_TIMEOUT_CPU_CYCLES
+    VAN_RX_EV_PACKET = 0x80  // Packet complete; see 'size', 'result', 'ack' and 'uncertainBit1'
+};
+
+// Converts bus level changes into the bytes of a packet. Keeps its state from one bus level change to the next.
+class TVanRxDecoder
+{
+  public:
+
+    TVanRxDecoder()
+        : state(VAN_RX_VACANT)
+        , prevPinLevel(VAN_BIT_RECESSIVE)
+        , pinLevelChangedDuringInterruptHandling(false)
+        , prev(0)
+        , sofAt(0)
+        , noiseCounter(0)
+        , jitter(0)
+        , atBit(0)
+        , readBits(0)
+        , addToBitTime(0)
+        , averageOneBitTime(0)
+      #ifdef VAN_RX_ADAPTIVE_BIT_TIMING
+        , busBitTime(VAN_NORMAL_BIT_TIME_CPU_CYCLES << VAN_BIT_TIME_FRAC_BITS)
+        , bitTime(VAN_NORMAL_BIT_TIME_CPU_CYCLES << VAN_BIT_TIME_FRAC_BITS)
+        , bitTimeFromAt(0)
+        , bitTimeNBits(0)
+      #endif // VAN_RX_ADAPTIVE_BIT_TIMING
+        , resync(false)
+        , resyncDropping(false)
+    {
+        InitPacket();
+    } // TVanRxDecoder
+
+    // Processes one bus level change. 'curr' is the CPU cycle counter value at the level change, 'pinLevel' is the
+    // new bus level. The packet bytes are written into 'bytes'; pass NULL if there is no room for a packet. Returns
+    // a combination of VanRxDecoderEvent_t values.
+    unsigned int Decode(uint32_t curr, int pinLevel, uint8_t* bytes);
+
+    // To be called right after 'Decode' (unless it returned VAN_RX_EV_IGNORED or VAN_RX_EV_NOISE), with the bus
+    // level as read back at that moment. A level change that is immediately undone points at a late interrupt.
+    void CheckPinLevelAtReturn(int pinLevel, int pinLevelAtReturn)
+    {
+        pinLevelChangedDuringInterruptHandling = jitter < CPU_CYCLES(100) && pinLevelAtReturn != pinLevel;
+    } // CheckPinLevelAtReturn
+
+    // To be called when the ACK time-out expires. Returns true if that completes the packet.
+    bool AckTimeout()
+    {
+        if (state != VAN_RX_WAITING_ACK) return false;
+        state = VAN_RX_DONE;
+        return true;
+    } // AckTimeout
+
+    // VAN_RX_DONE: the packet is complete, or there is no room for it
+    PacketReadState_t state;
+
+    // The packet being received
+    int size;
+    PacketReadResult_t result;
+    PacketAck_t ack;
+    int uncertainBit1;
+
+    int prevPinLevel;
+    bool pinLevelChangedDuringInterruptHandling;
+    uint32_t prev;  // CPU cycle counter value at the previous level change
+    uint32_t sofAt;  // CPU cycle counter value at the start of the SOF of the packet being received
+    int noiseCounter;
+    uint32_t jitter;
+    unsigned int atBit;
+    uint16_t readBits;
+
+    // CRC packet errors which can be fixed by inserting an extra bit indicate that the bit time measurements
+    // can be extended somewhat (see 'TVanPacketRxDesc::Repair')
+    long addToBitTime;
+    uint32_t averageOneBitTime;
+
+  #ifdef VAN_RX_ADAPTIVE_BIT_TIMING
+    // Bit times, in CPU cycles, with VAN_BIT_TIME_FRAC_BITS fractional bits
+    uint32_t busBitTime;  // As found in the previous packets; seeds 'bitTime' at each SOF
+    uint32_t bitTime;  // As measured in the packet being received
+
+    // The packet being received is measured from the level change at 'bitTimeFromAt', 'bitTimeNBits' bits ago
+    uint32_t bitTimeFromAt;
+    unsigned int bitTimeNBits;
+  #endif // VAN_RX_ADAPTIVE_BIT_TIMING
+
+    // Set after waking up from light sleep: level changes are skipped until the next SOF
+    volatile bool resync;
+    bool resyncDropping;  // Level changes of the packet that caused the wake-up are being skipped
+
+  #if defined VAN_RX_ISR_DEBUGGING || defined VAN_RX_IFS_DEBUGGING || defined VAN_RX_STATS
+    // The last decoded level change, for debugging and statistics
+    struct TEdge
+    {
+        uint32_t nCyclesMeasured;
+        uint32_t fromJitter;
+        uint32_t jitter;  // Right after the conversion into a number of bits
+        unsigned int nBits;
+        int prevPinLevel;
+        PacketReadState_t fromState;
+        uint16_t flipBits;
+        uint16_t readBits;  // Before a complete byte is taken out
+    } edge;
+  #endif // defined VAN_RX_ISR_DEBUGGING || defined VAN_RX_IFS_DEBUGGING || defined VAN_RX_STATS
+
+  private:
+
+    void InitPacket()
+    {
+        size = 0;
+        result = VAN_RX_PACKET_OK;
+        ack = VAN_NO_ACK;
+        uncertainBit1 = NO_UNCERTAIN_BIT;
+    } // InitPacket
+
+    static unsigned int nBits(uint32_t nCycles);
+    static unsigned int nBitsTakingIntoAccountJitter(uint32_t nCycles, uint32_t& jitter);
+
+  #ifdef VAN_RX_ADAPTIVE_BIT_TIMING
+    static unsigned int nBitsAdaptive(uint32_t nCycles, uint32_t bitTime, uint32_t& jitter);
+
+    // Number of CPU cycles in 'n / 32' bit times, at the bit time of the packet being received
+    uint32_t BitTimes32(uint32_t n) const { return (bitTime * n) >> (VAN_BIT_TIME_FRAC_BITS + 5); }
+  #endif // VAN_RX_ADAPTIVE_BIT_TIMING
+}; // class TVanRxDecoder
+
+inline __attribute__((always_inline)) unsigned int TVanRxDecoder::nBits(uint32_t nCycles)
+{
+    return (nCycles + CPU_CYCLES(200)) / VAN_NORMAL_BIT_TIME_CPU_CYCLES;
+} // TVanRxDecoder::nBits
+
+// Calculate number of bits from a number of elapsed CPU cycles
+inline __attribute__((always_inline)) unsigned int TVanRxDecoder::nBitsTakingIntoAccountJitter(
+    uint32_t nCycles,
+    uint32_t& jitter)
+{
+    // Here is the heart of the machine; lots of voodoo magic here...
+
+    // Theory:
+    // - VAN bus rate = 125 kbit/sec = 125 000 bits/sec
+    //   1 bit = 1/125000 = 0.000008 sec = 8.0 usec
+    // - CPU rate is 80 MHz
+    //   1 cycle @ 80 MHz = 0.0000000125 sec = 0.0125 usec
+    // --> So, 1 VAN-bus bit is 8.0 / 0.0125 = 640 cycles
+
+    // Sometimes, samples are stretched, because the ISR is called too late: ESP8266 interrupt service latency can
+    // vary. If that happens, we must compress the "sample time" for the next bit.
+
+    // All timing values were found by trial and error
+    jitter = 0;
+
+    if (nCycles < CPU_CYCLES(555))
+    {
+        if (nCycles > CPU_CYCLES(112)) jitter = nCycles - CPU_CYCLES(112);
+        return 0;
+    } // if
+
+  #define ONE_BIT_BOUNDARY CPU_CYCLES(1281)
+    if (nCycles < ONE_BIT_BOUNDARY)
+    {
+        if (nCycles > CPU_CYCLES(712)) jitter = nCycles - CPU_CYCLES(712);  // 712 --> 1281 = 569
+        return 1;
+    } // if
+
+    if (nCycles < CPU_CYCLES(1863))
+    {
+        if (nCycles > CPU_CYCLES(1349)) jitter = nCycles - CPU_CYCLES(1349);  // 1349 --> 1863 = 514
+        return 2;
+    } // if
+
+  #define THREE_BIT_BOUNDARY CPU_CYCLES(2500)
+    if (nCycles < THREE_BIT_BOUNDARY)
+    {
+        if (nCycles > CPU_CYCLES(1998)) jitter = nCycles - CPU_CYCLES(1998);  // 1998 --> 2500 = 502
+        return 3;
+    } // if
+
+    if (nCycles < CPU_CYCLES(3166))
+    {
+        if (nCycles > CPU_CYCLES(2636)) jitter = nCycles - CPU_CYCLES(2636);  // 2636 --> 3166 = 530
+        return 4;
+    } // if
+
+    if (nCycles < CPU_CYCLES(3819))
+    {
+        if (nCycles > CPU_CYCLES(3262)) jitter = nCycles - CPU_CYCLES(3262);  // 3262 --> 3819 = 557
+        return 5;
+    } // if
+
+    // We hardly ever get to this point
+    if (nCycles < CPU_CYCLES(4468))
+    {
+        if (nCycles > CPU_CYCLES(3930)) jitter = nCycles - CPU_CYCLES(3930);  // 3930 --> 4468 = 538
+        return 6;
+    } // if
+
+    const unsigned int _nBits = nBits(nCycles);
+    if (nCycles > _nBits * VAN_NORMAL_BIT_TIME_CPU_CYCLES) jitter = nCycles - _nBits * VAN_NORMAL_BIT_TIME_CPU_CYCLES;
+
+    return _nBits;
+} // TVanRxDecoder::nBitsTakingIntoAccountJitter
+
+#ifdef VAN_RX_ADAPTIVE_BIT_TIMING
+
+// The boundary between 'n' and 'n + 1' bits lies at 'n + VAN_BIT_BOUNDARY / 32' bit times. Interrupt latency only
+// ever delays a level change, so the boundary is well past the middle of a bit.
+#define VAN_BIT_BOUNDARY (21)
+
+// Persisting jitter is taken out by 1 / (2 ^ VAN_JITTER_RUNDOWN_SHIFT) per level change
+#define VAN_JITTER_RUNDOWN_SHIFT (3)
+
+// The bit time of the previous packets weighs in as this number of bits, when measuring the bit time of the packet
+// being received
+#define VAN_BIT_TIME_PRIOR_BITS (32)
+
+// Range of bit times that are accepted as measured
+#define VAN_MIN_BIT_TIME (CPU_CYCLES(560) << VAN_BIT_TIME_FRAC_BITS)
+#define VAN_MAX_BIT_TIME (CPU_CYCLES(780) << VAN_BIT_TIME_FRAC_BITS)
+
+// Calculate number of bits from a number of elapsed CPU cycles, given the bit time 'bitTime' (with
+// VAN_BIT_TIME_FRAC_BITS fractional bits)
+inline __attribute__((always_inline)) unsigned int TVanRxDecoder::nBitsAdaptive(
+    uint32_t nCycles,
+    uint32_t bitTime,
+    uint32_t& jitter)
+{
+    jitter = 0;
+
+    // Much longer than any sequence of equal bits within a packet: no need for precision
+    if (nCycles >= 16 * VAN_NORMAL_BIT_TIME_CPU_CYCLES) return nCycles / (bitTime >> VAN_BIT_TIME_FRAC_BITS);
+
+    const uint32_t nCyclesFrac = nCycles << VAN_BIT_TIME_FRAC_BITS;
+
+    unsigned int _nBits = 0;
+    uint32_t boundary = bitTime * VAN_BIT_BOUNDARY / 32;
+    while (nCyclesFrac >= boundary)
+    {
+        boundary += bitTime;
+        _nBits++;
+    } // while
+
+    const uint32_t expected = _nBits * bitTime;
+    if (nCyclesFrac > expected) jitter = (nCyclesFrac - expected) >> VAN_BIT_TIME_FRAC_BITS;
+
+    return _nBits;
+} // TVanRxDecoder::nBitsAdaptive
+
+#endif // VAN_RX_ADAPTIVE_BIT_TIMING
+
+// Note: always inlined, so that the interrupt handler does not need an extra function call
+inline __attribute__((always_inline)) unsigned int TVanRxDecoder::Decode(uint32_t curr, int pinLevel, uint8_t* bytes)
+{
+    // No room for the packet? Or room again, after the previous packet was taken? Then start all over.
+    if (bytes == NULL)
+    {
+        state = VAN_RX_DONE;
+    }
+    else if (state == VAN_RX_DONE)
+    {
+        InitPacket();
+        state = VAN_RX_VACANT;
+    } // if
+
+    // Pin levels
+
+    // The logic is:
+    // - if pinLevel == VAN_LOGICAL_HIGH, we've just had a series of VAN_LOGICAL_LOW bits.
+    // - if pinLevel == VAN_LOGICAL_LOW, we've just had a series of VAN_LOGICAL_HIGH bits.
+
+    // Number of elapsed CPU cycles
+    const uint32_t nCyclesMeasured = curr - prev;  // Arithmetic has safe roll-over
+    prev = curr;
+
+    const bool samePinLevel = (pinLevel == prevPinLevel);
+
+    // Just woken up from light sleep, somewhere in the packet that caused the wake-up: skip the rest of that packet
+    if (resync)
+    {
+        prevPinLevel = pinLevel;
+        if (pinLevel != VAN_BIT_DOMINANT || nCyclesMeasured < VAN_RESYNC_IDLE_CPU_CYCLES)
+        {
+            // Count the dropped packet once, at its first skipped level change
+            unsigned int events = VAN_RX_EV_IGNORED;
+            if (! resyncDropping) events |= VAN_RX_EV_LOST;
+            resyncDropping = true;
+            return events;
+        } // if
+        resync = false;
+    } // if
+
+    // Prevent CPU monopolization by noise on bus
+    if (nCyclesMeasured < 510 || samePinLevel)
+    {
+        if (++noiseCounter > 30) return VAN_RX_EV_NOISE;
+    }
+    else
+    {
+        noiseCounter = 0;
+    } // if
+
+    const PacketReadState_t fromState = state;
+
+    // Conversion from elapsed CPU cycles to number of bits, including built-up jitter
+    uint32_t nCycles = nCyclesMeasured + jitter;
+
+    const uint32_t prevJitter = jitter;
+
+  #ifdef VAN_RX_ADAPTIVE_BIT_TIMING
+
+    unsigned int nBits = nBitsAdaptive(nCycles, bitTime, jitter);
+
+    // With a correct bit time, any jitter is caused by interrupt latency, which does not persist
+    jitter -= jitter >> VAN_JITTER_RUNDOWN_SHIFT;
+
+  #else // ! VAN_RX_ADAPTIVE_BIT_TIMING
+
+    nCycles += addToBitTime;
+
+    // Experiment
+
+    if (nCyclesMeasured > CPU_CYCLES(600) && nCyclesMeasured < CPU_CYCLES(800))
+    {
+        averageOneBitTime = averageOneBitTime == 0 ? CPU_CYCLES(700) : (averageOneBitTime * 99 + nCyclesMeasured + 50) / 100;
+    } // if
+
+  #if 0
+    if (averageOneBitTime > CPU_CYCLES(660))
+    {
+        if (averageOneBitTime < CPU_CYCLES(693))
+        {
+            //nCycles = (4 * nCycles + CPU_CYCLES(700) - averageOneBitTime + 2) / 4;
+            nCycles += CPU_CYCLES(5);
+        }
+        else if (averageOneBitTime > CPU_CYCLES(714))
+        {
+            nCycles -= CPU_CYCLES(10);
+        } // if
+    } // if
+  #endif
+
+    if (fromState == VAN_RX_VACANT || fromState == VAN_RX_SEARCHING)
+    {
+        // During SOF, timing is slightly different. Timing values were found by trial and error.
+
+      #define FOUR_BITS THREE_BIT_BOUNDARY + CPU_CYCLES(10)
+        if (nCycles > CPU_CYCLES(2284) && nCycles < FOUR_BITS) nCycles = FOUR_BITS;
+        //else if (nCycles > CPU_CYCLES(600) && nCycles < CPU_CYCLES(800)) nCycles -= CPU_CYCLES(20);
+        else if (nCycles > CPU_CYCLES(1100) && nCycles < ONE_BIT_BOUNDARY) nCycles -= CPU_CYCLES(20);
+    }
+    else
+    {
+        // Sometimes, one long bit is in fact two bits
+
+        if (jitter < CPU_CYCLES(300))
+        {
+          #define MOVE_TOWARDS_TWO_BITS_AT CPU_CYCLES(1229)
+          #define MOVE_TOWARDS_TWO_BITS ONE_BIT_BOUNDARY - MOVE_TOWARDS_TWO_BITS_AT
+            if (nCyclesMeasured > CPU_CYCLES(987) && nCyclesMeasured < ONE_BIT_BOUNDARY && nCycles >= CPU_CYCLES(1220))
+            {
+                nCycles += MOVE_TOWARDS_TWO_BITS;
+            } // if
+        }
+        else if (jitter < CPU_CYCLES(400))
+        {
+            if (nCyclesMeasured > CPU_CYCLES(900) && nCyclesMeasured < CPU_CYCLES(988))
+            {
+                nCycles += CPU_CYCLES(22);
+            } // if
+        } // if
+    } // if
+
+    unsigned int nBits = nBitsTakingIntoAccountJitter(nCycles, jitter);
+
+    // Experiment
+  #define SMALLEST_JITTER CPU_CYCLES(20)
+    if (jitter < SMALLEST_JITTER)
+    {
+        jitter = 0;
+    }
+    else if (jitter <= CPU_CYCLES(200))
+    {
+      #define SMALL_JITTER_RUNDOWN SMALLEST_JITTER
+        if (jitter > prevJitter - CPU_CYCLES(15) && jitter < prevJitter + CPU_CYCLES(18)) jitter -= SMALL_JITTER_RUNDOWN;
+    }
+    else
+    {
+      #define LARGE_JITTER_RUNDOWN CPU_CYCLES(30)
+        if (jitter > prevJitter - CPU_CYCLES(30) && jitter < prevJitter + CPU_CYCLES(5)) jitter -= LARGE_JITTER_RUNDOWN;
+    } // if
+
+  #endif // VAN_RX_ADAPTIVE_BIT_TIMING
+
+    uint16_t flipBits = 0;
+
+  #if defined VAN_RX_ISR_DEBUGGING || defined VAN_RX_IFS_DEBUGGING || defined VAN_RX_STATS
+
+    // Record some data to be used for debugging and statistics outside this function
+    edge.nCyclesMeasured = nCyclesMeasured;
+    edge.fromJitter = prevJitter;
+    edge.jitter = jitter;
+    edge.nBits = nBits;
+    edge.prevPinLevel = prevPinLevel;
+    edge.fromState = fromState;
+    edge.flipBits = 0;
+    edge.readBits = 0;
+
+    #define DEBUG_EDGE(TO_, FROM_) edge.TO_ = (FROM_);
+
+  #else
+
+    (void)prevJitter;
+
+    #define DEBUG_EDGE(TO_, FROM_)
+
+  #endif // defined VAN_RX_ISR_DEBUGGING || defined VAN_RX_IFS_DEBUGGING || defined VAN_RX_STATS
+
+    prevPinLevel = pinLevel;
+
+    unsigned int events = 0;
+
+    if (fromState == VAN_RX_WAITING_ACK)
+    {
+        if (
+            // If another bit came after the "ACK", it is not an "ACK" but the first "1" bit of the next byte
+            (ack == VAN_ACK && pinLevel == VAN_LOGICAL_LOW)
+
+            // If the "ACK" came too soon or lasted more than 1 time slot, it is not an "ACK" but the first
+            // "1" bit of the next byte
+            || pinLevelChangedDuringInterruptHandling
+          #ifdef VAN_RX_ADAPTIVE_BIT_TIMING
+            || nCycles < BitTimes32(31)
+            || nCycles > BitTimes32(48)
+          #else // ! VAN_RX_ADAPTIVE_BIT_TIMING
+            || nCycles < CPU_CYCLES(650)
+            || nCycles > CPU_CYCLES(1000)
+          #endif // VAN_RX_ADAPTIVE_BIT_TIMING
+           )
+        {
+            events |= VAN_RX_EV_CANCEL_ACK_TIMER;
+
+            // Go back to state VAN_RX_LOADING
+            state = VAN_RX_LOADING;
+
+            ack = VAN_NO_ACK;
+        }
+        else
+        {
+            // TODO - move (under condition) into the ACK time-out?
+            ack = VAN_ACK;
+
+            // 'AckTimeout' will complete the packet
+        } // if
+    } // if
+
+    if (fromState == VAN_RX_VACANT)
+    {
+        readBits = 0;
+
+      #ifdef VAN_RX_ADAPTIVE_BIT_TIMING
+        // Seed the bit time for the packet that may start here
+        bitTime = busBitTime;
+      #endif // VAN_RX_ADAPTIVE_BIT_TIMING
+
+        if (pinLevel == VAN_LOGICAL_LOW)
+        {
+            // Normal detection: we've seen a series of VAN_LOGICAL_HIGH bits
+
+            state = VAN_RX_SEARCHING;
+            sofAt = curr;
+
+          #ifdef VAN_RX_ADAPTIVE_BIT_TIMING
+            bitTimeFromAt = curr;
+            bitTimeNBits = 0;
+          #endif // VAN_RX_ADAPTIVE_BIT_TIMING
+
+            if (nBits == 7 || nBits == 8) atBit = nBits; else atBit = 0;
+            jitter = 0;
+
+            pinLevelChangedDuringInterruptHandling = false;
+        }
+        else if (pinLevel == VAN_LOGICAL_HIGH)
+        {
+            if (nBits >= 2 && nBits <= 8)
+            {
+                // Late detection
+
+                state = VAN_RX_SEARCHING;
+                sofAt = curr - nCyclesMeasured;  // The SOF started at the previous level change
+
+              #ifdef VAN_RX_ADAPTIVE_BIT_TIMING
+                bitTimeFromAt = sofAt;
+                bitTimeNBits = nBits;
+              #endif // VAN_RX_ADAPTIVE_BIT_TIMING
+
+                atBit = nBits;
+                if (nBits > 5) jitter = 0;
+            } // if
+        } // if
+
+        return events;
+    } // if
+
+    // No room for the packet (the receive queue is completely full)?
+    if (fromState == VAN_RX_DONE) return events | VAN_RX_EV_OVERRUN;
+
+    // During packet reception, the "Enhanced Manchester" encoding guarantees at most 5 bits are the same,
+    // except during EOD when it can be 6.
+    // However, sometimes the Manchester bit is missed. Let's be tolerant with that, and just pretend it
+    // was there, by accepting up to 10 equal bits.
+    if (nBits > 10)
+    {
+        jitter = 0;
+
+        if (fromState == VAN_RX_SEARCHING)
+        {
+            readBits = 0;
+            atBit = 0;
+            size = 0;
+
+            return events;
+        } // if
+
+        if (atBit == 9 && size < VAN_MAX_PACKET_SIZE)
+        {
+            uint16_t currentByte = readBits << 1;
+            uint8_t readByte = (currentByte >> 2 & 0xF0) | (currentByte >> 1 & 0x0F);
+            bytes[size++] = readByte;
+        }
+        else
+        {
+            result = VAN_RX_ERROR_NBITS;
+        } // if
+
+        state = VAN_RX_DONE;
+        return events | VAN_RX_EV_PACKET;
+    } // if
+
+    // Experimental handling of special situations caused by a missed interrupt or a very late ISR invocation.
+    // All cases were found by trial and error.
+    if (nBits == 0)
+    {
+        if (fromState == VAN_RX_SEARCHING)
+        {
+            nBits = 1;
+            DEBUG_EDGE(nBits, 1);
+
+            jitter = 0;
+        }
+        else if (atBit > 0)
+        {
+            const uint16_t prev = readBits;
+
+            // Set or clear the last read bit
+            readBits = pinLevel == VAN_LOGICAL_LOW ? readBits | 0x0001 : readBits & 0xFFFE;
+
+            // If last bit was actually flipped, reset jitter
+            //if (atBit > 0 && prev != readBits) jitter = 0;
+            if (prev != readBits) jitter -= jitter < CPU_CYCLES(157U) ? jitter : CPU_CYCLES(157U);
+        } // if
+    }
+    else if (samePinLevel)
+    {
+        if (nBits == 1)
+        {
+            flipBits = 0x0001;
+        }
+        else if (nBits == 2)
+        {
+            // Flip the last 'nBits' except the very last bit, e.g. flip the bits -- ---- --X-
+            flipBits = 0x0002;
+        }
+        else if (nBits > 2)
+        {
+            // Flip the last 'nBits' except the very last bit, e.g. if nBits == 4 ==> flip the bits -- ---- XXX-
+            flipBits = (1 << nBits) - 1 - 1;
+
+            // If the interrupt was so late that the pin level has already changed again, then flip also the very
+            // last bit
+            if (jitter > CPU_CYCLES(280)) flipBits |= 0x0001;
+        } // if
+
+        if ((flipBits & 0x0001) == 0x0001) prevPinLevel = 2; // next ISR, samePinLevel must always be false.
+
+        DEBUG_EDGE(flipBits, flipBits);
+    } // if
+
+    readBits <<= nBits;
+    atBit += nBits;
+
+  #ifdef VAN_RX_ADAPTIVE_BIT_TIMING
+    bitTimeNBits += nBits;
+  #endif // VAN_RX_ADAPTIVE_BIT_TIMING
+
+    // Calculate the position of the last received bit (in order of reception: MSB first)
+    int bitPosition = size * 8 + atBit;
+
+    // Count only the "real" bits, not the Manchester bits
+    if (atBit > 4) bitPosition--;
+    if (atBit > 9) bitPosition--;
+
+    if (pinLevel == VAN_LOGICAL_LOW)
+    {
+        // Just had a series of VAN_LOGICAL_HIGH bits
+        uint16_t pattern = (1 << nBits) - 1;
+        readBits |= pattern;
+    } // if
+
+    if (flipBits == 0 && nBits == 3 && (atBit == 5 || atBit == 10) && uncertainBit1 == NO_UNCERTAIN_BIT)
+    {
+        // 4-th or 8-th bit same as Manchester bit? Then mark that bit position as candidate for
+        // later repair by the CheckCrcAndRepair(...) method.
+        uncertainBit1 = bitPosition;  // Position 1 = MSB, bit 8 = LSB
+    } // if
+
+    if (flipBits != 0)
+    {
+        readBits ^= flipBits;
+
+        if (nBits > 1 && uncertainBit1 == NO_UNCERTAIN_BIT)
+        {
+            // The last bit is very uncertain: mark the bit position as candidate for later repair by the
+            // CheckCrcAndRepair(...) method
+            uncertainBit1 = bitPosition;  // Position 1 = MSB, bit 8 = LSB
+
+            // Note: the one-but-last bit is also very uncertain, but for now we mark only the last bit.
+            // In a later version, more than one "uncertain bit" marking may be implemented.
+        } // if
+    } // if
+
+  #ifndef VAN_RX_ADAPTIVE_BIT_TIMING
+    if (fromState == VAN_RX_SEARCHING)
+    {
+        // The bit timing is slightly different during SOF: apply alternative jitter calculations
+        if (nBits == 3)
+        {
+            // Decrease jitter value by 168, but don't go below 0
+            if (jitter > CPU_CYCLES(168)) jitter = jitter - CPU_CYCLES(168); else jitter = 0;
+        }
+        else if (atBit == 4)
+        {
+            if (nBits == 4)
+            {
+                // Timing seems to be around 2590 for the first 4-bit sequence ("----") during SOF
+                // (normally it is around 2639)
+                if (nCycles > CPU_CYCLES(2624)) jitter = nCycles - CPU_CYCLES(2624); else jitter = 0;
+            }
+        }
+        else if (atBit == 7/* || atBit == 8*/)
+        {
+            if (nBits == 1)
+            {
+                // Decrease jitter value by 130, but don't go below 0
+                if (jitter > CPU_CYCLES(130)) jitter = jitter - CPU_CYCLES(130); else jitter = 0;
+            }
+            else if (nBits == 2)
+            {
+                // Decrease jitter value by 168, but don't go below 0
+                if (jitter > CPU_CYCLES(168)) jitter = jitter - CPU_CYCLES(168); else jitter = 0;
+            }
+            else if (nBits == 4)
+            {
+                // Timing seems to be around 2530 for the second 4-bit sequence ("1111") during SOF
+                // (normally it is around 2639)
+                if (nCycles > CPU_CYCLES(2514)) jitter = nCycles - CPU_CYCLES(2514); else jitter = 0;
+            } // if
+        } // if
+    } // if
+  #endif // VAN_RX_ADAPTIVE_BIT_TIMING
+
+    if (fromState == VAN_RX_SEARCHING)
+    {
+        // Be flexible in SOF detection. All cases were found by trial and error.
+        if ((atBit == 6 || atBit == 7 || atBit == 8) && (readBits & 0x00F) == 0x00D)  // e.g. 11 11-1, --- 11-1, -11 11-1, ---1 11-1, --11 11-1, ---- 11-1
+        {
+            atBit = 10;
+        }
+        else if ((atBit == 8 || atBit == 9) && (readBits & 0x00E) == 0x00A)  // e.g. -11 11-1 1, --11 11-1 1
+        {
+            atBit = 11;
+        }
+        else if (atBit == 9 && (readBits & 0x003) == 0x001)  // e.g. - --11 11-1, - ---- ---1, - ---- -1-1
+        {
+            atBit = 10;
+        }
+        else if (atBit == 10 && (readBits & 0x006) == 0x002) // e.g. - --11 11-1 -, - --11 11-1 1, - ---- -1-1 1
+        {
+            atBit = 11;
+        } // if
+        else if (atBit == 12 && (readBits & 0x018) == 0x008) // e.g. - ---- 11-1 111
+        {
+            atBit = 13;
+        } // if
+        else if (atBit == 13 && readBits == 0x1FF) // e.g. - ---1 1111 1111
+        {
+            // This is not a SOF pattern
+            readBits = 0x000; // Force to state VAN_RX_VACANT, below
+        } // if
+        else if (atBit == 14 && readBits == 0x3FF) // e.g. -- --11 1111 1111
+        {
+            // This is not a SOF pattern
+            readBits = 0x000; // Force to state VAN_RX_VACANT, below
+        } // if
+    } // if
+
+    DEBUG_EDGE(readBits, readBits);
+
+    if (atBit >= 10)
+    {
+        atBit -= 10;
+
+        // uint16_t, not uint8_t: we are reading 10 bits per byte ("Enhanced Manchester" encoding)
+        uint16_t currentByte = readBits >> atBit;
+
+        // Get ready for next byte
+        readBits &= (1 << atBit) - 1;
+
+        if (fromState == VAN_RX_SEARCHING)
+        {
+            // Ideally, the first 10 bits are 00 0011 1101 (0x03D) (SOF, Start Of Frame)
+            if (currentByte != 0x03D
+
+                // Accept also (found through trial and error):
+                && currentByte != 0x009 // 00 0000 1001
+                && currentByte != 0x01D // 00 0001 1101
+                && currentByte != 0x039 // 00 0011 1001
+                && currentByte != 0x03E // 00 0011 1110
+                && currentByte != 0x019 // 00 0001 1001
+                && currentByte != 0x03B // 00 0011 1011
+                && currentByte != 0x03C // 00 0011 1100
+                && currentByte != 0x01E // 00 0001 1110
+                && currentByte != 0x00D // 00 0000 1101
+                && currentByte != 0x005 // 00 0000 0101
+                && currentByte != 0x001 // 00 0000 0001
+                && currentByte != 0x03F // 00 0011 1111
+                && currentByte != 0x3FD // 11 1111 1101
+                && currentByte != 0x079 // 00 0111 1001
+                && currentByte != 0x07D // 00 0111 1101
+               )
+            {
+                state = VAN_RX_VACANT;
+
+                jitter = 0;
+
+                return events;
+            } // if
+
+          #ifdef VAN_RX_ADAPTIVE_BIT_TIMING
+            // Not the ideal SOF pattern? Then the number of bits since the start of the SOF is uncertain: measure the
+            // bit time of this packet from here on.
+            if (currentByte != 0x03D)
+            {
+                bitTimeFromAt = curr;
+                bitTimeNBits = 0;
+            } // if
+          #endif // VAN_RX_ADAPTIVE_BIT_TIMING
+
+            currentByte = 0x03D;
+
+            state = VAN_RX_LOADING;
+        } // if
+
+      #ifdef VAN_RX_ADAPTIVE_BIT_TIMING
+        if (bitTimeNBits > 0)
+        {
+            // Measure the bit time over the packet so far. To prevent a single late level change from throwing the
+            // measurement off, the bit time of the previous packets also weighs in.
+            const uint32_t measured =
+                (((curr - bitTimeFromAt) << VAN_BIT_TIME_FRAC_BITS)  // Arithmetic has safe roll-over
+                    + busBitTime * VAN_BIT_TIME_PRIOR_BITS)
+                / (bitTimeNBits + VAN_BIT_TIME_PRIOR_BITS);
+
+            if (measured > VAN_MIN_BIT_TIME && measured < VAN_MAX_BIT_TIME) bitTime = measured;
+        } // if
+      #endif // VAN_RX_ADAPTIVE_BIT_TIMING
+
+        // Remove the 2 Manchester bits 'm'; the relevant 8 bits are 'X':
+        //   9 8 7 6 5 4 3 2 1 0
+        //   X X X X m X X X X m
+        uint8_t readByte = (currentByte >> 2 & 0xF0) | (currentByte >> 1 & 0x0F);
+
+        // No room for another byte? This can happen if the bus goes on after a presumed EOD at the maximum packet
+        // size (see state VAN_RX_WAITING_ACK above).
+        if (size >= VAN_MAX_PACKET_SIZE)
+        {
+            result = VAN_RX_ERROR_MAX_PACKET;
+            jitter = 0;
+
+            state = VAN_RX_DONE;
+            return events | VAN_RX_EV_PACKET;
+        } // if
+
+        bytes[size++] = readByte;
+
+        // IDEN complete? Then the caller may e.g. apply an acceptance filter.
+        if (size == 3) events |= VAN_RX_EV_HEADER;
+
+        // EOD detected if last two bits are 0 followed by a 1, but never in bytes 0...4
+        if ((currentByte & 0x003) == 0 && atBit == 0 && size >= 5
+
+            // Experiment for 3 last "0"-bits: too short means it is not EOD
+          #ifdef VAN_RX_ADAPTIVE_BIT_TIMING
+            && (nBits != 3 || nCycles > BitTimes32(94)))
+          #else // ! VAN_RX_ADAPTIVE_BIT_TIMING
+            && (nBits != 3 || nCycles > CPU_CYCLES(1963)))
+          #endif // VAN_RX_ADAPTIVE_BIT_TIMING
+        {
+            state = VAN_RX_WAITING_ACK;
+
+          #ifdef VAN_RX_ADAPTIVE_BIT_TIMING
+            // Complete packet: let its bit time weigh in to seed the next packet
+            busBitTime = (busBitTime * 3 + bitTime) >> 2;
+          #endif // VAN_RX_ADAPTIVE_BIT_TIMING
+
+            // Set a timeout for the ACK bit
+            events |= VAN_RX_EV_ARM_ACK_TIMER;
+        }
+        else if (size >= VAN_MAX_PACKET_SIZE)
+        {
+            result = VAN_RX_ERROR_MAX_PACKET;
+            jitter = 0;
+
+            state = VAN_RX_DONE;
+            events |= VAN_RX_EV_PACKET;
+        } // if
+    } // if
+
+    return events;
+} // TVanRxDecoder::Decode
+
+#endif // VanBusRxDecoder_h
@@ -3,7 +3,7 @@
  *
  * Written by Erik Tromp
  *
- * Version 0.4.1 - September, 2024
+ * Version 0.4.2 - October, 2026
  *
  * MIT license, all text above must be included in any redistribution.
  */
@@ -18,64 +18,518 @@
   #define VAN_BIT_TIMER_TICKS (8 * 5 + 1)
 #endif // ARDUINO_ARCH_ESP32
 
+// Manchester-stuffed representation of each byte value: after each 4 bits, the inverse of the last bit is
+// inserted. Generated by: (byte & 0xF0) << 2 | (~ byte & 0x10) << 1 | (byte & 0x0F) << 1 | (~ byte & 0x01)
+#define VAN_MANCHESTER_TABLE_SIZE 256
+static const uint16_t manchesterTable[VAN_MANCHESTER_TABLE_SIZE] =
+{
+    0x021, 0x022, 0x025, 0x026, 0x029, 0x02A, 0x02D, 0x02E, 0x031, 0x032, 0x035, 0x036, 0x039, 0x03A, 0x03D, 0x03E,
+    0x041, 0x042, 0x045, 0x046, 0x049, 0x04A, 0x04D, 0x04E, 0x051, 0x052, 0x055, 0x056, 0x059, 0x05A, 0x05D, 0x05E,
+    0x0A1, 0x0A2, 0x0A5, 0x0A6, 0x0A9, 0x0AA, 0x0AD, 0x0AE, 0x0B1, 0x0B2, 0x0B5, 0x0B6, 0x0B9, 0x0BA, 0x0BD, 0x0BE,
+    0x0C1, 0x0C2, 0x0C5, 0x0C6, 0x0C9, 0x0CA, 0x0CD, 0x0CE, 0x0D1, 0x0D2, 0x0D5, 0x0D6, 0x0D9, 0x0DA, 0x0DD, 0x0DE,
+    0x121, 0x122, 0x125, 0x126, 0x129, 0x12A, 0x12D, 0x12E, 0x131, 0x132, 0x135, 0x136, 0x139, 0x13A, 0x13D, 0x13E,
+    0x141, 0x142, 0x145, 0x146, 0x149, 0x14A, 0x14D, 0x14E, 0x151, 0x152, 0x155, 0x156, 0x159, 0x15A, 0x15D, 0x15E,
+    0x1A1, 0x1A2, 0x1A5, 0x1A6, 0x1A9, 0x1AA, 0x1AD, 0x1AE, 0x1B1, 0x1B2, 0x1B5, 0x1B6, 0x1B9, 0x1BA, 0x1BD, 0x1BE,
+    0x1C1, 0x1C2, 0x1C5, 0x1C6, 0x1C9, 0x1CA, 0x1CD, 0x1CE, 0x1D1, 0x1D2, 0x1D5, 0x1D6, 0x1D9, 0x1DA, 0x1DD, 0x1DE,
+    0x221, 0x222, 0x225, 0x226, 0x229, 0x22A, 0x22D, 0x22E, 0x231, 0x232, 0x235, 0x236, 0x239, 0x23A, 0x23D, 0x23E,
+    0x241, 0x242, 0x245, 0x246, 0x249, 0x24A, 0x24D, 0x24E, 0x251, 0x252, 0x255, 0x256, 0x259, 0x25A, 0x25D, 0x25E,
+    0x2A1, 0x2A2, 0x2A5, 0x2A6, 0x2A9, 0x2AA, 0x2AD, 0x2AE, 0x2B1, 0x2B2, 0x2B5, 0x2B6, 0x2B9, 0x2BA, 0x2BD, 0x2BE,
+    0x2C1, 0x2C2, 0x2C5, 0x2C6, 0x2C9, 0x2CA, 0x2CD, 0x2CE, 0x2D1, 0x2D2, 0x2D5, 0x2D6, 0x2D9, 0x2DA, 0x2DD, 0x2DE,
+    0x321, 0x322, 0x325, 0x326, 0x329, 0x32A, 0x32D, 0x32E, 0x331, 0x332, 0x335, 0x336, 0x339, 0x33A, 0x33D, 0x33E,
+    0x341, 0x342, 0x345, 0x346, 0x349, 0x34A, 0x34D, 0x34E, 0x351, 0x352, 0x355, 0x356, 0x359, 0x35A, 0x35D, 0x35E,
+    0x3A1, 0x3A2, 0x3A5, 0x3A6, 0x3A9, 0x3AA, 0x3AD, 0x3AE, 0x3B1, 0x3B2, 0x3B5, 0x3B6, 0x3B9, 0x3BA, 0x3BD, 0x3BE,
+    0x3C1, 0x3C2, 0x3C5, 0x3C6, 0x3C9, 0x3CA, 0x3CD, 0x3CE, 0x3D1, 0x3D2, 0x3D5, 0x3D6, 0x3D9, 0x3DA, 0x3DD, 0x3DE,
+};
+
+// Stuff the CRC bytes, then add the EOD, ACK and EOF bits
+static void StuffCrcAndEof(uint16_t stuffedBytes[], const uint8_t bytes[], size_t dataLen)
+{
+    stuffedBytes[dataLen + 3] = manchesterTable[bytes[dataLen + 3]];
+
+    // The last bit is always 0 (CRC has been shifted left 1 bit), and the last Manchester bit is also always 0,
+    // to indicate EOD
+    stuffedBytes[dataLen + 4] = manchesterTable[bytes[dataLen + 4]] & 0xFFFC;
+
+    // End with 10 VAN_LOGICAL_HIGH-bits: 2 bits for the (optional) ACK, then 8 bits for EOF
+    stuffedBytes[dataLen + 5] = 0xFFFF;
+} // StuffCrcAndEof
+
+// Nothing (more) to send: stop the bit timer
+void IRAM_ATTR TVanPacketTxQueue::StopBitSendTimer()
+{
+    VanBusRx.RegisterTxIsr(NULL);
+
+  #ifdef ARDUINO_ARCH_ESP32
+    timerAlarmDisable(timer);
+  #else // ! ARDUINO_ARCH_ESP32
+    timer1_disable();
+  #endif // ARDUINO_ARCH_ESP32
+} // TVanPacketTxQueue::StopBitSendTimer
+
+// Random number for the retry backoff. Seeded by the CPU cycle counter, so each device on the bus has its own
+// sequence.
+static uint32_t IRAM_ATTR BackoffRandom()
+{
+    static uint32_t state = 0;
+    if (state == 0) state = ESP.getCycleCount() | 1;
+
+    // Xorshift
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+} // BackoffRandom
+
+// Random number of bit times to wait, on top of the inter-frame space, before the next attempt. The range of the
+// backoff doubles with each attempt, so that two devices retrying at the same time soon end up out of step.
+static unsigned int IRAM_ATTR BackoffBits(int attempt)
+{
+    unsigned int range = VAN_TX_BACKOFF_BITS;
+    for (int i = 1; i < attempt && range < VAN_TX_MAX_BACKOFF_BITS; i++) range <<= 1;
+    if (range > VAN_TX_MAX_BACKOFF_BITS) range = VAN_TX_MAX_BACKOFF_BITS;
+    return BackoffRandom() % range;
+} // BackoffBits
+
+// Reliable send: put the packet back for another attempt, after a random backoff
+void IRAM_ATTR RetryPacketTransmission(TVanPacketTxDesc* txDesc)
+{
+    ++VanBusTx.nRetries;
+    txDesc->nRetries++;
+
+    txDesc->backoffBits = BackoffBits(txDesc->nRetries);
+
+    // The outcome of the next attempt counts
+    txDesc->bitError = false;
+    txDesc->bitOk = false;
+    txDesc->ackSeen = false;
+
+    // Back in the queue. During the backoff, a more urgent packet may be sent first.
+    txDesc->state = VAN_TX_WAITING;
+} // RetryPacketTransmission
+
+#ifdef VAN_TX_ESP32_RMT
+
+static volatile bool rmtTxStarted;  // Set by 'RmtTxTask' as soon as the RMT peripheral is shifting out the packet
+
+// The RMT driver functions (and 'attachInterrupt', 'detachInterrupt') are not in IRAM, so they must not be called
+// from an ISR: the ISRs are in IRAM because they must keep running while the flash cache is disabled, e.g. during
+// SPIFFS or NVS writes. The ISRs hand these calls over to 'RmtTxTask' instead, by a task notification.
+#define VAN_TX_RMT_NOTIFY_STOP 0x01  // Stop transmitting (if still busy), and stop checking for collisions
+#define VAN_TX_RMT_NOTIFY_START 0x02  // Start transmitting 'rmtTxItems'
+static TaskHandle_t rmtTxTask = NULL;
+static volatile int rmtTxNItems;
+
+static void IRAM_ATTR NotifyRmtTxTask(uint32_t what)
+{
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    xTaskNotifyFromISR(rmtTxTask, what, eSetBits, &higherPriorityTaskWoken);
+    if (higherPriorityTaskWoken) portYIELD_FROM_ISR();
+} // NotifyRmtTxTask
+
+#endif // VAN_TX_ESP32_RMT
+
+#ifdef ARDUINO_ARCH_ESP32
+
+// Given each time a packet leaves the transmit queue, so that 'WaitForHeadAvailable' and 'WaitForPacketDone' can
+// block instead of polling
+static SemaphoreHandle_t txDoneSemaphore = NULL;
+
+#endif // ARDUINO_ARCH_ESP32
+
+// Wakes up a task waiting for a packet to leave the transmit queue. Only to be called from ISR.
+static inline void IRAM_ATTR SignalTxDone()
+{
+  #ifdef ARDUINO_ARCH_ESP32
+    if (txDoneSemaphore == NULL) return;
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    xSemaphoreGiveFromISR(txDoneSemaphore, &higherPriorityTaskWoken);
+    if (higherPriorityTaskWoken) portYIELD_FROM_ISR();
+  #endif // ARDUINO_ARCH_ESP32
+} // SignalTxDone
+
 // Finish packet transmission
 void IRAM_ATTR FinishPacketTransmission(TVanPacketTxDesc* txDesc)
 {
-    // Save statistics
-    if (txDesc->nCollisions != 0)
+    const bool gaveUp = txDesc->nCollisions >= VAN_TX_MAX_COLLISIONS;
+
+    if (! gaveUp && txDesc->IsUndelivered() && txDesc->nRetries < txDesc->maxRetries)
     {
-        if (txDesc->nCollisions == 1) ++VanBusTx.nSingleCollisions; else ++VanBusTx.nMultipleCollisions;
-    } // if
+        // The bit timer keeps running; the next time it goes off, 'SendBitIsr' arms it for the end of the backoff
+        RetryPacketTransmission(txDesc);
+    }
+    else
+    {
+        // Save statistics
+        if (txDesc->nCollisions != 0)
+        {
+            if (txDesc->nCollisions == 1) ++VanBusTx.nSingleCollisions; else ++VanBusTx.nMultipleCollisions;
+        } // if
 
-    VanBusTx._AdvanceTail();
+        const bool undelivered = ! gaveUp && txDesc->IsUndelivered();
+        if (undelivered) ++VanBusTx.nUndelivered;
 
-    // Nothing more to send?
-    if (VanBusTx._tail->state == VAN_TX_DONE)
-    {
-        VanBusRx.RegisterTxIsr(NULL);
+        VanBusTx._SetResult(txDesc, gaveUp || undelivered ? VAN_TX_FAILED : VAN_TX_DELIVERED);
 
-      #ifdef ARDUINO_ARCH_ESP32
-        timerAlarmDisable(timer);
-      #else // ! ARDUINO_ARCH_ESP32
-        timer1_disable();
-      #endif // ARDUINO_ARCH_ESP32
+        VanBusTx._AdvanceTail();
+        SignalTxDone();
 
-    } // if 
+        // Nothing more to send?
+        if (VanBusTx._tail->state == VAN_TX_DONE) TVanPacketTxQueue::StopBitSendTimer();
+    } // if
 
     VanBusRx.SetLastMediaAccessAt(ESP.getCycleCount()); // It was me! :-)
 
+  #if defined VAN_TX_ESP32_RMT
+    // Stop checking for collisions ('detachInterrupt' is not allowed in an ISR; see VAN_TX_RMT_NOTIFY_START)
+    rmtTxStarted = false;
+    NotifyRmtTxTask(VAN_TX_RMT_NOTIFY_STOP);
+  #elif ! defined VAN_RX_ESP32_RMT
     // Start listening again at other devices on the bus
-    attachInterrupt(digitalPinToInterrupt(VanBusRx.pin), RxPinChangeIsr, CHANGE);
+    VanBusRx.AttachPinIsr();
+  #endif // VAN_TX_ESP32_RMT
 } // 
 
+#ifdef VAN_TX_ESP32_RMT
+
+// The RMT clock is divided down to the same tick as the bit timer, so each bit takes VAN_BIT_TIMER_TICKS
+#define VAN_TX_RMT_CLK_DIV 16
+#define VAN_TX_RMT_MAX_ITEMS (VAN_TX_RMT_MEM_BLOCKS * 64)
+
+#define VAN_TX_BIT_CPU_CYCLES (VAN_BIT_TIMER_TICKS * 16 * CPU_F_FACTOR)
+
+// The bus level is compared with the transmitted bits at the middle of each bit: the own level changes are seen on
+// the receive pin only after the transceiver loop delay plus the interrupt latency. Up to half a bit time of delay
+// is tolerated.
+#define VAN_TX_HALF_BIT_CPU_CYCLES (VAN_TX_BIT_CPU_CYCLES / 2)
+
+static rmt_item32_t rmtTxItems[VAN_TX_RMT_MAX_ITEMS];
+
+// Collision detection state
+static uint32_t txStartedAt;
+static uint32_t txPrevEdgeAt;
+static int txPrevLevel;
+
+// Encodes a stuffed packet into RMT items, one level plus duration for each run of equal bits. Returns the number
+// of items, including the end marker.
+int IRAM_ATTR EncodeRmtItems(const TVanPacketTxDesc* txDesc)
+{
+    const int nBits = txDesc->size * 10;
+    rmt_item32_t* item = rmtTxItems;
+    bool secondHalf = false;
+
+    int bitNo = 0;
+    while (bitNo < nBits)
+    {
+        const uint16_t level = txDesc->StuffedBit(bitNo);
+        int runLength = 1;
+        while (bitNo + runLength < nBits && txDesc->StuffedBit(bitNo + runLength) == level) runLength++;
+        bitNo += runLength;
+
+        if (secondHalf)
+        {
+            item->level1 = level;
+            item->duration1 = runLength * VAN_BIT_TIMER_TICKS;
+            item++;
+        }
+        else
+        {
+            item->level0 = level;
+            item->duration0 = runLength * VAN_BIT_TIMER_TICKS;
+        } // if
+        secondHalf = ! secondHalf;
+    } // while
+
+    // A zero duration marks the end of the transmission. The output then returns to the idle (recessive) level.
+    if (secondHalf)
+    {
+        item->level1 = 1;
+        item->duration1 = 0;
+    }
+    else
+    {
+        item->val = 0;
+    } // if
+
+    return item - rmtTxItems + 1;
+} // EncodeRmtItems
+
+#ifdef VAN_RX_ESP32_RMT
+// Only attached during transmission: without VAN_RX_ESP32_RMT, 'RxPinChangeIsr' does the check
+void IRAM_ATTR TxRmtEdgeIsr()
+{
+    const int pinLevel = digitalRead(VanBusRx.pin);
+    TxRmtCheckEdge(ESP.getCycleCount(), pinLevel);
+} // TxRmtEdgeIsr
+#endif // VAN_RX_ESP32_RMT
+
+// Hand over a packet to the RMT peripheral. The transmission is started by 'RmtTxTask'.
+void IRAM_ATTR StartRmtTransmission(TVanPacketTxDesc* txDesc)
+{
+    // The bit timer is not needed while the RMT peripheral is transmitting
+    VanBusRx.RegisterTxIsr(NULL);
+    timerAlarmDisable(timer);
+
+    rmtTxNItems = EncodeRmtItems(txDesc);
+
+    txDesc->state = VAN_TX_SENDING;
+    txPrevLevel = VAN_BIT_RECESSIVE;
+    rmtTxStarted = false;
+
+    NotifyRmtTxTask(VAN_TX_RMT_NOTIFY_START);
+} // StartRmtTransmission
+
+// Task that calls the RMT driver on behalf of the ISRs (see VAN_TX_RMT_NOTIFY_START). Runs at the highest priority,
+// so it is scheduled right after the ISR that notified it.
+void RmtTxTask(void* param)
+{
+    (void)param;
+
+    for (;;)
+    {
+        uint32_t what = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &what, portMAX_DELAY);
+
+        // A stop request is always about an earlier transmission than a start request, so handle that first
+        if (what & VAN_TX_RMT_NOTIFY_STOP)
+        {
+            rmt_tx_stop(VAN_TX_RMT_CHANNEL);  // Output returns to the idle (recessive) level
+
+          #ifdef VAN_RX_ESP32_RMT
+            detachInterrupt(digitalPinToInterrupt(VanBusRx.pin));
+          #endif // VAN_RX_ESP32_RMT
+        } // if
+
+        if (what & VAN_TX_RMT_NOTIFY_START)
+        {
+            rmt_fill_tx_items(VAN_TX_RMT_CHANNEL, rmtTxItems, rmtTxNItems, 0);
+
+          #ifdef VAN_RX_ESP32_RMT
+            attachInterrupt(digitalPinToInterrupt(VanBusRx.pin), TxRmtEdgeIsr, CHANGE);
+          #endif // VAN_RX_ESP32_RMT
+
+            NO_INTERRUPTS;
+            rmt_tx_start(VAN_TX_RMT_CHANNEL, true);
+            txStartedAt = ESP.getCycleCount();
+            txPrevEdgeAt = txStartedAt;
+            VanBusTx._tail->sofAt = txStartedAt;
+            rmtTxStarted = true;
+            INTERRUPTS;
+        } // if
+    } // for
+} // RmtTxTask
+
+// Called on each level change of the receive pin. The bus level since the previous level change is compared with
+// the bits that were transmitted in that period. If the bus was dominant during a recessive bit, another device
+// has won the arbitration: stop transmitting and try again later.
+void IRAM_ATTR TxRmtCheckEdge(uint32_t curr, int pinLevel)
+{
+    TVanPacketTxDesc* txDesc = VanBusTx._tail;
+    if (txDesc->state != VAN_TX_SENDING || ! rmtTxStarted) return;
+
+    NO_INTERRUPTS;
+
+    const int busLevel = txPrevLevel;
+    const int32_t fromAt = (int32_t)(txPrevEdgeAt - txStartedAt) + VAN_TX_HALF_BIT_CPU_CYCLES;
+    const int32_t toAt = (int32_t)(curr - txStartedAt) - VAN_TX_HALF_BIT_CPU_CYCLES;
+    txPrevEdgeAt = curr;
+    txPrevLevel = pinLevel;
+
+    // Check for collisions until (but not including) the EOD. Otherwise we will see an ACK bit from the receiver as
+    // a collision. Then check the 2 ACK bits.
+    const int eodBit = txDesc->eodAt * 10;
+    int toBit = toAt / (int32_t)VAN_TX_BIT_CPU_CYCLES;
+    if (toBit > eodBit + 1) toBit = eodBit + 1;
+
+    for (int bitNo = fromAt / (int32_t)VAN_TX_BIT_CPU_CYCLES; toAt >= 0 && bitNo <= toBit; bitNo++)
+    {
+        if (bitNo >= eodBit)
+        {
+            if (busLevel == VAN_BIT_DOMINANT) txDesc->ackSeen = true;
+            continue;
+        } // if
+
+        const int sentLevel = txDesc->StuffedBit(bitNo) ? VAN_BIT_RECESSIVE : VAN_BIT_DOMINANT;
+
+        if (busLevel == VAN_BIT_DOMINANT && sentLevel == VAN_BIT_RECESSIVE)
+        {
+            // Have 'RmtTxTask' stop the RMT peripheral. Until then, the RMT peripheral goes on shifting out the
+            // packet: typically for less than one bit time.
+            rmtTxStarted = false;
+            NotifyRmtTxTask(VAN_TX_RMT_NOTIFY_STOP);
+
+            if (txDesc->nCollisions == 0) txDesc->firstCollisionAtBit = bitNo;
+            txDesc->nCollisions++;
+
+            if (txDesc->nCollisions >= VAN_TX_MAX_COLLISIONS)
+            {
+                // Give up on this packet
+                ++VanBusTx.nMaxCollisionErrors;
+                FinishPacketTransmission(txDesc);
+            }
+            else
+            {
+                // Backout and start all over again. The RMT receiver (or the pin interrupt) keeps listening, so the
+                // frame of the winner keeps pushing the carrier sense forward.
+                VanBusRx.SetLastMediaAccessAt(curr);
+                txDesc->backoffBits = BackoffBits(txDesc->nCollisions);
+                txDesc->state = VAN_TX_WAITING;
+            } // if
+
+            INTERRUPTS;
+
+            if (VanBusTx._tail->state == VAN_TX_WAITING) TVanPacketTxQueue::StartBitSendTimer();
+            return;
+        } // if
+
+        if (busLevel == VAN_BIT_RECESSIVE && sentLevel == VAN_BIT_DOMINANT) txDesc->bitError = true;
+        else txDesc->bitOk = true;
+    } // for
+
+    INTERRUPTS;
+} // TxRmtCheckEdge
+
+// Called by the RMT driver when the complete packet has been shifted out
+void IRAM_ATTR RmtTxEndCallback(rmt_channel_t channel, void* arg)
+{
+    (void)arg;
+    if (channel != VAN_TX_RMT_CHANNEL) return;
+
+    NO_INTERRUPTS;
+
+    // Not if the transmission was stopped because of a collision
+    TVanPacketTxDesc* txDesc = VanBusTx._tail;
+    if (txDesc->state != VAN_TX_SENDING)
+    {
+        INTERRUPTS;
+        return;
+    } // if
+
+    FinishPacketTransmission(txDesc);
+
+    INTERRUPTS;
+
+    // Next packet waiting? Then start the bit timer to wait for the bus to become idle.
+    if (VanBusTx._tail->state == VAN_TX_WAITING) TVanPacketTxQueue::StartBitSendTimer();
+} // RmtTxEndCallback
+
+// Sets up the RMT peripheral to transmit on 'txPin', and starts 'RmtTxTask' on core 'isrCore'. Note: the RMT
+// interrupt is serviced by the core that first installs an RMT driver.
+static bool SetupRmtTx(uint8_t txPin, int isrCore)
+{
+    rmt_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.rmt_mode = RMT_MODE_TX;
+    config.channel = VAN_TX_RMT_CHANNEL;
+    config.gpio_num = (gpio_num_t)txPin;
+    config.clk_div = VAN_TX_RMT_CLK_DIV;
+    config.mem_block_num = VAN_TX_RMT_MEM_BLOCKS;
+    config.tx_config.carrier_en = false;
+    config.tx_config.idle_output_en = true;
+    config.tx_config.idle_level = RMT_IDLE_LEVEL_HIGH;  // Recessive, like 'digitalWrite(txPin, VAN_BIT_RECESSIVE)'
+
+    if (rmt_config(&config) != ESP_OK) return false;
+    if (rmt_driver_install(VAN_TX_RMT_CHANNEL, 0, 0) != ESP_OK) return false;
+
+    rmt_register_tx_end_callback(RmtTxEndCallback, NULL);
+
+    const int core = isrCore == VAN_ISR_CORE_CALLER ? xPortGetCoreID() : isrCore;
+    if (xTaskCreatePinnedToCore(RmtTxTask, "VanBusTx", 2048, NULL, configMAX_PRIORITIES - 1, &rmtTxTask, core)
+        != pdPASS)
+    {
+        rmt_driver_uninstall(VAN_TX_RMT_CHANNEL);
+        return false;
+    } // if
+
+    return true;
+} // SetupRmtTx
+
+// Undoes a successful 'SetupRmtTx'
+static void AbortRmtTx()
+{
+    if (rmtTxTask != NULL)
+    {
+        vTaskDelete(rmtTxTask);
+        rmtTxTask = NULL;
+    } // if
+
+    rmt_driver_uninstall(VAN_TX_RMT_CHANNEL);
+} // AbortRmtTx
+
+#endif // VAN_TX_ESP32_RMT
+
 // Send one bit on the VAN bus
 void IRAM_ATTR SendBitIsr()
 {
     uint32_t curr = ESP.getCycleCount();  // Store CPU cycle counter value as soon as possible
 
+    PROFILE_ISR(VanBusTx.sendBitIsrProfile, curr, &mux);
+
     static unsigned int atBit = 9;
 
     static uint16_t* p_stuffedByte;
 
     TVanPacketTxDesc* txDesc = VanBusTx._tail;
 
-    //if (txDesc->state == VAN_TX_DONE) return;
+    if (txDesc->state != VAN_TX_SENDING)
+    {
+        // A more urgent packet may have been queued, or a deadline may have passed, since the timer was armed
+        if (! VanBusTx._SelectNext())
+        {
+            TVanPacketTxQueue::StopBitSendTimer();
+            return;
+        } // if
+
+        txDesc = VanBusTx._tail;
+    } // if
 
     if (txDesc->state == VAN_TX_WAITING)
     {
-        // Wait at least 8 (EOF) + 4 (IFS) bits after last media access
+        // Wait at least 8 (EOF) + 5 (IFS) bits after last media access. Before a retry (reliable send), wait the
+        // backoff time on top of that. Any other packet on the bus in the mean time starts the wait all over again.
         uint32_t nCycles = curr - VanBusRx.GetLastMediaAccessAt();  // Arithmetic has safe roll-over
-        if (nCycles < (8 /* EOF */ + 5 /* IFS */) * (VAN_BIT_TIMER_TICKS * 16) * CPU_F_FACTOR)
+        const unsigned int idleBits = VAN_CARRIER_SENSE_BITS + txDesc->backoffBits;
+        if (nCycles < idleBits * (VAN_BIT_TIMER_TICKS * 16) * CPU_F_FACTOR)
         {
-            txDesc->busOccupied = true;
+            if (nCycles < VAN_CARRIER_SENSE_BITS * (VAN_BIT_TIMER_TICKS * 16) * CPU_F_FACTOR)
+            {
+                txDesc->busOccupied = true;
+            } // if
+
+            // Try again as soon as the bus has been idle long enough after this media access
+            ArmTxTimer(idleBits);
             return;
         } // if
 
+        txDesc->backoffBits = 0;
+
+      #ifdef VAN_TX_ESP32_RMT
+        // The RMT peripheral shifts out the complete packet; the receiver just keeps listening
+        txDesc->interFrameCpuCycles = nCycles;
+        StartRmtTransmission(txDesc);
+        return;
+      #endif // VAN_TX_ESP32_RMT
+
+        // Start sending: from now on, one bit each timer interrupt
+
+      #ifdef ARDUINO_ARCH_ESP32
+        timerWrite(timer, 0);
+        timerAlarmWrite(timer, VAN_BIT_TIMER_TICKS, true);
+        timerAlarmEnable(timer);
+      #else // ! ARDUINO_ARCH_ESP32
+        timer1_enable(TIM_DIV16, TIM_EDGE, TIM_LOOP);
+        timer1_write(VAN_BIT_TIMER_TICKS);
+      #endif // ARDUINO_ARCH_ESP32
+
         // Don't waste precious CPU time handling the RX pin interrupts of my own transmission.
         // TODO - this will cause any colliding incoming packet to be not received by the receiver.
-        detachInterrupt(digitalPinToInterrupt(VanBusRx.pin));
+        // Note: the RMT receiver costs no CPU time per bit, so that one just keeps listening, also to my own
+        // transmission.
+      #ifndef VAN_RX_ESP32_RMT
+        VanBusRx.DetachPinIsr();
+      #endif // VAN_RX_ESP32_RMT
 
         txDesc->interFrameCpuCycles = nCycles;
+        txDesc->sofAt = curr;
         txDesc->state = VAN_TX_SENDING;
         atBit = 9;
         p_stuffedByte = txDesc->stuffedBytes;
@@ -101,13 +555,48 @@ void IRAM_ATTR SendBitIsr()
             if (txDesc->nCollisions == 0) txDesc->firstCollisionAtBit = atByte * 10 + (9 - atBit);
             txDesc->nCollisions++;
 
-            // Backout and start all over again
+            if (txDesc->nCollisions >= VAN_TX_MAX_COLLISIONS)
+            {
+                // Give up on this packet. Its last bit was recessive, so the bus is released.
+                ++VanBusTx.nMaxCollisionErrors;
+                FinishPacketTransmission(txDesc);
+                return;
+            } // if
+
+            // Backout: release the bus right away, so that the frame of the winner is not disturbed
+          #ifdef ARDUINO_ARCH_ESP32
+            REG_WRITE(GPIO_OUT_W1TS_REG, 1 << VanBusTx.txPin);
+          #else // ! ARDUINO_ARCH_ESP32
+            GPOS = (1 << VanBusTx.txPin);
+          #endif // ARDUINO_ARCH_ESP32
+            lastSetLevel = VAN_BIT_RECESSIVE;
+
+            // Listen again, so that the frame of the winner keeps pushing the carrier sense forward
+            VanBusRx.SetLastMediaAccessAt(curr);
+          #ifndef VAN_RX_ESP32_RMT
+            VanBusRx.AttachPinIsr();
+          #endif // VAN_RX_ESP32_RMT
+
+            // Start all over again, after a random backoff on top of the inter-frame space
+            txDesc->backoffBits = BackoffBits(txDesc->nCollisions);
             txDesc->state = VAN_TX_WAITING;
+            ArmTxTimer(VAN_CARRIER_SENSE_BITS + txDesc->backoffBits);
+            return;
         } // if
 
         if (pinLevel == VAN_BIT_RECESSIVE && lastSetLevel == VAN_BIT_DOMINANT) txDesc->bitError = true;
 
         if (pinLevel == lastSetLevel) txDesc->bitOk = true;
+    }
+    else if (p_stuffedByte == txDesc->p_eod && (atBit == 8 || atBit == 7))
+    {
+        // The previously transmitted bit was one of the 2 ACK bits: did a receiver pull the bus to 'dominant'?
+
+    #ifdef ARDUINO_ARCH_ESP32
+        if (digitalRead(VanBusRx.pin) == VAN_BIT_DOMINANT) txDesc->ackSeen = true;
+    #else // ! ARDUINO_ARCH_ESP32
+        if (GPIP(VanBusRx.pin) == VAN_BIT_DOMINANT) txDesc->ackSeen = true;
+    #endif // ARDUINO_ARCH_ESP32
     } // if
 
     uint16_t byte = *p_stuffedByte;
@@ -144,20 +633,202 @@ void IRAM_ATTR SendBitIsr()
     } // if
 } // SendBitIsr
 
+#if ! defined VAN_RX_ESP32_RMT && ! defined VAN_TX_ESP32_RMT
+
+// In-frame reply being transmitted
+static const uint16_t* volatile p_replyWord = NULL;  // Next stuffed byte to send; NULL when idle
+static const TVanPreparedTxPacket* volatile replyPacket = NULL;  // Reply being sent; NULL when idle
+static const uint16_t* p_replyEod;
+static unsigned int replyAtBit;
+
+// Send one bit of an in-frame reply on the VAN bus
+void IRAM_ATTR SendReplyBitIsr()
+{
+    if (p_replyWord == p_replyEod)
+    {
+        // The EOD has been sent: release the bus. The receiver ISR sees the EOD and waits for the ACK bit.
+      #ifdef ARDUINO_ARCH_ESP32
+        REG_WRITE(GPIO_OUT_W1TS_REG, 1 << VanBusTx.txPin);
+        timerAlarmDisable(timer);
+      #else // ! ARDUINO_ARCH_ESP32
+        GPOS = (1 << VanBusTx.txPin);
+        timer1_disable();
+      #endif // ARDUINO_ARCH_ESP32
+
+        p_replyWord = NULL;
+        replyPacket = NULL;
+
+        // Hand the timer back to the transmitter, if it has a packet waiting
+        if (VanBusRx.txTimerIsr != NULL) ArmTxTimer();
+        return;
+    } // if
+
+    // Write to GPIO pin
+    if (*p_replyWord & (1 << replyAtBit))
+    {
+    #ifdef ARDUINO_ARCH_ESP32
+        REG_WRITE(GPIO_OUT_W1TS_REG, 1 << VanBusTx.txPin);
+    #else // ! ARDUINO_ARCH_ESP32
+        GPOS = (1 << VanBusTx.txPin);
+    #endif // ARDUINO_ARCH_ESP32
+    }
+    else
+    {
+    #ifdef ARDUINO_ARCH_ESP32
+        REG_WRITE(GPIO_OUT_W1TC_REG, 1 << VanBusTx.txPin);
+    #else // ! ARDUINO_ARCH_ESP32
+        GPOC = (1 << VanBusTx.txPin);
+    #endif // ARDUINO_ARCH_ESP32
+    } // if
+
+    // Advance to next bit
+    if (replyAtBit-- == 0)
+    {
+        replyAtBit = 9;
+        p_replyWord++;
+    } // if
+} // SendReplyBitIsr
+
+// Called by the receiver ISR as soon as a packet header is received, while the bus is released after the COM
+// field. If an in-frame reply is registered for the header, transmission of its data starts right away.
+void IRAM_ATTR InFrameReplyIsr(uint16_t header)
+{
+    if ((header & 0x03) != 0x03) return;  // Not a read request for in-frame response (R/W and RTR flags)
+    if (p_replyWord != NULL) return;  // Busy
+
+    const TVanPreparedTxPacket* reply = NULL;
+    for (int i = 0; i < VAN_TX_MAX_IN_FRAME_REPLIES; i++)
+    {
+        const TVanPreparedTxPacket* entry = VanBusTx.inFrameReplies[i];
+        if (entry != NULL && (entry->bytes[1] << 8 | entry->bytes[2]) == header)
+        {
+            reply = entry;
+            break;
+        } // if
+    } // for
+    if (reply == NULL) return;
+
+    // Send the data and the CRC (ending with the EOD); the ACK is up to the requester
+    replyPacket = reply;
+    p_replyWord = reply->stuffedBytes + 3;
+    p_replyEod = reply->stuffedBytes + reply->dataLen + 5;
+    replyAtBit = 9;
+
+    // From now on, one bit each timer interrupt. The timer is given back when the reply is done.
+
+  #ifdef ARDUINO_ARCH_ESP32
+    timerAlarmDisable(timer);
+    timerAttachInterrupt(timer, &SendReplyBitIsr, true);
+    timerWrite(timer, 0);
+    timerAlarmWrite(timer, VAN_BIT_TIMER_TICKS, true);
+    timerAlarmEnable(timer);
+  #else // ! ARDUINO_ARCH_ESP32
+    timer1_disable();
+    timer1_attachInterrupt(SendReplyBitIsr);
+    timer1_enable(TIM_DIV16, TIM_EDGE, TIM_LOOP);
+    timer1_write(VAN_BIT_TIMER_TICKS);
+  #endif // ARDUINO_ARCH_ESP32
+
+    // The first bit goes out right away
+    SendReplyBitIsr();
+
+    ++VanBusTx.nInFrameReplies;
+} // InFrameReplyIsr
+
+#endif // ! defined VAN_RX_ESP32_RMT && ! defined VAN_TX_ESP32_RMT
+
+// For 'TVanPacketRxQueue::LightSleep'
+static bool TxIsBusy()
+{
+    return VanBusTx.IsBusy();
+} // TxIsBusy
+
 // Initializes the VAN packet transmitter
-void TVanPacketTxQueue::Setup(uint8_t theRxPin, uint8_t theTxPin)
+bool TVanPacketTxQueue::Setup(uint8_t theRxPin, uint8_t theTxPin, int isrCore, int queueSize)
 {
+    if (pool != NULL) return false; // Already setup
+    if (queueSize <= 0) return false;
+
     txPin = theTxPin;
 
+    size = queueSize;
+    pool = new TVanPacketTxDesc[queueSize];
+    _head = pool;
+    _tail = pool;
+    end = pool + queueSize;
+
+    nResults = 2 * queueSize;
+    results = new TVanPacketTxResult[nResults];
+    for (int i = 0; i < nResults; i++) results[i].result = VAN_TX_UNKNOWN;
+
+  #ifdef ARDUINO_ARCH_ESP32
+    // Kept when 'Setup' is aborted, for a next try
+    if (txDoneSemaphore == NULL) txDoneSemaphore = xSemaphoreCreateBinary();
+  #endif // ARDUINO_ARCH_ESP32
+
+  #ifdef VAN_TX_ESP32_RMT
+    if (! SetupRmtTx(theTxPin, isrCore)) return AbortSetup();
+  #else // ! VAN_TX_ESP32_RMT
     pinMode(theTxPin, OUTPUT);
     digitalWrite(theTxPin, VAN_BIT_RECESSIVE);  // Set bus state to 'recessive' (CANH and CANL: not driven)
+  #endif // VAN_TX_ESP32_RMT
+
+    if (! VanBusRx.Setup(theRxPin, VAN_DEFAULT_RX_QUEUE_SIZE, isrCore))
+    {
+      #ifdef VAN_TX_ESP32_RMT
+        AbortRmtTx();
+      #endif // VAN_TX_ESP32_RMT
+        return AbortSetup();
+    } // if
 
-    VanBusRx.Setup(theRxPin);
     VanBusRx.RegisterTxTimerTicks(VAN_BIT_TIMER_TICKS);
+    VanBusRx.RegisterTxBusyCheck(TxIsBusy);
+
+    return true;
 } // TVanPacketTxQueue::Setup
 
+// Undoes what 'Setup' did so far, so that 'Setup' can be tried again. Always returns false.
+bool TVanPacketTxQueue::AbortSetup()
+{
+    delete[] pool;
+    pool = NULL;
+    _head = NULL;
+    _tail = NULL;
+    end = NULL;
+    size = 0;
+
+    delete[] results;
+    results = NULL;
+    nResults = 0;
+
+    txPin = VAN_NO_PIN_ASSIGNED;
+
+    return false;
+} // TVanPacketTxQueue::AbortSetup
+
+// Returns true while a packet is waiting to be sent, or being sent. All slots are checked: a newly queued packet is
+// picked up as '_tail' only by the next 'SendBitIsr'.
+bool TVanPacketTxQueue::IsBusy() const
+{
+    bool busy = false;
+
+    NO_INTERRUPTS;
+    for (const TVanPacketTxDesc* txDesc = pool; txDesc < end; txDesc++)
+    {
+        if (txDesc->state != VAN_TX_DONE)
+        {
+            busy = true;
+            break;
+        } // if
+    } // for
+    INTERRUPTS;
+
+    return busy;
+} // TVanPacketTxQueue::IsBusy
+
 // Send data as a packet on the VAN bus
-void TVanPacketTxDesc::PreparePacket(uint16_t iden, uint8_t cmdFlags, const uint8_t* data, size_t dataLen)
+void TVanPacketTxDesc::PreparePacket(uint16_t iden, uint8_t cmdFlags, const uint8_t* data, size_t dataLen,
+    uint8_t priority, unsigned int deadlineMs)
 {
     Init();
 
@@ -177,25 +848,115 @@ void TVanPacketTxDesc::PreparePacket(uint16_t iden, uint8_t cmdFlags, const uint
     bytes[dataLen + 4] = crc & 0xFF;
 
     // Stuff with Manchester bits
-    for (size_t i = 0; i < dataLen + 5; i++)
-    {
-        uint8_t byte = bytes[i];
-        stuffedBytes[i] = (byte & 0xF0) << 2 | (~ byte & 0x10) << 1 | (byte & 0x0F) << 1 | (~ byte & 0x01);
-    } // for
+    for (size_t i = 0; i < dataLen + 3; i++) stuffedBytes[i] = manchesterTable[bytes[i]];
+    StuffCrcAndEof(stuffedBytes, bytes, dataLen);
 
-    // The last bit is always 0 (CRC has been shifted left 1 bit), and the last Manchester bit is also always 0,
-    // to indicate EOD
-    stuffedBytes[dataLen + 4] &= 0xFFFC;
+    SetSize(dataLen, cmdFlags, priority, deadlineMs);
+} // TVanPacketTxDesc::PreparePacket
+
+// Send a prepared packet on the VAN bus
+void TVanPacketTxDesc::PreparePacket(const TVanPreparedTxPacket& packet, uint8_t priority, unsigned int deadlineMs)
+{
+    Init();
+
+    n = VanBusTx.GetCount();
+
+    // The packet is already stuffed, including EOD, ACK and EOF bits
+    memcpy(stuffedBytes, packet.stuffedBytes, (packet.dataLen + 5 + 1) * sizeof(stuffedBytes[0]));
+
+    SetSize(packet.dataLen, packet.CommandFlags(), priority, deadlineMs);
+} // TVanPacketTxDesc::PreparePacket
+
+// Set the transmit pointers for a stuffed packet with 'dataLen' data bytes, and mark it ready for sending.
+// When 'deadlineMs' is not 0, the packet is dropped if not sent within that many milliseconds.
+void TVanPacketTxDesc::SetSize(size_t dataLen, uint8_t cmdFlags, uint8_t prio, unsigned int deadlineMs)
+{
     eodAt = dataLen + 5;
     p_eod = stuffedBytes + dataLen + 5;
 
-    // End with 10 VAN_LOGICAL_HIGH-bits: 2 bits for the (optional) ACK, then 8 bits for EOF
-    stuffedBytes[dataLen + 5] = 0xFFFF;
     size = dataLen + 5 + 1;  // Adding 1 for the last 10 VAN_LOGICAL_HIGH-bits
     p_last = stuffedBytes + dataLen + 5 + 1;
 
+    // Register the outcome as pending before the ISR can pick up the packet
+    TVanPacketTxResult* result = VanBusTx.results + n % VanBusTx.nResults;
+    result->n = n;
+    result->result = VAN_TX_PENDING;
+    result->nCollisions = 0;
+    result->nRetries = 0;
+    result->ack = VAN_NO_ACK;
+    result->bitError = false;
+    result->sofAt = 0;
+    result->eofAt = 0;
+
+    // Reliable send is only for packets that request an acknowledge (RAK flag)
+    maxRetries = (cmdFlags & 0x04) != 0 ? VanBusTx.maxRetries : 0;
+
+    priority = prio;
+    hasDeadline = deadlineMs != 0;
+    deadline = millis() + deadlineMs;
+
     state = VAN_TX_WAITING;
-} // TVanPacketTxDesc::PreparePacket
+} // TVanPacketTxDesc::SetSize
+
+TVanPreparedTxPacket::TVanPreparedTxPacket(uint16_t iden, uint8_t cmdFlags, const uint8_t* data, size_t dataLen)
+    : dataLen(0)
+{
+    bytes[0] = 0x0E;  // SOF
+    bytes[1] = iden >> 4 & 0xFF;  // IDEN (MSB 8 bits)
+    bytes[2] = iden << 4 | 0x08 | (cmdFlags & 0x07);  // IDEN (LSB 4 bits), fixed-1 (1 bit), COM (3 bits)
+
+    // The header is stuffed, and its CRC contribution calculated, only once
+    for (int i = 0; i < 3; i++) stuffedBytes[i] = manchesterTable[bytes[i]];
+    crcAt[0] = _crcUpdate(0x7FFF, bytes + 1, 2);  // Skip SOF
+    UpdateCrc(0);
+
+    SetData(data, dataLen);
+} // TVanPreparedTxPacket::TVanPreparedTxPacket
+
+// Replace the data of a prepared packet. Only the bytes that differ from the current data are stuffed again.
+void TVanPreparedTxPacket::SetData(const uint8_t* data, size_t dataLen)
+{
+    // Send at most VAN_MAX_DATA_BYTES data
+    if (dataLen > VAN_MAX_DATA_BYTES) dataLen = VAN_MAX_DATA_BYTES;
+
+    size_t from = dataLen;
+    for (size_t i = 0; i < dataLen; i++)
+    {
+        // Positions beyond the current data contain the CRC, so are always overwritten
+        if (i < this->dataLen && bytes[3 + i] == data[i]) continue;
+
+        bytes[3 + i] = data[i];
+        stuffedBytes[3 + i] = manchesterTable[data[i]];
+        if (i < from) from = i;
+    } // for
+
+    if (from == dataLen && dataLen == this->dataLen) return;  // Nothing changed
+
+    this->dataLen = dataLen;
+    UpdateCrc(from);
+} // TVanPreparedTxPacket::SetData
+
+// Replace a single data byte of a prepared packet
+void TVanPreparedTxPacket::SetByte(size_t i, uint8_t value)
+{
+    if (i >= dataLen || bytes[3 + i] == value) return;
+
+    bytes[3 + i] = value;
+    stuffedBytes[3 + i] = manchesterTable[value];
+    UpdateCrc(i);
+} // TVanPreparedTxPacket::SetByte
+
+// Recalculate the CRC, starting at data byte 'from', and stuff it
+void TVanPreparedTxPacket::UpdateCrc(size_t from)
+{
+    for (size_t i = from; i < dataLen; i++) crcAt[i + 1] = _crcUpdate(crcAt[i], bytes + 3 + i, 1);
+
+    uint16_t crc = (crcAt[dataLen] ^ 0x7FFF) << 1;  // Shift left 1 bit to turn 15 bit result into 16 bit representation
+    bytes[dataLen + 3] = crc >> 8;
+    bytes[dataLen + 4] = crc & 0xFF;
+
+    StuffCrcAndEof(stuffedBytes, bytes, dataLen);
+} // TVanPreparedTxPacket::UpdateCrc
 
 // Print information about a transmitted package
 void TVanPacketTxDesc::Dump() const
@@ -204,7 +965,7 @@ void TVanPacketTxDesc::Dump() const
     if (state != VAN_TX_DONE) return;
 
     // Only if there is something interesting to print
-    if (! busOccupied && bitOk && nCollisions == 0 && ! bitError) return;
+    if (! busOccupied && bitOk && nCollisions == 0 && ! bitError && nRetries == 0) return;
 
     uint32_t ifsBits = interFrameCpuCycles / CPU_F_FACTOR / VAN_BIT_TIMER_TICKS / 16;
     Serial.printf_P(PSTR("#%" PRIu32 ", ifsBits=%" PRIu32 "%s"), n, ifsBits, busOccupied ? ", busOccupied" : "");
@@ -214,118 +975,405 @@ void TVanPacketTxDesc::Dump() const
         Serial.printf_P(PSTR(", nCollisions=%" PRIu32 ", firstCollisionAtBit=%" PRIu32), nCollisions, firstCollisionAtBit);
     } // if
 
+    if (nRetries > 0) Serial.printf_P(PSTR(", nRetries=%u"), nRetries);
+
     Serial.printf_P(PSTR("%s%s\n"), bitOk ? "" : ", NO bitOk", bitError ? ", bitError" : "");
 } // TVanPacketTxDesc::Dump
 
 void TVanPacketTxQueue::StartBitSendTimer()
 {
-    VanBusRx.RegisterTxIsr(&SendBitIsr);
+  #ifdef VAN_TX_ESP32_RMT
+    // While the RMT peripheral is transmitting, the bit timer is off. It is started again when the transmission ends.
+    if (VanBusTx._tail->state == VAN_TX_SENDING) return;
+  #endif // VAN_TX_ESP32_RMT
 
-    // TODO - wait here until:
-    // nCycles >= (8 /* EOF */ + 5 /* IFS */) * (VAN_BIT_TIMER_TICKS * 16) * CPU_F_FACTOR
-    // If we start the SendBitIsr now, we might introduce extra wobbling in the RxPinChangeIsr, causing CRC errors
-    // Preference is to not have the timer1 interrupt handler being called while a packet is being received.
-
-    //uint32_t curr = ESP.getCycleCount();
-    //uint32_t nCycles = curr - VanBusRx.GetLastMediaAccessAt();  // Arithmetic has safe roll-over
-    //if (nCycles < (8 /* EOF */ + 5 /* IFS */) * (VAN_BIT_TIMER_TICKS * 16) * CPU_F_FACTOR) return;
+    VanBusRx.RegisterTxIsr(&SendBitIsr);
 
     NO_INTERRUPTS;
 
-    // Transmitting a packet is done completely by interrupt-servicing
+    // Transmitting a packet is done completely by interrupt-servicing. The timer is armed to go off as soon as the
+    // bus has been idle long enough. If the timer is busy (e.g. the receiver is waiting for an ACK bit), the
+    // receiver arms it when done.
 
 #ifdef ARDUINO_ARCH_ESP32
-
-    if (! timerAlarmEnabled(timer))
-    {
-        // Set a repetitive timer
-        timerAlarmDisable(timer);
-        timerAttachInterrupt(timer, &SendBitIsr, true);
-        timerAlarmWrite(timer, VAN_BIT_TIMER_TICKS, true);
-        timerAlarmEnable(timer);
-    } // if
-
+    if (! timerAlarmEnabled(timer)) ArmTxTimer();
 #else // ! ARDUINO_ARCH_ESP32
-
-    if (! timer1_enabled())
-    {
-        // Set a repetitive timer
-        timer1_disable();
-        timer1_attachInterrupt(SendBitIsr);
-
-        // Clock to timer (prescaler) is always 80MHz, even F_CPU is 160 MHz
-        timer1_enable(TIM_DIV16, TIM_EDGE, TIM_LOOP);
-
-        timer1_write(VAN_BIT_TIMER_TICKS);
-    } // if
-
+    if (! timer1_enabled()) ArmTxTimer();
 #endif // ARDUINO_ARCH_ESP32
 
     INTERRUPTS;
 } // void TVanPacketTxQueue::StartBitSendTimer
 
-// Wait until the head of the queue is available. When 'timeOutMs' is set to 0, will wait forever.
-bool TVanPacketTxQueue::WaitForHeadAvailable(unsigned int timeOutMs)
+// Points '_head' at a free slot, if there is one. Otherwise, returns false.
+bool TVanPacketTxQueue::SlotAvailable()
 {
-    unsigned int waitPoll = timeOutMs;
+    if (pool == NULL) return false;  // Not setup
 
+    // Packets do not leave the queue in the order they came in, so any slot can be the free one
+    for (int i = 0; i < size; i++)
+    {
+        if (_head->state == VAN_TX_DONE) return true;
+        if (++_head == end) _head = pool;  // roll over if needed
+    } // for
+
+    return false;
+} // TVanPacketTxQueue::SlotAvailable
+
+// Gives the CPU to other tasks until a packet may have left the transmit queue
+void TVanPacketTxQueue::WaitForTxDone()
+{
+  #ifdef ARDUINO_ARCH_ESP32
+    // Block until the ISR signals that a packet left the queue. At most 1 tick: the semaphore may have been taken by
+    // another waiting task, or given before the caller started waiting.
+    if (txDoneSemaphore != NULL) xSemaphoreTake(txDoneSemaphore, 1); else vTaskDelay(1);  // Not setup
+  #else // ! ARDUINO_ARCH_ESP32
+    // Single-threaded: nothing to block on. Let the Wi-Fi stack run; a packet takes less than 0.3 milliseconds on
+    // the bus, so don't sleep in steps of 1 millisecond.
+    delay(0);
+  #endif // ARDUINO_ARCH_ESP32
+} // TVanPacketTxQueue::WaitForTxDone
+
+// Wait until a slot in the queue is available, at most until 'timeOutMs' milliseconds after 'start' (a value of
+// 'millis()'). When 'timeOutMs' is set to 0, will wait forever.
+bool TVanPacketTxQueue::WaitForHeadAvailable(unsigned long start, unsigned int timeOutMs)
+{
     // Relying on short-circuit boolean evaluation
-    while (! SlotAvailable() && (timeOutMs == 0 || --waitPoll > 0)) delay(1);
+    while (! SlotAvailable() && (timeOutMs == 0 || millis() - start < timeOutMs)) WaitForTxDone();  // Arithmetic has safe roll-over
 
     return SlotAvailable();
 } // TVanPacketTxQueue::WaitForHeadAvailable
 
+// Wait until the packet in slot 'txDesc' has left the queue, at most until 'timeOutMs' milliseconds after 'start'
+// (a value of 'millis()'). When 'timeOutMs' is set to 0, will wait forever.
+bool TVanPacketTxQueue::WaitForPacketDone(const TVanPacketTxDesc* txDesc, unsigned long start, unsigned int timeOutMs)
+{
+    // Relying on short-circuit boolean evaluation
+    while (txDesc->state != VAN_TX_DONE && (timeOutMs == 0 || millis() - start < timeOutMs)) WaitForTxDone();  // Arithmetic has safe roll-over
+
+    return txDesc->state == VAN_TX_DONE;
+} // TVanPacketTxQueue::WaitForPacketDone
+
 // Synchronous packet send: returns as soon as the packet was transmitted.
 // Will wait at most 'timeOutMs' milliseconds. When 'timeOutMs' is set to 0, will wait forever
 bool TVanPacketTxQueue::SyncSendPacket(uint16_t iden, uint8_t cmdFlags, const uint8_t* data, size_t dataLen, unsigned int timeOutMs)
 {
+    // The time-out covers both waiting for a free slot and waiting for the transmission to be finished
+    const unsigned long start = millis();
+
     // If the Tx queue is full, wait a bit
-    if (! WaitForHeadAvailable(timeOutMs))
+    if (! WaitForHeadAvailable(start, timeOutMs))
     {
         ++nDropped;
         return false;
     } // if
 
+    TVanPacketTxDesc* txDesc = _head;
+    uint32_t n = GetCount();
+
     _head->PreparePacket(iden, cmdFlags, data, dataLen);
+    AdvanceHead();
     StartBitSendTimer();
 
     // Wait here for the packet transmission to be finished
-    if (! WaitForHeadAvailable()) return false;
+    if (! WaitForPacketDone(txDesc, start, timeOutMs)) return false;
+
+    return GetTxResult(n) == VAN_TX_DELIVERED;
+} // TVanPacketTxQueue::SyncSendPacket
+
+// Asynchronous packet send: queues the packet to be transmitted then returns.
+// If the TX queue is full, will wait at most 'timeOutMs' milliseconds. When 'timeOutMs' is set to 0, will wait forever.
+bool TVanPacketTxQueue::SendPacket(uint16_t iden, uint8_t cmdFlags, const uint8_t* data, size_t dataLen, unsigned int timeOutMs,
+    uint8_t priority, unsigned int deadlineMs)
+{
+    // If the Tx queue is full, wait a bit
+    if (! WaitForHeadAvailable(millis(), timeOutMs))
+    {
+        ++nDropped;
+        return false;
+    } // if
 
+    _head->PreparePacket(iden, cmdFlags, data, dataLen, priority, deadlineMs);
     AdvanceHead();
+    StartBitSendTimer();
 
     return true;
+} // TVanPacketTxQueue::SendPacket
+
+// Synchronous send of a prepared packet: returns as soon as the packet was transmitted.
+// Will wait at most 'timeOutMs' milliseconds. When 'timeOutMs' is set to 0, will wait forever
+bool TVanPacketTxQueue::SyncSendPacket(const TVanPreparedTxPacket& packet, unsigned int timeOutMs)
+{
+    // The time-out covers both waiting for a free slot and waiting for the transmission to be finished
+    const unsigned long start = millis();
+
+    // If the Tx queue is full, wait a bit
+    if (! WaitForHeadAvailable(start, timeOutMs))
+    {
+        ++nDropped;
+        return false;
+    } // if
+
+    TVanPacketTxDesc* txDesc = _head;
+    uint32_t n = GetCount();
+
+    _head->PreparePacket(packet);
+    AdvanceHead();
+    StartBitSendTimer();
+
+    // Wait here for the packet transmission to be finished
+    if (! WaitForPacketDone(txDesc, start, timeOutMs)) return false;
+
+    return GetTxResult(n) == VAN_TX_DELIVERED;
 } // TVanPacketTxQueue::SyncSendPacket
 
-// Asynchronous packet send: queues the packet to be transmitted then returns.
+// Asynchronous send of a prepared packet: queues the packet to be transmitted then returns.
 // If the TX queue is full, will wait at most 'timeOutMs' milliseconds. When 'timeOutMs' is set to 0, will wait forever.
-bool TVanPacketTxQueue::SendPacket(uint16_t iden, uint8_t cmdFlags, const uint8_t* data, size_t dataLen, unsigned int timeOutMs)
+bool TVanPacketTxQueue::SendPacket(const TVanPreparedTxPacket& packet, unsigned int timeOutMs,
+    uint8_t priority, unsigned int deadlineMs)
 {
     // If the Tx queue is full, wait a bit
-    if (! WaitForHeadAvailable(timeOutMs))
+    if (! WaitForHeadAvailable(millis(), timeOutMs))
     {
         ++nDropped;
         return false;
     } // if
 
-    _head->PreparePacket(iden, cmdFlags, data, dataLen);
+    _head->PreparePacket(packet, priority, deadlineMs);
+    AdvanceHead();
     StartBitSendTimer();
 
+    return true;
+} // TVanPacketTxQueue::SendPacket
+
+// Non-blocking packet send: queues the packet to be transmitted if there is room in the Tx queue, then returns
+bool TVanPacketTxQueue::QueuePacket(uint16_t iden, uint8_t cmdFlags, const uint8_t* data, size_t dataLen, uint32_t* n,
+    uint8_t priority, unsigned int deadlineMs)
+{
+    if (! SlotAvailable())
+    {
+        ++nDropped;
+        return false;
+    } // if
+
+    if (n != NULL) *n = GetCount();
+
+    _head->PreparePacket(iden, cmdFlags, data, dataLen, priority, deadlineMs);
     AdvanceHead();
+    StartBitSendTimer();
 
     return true;
-} // TVanPacketTxQueue::SendPacket
+} // TVanPacketTxQueue::QueuePacket
+
+// Non-blocking send of a prepared packet
+bool TVanPacketTxQueue::QueuePacket(const TVanPreparedTxPacket& packet, uint32_t* n,
+    uint8_t priority, unsigned int deadlineMs)
+{
+    if (! SlotAvailable())
+    {
+        ++nDropped;
+        return false;
+    } // if
+
+    if (n != NULL) *n = GetCount();
+
+    _head->PreparePacket(packet, priority, deadlineMs);
+    AdvanceHead();
+    StartBitSendTimer();
+
+    return true;
+} // TVanPacketTxQueue::QueuePacket
+
+// Register an in-frame reply. A reply registered earlier for the same IDEN and command flags is replaced.
+bool TVanPacketTxQueue::SetInFrameReply(const TVanPreparedTxPacket* reply, unsigned int timeOutMs)
+{
+  #if defined VAN_RX_ESP32_RMT || defined VAN_TX_ESP32_RMT
+    // The RMT receiver decodes a packet only after it has ended; the RMT transmitter owns the Tx pin
+    (void)reply;
+    (void)timeOutMs;
+    return false;
+  #else // ! defined VAN_RX_ESP32_RMT && ! defined VAN_TX_ESP32_RMT
+    if (txPin == VAN_NO_PIN_ASSIGNED) return false;  // Not setup
+    if ((reply->CommandFlags() & 0x03) != 0x03) return false;  // Not a read request for in-frame response
+
+    int freeAt = -1;
+    for (int i = 0; i < VAN_TX_MAX_IN_FRAME_REPLIES; i++)
+    {
+        const TVanPreparedTxPacket* entry = inFrameReplies[i];
+        if (entry != NULL && entry->bytes[1] == reply->bytes[1] && entry->bytes[2] == reply->bytes[2])
+        {
+            return ReplaceInFrameReply(i, reply, timeOutMs);
+        } // if
+        if (entry == NULL && freeAt < 0) freeAt = i;
+    } // for
+
+    if (freeAt < 0) return false;  // Table full
+
+    inFrameReplies[freeAt] = reply;
+    VanBusRx.RegisterInFrameReplyIsr(InFrameReplyIsr);
+
+    return true;
+  #endif // defined VAN_RX_ESP32_RMT || defined VAN_TX_ESP32_RMT
+} // TVanPacketTxQueue::SetInFrameReply
+
+// Unregister all in-frame replies for 'iden'
+bool TVanPacketTxQueue::ClearInFrameReply(uint16_t iden, unsigned int timeOutMs)
+{
+    bool result = true;
+    for (int i = 0; i < VAN_TX_MAX_IN_FRAME_REPLIES; i++)
+    {
+        const TVanPreparedTxPacket* entry = inFrameReplies[i];
+        if (entry != NULL && entry->Iden() == iden && ! ReplaceInFrameReply(i, NULL, timeOutMs)) result = false;
+    } // for
+    return result;
+} // TVanPacketTxQueue::ClearInFrameReply
+
+// Returns true if the receiver ISR is sending 'reply' as in-frame reply
+bool TVanPacketTxQueue::IsSendingInFrameReply(const TVanPreparedTxPacket* reply) const
+{
+  #if ! defined VAN_RX_ESP32_RMT && ! defined VAN_TX_ESP32_RMT
+    return reply != NULL && replyPacket == reply;
+  #else // defined VAN_RX_ESP32_RMT || defined VAN_TX_ESP32_RMT
+    (void)reply;
+    return false;  // In-frame replies are never sent
+  #endif // ! defined VAN_RX_ESP32_RMT && ! defined VAN_TX_ESP32_RMT
+} // TVanPacketTxQueue::IsSendingInFrameReply
+
+// Replaces entry 'i' in the table of in-frame replies by 'reply' (may be NULL). If the receiver ISR is sending the
+// old reply, waits until it is done, so that the old reply can be changed or freed after return. Returns false if
+// the old reply was still being sent after 'timeOutMs' milliseconds.
+bool TVanPacketTxQueue::ReplaceInFrameReply(int i, const TVanPreparedTxPacket* reply, unsigned int timeOutMs)
+{
+    // 'InFrameReplyIsr' is called by the 'VanBusRx' ISR, which holds the same lock while looking up and starting a
+    // reply. So once the entry is replaced, the old reply is either being sent already, or not started again.
+    NO_INTERRUPTS;
+    const TVanPreparedTxPacket* old = inFrameReplies[i];
+    inFrameReplies[i] = reply;
+    INTERRUPTS;
+
+  #if ! defined VAN_RX_ESP32_RMT && ! defined VAN_TX_ESP32_RMT
+    if (old == NULL || old == reply) return true;
+
+    // A reply takes at most a few milliseconds
+    const unsigned long start = millis();
+    while (replyPacket == old)
+    {
+        if (millis() - start >= timeOutMs) return false;  // Arithmetic has safe roll-over
+        yield();
+    } // while
+  #else // defined VAN_RX_ESP32_RMT || defined VAN_TX_ESP32_RMT
+    (void)old;  // In-frame replies are never sent
+    (void)timeOutMs;
+  #endif // ! defined VAN_RX_ESP32_RMT && ! defined VAN_TX_ESP32_RMT
+
+    return true;
+} // TVanPacketTxQueue::ReplaceInFrameReply
+
+// Returns the outcome of the transmission of packet with sequence number 'n'
+PacketTxResult_t TVanPacketTxQueue::GetTxResult(uint32_t n, TVanPacketTxResult* result) const
+{
+    if (results == NULL) return VAN_TX_UNKNOWN;  // Not setup
+
+    NO_INTERRUPTS;
+    TVanPacketTxResult copy = results[n % nResults];
+    INTERRUPTS;
+
+    // Overwritten by a later packet, or never queued?
+    if (copy.n != n || copy.result == VAN_TX_UNKNOWN) return VAN_TX_UNKNOWN;
+
+    if (result != NULL) *result = copy;
+    return copy.result;
+} // TVanPacketTxQueue::GetTxResult
+
+// Points '_tail' at the most urgent packet waiting to be sent, unless a packet is being sent. Packets of which the
+// deadline has passed are dropped. Returns false if there is nothing to send.
+bool IRAM_ATTR TVanPacketTxQueue::_SelectNext()
+{
+    if (_tail->state == VAN_TX_SENDING) return true;
+
+    TVanPacketTxDesc* next = NULL;
+    unsigned long now = millis();
+
+    for (TVanPacketTxDesc* txDesc = pool; txDesc < end; txDesc++)
+    {
+        if (txDesc->state != VAN_TX_WAITING) continue;
+
+        if (txDesc->hasDeadline && (long)(now - txDesc->deadline) >= 0)  // Arithmetic has safe roll-over
+        {
+            // Too late: drop without sending
+            ++nExpired;
+            _SetResult(txDesc, VAN_TX_EXPIRED);
+            txDesc->state = VAN_TX_DONE;
+            SignalTxDone();
+            continue;
+        } // if
+
+        if (next == NULL || txDesc->IsMoreUrgentThan(next)) next = txDesc;
+    } // for
+
+    if (next == NULL) return false;
+
+    _tail = next;
+    return true;
+} // TVanPacketTxQueue::_SelectNext
+
+// Save the outcome of a packet that leaves the queue
+void IRAM_ATTR TVanPacketTxQueue::_SetResult(const TVanPacketTxDesc* txDesc, PacketTxResult_t outcome)
+{
+    TVanPacketTxResult* result = results + txDesc->n % nResults;
+    if (result->n != txDesc->n) return;
+
+    result->result = outcome;
+    result->nCollisions = txDesc->nCollisions;
+    result->nRetries = txDesc->nRetries;
+    result->ack = txDesc->ackSeen ? VAN_ACK : VAN_NO_ACK;
+    result->bitError = txDesc->bitError;
+
+    if (outcome == VAN_TX_EXPIRED)
+    {
+        result->sofAt = 0;
+        result->eofAt = 0;
+    }
+    else
+    {
+        const uint32_t now = ESP.getCycleCount();
+        result->eofAt = _cycleCount64(now);
+        result->sofAt = result->eofAt - (uint32_t)(now - txDesc->sofAt);  // Arithmetic has safe roll-over
+    } // if
+} // TVanPacketTxQueue::_SetResult
 
 // Dumps packet statistics
 void TVanPacketTxQueue::DumpStats(Stream& s) const
 {
     s.printf_P(
-        PSTR("transmitted pkts: %" PRIu32 ", single collisions: %" PRIu32 ", multiple collisions: %" PRIu32 ", dropped: %" PRIu32 "\n"),
+        PSTR("transmitted pkts: %" PRIu32 ", single collisions: %" PRIu32 ", multiple collisions: %" PRIu32
+            ", max collision errors: %" PRIu32 ", dropped: %" PRIu32 ", expired: %" PRIu32
+            ", in-frame replies: %" PRIu32 ", retries: %" PRIu32 ", undelivered: %" PRIu32 "\n"),
         GetCount(),
         nSingleCollisions,
         nMultipleCollisions,
-        nDropped
+        nMaxCollisionErrors,
+        nDropped,
+        nExpired,
+        nInFrameReplies,
+        nRetries,
+        nUndelivered
     );
 } // TVanPacketTxQueue::DumpStats
 
+#ifdef VAN_ISR_PROFILING
+
+// Prints the execution time statistics of 'SendBitIsr'
+void TVanPacketTxQueue::DumpIsrProfile(Stream& s, bool reset)
+{
+    NO_INTERRUPTS;
+    const TIsrProfile profile = sendBitIsrProfile;
+    if (reset) sendBitIsrProfile.Init();
+    INTERRUPTS;
+
+    s.printf_P(PSTR("SendBitIsr                 "));
+    profile.Dump(s);
+} // TVanPacketTxQueue::DumpIsrProfile
+
+#endif // VAN_ISR_PROFILING
+
 TVanPacketTxQueue VanBusTx;
@@ -3,7 +3,7 @@
  *
  * Written by Erik Tromp
  *
- * Version 0.4.1 - September, 2024
+ * Version 0.4.2 - October, 2026
  *
  * MIT license, all text above must be included in any redistribution.
  */
@@ -22,6 +22,13 @@
  *   In loop() :
  *     uint8_t rmtTemperatureBytes[] = {0x0F, 0x07, 0x00, 0x00, 0x00, 0x00, 0x70};
  *     VanBusTx.SendPacket(0x8A4, 0x08, rmtTemperatureBytes, sizeof(rmtTemperatureBytes));
+ *
+ *   Packets that are sent repeatedly can be prepared once, e.g. as a global variable:
+ *     TVanPreparedTxPacket rmtTemperaturePacket(0x8A4, 0x08, rmtTemperatureBytes, sizeof(rmtTemperatureBytes));
+ *
+ *   and then in loop() :
+ *     rmtTemperaturePacket.SetByte(6, 0x70);  // Only if the data changed
+ *     VanBusTx.SendPacket(rmtTemperaturePacket);
  */
 
 #ifndef VanBusTx_h
@@ -30,13 +37,70 @@
 #include "VanBusRx.h"
 
 enum PacketWriteState_t { VAN_TX_WAITING, VAN_TX_SENDING, VAN_TX_DONE };
+enum PacketTxResult_t { VAN_TX_UNKNOWN, VAN_TX_PENDING, VAN_TX_DELIVERED, VAN_TX_FAILED, VAN_TX_EXPIRED };
+
+// Of the packets waiting in the Tx queue, the one with the highest priority is sent first. Any value 0...255 can be
+// used; these are just suggestions.
+#define VAN_TX_PRIORITY_LOW 0
+#define VAN_TX_PRIORITY_NORMAL 1
+#define VAN_TX_PRIORITY_HIGH 2
+
+// Outcome of a packet transmission, as reported by 'TVanPacketTxQueue::GetTxResult'
+struct TVanPacketTxResult
+{
+    uint32_t n;  // Sequence number of the packet
+    PacketTxResult_t result;  // VAN_TX_FAILED: gave up after VAN_TX_MAX_COLLISIONS collisions, or (reliable send)
+                              // still not acknowledged, or still a bit error, after the last retry;
+                              // VAN_TX_EXPIRED: not sent because its deadline passed
+    uint32_t nCollisions;
+    uint32_t nRetries;  // Reliable send: number of times the packet was sent again (see 'SetReliableSend')
+    PacketAck_t ack;  // VAN_ACK if a receiver acknowledged the (last) transmission
+    bool bitError;  // Bus was read back 'recessive' while sending a 'dominant' bit, in the (last) transmission
+
+    // CPU cycles since boot (see 'TVanPacketRxDesc::SofCycles'); convert with '_cyclesToMicros'. Start and end of
+    // the (last) transmission attempt; 0 if the packet expired.
+    uint64_t sofAt;
+    uint64_t eofAt;
+}; // struct TVanPacketTxResult
+
+// VAN packet with fixed IDEN and command flags, prepared for repeated transmission. The packet is kept in its
+// Manchester-stuffed form, so that queueing it for transmission is only a copy. When the data is changed, only the
+// changed bytes are stuffed again, and the CRC is recalculated starting at the first changed byte.
+class TVanPreparedTxPacket
+{
+  public:
+    TVanPreparedTxPacket(uint16_t iden, uint8_t cmdFlags, const uint8_t* data = NULL, size_t dataLen = 0);
+    void SetData(const uint8_t* data, size_t dataLen);
+    void SetByte(size_t i, uint8_t value);
+
+    uint16_t Iden() const { return bytes[1] << 4 | bytes[2] >> 4; }
+    uint8_t CommandFlags() const { return bytes[2] & 0x0F; }
+    const uint8_t* Data() const { return bytes + 3; }
+    size_t DataLen() const { return dataLen; }
+
+  private:
+
+    uint8_t bytes[VAN_MAX_PACKET_SIZE];
+    uint16_t stuffedBytes[VAN_MAX_PACKET_SIZE + 1];  // 1 extra "byte": 2 ACK bits and 8 EOF bits
+    uint16_t crcAt[VAN_MAX_DATA_BYTES + 1];  // Intermediate CRC value before each data byte
+    size_t dataLen;
+
+    void UpdateCrc(size_t from);
+
+    friend void InFrameReplyIsr(uint16_t header);
+    friend class TVanPacketTxDesc;
+    friend class TVanPacketTxQueue;
+}; // class TVanPreparedTxPacket
 
 // VAN packet Tx descriptor
 class TVanPacketTxDesc
 {
   public:
     TVanPacketTxDesc() { Init(); }
-    void PreparePacket(uint16_t iden, uint8_t cmdFlags, const uint8_t* data, size_t dataLen);
+    void PreparePacket(uint16_t iden, uint8_t cmdFlags, const uint8_t* data, size_t dataLen,
+        uint8_t priority = VAN_TX_PRIORITY_NORMAL, unsigned int deadlineMs = 0);
+    void PreparePacket(const TVanPreparedTxPacket& packet,
+        uint8_t priority = VAN_TX_PRIORITY_NORMAL, unsigned int deadlineMs = 0);
     void Dump() const;
 
   private:
@@ -48,83 +112,218 @@ class TVanPacketTxDesc
     unsigned int size;
     unsigned int eodAt;
     volatile PacketWriteState_t state;
+    uint8_t priority;
+    bool hasDeadline;
+    unsigned long deadline;  // Value of 'millis()' after which the packet is dropped if not yet sent
 
     #define VAN_TX_MAX_COLLISIONS 10
 
+    // Reliable send: before a retry, wait a random number of bit times, extra to the inter-frame space. The range
+    // starts at VAN_TX_BACKOFF_BITS and doubles with each retry, up to VAN_TX_MAX_BACKOFF_BITS.
+    #define VAN_TX_BACKOFF_BITS 16
+    #define VAN_TX_MAX_BACKOFF_BITS 512
+
     uint32_t nCollisions;
     uint32_t firstCollisionAtBit;
     bool bitError;
     bool bitOk;
     bool busOccupied;
+    bool ackSeen;
+    // Reliable send: retry at most this many times if not acknowledged, or on a bit error; 0 if not reliable. Fixed
+    // when the packet is queued (see 'TVanPacketTxQueue::SetReliableSend').
+    uint8_t maxRetries;
+    uint8_t nRetries;
+    uint16_t backoffBits;  // Extra bit times to wait for an idle bus, before the next attempt
     uint32_t interFrameCpuCycles;  // Inter-Frame Spacing (IFS) after last received packet, counted in CPU cycles
+    uint32_t sofAt;  // CPU cycle counter value at start of transmission
 
     void Init()
     {
         size = 0;
         eodAt = 0;
         state = VAN_TX_DONE;
+        priority = VAN_TX_PRIORITY_NORMAL;
+        hasDeadline = false;
         nCollisions = 0;
         firstCollisionAtBit = 0;
         bitError = false;
         bitOk = false;
         busOccupied = false;
+        ackSeen = false;
+        maxRetries = 0;
+        nRetries = 0;
+        backoffBits = 0;
     } // Init
 
+    void SetSize(size_t dataLen, uint8_t cmdFlags, uint8_t prio, unsigned int deadlineMs);
+
+    // Reliable send: a packet with the RAK (Request AcKnowledge) flag set is only delivered once it was acknowledged,
+    // and sent without bit errors
+    bool IRAM_ATTR IsUndelivered() const { return maxRetries > 0 && (bitError || ! ackSeen); }
+
+    // Higher priority first; then the packet with the earliest deadline; then the packet that was queued first
+    bool IRAM_ATTR IsMoreUrgentThan(const TVanPacketTxDesc* other) const
+    {
+        if (priority != other->priority) return priority > other->priority;
+        if (hasDeadline != other->hasDeadline) return hasDeadline;
+        if (hasDeadline && deadline != other->deadline) return (long)(deadline - other->deadline) < 0;  // Safe roll-over
+        return (int32_t)(n - other->n) < 0;  // Arithmetic has safe roll-over
+    } // IsMoreUrgentThan
+
+  #ifdef VAN_TX_ESP32_RMT
+    // Returns bit 'bitNo' of the stuffed packet. Of each 10 bits, the most significant is sent first.
+    uint16_t StuffedBit(int bitNo) const { return stuffedBytes[bitNo / 10] >> (9 - bitNo % 10) & 0x01; }
+  #endif // VAN_TX_ESP32_RMT
+
     friend void FinishPacketTransmission(TVanPacketTxDesc* txDesc);
+    friend void RetryPacketTransmission(TVanPacketTxDesc* txDesc);
     friend void SendBitIsr();
+  #ifdef VAN_TX_ESP32_RMT
+    friend int EncodeRmtItems(const TVanPacketTxDesc* txDesc);
+    friend void StartRmtTransmission(TVanPacketTxDesc* txDesc);
+    friend void RmtTxTask(void* param);
+    friend void TxRmtCheckEdge(uint32_t curr, int pinLevel);
+    friend void RmtTxEndCallback(rmt_channel_t channel, void* arg);
+  #endif // VAN_TX_ESP32_RMT
     friend class TVanPacketTxQueue;
 }; // class TVanPacketTxDesc
 
-// Circular buffer of VAN packet Tx descriptors
+// Pool of VAN packet Tx descriptors. Of the packets waiting, the ISR sends the most urgent one first (see
+// 'TVanPacketTxDesc::IsMoreUrgentThan'). A packet that has a deadline ('deadlineMs' milliseconds after being queued)
+// is dropped without being sent if the deadline passes before its transmission starts.
 class TVanPacketTxQueue
 {
   public:
 
-    #define VAN_TX_QUEUE_SIZE 5
+    #define VAN_DEFAULT_TX_QUEUE_SIZE 5
+    #define VAN_TX_MAX_IN_FRAME_REPLIES 8
+    #define VAN_TX_DEFAULT_MAX_RETRIES 3
 
     // Constructor
     TVanPacketTxQueue()
         : txPin(VAN_NO_PIN_ASSIGNED)
-        , _head(pool)
-        , _tail(pool)
-        , end(pool + VAN_TX_QUEUE_SIZE)
+        , size(0)
+        , pool(NULL)
+        , _head(NULL)
+        , _tail(NULL)
+        , end(NULL)
         , count(0)
         , nDropped(0)
+        , nExpired(0)
         , nSingleCollisions(0)
         , nMultipleCollisions(0)
         , nMaxCollisionErrors(0)
-    { }
+        , maxRetries(0)
+        , nRetries(0)
+        , nUndelivered(0)
+        , nResults(0)
+        , results(NULL)
+        , nInFrameReplies(0)
+    {
+        for (int i = 0; i < VAN_TX_MAX_IN_FRAME_REPLIES; i++) inFrameReplies[i] = NULL;
+    }
 
-    void Setup(uint8_t theRxPin, uint8_t theTxPin);
+    bool Setup(uint8_t theRxPin, uint8_t theTxPin, int isrCore = VAN_ISR_CORE_CALLER,
+        int queueSize = VAN_DEFAULT_TX_QUEUE_SIZE);
     bool SyncSendPacket(uint16_t iden, uint8_t cmdFlags, const uint8_t* data, size_t dataLen, unsigned int timeOutMs = 10);
-    bool SendPacket(uint16_t iden, uint8_t cmdFlags, const uint8_t* data, size_t dataLen, unsigned int timeOutMs = 10);
+    bool SendPacket(uint16_t iden, uint8_t cmdFlags, const uint8_t* data, size_t dataLen, unsigned int timeOutMs = 10,
+        uint8_t priority = VAN_TX_PRIORITY_NORMAL, unsigned int deadlineMs = 0);
+    bool SyncSendPacket(const TVanPreparedTxPacket& packet, unsigned int timeOutMs = 10);
+    bool SendPacket(const TVanPreparedTxPacket& packet, unsigned int timeOutMs = 10,
+        uint8_t priority = VAN_TX_PRIORITY_NORMAL, unsigned int deadlineMs = 0);
+
+    // Non-blocking: returns 'false' immediately if the Tx queue is full. Otherwise, the sequence number of the queued
+    // packet is returned in 'n' (if not NULL); pass that to 'GetTxResult' to find out how the transmission went.
+    bool QueuePacket(uint16_t iden, uint8_t cmdFlags, const uint8_t* data, size_t dataLen, uint32_t* n = NULL,
+        uint8_t priority = VAN_TX_PRIORITY_NORMAL, unsigned int deadlineMs = 0);
+    bool QueuePacket(const TVanPreparedTxPacket& packet, uint32_t* n = NULL,
+        uint8_t priority = VAN_TX_PRIORITY_NORMAL, unsigned int deadlineMs = 0);
+
+    // Returns VAN_TX_UNKNOWN if 'n' was never queued, or is too old to remember; otherwise the outcome so far.
+    // If 'result' is not NULL, the details are copied into it.
+    PacketTxResult_t GetTxResult(uint32_t n, TVanPacketTxResult* result = NULL) const;
+
+    // In-frame reply to a read request (R/W and RTR flags set): as soon as the header of a packet with the IDEN
+    // and command flags of 'reply' is received, the receiver ISR starts transmitting the data and CRC of 'reply'.
+    // The object 'reply' is not copied, so it must remain valid, and must not be changed (e.g. with 'SetData' or
+    // 'SetByte'), while registered: the ISR may be sending it at any time. To change the reply, register another
+    // object in its place, or unregister it first. A reply registered earlier for the same IDEN and command flags is
+    // replaced. Returns false if the table is full, if 'reply' is not a read request, or when using VAN_RX_ESP32_RMT
+    // or VAN_TX_ESP32_RMT.
+    // When a reply is replaced ('SetInFrameReply') or unregistered ('ClearInFrameReply') while the ISR is sending
+    // it, these functions wait until it has been sent, at most 'timeOutMs' milliseconds; after return, the old reply
+    // may be changed or freed. If it was still being sent after 'timeOutMs', they return false; the table is updated
+    // anyway, but the old reply must not be changed or freed until 'IsSendingInFrameReply' returns false for it.
+    bool SetInFrameReply(const TVanPreparedTxPacket* reply, unsigned int timeOutMs = 10);
+    bool ClearInFrameReply(uint16_t iden, unsigned int timeOutMs = 10);
+    bool IsSendingInFrameReply(const TVanPreparedTxPacket* reply) const;
+
+    // Reliable send of packets with the RAK (Request AcKnowledge) flag set in the command flags: if no receiver
+    // acknowledges the packet, or if a bit error is seen, the packet is sent again after a random backoff, at most
+    // 'maxRetries' (at most 255) times. Set 'maxRetries' to 0 to turn off. Applies to packets queued after the call.
+    void SetReliableSend(int maxRetries = VAN_TX_DEFAULT_MAX_RETRIES)
+    {
+        this->maxRetries = maxRetries < 0 ? 0 : maxRetries > 255 ? 255 : maxRetries;
+    } // SetReliableSend
+
     uint32_t GetCount() const { ISR_SAFE_GET(uint32_t, count); }
     void DumpStats(Stream& s) const;
 
+    // Returns true while a packet is waiting to be sent, or being sent
+    bool IsBusy() const;
+
+  #ifdef VAN_ISR_PROFILING
+    // Prints the execution time statistics of 'SendBitIsr'. Optionally clears them afterwards.
+    void DumpIsrProfile(Stream& s, bool reset = false);
+  #endif // VAN_ISR_PROFILING
+
   private:
 
     uint8_t txPin;
-    TVanPacketTxDesc pool[VAN_TX_QUEUE_SIZE];
-    TVanPacketTxDesc* volatile _head;
-    TVanPacketTxDesc* volatile _tail;
+    int size;
+    TVanPacketTxDesc* pool;
+    TVanPacketTxDesc* volatile _head;  // Slot to be filled next
+    TVanPacketTxDesc* volatile _tail;  // Packet being sent, or to be sent next
     TVanPacketTxDesc* end;
 
     // Some statistics. Numbers can roll over.
     uint32_t count;
     uint32_t nDropped;
+    uint32_t nExpired;
     uint32_t nSingleCollisions;
     uint32_t nMultipleCollisions;
     uint32_t nMaxCollisionErrors;
 
-    bool SlotAvailable() const { ISR_SAFE_GET(bool, _head->state == VAN_TX_DONE); }
+    int maxRetries;
+    uint32_t nRetries;
+    uint32_t nUndelivered;  // Reliable send: given up after 'maxRetries' retries
+
+    // Outcome of the most recently queued packets, indexed by sequence number. Twice the queue size, so that the
+    // outcome of a packet remains available for a while after it leaves the queue.
+    int nResults;
+    TVanPacketTxResult* results;
+
+    const TVanPreparedTxPacket* volatile inFrameReplies[VAN_TX_MAX_IN_FRAME_REPLIES];
+    uint32_t nInFrameReplies;
+
+  #ifdef VAN_ISR_PROFILING
+    TIsrProfile sendBitIsrProfile;
+  #endif // VAN_ISR_PROFILING
+
+    bool AbortSetup();
+    bool ReplaceInFrameReply(int i, const TVanPreparedTxPacket* reply, unsigned int timeOutMs);
+    bool SlotAvailable();
     static void StartBitSendTimer();
-    bool WaitForHeadAvailable(unsigned int timeOutMs = 10);
+    static void IRAM_ATTR StopBitSendTimer();
+    static void WaitForTxDone();
+    bool WaitForHeadAvailable(unsigned long start, unsigned int timeOutMs);
+    bool WaitForPacketDone(const TVanPacketTxDesc* txDesc, unsigned long start, unsigned int timeOutMs);
 
     // Only to be called from ISR, unsafe otherwise
     void IRAM_ATTR _AdvanceTail()
     {
         _tail->state = VAN_TX_DONE;
-        if (++_tail == end) _tail = pool;  // roll over if needed
+        _SelectNext();
     } // _AdvanceTail
 
     void AdvanceHead()
@@ -133,8 +332,21 @@ class TVanPacketTxQueue
         count++;
     } // AdvanceHead
 
+    // Only to be called from ISR, unsafe otherwise
+    bool IRAM_ATTR _SelectNext();
+    void IRAM_ATTR _SetResult(const TVanPacketTxDesc* txDesc, PacketTxResult_t outcome);
+
     friend void FinishPacketTransmission(TVanPacketTxDesc* txDesc);
+    friend void RetryPacketTransmission(TVanPacketTxDesc* txDesc);
     friend void SendBitIsr();
+    friend void SendReplyBitIsr();
+    friend void InFrameReplyIsr(uint16_t header);
+  #ifdef VAN_TX_ESP32_RMT
+    friend void StartRmtTransmission(TVanPacketTxDesc* txDesc);
+    friend void RmtTxTask(void* param);
+    friend void TxRmtCheckEdge(uint32_t curr, int pinLevel);
+    friend void RmtTxEndCallback(rmt_channel_t channel, void* arg);
+  #endif // VAN_TX_ESP32_RMT
     friend class TVanPacketTxDesc;
 }; // class TVanPacketTxQueue
 
@@ -3,7 +3,7 @@
  *
  * Written by Erik Tromp
  *
- * Version 0.4.1 - September, 2024
+ * Version 0.4.2 - October, 2026
  *
  * MIT license, all text above must be included in any redistribution.
  */
@@ -11,13 +11,13 @@
 #ifndef VanBusVersion_h
 #define VanBusVersion_h
 
-#define VAN_BUS_VERSION "0.4.1"
+#define VAN_BUS_VERSION "0.4.2"
 
 #define VAN_BUS_VERSION_MAJOR 0
 #define VAN_BUS_VERSION_MINOR 4
-#define VAN_BUS_VERSION_PATCH 1
+#define VAN_BUS_VERSION_PATCH 2
 
-#define VAN_BUS_VERSION_INT 000004001
+#define VAN_BUS_VERSION_INT 000004002
 
 #define VAN_BUS_RX_VERSION VAN_BUS_VERSION_INT
 